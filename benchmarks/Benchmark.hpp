@@ -0,0 +1,150 @@
+#ifndef MAFS_BENCHMARK_H
+#define MAFS_BENCHMARK_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fmt/format.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * Minimal benchmark harness, modeled after Google Benchmark.
+ *
+ * A benchmark is a function taking a State; it does its setup, then runs the measured code inside
+ * "while (State.KeepRunning())" and declares the work done per iteration with SetFlops/SetBytes so
+ * the runner can report GFLOP/s and GB/s. Each benchmark runs until it has been measured for at
+ * least the minimum time, doubling the iteration count between attempts.
+ */
+namespace Mafs::Bench {
+
+/**
+ * @brief Keeps the compiler from optimizing away a value.
+ */
+template <typename T> inline void DoNotOptimize(T const &Value) {
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : "r,m"(Value) : "memory");
+#else
+  static volatile const void *pSink;
+  pSink = &Value;
+#endif
+}
+
+/**
+ * @brief Benchmark loop state.
+ */
+class State {
+protected:
+  size_t m_nIterations;     // Iterations requested for this attempt.
+  size_t m_nDone = 0;       // Iterations done so far.
+  double m_Flops = 0;       // Floating point operations per iteration.
+  double m_Bytes = 0;       // Bytes read + written per iteration.
+  std::chrono::steady_clock::time_point m_Start;
+  std::chrono::steady_clock::duration m_Elapsed{};
+  bool m_bRunning = false;
+
+public:
+  explicit State(size_t nIterations) : m_nIterations(nIterations) {}
+
+  /**
+   * @brief Returns true while the benchmark must keep iterating. Starts the clock on the first
+   * call and stops it on the last one, so the setup before the loop is not measured.
+   */
+  inline auto KeepRunning() -> bool {
+    if (!m_bRunning) {
+      m_bRunning = true;
+      m_Start = std::chrono::steady_clock::now();
+    }
+    if (m_nDone++ < m_nIterations)
+      return true;
+    m_Elapsed = std::chrono::steady_clock::now() - m_Start;
+    return false;
+  }
+
+  inline void SetFlops(double Flops) { m_Flops = Flops; }
+  inline void SetBytes(double Bytes) { m_Bytes = Bytes; }
+
+  inline size_t Iterations() const { return m_nIterations; }
+  inline double Flops() const { return m_Flops; }
+  inline double Bytes() const { return m_Bytes; }
+  inline double Seconds() const { return std::chrono::duration<double>(m_Elapsed).count(); }
+};
+
+/**
+ * @brief A registered benchmark.
+ */
+struct Benchmark {
+  std::string strName;
+  std::function<void(State &)> Func;
+};
+
+/**
+ * @brief Result of a benchmark run.
+ */
+struct Result {
+  std::string strName;
+  size_t nIterations = 0;
+  double NsPerIteration = 0;
+  double GFlops = 0;
+  double GBytes = 0;
+};
+
+inline auto Registry() -> std::vector<Benchmark> & {
+  static std::vector<Benchmark> Benchmarks;
+  return Benchmarks;
+}
+
+/**
+ * @brief Registers Func under strName.
+ */
+inline void Register(const std::string &strName, std::function<void(State &)> Func) {
+  Registry().push_back({strName, std::move(Func)});
+}
+
+/**
+ * @brief Runs Bench until it has been measured for at least MinSeconds.
+ */
+inline auto Run(const Benchmark &Bench, double MinSeconds) -> Result {
+  size_t nIterations = 1;
+  while (true) {
+    State Current(nIterations);
+    Bench.Func(Current);
+    const double Seconds = Current.Seconds();
+    if (Seconds >= MinSeconds || nIterations >= (size_t(1) << 30)) {
+      Result Rtn;
+      Rtn.strName = Bench.strName;
+      Rtn.nIterations = nIterations;
+      Rtn.NsPerIteration = Seconds * 1e9 / static_cast<double>(nIterations);
+      Rtn.GFlops = Current.Flops() * static_cast<double>(nIterations) / Seconds * 1e-9;
+      Rtn.GBytes = Current.Bytes() * static_cast<double>(nIterations) / Seconds * 1e-9;
+      return Rtn;
+    }
+    // Aim directly for the minimum time, at most 10x more iterations per attempt.
+    const double Scale = Seconds > 0 ? MinSeconds * 1.4 / Seconds : 10;
+    nIterations = std::max(nIterations + 1,
+                           static_cast<size_t>(static_cast<double>(nIterations) *
+                                               std::min(10.0, Scale)));
+  }
+}
+
+/**
+ * @brief Serializes the results (and the run context) as JSON.
+ */
+inline auto ToJson(const std::vector<Result> &Results, const std::string &strContext)
+    -> std::string {
+  std::string strJson =
+      fmt::format("{{\n  \"context\": {{{}}},\n  \"benchmarks\": [\n", strContext);
+  for (size_t i = 0; i < Results.size(); ++i) {
+    const Result &Res = Results[i];
+    strJson += fmt::format("    {{\"name\": \"{}\", \"iterations\": {}, \"real_time\": {:.3f}, "
+                           "\"time_unit\": \"ns\", \"gflops\": {:.4f}, "
+                           "\"bytes_per_second\": {:.6e}}}{}\n",
+                           Res.strName, Res.nIterations, Res.NsPerIteration, Res.GFlops,
+                           Res.GBytes * 1e9, i + 1 < Results.size() ? "," : "");
+  }
+  return strJson + "  ]\n}\n";
+}
+}; // namespace Mafs::Bench
+
+#endif // MAFS_BENCHMARK_H
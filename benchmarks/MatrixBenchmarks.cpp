@@ -0,0 +1,460 @@
+/*********************************************************************************
+ * MatrixBenchmarks.cpp
+ * Benchmarks for the MtxOperation entries, the containers and the MatrixBase helpers.
+ * Every benchmark is registered for float/double and row/col major dynamic matrices.
+ *********************************************************************************/
+
+#include "Benchmark.hpp"
+#include <Mafs/Matrix/Bit/BitOperations.hpp>
+#include <Mafs/Matrix/Matrix.hpp>
+#include <Mafs/Matrix/Operations/Operations.hpp>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace {
+using Mafs::Bench::DoNotOptimize;
+using Mafs::Bench::Register;
+using Mafs::Bench::State;
+
+template <typename T, size_t Options_> using DynMatrix = Mafs::Matrix<T, 0, 0, Options_>;
+
+template <typename T> constexpr auto TypeName() -> const char * {
+  return sizeof(T) == sizeof(float) ? "float" : "double";
+}
+
+template <size_t Options_> constexpr auto OrderName() -> const char * {
+  return AreEnumsEqual<Options_ & 0x1, Mafs::MtxRowMajor>() ? "RowMajor" : "ColMajor";
+}
+
+template <typename T, size_t Options_>
+auto RandomMatrix(size_t nRows, size_t nCols, unsigned nSeed) -> DynMatrix<T, Options_> {
+  std::mt19937 Generator(nSeed);
+  std::uniform_real_distribution<T> Distribution(-1, 1);
+  DynMatrix<T, Options_> Matrix(nRows, nCols);
+  for (size_t i = 0; i < Matrix.Size(); ++i)
+    Matrix.Data()[i] = Distribution(Generator);
+  return Matrix;
+}
+
+// Well conditioned system for the solvers.
+template <typename T, size_t Options_> auto SolverMatrix(size_t nSize) -> DynMatrix<T, Options_> {
+  auto Matrix = RandomMatrix<T, Options_>(nSize, nSize, 1);
+  for (size_t i = 0; i < nSize; ++i)
+    Matrix(i, i) += static_cast<T>(nSize);
+  return Matrix;
+}
+
+template <typename T, size_t Options_> void RegisterMatrixBenchmarks() {
+  const std::string strSuffix = fmt::format("<{},{}>", TypeName<T>(), OrderName<Options_>());
+  const double nElementSize = sizeof(T);
+
+  // --- MtxOperation ---
+  for (size_t n : {64, 256, 1024})
+    Register(fmt::format("Sum{}/{}", strSuffix, n), [n, nElementSize](State &Bench) {
+      const auto A = RandomMatrix<T, Options_>(n, n, 1);
+      const auto B = RandomMatrix<T, Options_>(n, n, 2);
+      Bench.SetFlops(static_cast<double>(n * n));
+      Bench.SetBytes(3 * nElementSize * static_cast<double>(n * n));
+      while (Bench.KeepRunning()) {
+        auto C = Mafs::Internal::MtxOperation.Sum(A, B);
+        DoNotOptimize(C.Data()[0]);
+      }
+    });
+
+  for (size_t n : {64, 256, 512}) {
+    const double Flops =
+        2.0 / 3.0 * static_cast<double>(n * n * n) + 2.0 * static_cast<double>(n * n);
+    Register(fmt::format("Solve{}/{}", strSuffix, n), [n, Flops, nElementSize](State &Bench) {
+      const auto A = SolverMatrix<T, Options_>(n);
+      const auto B = RandomMatrix<T, Options_>(n, 1, 2);
+      Bench.SetFlops(Flops);
+      Bench.SetBytes(nElementSize * static_cast<double>(n * n));
+      while (Bench.KeepRunning()) {
+        auto X = Mafs::Internal::MtxOperation.Solve(A, B);
+        DoNotOptimize(X.Data()[0]);
+      }
+    });
+    Register(fmt::format("MixedPrecisionSolve{}/{}", strSuffix, n),
+             [n, Flops, nElementSize](State &Bench) {
+               const auto A = SolverMatrix<T, Options_>(n);
+               const auto B = RandomMatrix<T, Options_>(n, 1, 2);
+               Bench.SetFlops(Flops);
+               Bench.SetBytes(nElementSize * static_cast<double>(n * n));
+               while (Bench.KeepRunning()) {
+                 auto X = Mafs::Internal::MtxOperation.MixedPrecisionSolve(A, B);
+                 DoNotOptimize(X.Data()[0]);
+               }
+             });
+  }
+
+  // Only the lower triangle is read, a random matrix is as good as a symmetric one.
+  for (size_t n : {64, 256, 512})
+    for (size_t nCount : {size_t(0), size_t(10)})
+      Register(fmt::format("SymmetricEigen{}{}/{}", nCount == 0 ? "" : "Top10", strSuffix, n),
+               [n, nCount, nElementSize](State &Bench) {
+                 const auto A = RandomMatrix<T, Options_>(n, n, 1);
+                 const size_t nVectors = nCount == 0 ? n : nCount;
+                 Bench.SetFlops(4.0 / 3.0 * static_cast<double>(n * n * n) +
+                                2.0 * static_cast<double>(n * n * nVectors));
+                 Bench.SetBytes(nElementSize * static_cast<double>(n * (n + nVectors)));
+                 while (Bench.KeepRunning()) {
+                   auto Eigen = Mafs::Internal::MtxOperation.SymmetricEigen(
+                       A, Mafs::MtxEigenVectors, nCount);
+                   DoNotOptimize(Eigen.Values[0]);
+                 }
+               });
+
+  // 2n x n, full SVD and rank 10 randomized SVD (2 power iterations).
+  for (size_t n : {64, 256, 512})
+    for (size_t nRank : {size_t(0), size_t(10)})
+      Register(fmt::format("{}Svd{}/{}", nRank == 0 ? "" : "Randomized", strSuffix, n),
+               [n, nRank, nElementSize](State &Bench) {
+                 const auto A = RandomMatrix<T, Options_>(2 * n, n, 1);
+                 const double Size = static_cast<double>(2 * n * n);
+                 Bench.SetFlops(nRank == 0 ? 20.0 * Size * static_cast<double>(n)
+                                           : 12.0 * Size * static_cast<double>(nRank + 10));
+                 Bench.SetBytes(nElementSize * Size * (nRank == 0 ? 3.0 : 6.0));
+                 while (Bench.KeepRunning()) {
+                   auto Svd = nRank == 0 ? Mafs::Internal::MtxOperation.Svd(A)
+                                         : Mafs::Internal::MtxOperation.RandomizedSvd(A, nRank);
+                   DoNotOptimize(Svd.Values[0]);
+                 }
+               });
+
+  for (size_t n : {64, 256, 512}) {
+    Register(fmt::format("Multiplication{}/{}", strSuffix, n), [n, nElementSize](State &Bench) {
+      const auto A = RandomMatrix<T, Options_>(n, n, 1);
+      const auto B = RandomMatrix<T, Options_>(n, n, 2);
+      Bench.SetFlops(2.0 * static_cast<double>(n * n * n));
+      Bench.SetBytes(3 * nElementSize * static_cast<double>(n * n));
+      while (Bench.KeepRunning()) {
+        auto C = Mafs::Internal::MtxOperation.Multiplication(A, B);
+        DoNotOptimize(C.Data()[0]);
+      }
+    });
+    // Gram matrices of 4n x n samples: A^T * A reads A in place, A * A^T packs panels of A^T.
+    for (const auto eOp : {Mafs::MtxTrans, Mafs::MtxNoTrans})
+      Register(fmt::format("Gram{}{}/{}", eOp == Mafs::MtxTrans ? "AtA" : "AAt", strSuffix, n),
+               [n, eOp, nElementSize](State &Bench) {
+                 const auto A = eOp == Mafs::MtxTrans ? RandomMatrix<T, Options_>(4 * n, n, 1)
+                                                      : RandomMatrix<T, Options_>(n, 4 * n, 1);
+                 Bench.SetFlops(static_cast<double>(n * (n + 1) * 4 * n));
+                 Bench.SetBytes(5 * nElementSize * static_cast<double>(n * n));
+                 while (Bench.KeepRunning()) {
+                   auto C = Mafs::Internal::MtxOperation.Gram(A, eOp);
+                   DoNotOptimize(C.Data()[0]);
+                 }
+               });
+    // Dense layer C = relu(A * B + bias): the fused epilogue, then the product and a separate
+    // pass over C.
+    for (const bool bFused : {true, false})
+      Register(fmt::format("BiasRelu{}{}/{}", bFused ? "Fused" : "Separate", strSuffix, n),
+               [n, bFused, nElementSize](State &Bench) {
+                 const auto A = RandomMatrix<T, Options_>(n, n, 1);
+                 const auto B = RandomMatrix<T, Options_>(n, n, 2);
+                 const auto Bias = RandomMatrix<T, Options_>(1, n, 3);
+                 const auto Relu = [](T Value) { return Value > T(0) ? Value : T(0); };
+                 auto C = RandomMatrix<T, Options_>(n, n, 4);
+                 Bench.SetFlops(2.0 * static_cast<double>(n * n * n));
+                 Bench.SetBytes(3 * nElementSize * static_cast<double>(n * n));
+                 while (Bench.KeepRunning()) {
+                   if (bFused) {
+                     Mafs::Internal::MtxOperation.Multiplication(
+                         A, Mafs::MtxNoTrans, B, Mafs::MtxNoTrans, C, T(1), T(0),
+                         Mafs::MtxEpilogue{Mafs::MtxColBias, Bias.Data(), Relu});
+                   } else {
+                     Mafs::Internal::MtxOperation.Multiplication(A, Mafs::MtxNoTrans, B,
+                                                                 Mafs::MtxNoTrans, C);
+                     const bool bRowMajor = AreEnumsEqual<Options_ & 0x1, Mafs::MtxRowMajor>();
+                     for (size_t k = 0; k < n * n; ++k)
+                       C.Data()[k] = Relu(C.Data()[k] + Bias.Data()[bRowMajor ? k % n : k / n]);
+                   }
+                   DoNotOptimize(C.Data()[0]);
+                 }
+               });
+  }
+
+  // Markov chain propagation P^1000 (15 products) and exp of a matrix of norm about n / 2 (6
+  // products, a solve and a few squarings).
+  for (size_t n : {16, 128, 512}) {
+    Register(fmt::format("Power{}/{}", strSuffix, n), [n, nElementSize](State &Bench) {
+      auto A = RandomMatrix<T, Options_>(n, n, 1);
+      // Stochastic rows, so the powers neither overflow nor vanish.
+      for (size_t i = 0; i < n; ++i) {
+        T Sum = 0;
+        for (size_t j = 0; j < n; ++j)
+          Sum += A(i, j) = std::abs(A(i, j));
+        for (size_t j = 0; j < n; ++j)
+          A(i, j) /= Sum;
+      }
+      Bench.SetFlops(30.0 * static_cast<double>(n * n * n));
+      Bench.SetBytes(2 * nElementSize * static_cast<double>(n * n));
+      auto B = A;
+      while (Bench.KeepRunning()) {
+        Mafs::Internal::MtxOperation.Power(A, 1000, B);
+        DoNotOptimize(B.Data()[0]);
+      }
+    });
+    Register(fmt::format("Exp{}/{}", strSuffix, n), [n, nElementSize](State &Bench) {
+      const auto A = RandomMatrix<T, Options_>(n, n, 1);
+      Bench.SetBytes(2 * nElementSize * static_cast<double>(n * n));
+      auto B = A;
+      while (Bench.KeepRunning()) {
+        Mafs::Internal::MtxOperation.Exp(A, B);
+        DoNotOptimize(B.Data()[0]);
+      }
+    });
+  }
+
+  // Image filtering: a 3x3 blur (direct kernel) and a bank of 8 11x11 filters (im2col products),
+  // correlated and convolved (the flipped filters).
+  for (size_t nFilter : {3, 11}) {
+    const size_t nFilters = nFilter == 3 ? 1 : 8;
+    for (const bool bConvolution : {false, true})
+      Register(fmt::format("{}{}/{}x{}x{}", bConvolution ? "Convolution" : "Correlation", strSuffix,
+                           nFilters, nFilter, nFilter),
+               [nFilter, nFilters, bConvolution, nElementSize](State &Bench) {
+                 const size_t n = 512;
+                 const auto A = RandomMatrix<T, Options_>(n, n, 1);
+                 std::vector<Mafs::Matrix<T, 0, 0, Options_>> Filters;
+                 for (size_t f = 0; f < nFilters; ++f)
+                   Filters.push_back(RandomMatrix<T, Options_>(nFilter, nFilter, f + 2));
+                 const size_t nOut = n - nFilter + 1;
+                 Bench.SetFlops(2.0 *
+                                static_cast<double>(nFilters * nOut * nOut * nFilter * nFilter));
+                 Bench.SetBytes(nElementSize *
+                                static_cast<double>(n * n + nFilters * nOut * nOut));
+                 while (Bench.KeepRunning()) {
+                   auto Outputs = bConvolution
+                                      ? Mafs::Internal::MtxOperation.Convolution(A, Filters)
+                                      : Mafs::Internal::MtxOperation.Correlation(A, Filters);
+                   DoNotOptimize(Outputs[0].Data()[0]);
+                 }
+               });
+  }
+
+  for (size_t n : {64, 256, 1024, 4096})
+    Register(fmt::format("Transpose{}/{}", strSuffix, n), [n, nElementSize](State &Bench) {
+      const auto A = RandomMatrix<T, Options_>(n, n, 1);
+      Bench.SetBytes(2 * nElementSize * static_cast<double>(n * n));
+      while (Bench.KeepRunning()) {
+        auto B = Mafs::Internal::MtxOperation.Transpose(A);
+        DoNotOptimize(B.Data()[0]);
+      }
+    });
+
+  for (size_t n : {64, 256, 1024}) {
+    Register(fmt::format("HorizontalConcat{}/{}", strSuffix, n), [n, nElementSize](State &Bench) {
+      const auto A = RandomMatrix<T, Options_>(n, n, 1);
+      const auto B = RandomMatrix<T, Options_>(n, n, 2);
+      Bench.SetBytes(4 * nElementSize * static_cast<double>(n * n));
+      while (Bench.KeepRunning()) {
+        auto C = Mafs::Internal::MtxOperation.HorizontalConcat(A, B);
+        DoNotOptimize(C.Data()[0]);
+      }
+    });
+    Register(fmt::format("VerticalConcat{}/{}", strSuffix, n), [n, nElementSize](State &Bench) {
+      const auto A = RandomMatrix<T, Options_>(n, n, 1);
+      const auto B = RandomMatrix<T, Options_>(n, n, 2);
+      Bench.SetBytes(4 * nElementSize * static_cast<double>(n * n));
+      while (Bench.KeepRunning()) {
+        auto C = Mafs::Internal::MtxOperation.VerticalConcat(A, B);
+        DoNotOptimize(C.Data()[0]);
+      }
+    });
+  }
+
+  // --- MatrixBase ---
+  for (size_t n : {64, 256, 1024}) {
+    Register(fmt::format("SwapRows{}/{}", strSuffix, n), [n, nElementSize](State &Bench) {
+      auto A = RandomMatrix<T, Options_>(n, n, 1);
+      Bench.SetBytes(4 * nElementSize * static_cast<double>(n));
+      size_t i = 0;
+      while (Bench.KeepRunning()) {
+        A.SwapRows(i % n, n - 1 - i % n);
+        ++i;
+      }
+      DoNotOptimize(A.Data()[0]);
+    });
+    Register(fmt::format("SwapCols{}/{}", strSuffix, n), [n, nElementSize](State &Bench) {
+      auto A = RandomMatrix<T, Options_>(n, n, 1);
+      Bench.SetBytes(4 * nElementSize * static_cast<double>(n));
+      size_t i = 0;
+      while (Bench.KeepRunning()) {
+        A.SwapCols(i % n, n - 1 - i % n);
+        ++i;
+      }
+      DoNotOptimize(A.Data()[0]);
+    });
+  }
+
+  // Appends an n x n block, and collects n samples of 1 x n one row at a time (amortized by the
+  // geometric growth in row major, every col moves in col major).
+  for (size_t n : {64, 256, 1024}) {
+    Register(fmt::format("AppendRows{}/{}", strSuffix, n), [n, nElementSize](State &Bench) {
+      const auto A = RandomMatrix<T, Options_>(n, n, 1);
+      const auto B = RandomMatrix<T, Options_>(n, n, 2);
+      Bench.SetBytes(5 * nElementSize * static_cast<double>(n * n));
+      while (Bench.KeepRunning()) {
+        auto C = A;
+        C.AppendRows(B);
+        DoNotOptimize(C.Data()[0]);
+      }
+    });
+    // Inserts n / 4 rows in the middle and removes them, so the size stays the same.
+    Register(fmt::format("InsertRows{}/{}", strSuffix, n), [n, nElementSize](State &Bench) {
+      auto A = RandomMatrix<T, Options_>(n, n, 1);
+      const auto Rows = RandomMatrix<T, Options_>(n / 4, n, 2);
+      Bench.SetBytes(2 * nElementSize * static_cast<double>(n * n));
+      while (Bench.KeepRunning()) {
+        A.InsertRows(n / 2, Rows);
+        A.RemoveRows(n / 2, n / 4);
+      }
+      DoNotOptimize(A.Data()[0]);
+    });
+  }
+  for (size_t n : {64, 256})
+    Register(fmt::format("AppendRowByRow{}/{}", strSuffix, n), [n, nElementSize](State &Bench) {
+      const auto Sample = RandomMatrix<T, Options_>(1, n, 1);
+      Bench.SetBytes(nElementSize * static_cast<double>(n * n));
+      while (Bench.KeepRunning()) {
+        DynMatrix<T, Options_> Samples;
+        for (size_t i = 0; i < n; ++i)
+          Samples.AppendRows(Sample);
+        DoNotOptimize(Samples.Data()[0]);
+      }
+    });
+
+  for (size_t n : {256, 1024, 4096})
+    for (Mafs::MtxSummation eMode : {Mafs::MtxSumFast, Mafs::MtxSumPairwise, Mafs::MtxSumKahan}) {
+      const char *pMode = eMode == Mafs::MtxSumFast ? "" : eMode == Mafs::MtxSumKahan ? "Kahan"
+                                                                                      : "Pairwise";
+      Register(fmt::format("Reduce{}{}/{}", pMode, strSuffix, n),
+               [n, nElementSize, eMode](State &Bench) {
+                 const auto A = RandomMatrix<T, Options_>(n, n, 1);
+                 Bench.SetFlops(static_cast<double>(n * n));
+                 Bench.SetBytes(nElementSize * static_cast<double>(n * n));
+                 while (Bench.KeepRunning())
+                   DoNotOptimize(A.Sum(eMode));
+               });
+    }
+  for (size_t n : {256, 1024})
+    Register(fmt::format("ApplyTanh{}/{}", strSuffix, n), [n, nElementSize](State &Bench) {
+      auto A = RandomMatrix<T, Options_>(n, n, 1);
+      Bench.SetBytes(2 * nElementSize * static_cast<double>(n * n));
+      while (Bench.KeepRunning())
+        A.Apply(Mafs::MtxTanh{});
+      DoNotOptimize(A.Data()[0]);
+    });
+  for (size_t n : {256, 1024})
+    Register(fmt::format("RowNorms{}/{}", strSuffix, n), [n, nElementSize](State &Bench) {
+      const auto A = RandomMatrix<T, Options_>(n, n, 1);
+      Bench.SetFlops(2 * static_cast<double>(n * n));
+      Bench.SetBytes(nElementSize * static_cast<double>(n * n));
+      while (Bench.KeepRunning()) {
+        auto Norms = A.RowReduce(Mafs::MtxReduceNorm);
+        DoNotOptimize(Norms[0]);
+      }
+    });
+  for (size_t n : {256, 1024}) {
+    Register(fmt::format("Fill{}/{}", strSuffix, n), [n, nElementSize](State &Bench) {
+      auto A = RandomMatrix<T, Options_>(n, n, 1);
+      Bench.SetBytes(nElementSize * static_cast<double>(n * n));
+      while (Bench.KeepRunning())
+        A.Fill(T(2));
+      DoNotOptimize(A.Data()[0]);
+    });
+    Register(fmt::format("SetRandom{}/{}", strSuffix, n), [n, nElementSize](State &Bench) {
+      auto A = RandomMatrix<T, Options_>(n, n, 1);
+      Bench.SetBytes(nElementSize * static_cast<double>(n * n));
+      while (Bench.KeepRunning())
+        A.SetRandom(T(-1), T(1), 7);
+      DoNotOptimize(A.Data()[0]);
+    });
+    Register(fmt::format("SetRandomNormal{}/{}", strSuffix, n), [n, nElementSize](State &Bench) {
+      auto A = RandomMatrix<T, Options_>(n, n, 1);
+      Bench.SetBytes(nElementSize * static_cast<double>(n * n));
+      while (Bench.KeepRunning())
+        A.SetRandomNormal(T(0), T(1), 7);
+      DoNotOptimize(A.Data()[0]);
+    });
+  }
+
+  for (size_t n : {16, 64, 256})
+    Register(fmt::format("ToString{}/{}", strSuffix, n), [n](State &Bench) {
+      auto A = RandomMatrix<T, Options_>(n, n, 1);
+      Bench.SetBytes(static_cast<double>(A.ToString().size()));
+      while (Bench.KeepRunning()) {
+        auto strText = A.ToString();
+        DoNotOptimize(strText.data()[0]);
+      }
+    });
+}
+
+template <typename T> void RegisterContainerBenchmarks() {
+  const std::string strSuffix = fmt::format("<{}>", TypeName<T>());
+  for (size_t n : {64, 256, 1024}) {
+    Register(fmt::format("ContainerAlloc{}/{}", strSuffix, n), [n](State &Bench) {
+      while (Bench.KeepRunning()) {
+        Mafs::Internal::Container<T, Mafs::MtxDynamic, Mafs::MtxDynamic> Container(n, n);
+        DoNotOptimize(Container.Data());
+      }
+    });
+    Register(fmt::format("ContainerAllocZero{}/{}", strSuffix, n), [n](State &Bench) {
+      while (Bench.KeepRunning()) {
+        Mafs::Internal::Container<T, Mafs::MtxDynamic, Mafs::MtxDynamic> Container(n, n, true);
+        DoNotOptimize(Container.Data());
+      }
+    });
+    Register(fmt::format("ContainerResize{}/{}", strSuffix, n), [n](State &Bench) {
+      Mafs::Internal::Container<T, Mafs::MtxDynamic, Mafs::MtxDynamic> Container(n, n);
+      size_t i = 0;
+      while (Bench.KeepRunning()) {
+        Container.Resize(n + (i++ & 1), n);
+        DoNotOptimize(Container.Data());
+      }
+    });
+  }
+}
+
+void RegisterBitBenchmarks() {
+  // n x 4096 bit matrices of density 1/2: one popcount product reads 64 words per pair of rows.
+  auto RandomBits = [](size_t nRows, size_t nCols, unsigned nSeed) {
+    std::mt19937_64 Generator(nSeed);
+    Mafs::Bit::BitMatrix Matrix(nRows, nCols);
+    for (size_t w = 0; w < nRows * Matrix.WordsPerRow(); ++w)
+      Matrix.Data()[w] = Generator();
+    return Matrix;
+  };
+  for (size_t n : {256, 1024}) {
+    Register(fmt::format("BitIntersectionCount/{}", n), [n, RandomBits](State &Bench) {
+      const auto A = RandomBits(n, 4096, 1), B = RandomBits(n, 4096, 2);
+      Bench.SetBytes(static_cast<double>(2 * n * 512 + 4 * n * n));
+      while (Bench.KeepRunning()) {
+        auto C = Mafs::Bit::IntersectionCount(A, B);
+        DoNotOptimize(C.Data()[0]);
+      }
+    });
+    Register(fmt::format("BitMultiplication/{}", n), [n, RandomBits](State &Bench) {
+      const auto A = RandomBits(n, n, 1), B = RandomBits(n, n, 2);
+      Bench.SetBytes(static_cast<double>(3 * n * n / 8));
+      while (Bench.KeepRunning()) {
+        auto C = Mafs::Bit::Multiplication(A, B);
+        DoNotOptimize(C.Data()[0]);
+      }
+    });
+  }
+}
+
+const bool bRegistered = []() {
+  RegisterMatrixBenchmarks<float, Mafs::MtxRowMajor>();
+  RegisterMatrixBenchmarks<float, Mafs::MtxColMajor>();
+  RegisterMatrixBenchmarks<double, Mafs::MtxRowMajor>();
+  RegisterMatrixBenchmarks<double, Mafs::MtxColMajor>();
+  RegisterContainerBenchmarks<float>();
+  RegisterContainerBenchmarks<double>();
+  RegisterBitBenchmarks();
+  return true;
+}();
+} // namespace
@@ -0,0 +1,87 @@
+/*********************************************************************************
+ * main.cpp
+ * Benchmark runner.
+ *
+ * Usage: benchmarks [--benchmark_filter=<substring>] [--benchmark_min_time=<seconds>]
+ *                   [--benchmark_out=<file.json>] [--benchmark_list]
+ *********************************************************************************/
+
+#include "Benchmark.hpp"
+#include <Mafs/Matrix/MatrixDataTypes.hpp>
+#include <Mafs/Utils/Utils.hpp>
+#include <ctime>
+#include <fstream>
+#include <thread>
+
+static auto ArgValue(const std::string &strArg, const std::string &strName, std::string &strValue)
+    -> bool {
+  const std::string strPrefix = "--" + strName + "=";
+  if (strArg.rfind(strPrefix, 0) != 0)
+    return false;
+  strValue = strArg.substr(strPrefix.size());
+  return true;
+}
+
+static auto Context() -> std::string {
+  using namespace Mafs;
+  char Date[64];
+  const std::time_t Now = std::time(nullptr);
+  std::strftime(Date, sizeof(Date), "%Y-%m-%dT%H:%M:%S", std::localtime(&Now));
+#ifdef MAFS_ENABLE_THREADS
+  const bool bThreads = true;
+#else
+  const bool bThreads = false;
+#endif
+  return fmt::format("\"date\": \"{}\", \"backend\": \"{}\", \"threads_enabled\": {}, "
+                     "\"num_cpus\": {}",
+                     Date,
+                     AreEnumsEqual(MAFS_MATRIX_OPERATION_MODE, MtxOpCuda) ? "Cuda" : "Basic",
+                     bThreads, std::thread::hardware_concurrency());
+}
+
+int main(int argc, char **argv) {
+  std::string strFilter, strOut, strValue;
+  double MinSeconds = 0.2;
+  bool bList = false;
+  for (int i = 1; i < argc; ++i) {
+    const std::string strArg = argv[i];
+    if (ArgValue(strArg, "benchmark_filter", strValue))
+      strFilter = strValue;
+    else if (ArgValue(strArg, "benchmark_min_time", strValue))
+      MinSeconds = std::stod(strValue);
+    else if (ArgValue(strArg, "benchmark_out", strValue))
+      strOut = strValue;
+    else if (strArg == "--benchmark_list")
+      bList = true;
+    else {
+      fmt::print(stderr, "Unknown argument {}\n", strArg);
+      return 1;
+    }
+  }
+
+  std::vector<Mafs::Bench::Result> Results;
+  fmt::print("{:<44} {:>14} {:>12} {:>10} {:>10}\n", "Benchmark", "Time (ns)", "Iterations",
+             "GFLOP/s", "GB/s");
+  for (const auto &Bench : Mafs::Bench::Registry()) {
+    if (Bench.strName.find(strFilter) == std::string::npos)
+      continue;
+    if (bList) {
+      fmt::print("{}\n", Bench.strName);
+      continue;
+    }
+    const auto Res = Mafs::Bench::Run(Bench, MinSeconds);
+    fmt::print("{:<44} {:>14.1f} {:>12} {:>10.3f} {:>10.3f}\n", Res.strName, Res.NsPerIteration,
+               Res.nIterations, Res.GFlops, Res.GBytes);
+    Results.push_back(Res);
+  }
+
+  if (!strOut.empty()) {
+    std::ofstream File(strOut);
+    File << Mafs::Bench::ToJson(Results, Context());
+    if (!File) {
+      fmt::print(stderr, "Could not write {}\n", strOut);
+      return 1;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,43 @@
+/*********************************************************************************
+ * tune.cpp
+ * Tunes the kernel block sizes/thresholds for this host and stores them in the tuning cache.
+ *
+ * Usage: mafs_tune [--size=<n>] [--dry-run]
+ *********************************************************************************/
+
+#include <Mafs/Matrix/Matrix.hpp>
+#include <Mafs/Matrix/Operations/Operations.hpp>
+#include <string>
+
+int main(int argc, char **argv) {
+  size_t nSize = 256;
+  bool bSave = true;
+  for (int i = 1; i < argc; ++i) {
+    const std::string strArg = argv[i];
+    if (strArg.rfind("--size=", 0) == 0)
+      nSize = std::stoul(strArg.substr(7));
+    else if (strArg == "--dry-run")
+      bSave = false;
+    else {
+      fmt::print(stderr, "Unknown argument {}\n", strArg);
+      return 1;
+    }
+  }
+
+  fmt::print("Tuning {}\n", Mafs::Internal::CpuModel());
+  const Mafs::MtxTuningParams Params = Mafs::Internal::MtxOperation.AutoTune(false, nSize);
+  for (const auto &[pName, pField] : Mafs::Internal::TuningFields)
+    fmt::print("{} = {}\n", pName, Params.*pField);
+
+  if (bSave) {
+    const std::string strPath = Mafs::Internal::TuningCachePath();
+    try {
+      Mafs::Internal::SaveTuning(strPath, Mafs::Internal::CpuModel(), Params);
+    } catch (const std::runtime_error &Error) {
+      fmt::print(stderr, "{}\n", Error.what());
+      return 1;
+    }
+    fmt::print("Saved to {}\n", strPath);
+  }
+  return 0;
+}
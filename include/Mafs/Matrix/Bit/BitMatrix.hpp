@@ -0,0 +1,245 @@
+#ifndef MAFS_MATRIX_BIT_BITMATRIX_H
+#define MAFS_MATRIX_BIT_BITMATRIX_H
+
+#include <Mafs/Matrix/Matrix.hpp>
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+#include <stdint.h>
+#include <vector>
+
+namespace Mafs::Bit {
+/**
+ * @brief Boolean matrix packed 64 entries per word.
+ *
+ * Each row is stored row major in WordsPerRow() consecutive 64 bits words, entry [i][j] is bit
+ * j % 64 of word j / 64 of row i. The bits past ColCount in the last word of a row are always
+ * zero, so the word-wise operations and the popcounts never need to mask them.
+ * A nRows x nCols matrix uses nRows * ceil(nCols / 64) * 8 bytes, 8x less than a Matrix<bool>.
+ *
+ * @see BitOperations.hpp for the products.
+ */
+class BitMatrix {
+protected:
+  size_t m_nRows = 0;  // Number of rows.
+  size_t m_nCols = 0;  // Number of cols.
+  size_t m_nWords = 0; // Words per row (ceil(m_nCols / 64)).
+  std::vector<uint64_t> m_Words;
+
+  /**
+   * @brief Valid bits of the last word of each row.
+   */
+  inline auto TailMask() const -> uint64_t {
+    return m_nCols % WordBits == 0 ? ~uint64_t(0) : (uint64_t(1) << (m_nCols % WordBits)) - 1;
+  }
+
+  /**
+   * @brief Zeroes the bits past ColCount (after the operations setting them, e.g. Not).
+   */
+  void ClearPadding() {
+    if (m_nWords == 0)
+      return;
+    const uint64_t Mask = TailMask();
+    for (size_t i = 0; i < m_nRows; ++i)
+      m_Words[i * m_nWords + m_nWords - 1] &= Mask;
+  }
+
+  inline void BoundCheck(size_t nRow, size_t nCol) const {
+    if (nRow >= m_nRows || nCol >= m_nCols)
+      throw std::out_of_range(fmt::format("Index [{}][{}] is out of range", nRow, nCol));
+  }
+
+  inline void DimensionCheck(const BitMatrix &Other) const {
+    if (m_nRows != Other.m_nRows || m_nCols != Other.m_nCols)
+      throw std::domain_error(
+          fmt::format("RowCount and ColCount must be equal. lMatrix[{}][{}] / rMatrix[{}][{}]",
+                      m_nRows, m_nCols, Other.m_nRows, Other.m_nCols));
+  }
+
+  /**
+   * @brief this = Function(this, Other) word by word.
+   */
+  template <typename Func> auto Combine(const BitMatrix &Other, Func Function) -> BitMatrix & {
+    DimensionCheck(Other);
+    for (size_t w = 0; w < m_Words.size(); ++w)
+      m_Words[w] = Function(m_Words[w], Other.m_Words[w]);
+    return *this;
+  }
+
+public:
+  static constexpr size_t WordBits = 64;
+
+  BitMatrix() = default;
+
+  /**
+   * @brief nRows x nCols matrix with every entry set to bValue.
+   *
+   * @param nRows
+   * @param nCols
+   * @param bValue
+   */
+  BitMatrix(size_t nRows, size_t nCols, bool bValue = false)
+      : m_nRows(nRows), m_nCols(nCols), m_nWords((nCols + WordBits - 1) / WordBits),
+        m_Words(nRows * m_nWords, bValue ? ~uint64_t(0) : 0) {
+    ClearPadding();
+  }
+
+  /**
+   * @brief Packs a dense matrix (any type and storage order): an entry is set if the value isn't
+   * zero.
+   *
+   * @param Matrix
+   */
+  template <typename Derived>
+  explicit BitMatrix(const Internal::MatrixBase<Derived> &Matrix)
+      : BitMatrix(Matrix.RowCount(), Matrix.ColCount()) {
+    typedef typename Internal::MatrixTraits<Derived>::Type Type;
+    const Type *pData = Matrix.Data();
+    const size_t nRowStride = Matrix.RowStride(), nColStride = Matrix.ColStride();
+    for (size_t i = 0; i < m_nRows; ++i)
+      for (size_t w = 0; w < m_nWords; ++w) {
+        const size_t nEnd = std::min(m_nCols, (w + 1) * WordBits);
+        uint64_t Word = 0;
+        for (size_t j = w * WordBits; j < nEnd; ++j)
+          Word |= uint64_t(pData[i * nRowStride + j * nColStride] != Type(0)) << (j % WordBits);
+        m_Words[i * m_nWords + w] = Word;
+      }
+  }
+
+  /**
+   * @brief Dense copy of the matrix: 1 for the set entries, 0 for the others.
+   *
+   * @tparam T
+   * @tparam Options_
+   * @return Matrix<T, MtxDynamic, MtxDynamic, Options_>
+   */
+  template <typename T, size_t Options_ = MtxDefaultOptions>
+  auto ToMatrix() const -> Matrix<T, MtxDynamic, MtxDynamic, Options_> {
+    auto Result = Matrix<T, MtxDynamic, MtxDynamic, Options_>::Zero(m_nRows, m_nCols);
+    T *pData = Result.Data();
+    const size_t nRowStride = Result.RowStride(), nColStride = Result.ColStride();
+    for (size_t i = 0; i < m_nRows; ++i)
+      for (size_t w = 0; w < m_nWords; ++w)
+        for (uint64_t Word = m_Words[i * m_nWords + w]; Word != 0; Word &= Word - 1) {
+          const size_t j = w * WordBits + static_cast<size_t>(std::countr_zero(Word));
+          pData[i * nRowStride + j * nColStride] = T(1);
+        }
+    return Result;
+  }
+
+  inline size_t RowCount() const { return m_nRows; }
+  inline size_t ColCount() const { return m_nCols; }
+  inline size_t Size() const { return m_nRows * m_nCols; }
+  inline size_t WordsPerRow() const { return m_nWords; }
+
+  /**
+   * @brief Words of row nRow (WordsPerRow() of them), no bound check.
+   */
+  inline uint64_t *Row(size_t nRow) { return m_Words.data() + nRow * m_nWords; }
+  inline const uint64_t *Row(size_t nRow) const { return m_Words.data() + nRow * m_nWords; }
+  inline uint64_t *Data() { return m_Words.data(); }
+  inline const uint64_t *Data() const { return m_Words.data(); }
+
+  /**
+   * @brief Entry [nRow][nCol], throws std::out_of_range if it is outside the matrix.
+   */
+  auto Get(size_t nRow, size_t nCol) const -> bool {
+    BoundCheck(nRow, nCol);
+    return (Row(nRow)[nCol / WordBits] >> (nCol % WordBits)) & 1;
+  }
+
+  auto operator()(size_t nRow, size_t nCol) const -> bool { return Get(nRow, nCol); }
+
+  /**
+   * @brief Sets entry [nRow][nCol] to bValue, throws std::out_of_range if it is outside the
+   * matrix.
+   */
+  void Set(size_t nRow, size_t nCol, bool bValue = true) {
+    BoundCheck(nRow, nCol);
+    uint64_t &Word = Row(nRow)[nCol / WordBits];
+    const uint64_t Bit = uint64_t(1) << (nCol % WordBits);
+    Word = bValue ? Word | Bit : Word & ~Bit;
+  }
+
+  /**
+   * @brief Sets every entry to bValue.
+   */
+  void Fill(bool bValue) {
+    std::fill(m_Words.begin(), m_Words.end(), bValue ? ~uint64_t(0) : 0);
+    ClearPadding();
+  }
+
+  /**
+   * @brief Number of set entries.
+   */
+  auto Count() const -> size_t {
+    size_t nCount = 0;
+    for (const uint64_t Word : m_Words)
+      nCount += static_cast<size_t>(std::popcount(Word));
+    return nCount;
+  }
+
+  /**
+   * @brief Number of set entries of row nRow.
+   */
+  auto CountRow(size_t nRow) const -> size_t {
+    size_t nCount = 0;
+    for (size_t w = 0; w < m_nWords; ++w)
+      nCount += static_cast<size_t>(std::popcount(Row(nRow)[w]));
+    return nCount;
+  }
+
+  /**
+   * @brief Element-wise AND/OR/XOR with a matrix of the same dimensions (std::domain_error
+   * otherwise).
+   */
+  auto operator&=(const BitMatrix &Other) -> BitMatrix & {
+    return Combine(Other, [](uint64_t a, uint64_t b) { return a & b; });
+  }
+  auto operator|=(const BitMatrix &Other) -> BitMatrix & {
+    return Combine(Other, [](uint64_t a, uint64_t b) { return a | b; });
+  }
+  auto operator^=(const BitMatrix &Other) -> BitMatrix & {
+    return Combine(Other, [](uint64_t a, uint64_t b) { return a ^ b; });
+  }
+  auto operator&(const BitMatrix &Other) const -> BitMatrix { return BitMatrix(*this) &= Other; }
+  auto operator|(const BitMatrix &Other) const -> BitMatrix { return BitMatrix(*this) |= Other; }
+  auto operator^(const BitMatrix &Other) const -> BitMatrix { return BitMatrix(*this) ^= Other; }
+
+  /**
+   * @brief Element-wise NOT.
+   */
+  auto operator~() const -> BitMatrix {
+    BitMatrix Result(*this);
+    for (uint64_t &Word : Result.m_Words)
+      Word = ~Word;
+    Result.ClearPadding();
+    return Result;
+  }
+
+  auto operator==(const BitMatrix &Other) const -> bool {
+    return m_nRows == Other.m_nRows && m_nCols == Other.m_nCols && m_Words == Other.m_Words;
+  }
+
+  /**
+   * @brief Matrix^T, by 64 x 64 blocks of bits.
+   */
+  auto Transpose() const -> BitMatrix {
+    BitMatrix Result(m_nCols, m_nRows);
+    for (size_t ii = 0; ii < m_nRows; ii += WordBits)
+      for (size_t w = 0; w < m_nWords; ++w) {
+        // Block of rows [ii, ii + 64) x cols [64 w, 64 w + 64): bit b of word r goes to bit r of
+        // word b of the result block.
+        const size_t nRows = std::min(WordBits, m_nRows - ii);
+        for (size_t r = 0; r < nRows; ++r)
+          for (uint64_t Word = Row(ii + r)[w]; Word != 0; Word &= Word - 1) {
+            const size_t j = w * WordBits + static_cast<size_t>(std::countr_zero(Word));
+            Result.Row(j)[ii / WordBits] |= uint64_t(1) << r;
+          }
+      }
+    return Result;
+  }
+};
+}; // namespace Mafs::Bit
+
+#endif // MAFS_MATRIX_BIT_BITMATRIX_H
@@ -0,0 +1,169 @@
+#ifndef MAFS_MATRIX_BIT_BITOPERATIONS_H
+#define MAFS_MATRIX_BIT_BITOPERATIONS_H
+
+#include <Mafs/Matrix/Bit/BitMatrix.hpp>
+#include <Mafs/Matrix/Operations/Kernels/Parallel.hpp>
+#include <Mafs/Matrix/Operations/Tuning.hpp>
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+#include <stdint.h>
+
+/**
+ * Products of bit matrices.
+ *
+ * The popcount products compare the rows of lMatrix with the rows of rMatrix (like lMatrix *
+ * rMatrix^T), 64 entries per instruction: the word loops are plain std::popcount reductions that
+ * the compiler turns into POPCNT (-mpopcnt), or into vector popcounts where the target has them
+ * (e.g. -mavx512vpopcntdq). Rows of rMatrix are processed by blocks that stay in cache while
+ * every row of a block of lMatrix is compared with them, and the rows of lMatrix are split among
+ * threads above the tuning parallel threshold (word operations).
+ */
+namespace Mafs::Bit {
+/**
+ * @brief Counts of a popcount product.
+ */
+typedef Matrix<uint32_t, MtxDynamic, MtxDynamic, MtxRowMajor> CountMatrix;
+
+/**
+ * @brief Calls Function(i, j, pRowL, pRowR) for every row i of lMatrix and row j of rMatrix,
+ * blocked and split among threads by rows of lMatrix.
+ */
+template <typename Func>
+void ForEachRowPair(const BitMatrix &lMatrix, const BitMatrix &rMatrix, Func Function) {
+  if (lMatrix.ColCount() != rMatrix.ColCount())
+    throw std::domain_error(
+        fmt::format("ColCount must be equal. lMatrix[{}][{}] / rMatrix[{}][{}]",
+                    lMatrix.RowCount(), lMatrix.ColCount(), rMatrix.RowCount(),
+                    rMatrix.ColCount()));
+  const MtxTuningParams Params = Internal::Tuning::Instance().Get();
+  const size_t nWords = lMatrix.WordsPerRow();
+  const size_t nLeftBlock = std::max<size_t>(Params.nGemmBlockM, 1);
+  // Rows of rMatrix of a block: about 32 KB of words.
+  const size_t nRightBlock = std::max<size_t>(4096 / std::max<size_t>(nWords, 1), 1);
+  const double Work = static_cast<double>(lMatrix.RowCount()) *
+                      static_cast<double>(rMatrix.RowCount()) * static_cast<double>(nWords);
+  const size_t nThreads = Work >= static_cast<double>(Params.nParallelThreshold)
+                              ? Internal::Kernels::ThreadCount(Params.nThreads)
+                              : 1;
+  const size_t nBlocks = (lMatrix.RowCount() + nLeftBlock - 1) / nLeftBlock;
+  Internal::Kernels::ParallelFor(nBlocks, nThreads, [&](size_t nBegin, size_t nEnd) {
+    const size_t nRowEnd = std::min(lMatrix.RowCount(), nEnd * nLeftBlock);
+    for (size_t ii = nBegin * nLeftBlock; ii < nRowEnd; ii += nLeftBlock)
+      for (size_t jj = 0; jj < rMatrix.RowCount(); jj += nRightBlock)
+        for (size_t i = ii; i < std::min(nRowEnd, ii + nLeftBlock); ++i)
+          for (size_t j = jj; j < std::min(rMatrix.RowCount(), jj + nRightBlock); ++j)
+            Function(i, j, lMatrix.Row(i), rMatrix.Row(j));
+  });
+}
+
+/**
+ * @brief Boolean product: Result[i][j] = OR_k lMatrix[i][k] AND rMatrix[k][j].
+ * Row i of Result is the OR of the rows of rMatrix selected by the set entries of row i of
+ * lMatrix, so the cost is proportional to the set entries of lMatrix times the words of a row.
+ * Throws std::domain_error if lMatrix ColCount doesn't match rMatrix RowCount.
+ *
+ * @param lMatrix
+ * @param rMatrix
+ * @return BitMatrix lMatrix.RowCount() x rMatrix.ColCount().
+ */
+inline auto Multiplication(const BitMatrix &lMatrix, const BitMatrix &rMatrix) -> BitMatrix {
+  if (lMatrix.ColCount() != rMatrix.RowCount())
+    throw std::domain_error(fmt::format(
+        "lMatrix ColCount must match rMatrix RowCount. lMatrix[{}][{}] / rMatrix[{}][{}]",
+        lMatrix.RowCount(), lMatrix.ColCount(), rMatrix.RowCount(), rMatrix.ColCount()));
+  BitMatrix Result(lMatrix.RowCount(), rMatrix.ColCount());
+  const MtxTuningParams Params = Internal::Tuning::Instance().Get();
+  const size_t nWords = rMatrix.WordsPerRow();
+  const size_t nThreads = lMatrix.Count() * nWords >= Params.nParallelThreshold
+                              ? Internal::Kernels::ThreadCount(Params.nThreads)
+                              : 1;
+  Internal::Kernels::ParallelFor(lMatrix.RowCount(), nThreads, [&](size_t nBegin, size_t nEnd) {
+    for (size_t i = nBegin; i < nEnd; ++i) {
+      uint64_t *pRow = Result.Row(i);
+      for (size_t w = 0; w < lMatrix.WordsPerRow(); ++w)
+        for (uint64_t Word = lMatrix.Row(i)[w]; Word != 0; Word &= Word - 1) {
+          const size_t k = w * BitMatrix::WordBits + static_cast<size_t>(std::countr_zero(Word));
+          const uint64_t *pRowR = rMatrix.Row(k);
+          for (size_t v = 0; v < nWords; ++v)
+            pRow[v] |= pRowR[v];
+        }
+    }
+  });
+  return Result;
+}
+
+/**
+ * @brief Result[i][j] = number of entries set in both row i of lMatrix and row j of rMatrix
+ * (size of the intersection of the sets). Throws std::domain_error if the ColCounts differ.
+ *
+ * @param lMatrix
+ * @param rMatrix
+ * @return CountMatrix lMatrix.RowCount() x rMatrix.RowCount().
+ */
+inline auto IntersectionCount(const BitMatrix &lMatrix, const BitMatrix &rMatrix)
+    -> CountMatrix {
+  CountMatrix Result(lMatrix.RowCount(), rMatrix.RowCount());
+  uint32_t *pResult = Result.Data();
+  const size_t nWords = lMatrix.WordsPerRow(), nCols = rMatrix.RowCount();
+  ForEachRowPair(lMatrix, rMatrix,
+                 [=](size_t i, size_t j, const uint64_t *pL, const uint64_t *pR) {
+                   uint32_t nCount = 0;
+                   for (size_t w = 0; w < nWords; ++w)
+                     nCount += static_cast<uint32_t>(std::popcount(pL[w] & pR[w]));
+                   pResult[i * nCols + j] = nCount;
+                 });
+  return Result;
+}
+
+/**
+ * @brief Result[i][j] = Hamming distance between row i of lMatrix and row j of rMatrix (entries
+ * that differ). Throws std::domain_error if the ColCounts differ.
+ *
+ * @param lMatrix
+ * @param rMatrix
+ * @return CountMatrix lMatrix.RowCount() x rMatrix.RowCount().
+ */
+inline auto HammingDistance(const BitMatrix &lMatrix, const BitMatrix &rMatrix) -> CountMatrix {
+  CountMatrix Result(lMatrix.RowCount(), rMatrix.RowCount());
+  uint32_t *pResult = Result.Data();
+  const size_t nWords = lMatrix.WordsPerRow(), nCols = rMatrix.RowCount();
+  ForEachRowPair(lMatrix, rMatrix,
+                 [=](size_t i, size_t j, const uint64_t *pL, const uint64_t *pR) {
+                   uint32_t nCount = 0;
+                   for (size_t w = 0; w < nWords; ++w)
+                     nCount += static_cast<uint32_t>(std::popcount(pL[w] ^ pR[w]));
+                   pResult[i * nCols + j] = nCount;
+                 });
+  return Result;
+}
+
+/**
+ * @brief Result[i][j] = Jaccard similarity |Li & Rj| / |Li | Rj| of row i of lMatrix and row j
+ * of rMatrix (1 for two empty rows). Throws std::domain_error if the ColCounts differ.
+ *
+ * @param lMatrix
+ * @param rMatrix
+ * @return Matrix<double> lMatrix.RowCount() x rMatrix.RowCount().
+ */
+inline auto Jaccard(const BitMatrix &lMatrix, const BitMatrix &rMatrix)
+    -> Matrix<double, MtxDynamic, MtxDynamic, MtxRowMajor> {
+  Matrix<double, MtxDynamic, MtxDynamic, MtxRowMajor> Result(lMatrix.RowCount(),
+                                                            rMatrix.RowCount());
+  double *pResult = Result.Data();
+  const size_t nWords = lMatrix.WordsPerRow(), nCols = rMatrix.RowCount();
+  ForEachRowPair(
+      lMatrix, rMatrix, [=](size_t i, size_t j, const uint64_t *pL, const uint64_t *pR) {
+        uint32_t nIntersection = 0, nUnion = 0;
+        for (size_t w = 0; w < nWords; ++w) {
+          nIntersection += static_cast<uint32_t>(std::popcount(pL[w] & pR[w]));
+          nUnion += static_cast<uint32_t>(std::popcount(pL[w] | pR[w]));
+        }
+        pResult[i * nCols + j] =
+            nUnion == 0 ? 1.0 : static_cast<double>(nIntersection) / static_cast<double>(nUnion);
+      });
+  return Result;
+}
+}; // namespace Mafs::Bit
+
+#endif // MAFS_MATRIX_BIT_BITOPERATIONS_H
@@ -0,0 +1,337 @@
+#ifndef MAFS_MATRIX_IO_BINARY_H
+#define MAFS_MATRIX_IO_BINARY_H
+
+#include <Mafs/Matrix/IO/Common.hpp>
+#include <Mafs/Matrix/Operations/Kernels/Blas.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define MAFS_HAS_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Mafs {
+/**
+ * @brief Element type stored in the binary file header.
+ * MtxBinaryRaw is used for any other trivially copyable type, the element size is then checked.
+ */
+enum MtxBinaryType {
+  MtxBinaryRaw = 0,
+  MtxBinaryInt8 = 1,
+  MtxBinaryUInt8 = 2,
+  MtxBinaryInt16 = 3,
+  MtxBinaryUInt16 = 4,
+  MtxBinaryInt32 = 5,
+  MtxBinaryUInt32 = 6,
+  MtxBinaryInt64 = 7,
+  MtxBinaryUInt64 = 8,
+  MtxBinaryFloat32 = 9,
+  MtxBinaryFloat64 = 10
+};
+
+namespace Internal {
+/**
+ * @brief Binary file header, always 64 bytes and stored in the host byte order.
+ *
+ * The payload is the raw Container array, written as is (storage order included) at nDataOffset,
+ * which is a multiple of nAlignment so a mapped file can be used directly by vectorized kernels.
+ */
+struct BinaryHeader {
+  char Magic[8];          // "MAFSMTX\0"
+  uint32_t nVersion;      // Format version.
+  uint32_t nEndianness;   // nEndianMark as written by the host.
+  uint32_t nType;         // MtxBinaryType.
+  uint32_t nTypeSize;     // sizeof(T).
+  uint32_t nOptions;      // MtxOptions (storage order).
+  uint32_t nAlignment;    // Payload alignment in bytes.
+  uint64_t nRows;         // Number of rows.
+  uint64_t nCols;         // Number of cols.
+  uint64_t nDataOffset;   // Payload offset from the beginning of the file.
+  uint64_t nReserved;     // Zero.
+};
+static_assert(sizeof(BinaryHeader) == 64, "BinaryHeader must be 64 bytes");
+
+static constexpr char BinaryMagic[8] = {'M', 'A', 'F', 'S', 'M', 'T', 'X', '\0'};
+static constexpr uint32_t nBinaryVersion = 1;
+static constexpr uint32_t nEndianMark = 0x01020304;
+static constexpr uint32_t nDefaultAlignment = 64;
+
+template <typename T> constexpr auto BinaryTypeOf() -> MtxBinaryType {
+  if constexpr (std::is_same_v<T, float>)
+    return MtxBinaryFloat32;
+  else if constexpr (std::is_same_v<T, double>)
+    return MtxBinaryFloat64;
+  else if constexpr (std::is_integral_v<T> && !std::is_same_v<T, bool>)
+    return static_cast<MtxBinaryType>((sizeof(T) == 1   ? 1
+                                       : sizeof(T) == 2 ? 3
+                                       : sizeof(T) == 4 ? 5
+                                                        : 7) +
+                                      (std::is_unsigned_v<T> ? 1 : 0));
+  else
+    return MtxBinaryRaw;
+}
+
+/**
+ * @brief Reads and validates the header of strPath for the element type T.
+ * Throws std::runtime_error if the file can't be read or doesn't hold T values.
+ *
+ * @param File
+ * @param strPath
+ * @return BinaryHeader
+ */
+template <typename T>
+auto ReadBinaryHeader(std::istream &File, const std::string &strPath) -> BinaryHeader {
+  BinaryHeader Header;
+  if (!File.read(reinterpret_cast<char *>(&Header), sizeof(Header)))
+    throw std::runtime_error(fmt::format("Could not read the header of {}", strPath));
+  if (std::memcmp(Header.Magic, BinaryMagic, sizeof(BinaryMagic)) != 0)
+    throw std::runtime_error(fmt::format("{} is not a Mafs binary matrix", strPath));
+  if (Header.nVersion != nBinaryVersion)
+    throw std::runtime_error(
+        fmt::format("{} has unsupported version {}", strPath, Header.nVersion));
+  if (Header.nEndianness != nEndianMark)
+    throw std::runtime_error(fmt::format("{} was written with a different byte order", strPath));
+  if (Header.nType != static_cast<uint32_t>(BinaryTypeOf<T>()) || Header.nTypeSize != sizeof(T))
+    throw std::runtime_error(
+        fmt::format("{} holds elements of type {} (size {}), expected {} (size {})", strPath,
+                    Header.nType, Header.nTypeSize, static_cast<uint32_t>(BinaryTypeOf<T>()),
+                    sizeof(T)));
+  return Header;
+}
+
+/**
+ * @brief True if a file of nFileSize bytes holds the header and the whole payload described by
+ * Header. Checked before anything is allocated or mapped, so a corrupt header (even one whose
+ * sizes overflow) is reported as a truncated file.
+ *
+ * @param Header
+ * @param nFileSize
+ * @return bool
+ */
+template <typename T> auto PayloadFits(const BinaryHeader &Header, uint64_t nFileSize) -> bool {
+  const uint64_t nMaxElements = std::numeric_limits<size_t>::max() / sizeof(T);
+  if (Header.nCols != 0 && Header.nRows > nMaxElements / Header.nCols)
+    return false;
+  return Header.nDataOffset <= nFileSize &&
+         sizeof(T) * Header.nRows * Header.nCols <= nFileSize - Header.nDataOffset;
+}
+}; // namespace Internal
+
+/**
+ * @brief Writes Matrix to strPath using the Mafs binary format.
+ * The data is written in its storage order with a single write, no conversion is made.
+ *
+ * @param Matrix
+ * @param strPath
+ * @param nAlignment payload alignment in bytes, must be a power of two.
+ */
+template <typename Derived>
+void Save(const Internal::MatrixBase<Derived> &Matrix, const std::string &strPath,
+          uint32_t nAlignment = Internal::nDefaultAlignment) {
+  typedef typename Internal::MatrixTraits<Derived>::Type Type;
+  static_assert(std::is_trivially_copyable_v<Type>, "Save requires a trivially copyable type");
+  if (nAlignment == 0 || (nAlignment & (nAlignment - 1)) != 0)
+    throw std::invalid_argument(fmt::format("Alignment {} is not a power of two", nAlignment));
+
+  Internal::BinaryHeader Header{};
+  std::memcpy(Header.Magic, Internal::BinaryMagic, sizeof(Header.Magic));
+  Header.nVersion = Internal::nBinaryVersion;
+  Header.nEndianness = Internal::nEndianMark;
+  Header.nType = Internal::BinaryTypeOf<Type>();
+  Header.nTypeSize = sizeof(Type);
+  Header.nOptions = Matrix.IsRowMajor() ? MtxRowMajor : MtxColMajor;
+  Header.nAlignment = nAlignment;
+  Header.nRows = Matrix.RowCount();
+  Header.nCols = Matrix.ColCount();
+  Header.nDataOffset = (sizeof(Header) + nAlignment - 1) / nAlignment * nAlignment;
+
+  std::ofstream File(strPath, std::ios::binary | std::ios::trunc);
+  if (!File)
+    throw std::runtime_error(fmt::format("Could not open {} for writing", strPath));
+
+  const std::vector<char> Padding(Header.nDataOffset - sizeof(Header), 0);
+  File.write(reinterpret_cast<const char *>(&Header), sizeof(Header));
+  File.write(Padding.data(), static_cast<std::streamsize>(Padding.size()));
+  File.write(reinterpret_cast<const char *>(Matrix.Data()),
+             static_cast<std::streamsize>(sizeof(Type) * Matrix.Size()));
+  if (!File.flush())
+    throw std::runtime_error(fmt::format("Could not write {}", strPath));
+}
+
+/**
+ * @brief Reads a matrix written by Save.
+ * If the storage order of the file and of MatrixType match, the payload is read straight into the
+ * matrix array. Otherwise it's read in chunks and transposed into place, so the peak memory is
+ * the matrix plus a small buffer.
+ *
+ * Throws std::runtime_error on I/O or type mismatch, and std::domain_error if MatrixType is
+ * static and the dimensions don't match.
+ *
+ * @tparam MatrixType e.g. Matrix<double, MtxDynamic, MtxDynamic>
+ * @param strPath
+ * @return MatrixType
+ */
+template <typename MatrixType> auto Load(const std::string &strPath) -> MatrixType {
+  typedef typename Internal::MatrixTraits<MatrixType>::Type Type;
+
+  std::ifstream File(strPath, std::ios::binary);
+  if (!File)
+    throw std::runtime_error(fmt::format("Could not open {} for reading", strPath));
+  const Internal::BinaryHeader Header = Internal::ReadBinaryHeader<Type>(File, strPath);
+  std::error_code Error;
+  const uint64_t nFileSize = std::filesystem::file_size(strPath, Error);
+  if (Error || !Internal::PayloadFits<Type>(Header, nFileSize))
+    throw std::runtime_error(fmt::format("{} is truncated", strPath));
+  const size_t nRows = Header.nRows, nCols = Header.nCols;
+
+  MatrixType MatrixRtn = Internal::MakeMatrix<MatrixType>(nRows, nCols, strPath);
+
+  File.seekg(static_cast<std::streamoff>(Header.nDataOffset));
+  const bool bFileRowMajor = AreEnumsEqual(Header.nOptions & 0x1, MtxRowMajor);
+  if (bFileRowMajor == MatrixRtn.IsRowMajor()) {
+    File.read(reinterpret_cast<char *>(MatrixRtn.Data()),
+              static_cast<std::streamsize>(sizeof(Type) * MatrixRtn.Size()));
+  } else {
+    // Each file "line" is a row (row major file) or a col (col major file).
+    const size_t nLines = bFileRowMajor ? nRows : nCols;
+    const size_t nLineSize = bFileRowMajor ? nCols : nRows;
+    const size_t nChunkLines = std::max<size_t>(1, (size_t(1) << 20) / (sizeof(Type) * nLineSize));
+    std::vector<Type> Buffer(nChunkLines * nLineSize);
+    Type *pDst = MatrixRtn.Data();
+    for (size_t nLine = 0; nLine < nLines && File; nLine += nChunkLines) {
+      const size_t nCount = std::min(nChunkLines, nLines - nLine);
+      File.read(reinterpret_cast<char *>(Buffer.data()),
+                static_cast<std::streamsize>(sizeof(Type) * nCount * nLineSize));
+      // In the destination, line nLine + l, element e sits at (nLine + l) + e * nLines.
+      Internal::Kernels::Copy(nCount, nLineSize, Buffer.data(), nLineSize, 1, pDst + nLine, 1,
+                              nLines);
+    }
+  }
+  if (!File)
+    throw std::runtime_error(fmt::format("{} is truncated", strPath));
+
+  return MatrixRtn;
+}
+
+/**
+ * @brief Read only matrix backed by a memory mapped Mafs binary file.
+ *
+ * The file payload is used in place (zero copy), pages are loaded by the OS on first access.
+ * Get() returns a const Matrix that can be passed to every operation; copying it produces a
+ * regular matrix that owns its memory. The storage order must match the one in the file.
+ *
+ * On platforms without mmap the file is loaded into memory instead.
+ *
+ * @tparam T
+ * @tparam Options_
+ */
+template <typename T, size_t Options_ = MtxDefaultOptions> class MappedMatrix {
+public:
+  typedef Matrix<T, MtxDynamic, MtxDynamic, Options_> MatrixType;
+
+protected:
+  // Matrix whose container points to the mapping.
+  class View : public MatrixType {
+  public:
+    void Attach(const T *pData, size_t nRows, size_t nCols) {
+      this->m_Container.Attach(const_cast<T *>(pData), nRows, nCols);
+    }
+  };
+
+  View m_Matrix;
+  void *m_pMapping = nullptr; // Start of the mapping.
+  size_t m_nMappingSize = 0;  // Size of the mapping in bytes.
+
+public:
+  explicit MappedMatrix(const std::string &strPath) {
+    std::ifstream File(strPath, std::ios::binary);
+    if (!File)
+      throw std::runtime_error(fmt::format("Could not open {} for reading", strPath));
+    const Internal::BinaryHeader Header = Internal::ReadBinaryHeader<T>(File, strPath);
+    if (!AreEnumsEqual(Header.nOptions & 0x1, Options_ & 0x1))
+      throw std::domain_error(
+          fmt::format("{} storage order doesn't match the MappedMatrix", strPath));
+    File.close();
+
+    const size_t nRows = Header.nRows, nCols = Header.nCols;
+#ifdef MAFS_HAS_MMAP
+    const int nFd = ::open(strPath.c_str(), O_RDONLY);
+    if (nFd < 0)
+      throw std::runtime_error(fmt::format("Could not open {} for mapping", strPath));
+    struct stat Stat;
+    if (::fstat(nFd, &Stat) != 0 ||
+        !Internal::PayloadFits<T>(Header, static_cast<uint64_t>(Stat.st_size))) {
+      ::close(nFd);
+      throw std::runtime_error(fmt::format("{} is truncated", strPath));
+    }
+    const size_t nBytes = Header.nDataOffset + sizeof(T) * nRows * nCols;
+    void *pMapping = ::mmap(nullptr, nBytes, PROT_READ, MAP_SHARED, nFd, 0);
+    ::close(nFd); // The mapping keeps the file alive.
+    if (pMapping == MAP_FAILED)
+      throw std::runtime_error(fmt::format("Could not map {}", strPath));
+
+    m_pMapping = pMapping;
+    m_nMappingSize = nBytes;
+    m_Matrix.Attach(reinterpret_cast<const T *>(static_cast<const char *>(pMapping) +
+                                                Header.nDataOffset),
+                    nRows, nCols);
+#else
+    MatrixType Loaded = Load<MatrixType>(strPath);
+    m_pMapping = new T[Loaded.Size()];
+    m_nMappingSize = Loaded.Size();
+    std::memcpy(m_pMapping, Loaded.Data(), sizeof(T) * Loaded.Size());
+    m_Matrix.Attach(static_cast<const T *>(m_pMapping), nRows, nCols);
+#endif
+  }
+
+  MappedMatrix(const MappedMatrix &) = delete;
+  MappedMatrix &operator=(const MappedMatrix &) = delete;
+
+  ~MappedMatrix() {
+#ifdef MAFS_HAS_MMAP
+    if (m_pMapping != nullptr)
+      ::munmap(m_pMapping, m_nMappingSize);
+#else
+    delete[] static_cast<T *>(m_pMapping);
+#endif
+  }
+
+  /**
+   * @brief Returns the mapped matrix.
+   *
+   * @return const MatrixType&
+   */
+  inline auto Get() const -> const MatrixType & { return m_Matrix; }
+
+  inline size_t RowCount() const { return m_Matrix.RowCount(); }
+  inline size_t ColCount() const { return m_Matrix.ColCount(); }
+  inline const T &At(size_t nRow, size_t nCol) const { return m_Matrix.At(nRow, nCol); }
+  inline const T &operator()(size_t nRow, size_t nCol) const { return m_Matrix.At(nRow, nCol); }
+};
+
+/**
+ * @brief Memory maps a file written by Save, without copying its payload.
+ *
+ * @see MappedMatrix
+ * @param strPath
+ * @return MappedMatrix<T, Options_>
+ */
+template <typename T, size_t Options_ = MtxDefaultOptions>
+auto MapFile(const std::string &strPath) -> MappedMatrix<T, Options_> {
+  return MappedMatrix<T, Options_>(strPath);
+}
+}; // namespace Mafs
+
+#endif // MAFS_MATRIX_IO_BINARY_H
@@ -0,0 +1,38 @@
+#ifndef MAFS_MATRIX_IO_COMMON_H
+#define MAFS_MATRIX_IO_COMMON_H
+
+#include <Mafs/Matrix/Matrix.hpp>
+#include <stdexcept>
+#include <string>
+
+namespace Mafs::Internal {
+/**
+ * @brief Creates the MatrixType that will receive a nRows x nCols matrix read from strPath.
+ * Dynamic matrices are allocated with the right size, static ones must already have it, otherwise
+ * std::domain_error is thrown.
+ *
+ * @tparam MatrixType
+ * @param nRows
+ * @param nCols
+ * @param strPath used in the error message.
+ * @return MatrixType
+ */
+template <typename MatrixType>
+auto MakeMatrix(size_t nRows, size_t nCols, const std::string &strPath) -> MatrixType {
+  typedef MatrixTraits<MatrixType> Traits;
+  constexpr bool bIsDynamic = AreEnumsEqual<Traits::Rows, MtxDynamic>() ||
+                              AreEnumsEqual<Traits::Cols, MtxDynamic>();
+  MatrixType MatrixRtn = [&]() {
+    if constexpr (bIsDynamic)
+      return MatrixType(nRows, nCols);
+    else
+      return MatrixType();
+  }();
+  if (MatrixRtn.RowCount() != nRows || MatrixRtn.ColCount() != nCols)
+    throw std::domain_error(fmt::format("{} holds a [{}][{}] matrix, expected [{}][{}]", strPath,
+                                        nRows, nCols, MatrixRtn.RowCount(), MatrixRtn.ColCount()));
+  return MatrixRtn;
+}
+}; // namespace Mafs::Internal
+
+#endif // MAFS_MATRIX_IO_COMMON_H
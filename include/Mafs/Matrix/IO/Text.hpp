@@ -0,0 +1,496 @@
+#ifndef MAFS_MATRIX_IO_TEXT_H
+#define MAFS_MATRIX_IO_TEXT_H
+
+#include <Mafs/Matrix/IO/Common.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <charconv>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#ifdef MAFS_ENABLE_THREADS
+#include <thread>
+#endif
+
+namespace Mafs {
+/**
+ * @brief CSV reader/writer options.
+ */
+struct MtxCsvOptions {
+  char cDelimiter = ','; // Field separator.
+  bool bHeader = false;  // Skip the first line when reading.
+  size_t nThreads = 1;   // Parsing threads (needs MAFS_ENABLE_THREADS, ignored otherwise).
+};
+
+namespace Internal {
+// Size of the blocks read from the file.
+static constexpr size_t nTextChunkSize = size_t(1) << 24;
+// Size of the output buffer flushed to the file.
+static constexpr size_t nTextWriteBuffer = size_t(1) << 20;
+
+inline auto IsBlank(char cChar) -> bool { return cChar == ' ' || cChar == '\t' || cChar == '\r'; }
+
+inline auto SkipBlanks(const char *pBegin, const char *pEnd) -> const char * {
+  while (pBegin != pEnd && IsBlank(*pBegin))
+    ++pBegin;
+  return pBegin;
+}
+
+inline auto IsBlankLine(const char *pBegin, const char *pEnd) -> bool {
+  return SkipBlanks(pBegin, pEnd) == pEnd;
+}
+
+/**
+ * @brief Parses a number at pBegin (leading blanks allowed) with std::from_chars, a bool is
+ * written 0 or 1. Throws std::runtime_error if there is no valid number.
+ *
+ * @return const char* first character after the number.
+ */
+template <typename T>
+auto ParseValue(const char *pBegin, const char *pEnd, T &Value, size_t nLine) -> const char * {
+  pBegin = SkipBlanks(pBegin, pEnd);
+  if (pBegin != pEnd && *pBegin == '+')
+    ++pBegin; // from_chars doesn't accept an explicit plus sign.
+  std::from_chars_result Result;
+  if constexpr (std::is_same_v<T, bool>) {
+    // from_chars has no bool overload.
+    unsigned nValue = 0;
+    Result = std::from_chars(pBegin, pEnd, nValue);
+    if (nValue > 1)
+      Result.ec = std::errc::result_out_of_range;
+    Value = nValue == 1;
+  } else {
+    Result = std::from_chars(pBegin, pEnd, Value);
+  }
+  const auto [pPtr, Error] = Result;
+  if (Error != std::errc())
+    throw std::runtime_error(fmt::format(
+        "Invalid number \"{}\" at line {}",
+        std::string(pBegin, std::min<const char *>(pEnd, pBegin + 32)), nLine + 1));
+  return pPtr;
+}
+
+/**
+ * @brief Calls Func(pBegin, pEnd, nLine) for every line of File, from the current position.
+ *
+ * The file is read in nTextChunkSize blocks cut at line boundaries, so the memory used doesn't
+ * depend on the file size. With MAFS_ENABLE_THREADS and nThreads > 1, the lines of each block
+ * are split in nThreads ranges parsed concurrently; Func must then be safe to call from several
+ * threads for different lines (e.g. writing distinct elements of a pre-sized container).
+ *
+ * nLine counts from zero at the starting position, "\r\n" endings are handled by the callers
+ * (blanks are skipped). The first exception thrown by Func is rethrown.
+ *
+ * @param File
+ * @param nThreads
+ * @param Func
+ */
+template <typename Callback>
+void ForEachLine(std::istream &File, size_t nThreads, Callback &&Func) {
+#ifndef MAFS_ENABLE_THREADS
+  nThreads = 1;
+#endif
+  nThreads = std::max<size_t>(1, nThreads);
+
+  // Runs Func over every line in [pBegin, pEnd), pEnd being right after a '\n' or the file end.
+  const auto ParseRange = [&Func](const char *pBegin, const char *pEnd, size_t nFirstLine) {
+    size_t nLine = nFirstLine;
+    while (pBegin != pEnd) {
+      const char *pNewLine = static_cast<const char *>(std::memchr(pBegin, '\n', pEnd - pBegin));
+      const char *pLineEnd = pNewLine != nullptr ? pNewLine : pEnd;
+      Func(pBegin, pLineEnd, nLine++);
+      pBegin = pNewLine != nullptr ? pNewLine + 1 : pEnd;
+    }
+  };
+
+  std::vector<char> Buffer;
+  size_t nLine = 0;
+  size_t nLeftover = 0; // Incomplete line kept from the previous block.
+  while (true) {
+    Buffer.resize(nLeftover + nTextChunkSize);
+    File.read(Buffer.data() + nLeftover, static_cast<std::streamsize>(nTextChunkSize));
+    const size_t nSize = nLeftover + static_cast<size_t>(File.gcount());
+    const bool bEof = !File;
+    if (nSize == 0)
+      break;
+
+    const char *pBegin = Buffer.data();
+    const char *pEnd = pBegin + nSize;
+    if (!bEof) {
+      // Cut after the last complete line.
+      const char *pLast = pEnd;
+      while (pLast != pBegin && *(pLast - 1) != '\n')
+        --pLast;
+      if (pLast == pBegin) {
+        // A single line longer than the block, keep reading.
+        nLeftover = nSize;
+        continue;
+      }
+      pEnd = pLast;
+    }
+
+    if (nThreads == 1) {
+      ParseRange(pBegin, pEnd, nLine);
+      nLine += static_cast<size_t>(std::count(pBegin, pEnd, '\n')) +
+               (pEnd != pBegin && *(pEnd - 1) != '\n' ? 1 : 0);
+    } else {
+#ifdef MAFS_ENABLE_THREADS
+      // Split at line boundaries and find the first line number of each range.
+      std::vector<const char *> Cuts{pBegin};
+      for (size_t t = 1; t < nThreads; ++t) {
+        const char *pCut = std::max(Cuts.back(), pBegin + (pEnd - pBegin) * t / nThreads);
+        while (pCut != pBegin && pCut != pEnd && *(pCut - 1) != '\n')
+          ++pCut;
+        Cuts.push_back(pCut);
+      }
+      Cuts.push_back(pEnd);
+
+      std::vector<size_t> FirstLines{nLine};
+      for (size_t t = 0; t < nThreads; ++t)
+        FirstLines.push_back(FirstLines.back() +
+                             static_cast<size_t>(std::count(Cuts[t], Cuts[t + 1], '\n')));
+
+      std::vector<std::exception_ptr> Errors(nThreads);
+      std::vector<std::thread> Threads;
+      for (size_t t = 0; t < nThreads; ++t)
+        Threads.emplace_back([&, t]() {
+          try {
+            ParseRange(Cuts[t], Cuts[t + 1], FirstLines[t]);
+          } catch (...) {
+            Errors[t] = std::current_exception();
+          }
+        });
+      for (auto &Thread : Threads)
+        Thread.join();
+      for (auto &Error : Errors)
+        if (Error)
+          std::rethrow_exception(Error);
+
+      nLine = FirstLines.back() + (pEnd != pBegin && *(pEnd - 1) != '\n' ? 1 : 0);
+#endif
+    }
+
+    if (bEof)
+      break;
+    nLeftover = static_cast<size_t>(Buffer.data() + nSize - pEnd);
+    std::memmove(Buffer.data(), pEnd, nLeftover);
+  }
+}
+
+/**
+ * @brief Buffered writer, numbers are formatted with std::to_chars (shortest round trip form).
+ */
+class TextWriter {
+protected:
+  std::ofstream m_File;
+  std::string m_strPath;
+  std::vector<char> m_Buffer;
+  size_t m_nUsed = 0;
+
+public:
+  explicit TextWriter(const std::string &strPath)
+      : m_File(strPath, std::ios::binary | std::ios::trunc), m_strPath(strPath),
+        m_Buffer(nTextWriteBuffer) {
+    if (!m_File)
+      throw std::runtime_error(fmt::format("Could not open {} for writing", strPath));
+  }
+
+  void Flush() {
+    m_File.write(m_Buffer.data(), static_cast<std::streamsize>(m_nUsed));
+    m_nUsed = 0;
+    if (!m_File.flush())
+      throw std::runtime_error(fmt::format("Could not write {}", m_strPath));
+  }
+
+  void Write(const char *pData, size_t nSize) {
+    if (m_nUsed + nSize > m_Buffer.size())
+      Flush();
+    if (nSize > m_Buffer.size()) {
+      m_File.write(pData, static_cast<std::streamsize>(nSize));
+      return;
+    }
+    std::memcpy(m_Buffer.data() + m_nUsed, pData, nSize);
+    m_nUsed += nSize;
+  }
+
+  void Write(const std::string &strText) { Write(strText.data(), strText.size()); }
+
+  void Write(char cChar) { Write(&cChar, 1); }
+
+  template <typename T> void WriteValue(const T &Value) {
+    static_assert(std::is_arithmetic_v<T>, "Text output requires an arithmetic type");
+    if constexpr (std::is_same_v<T, bool>) {
+      // to_chars(bool) is deleted, bools are written 0/1 like ParseValue reads them.
+      Write(Value ? '1' : '0');
+    } else {
+      // Enough for any integer or the shortest round trip form of a double.
+      if (m_nUsed + 64 > m_Buffer.size())
+        Flush();
+      const auto Result =
+          std::to_chars(m_Buffer.data() + m_nUsed, m_Buffer.data() + m_Buffer.size(), Value);
+      m_nUsed = static_cast<size_t>(Result.ptr - m_Buffer.data());
+    }
+  }
+};
+}; // namespace Internal
+
+/**
+ * @brief Reads a CSV file into a new matrix.
+ *
+ * The file is read twice, once to count the rows and cols so the container is allocated once,
+ * and once to parse the values (std::from_chars) straight into it. Every row must have the same
+ * number of values, blank lines are only allowed at the end of the file.
+ *
+ * @tparam MatrixType
+ * @param strPath
+ * @param Options
+ * @return MatrixType
+ */
+template <typename MatrixType>
+auto ReadCsv(const std::string &strPath, const MtxCsvOptions &Options = MtxCsvOptions())
+    -> MatrixType {
+  typedef typename Internal::MatrixTraits<MatrixType>::Type Type;
+  std::ifstream File(strPath, std::ios::binary);
+  if (!File)
+    throw std::runtime_error(fmt::format("Could not open {} for reading", strPath));
+
+  // First pass: dimensions.
+  const size_t nSkip = Options.bHeader ? 1 : 0;
+  size_t nRows = 0, nCols = 0;
+  Internal::ForEachLine(File, 1, [&](const char *pBegin, const char *pEnd, size_t nLine) {
+    if (nLine < nSkip || Internal::IsBlankLine(pBegin, pEnd))
+      return;
+    if (nCols == 0)
+      nCols = static_cast<size_t>(std::count(pBegin, pEnd, Options.cDelimiter)) + 1;
+    nRows = nLine + 1 - nSkip;
+  });
+  if (nRows == 0)
+    throw std::runtime_error(fmt::format("{} is empty", strPath));
+
+  MatrixType MatrixRtn = Internal::MakeMatrix<MatrixType>(nRows, nCols, strPath);
+  Type *pData = MatrixRtn.Data();
+  const size_t nRowStride = MatrixRtn.RowStride(), nColStride = MatrixRtn.ColStride();
+
+  // Second pass: values.
+  File.clear();
+  File.seekg(0);
+  Internal::ForEachLine(File, Options.nThreads,
+                        [&](const char *pBegin, const char *pEnd, size_t nLine) {
+                          if (nLine < nSkip)
+                            return;
+                          const size_t nRow = nLine - nSkip;
+                          if (nRow >= nRows)
+                            return; // Trailing blank lines.
+
+                          Type *pRow = pData + nRow * nRowStride;
+                          for (size_t j = 0; j < nCols; ++j) {
+                            if (j > 0) {
+                              pBegin = Internal::SkipBlanks(pBegin, pEnd);
+                              if (pBegin == pEnd || *pBegin != Options.cDelimiter)
+                                throw std::runtime_error(fmt::format(
+                                    "Expected {} values at line {}", nCols, nLine + 1));
+                              ++pBegin;
+                            }
+                            pBegin = Internal::ParseValue(pBegin, pEnd, pRow[j * nColStride],
+                                                          nLine);
+                          }
+                          if (!Internal::IsBlankLine(pBegin, pEnd))
+                            throw std::runtime_error(fmt::format(
+                                "Expected {} values at line {}", nCols, nLine + 1));
+                        });
+  return MatrixRtn;
+}
+
+/**
+ * @brief Writes Matrix as CSV, one row per line.
+ *
+ * @param Matrix
+ * @param strPath
+ * @param Options only cDelimiter is used.
+ */
+template <typename Derived>
+void WriteCsv(const Internal::MatrixBase<Derived> &Matrix, const std::string &strPath,
+              const MtxCsvOptions &Options = MtxCsvOptions()) {
+  Internal::TextWriter Writer(strPath);
+  const auto *pData = Matrix.Data();
+  for (size_t i = 0; i < Matrix.RowCount(); ++i) {
+    for (size_t j = 0; j < Matrix.ColCount(); ++j) {
+      if (j > 0)
+        Writer.Write(Options.cDelimiter);
+      Writer.WriteValue(pData[i * Matrix.RowStride() + j * Matrix.ColStride()]);
+    }
+    Writer.Write('\n');
+  }
+  Writer.Flush();
+}
+
+/**
+ * @brief Reads a MatrixMarket file (array or coordinate; real, integer or pattern; general,
+ * symmetric or skew-symmetric) into a new matrix. Entries missing from a coordinate file are zero,
+ * but both formats must hold as many entries or values as their size line says.
+ *
+ * @tparam MatrixType
+ * @param strPath
+ * @param nThreads parsing threads (needs MAFS_ENABLE_THREADS, ignored otherwise).
+ * @return MatrixType
+ */
+template <typename MatrixType>
+auto ReadMatrixMarket(const std::string &strPath, size_t nThreads = 1) -> MatrixType {
+  typedef typename Internal::MatrixTraits<MatrixType>::Type Type;
+  std::ifstream File(strPath, std::ios::binary);
+  if (!File)
+    throw std::runtime_error(fmt::format("Could not open {} for reading", strPath));
+
+  // Banner: %%MatrixMarket matrix <format> <field> <symmetry>
+  std::string strLine;
+  std::getline(File, strLine);
+  for (auto &cChar : strLine)
+    cChar = static_cast<char>(std::tolower(static_cast<unsigned char>(cChar)));
+  const auto HasWord = [&strLine](const char *pWord) {
+    return strLine.find(pWord) != std::string::npos;
+  };
+  if (strLine.rfind("%%matrixmarket matrix", 0) != 0)
+    throw std::runtime_error(fmt::format("{} is not a MatrixMarket matrix", strPath));
+  if (HasWord("complex") || HasWord("hermitian"))
+    throw std::runtime_error(fmt::format("{}: complex matrices are not supported", strPath));
+  const bool bCoordinate = HasWord(" coordinate");
+  const bool bPattern = HasWord(" pattern");
+  const bool bSymmetric = HasWord(" symmetric");
+  const bool bSkew = HasWord(" skew-symmetric");
+
+  // Skip comments, then the size line.
+  do {
+    std::getline(File, strLine);
+  } while (File && (strLine.empty() || strLine[0] == '%'));
+  size_t nRows = 0, nCols = 0, nEntries = 0;
+  const char *pSizeEnd = strLine.data() + strLine.size();
+  const char *pSize = Internal::ParseValue(strLine.data(), pSizeEnd, nRows, 0);
+  pSize = Internal::ParseValue(pSize, pSizeEnd, nCols, 0);
+  if (bCoordinate)
+    Internal::ParseValue(pSize, pSizeEnd, nEntries, 0);
+  if ((bSymmetric || bSkew) && nRows != nCols)
+    throw std::runtime_error(fmt::format("{}: symmetric matrices must be square", strPath));
+
+  MatrixType MatrixRtn = Internal::MakeMatrix<MatrixType>(nRows, nCols, strPath);
+  Type *pData = MatrixRtn.Data();
+  const size_t nRowStride = MatrixRtn.RowStride(), nColStride = MatrixRtn.ColStride();
+  std::fill(pData, pData + MatrixRtn.Size(), Type(0));
+
+  const auto Store = [&](size_t nRow, size_t nCol, Type Value) {
+    pData[nRow * nRowStride + nCol * nColStride] = Value;
+    if (nRow != nCol && bSymmetric)
+      pData[nCol * nRowStride + nRow * nColStride] = Value;
+    else if (nRow != nCol && bSkew)
+      pData[nCol * nRowStride + nRow * nColStride] = static_cast<Type>(-Value);
+  };
+
+  if (bCoordinate) {
+    std::atomic<size_t> nStored{0};
+    Internal::ForEachLine(File, nThreads, [&](const char *pBegin, const char *pEnd, size_t nLine) {
+      if (Internal::IsBlankLine(pBegin, pEnd))
+        return;
+      nStored.fetch_add(1, std::memory_order_relaxed);
+      size_t nRow = 0, nCol = 0;
+      Type Value = Type(1);
+      pBegin = Internal::ParseValue(pBegin, pEnd, nRow, nLine);
+      pBegin = Internal::ParseValue(pBegin, pEnd, nCol, nLine);
+      if (!bPattern)
+        Internal::ParseValue(pBegin, pEnd, Value, nLine);
+      if (nRow == 0 || nCol == 0 || nRow > nRows || nCol > nCols)
+        throw std::out_of_range(
+            fmt::format("Entry [{}][{}] at line {} is out of range", nRow, nCol, nLine + 1));
+      Store(nRow - 1, nCol - 1, Value);
+    });
+    if (nStored < nEntries)
+      throw std::runtime_error(fmt::format("{} is truncated", strPath));
+    if (nStored > nEntries)
+      throw std::runtime_error(fmt::format("{} has {} entries, its size line says {}", strPath,
+                                           nStored.load(), nEntries));
+  } else {
+    // Column major values; symmetric files only hold the lower triangle (skew without diagonal).
+    const size_t nDiagonalOffset = bSkew ? 1 : 0;
+    std::vector<size_t> ColStarts{0};
+    for (size_t j = 0; j < nCols; ++j)
+      ColStarts.push_back(ColStarts.back() +
+                          (bSymmetric || bSkew ? nRows - std::min(nRows, j + nDiagonalOffset)
+                                               : nRows));
+
+    std::atomic<size_t> nStored{0};
+    Internal::ForEachLine(File, nThreads, [&](const char *pBegin, const char *pEnd, size_t nLine) {
+      if (nLine >= ColStarts.back() && Internal::IsBlankLine(pBegin, pEnd))
+        return; // Trailing blank lines.
+      nStored.fetch_add(1, std::memory_order_relaxed);
+      if (nLine >= ColStarts.back())
+        return; // Counted to report the extra values.
+      Type Value = Type(0);
+      Internal::ParseValue(pBegin, pEnd, Value, nLine);
+      const size_t nCol = static_cast<size_t>(
+          std::upper_bound(ColStarts.begin(), ColStarts.end(), nLine) - ColStarts.begin() - 1);
+      const size_t nFirstRow = bSymmetric || bSkew ? nCol + nDiagonalOffset : 0;
+      Store(nFirstRow + nLine - ColStarts[nCol], nCol, Value);
+    });
+    if (nStored < ColStarts.back())
+      throw std::runtime_error(fmt::format("{} is truncated", strPath));
+    if (nStored > ColStarts.back())
+      throw std::runtime_error(fmt::format("{} has {} values, its size line says {}", strPath,
+                                           nStored.load(), ColStarts.back()));
+  }
+  return MatrixRtn;
+}
+
+/**
+ * @brief Writes Matrix as a general MatrixMarket file.
+ * bCoordinate = false writes the array format (every value, column major), true writes the
+ * coordinate format with the non zero values only.
+ *
+ * @param Matrix
+ * @param strPath
+ * @param bCoordinate
+ */
+template <typename Derived>
+void WriteMatrixMarket(const Internal::MatrixBase<Derived> &Matrix, const std::string &strPath,
+                       bool bCoordinate = false) {
+  typedef typename Internal::MatrixTraits<Derived>::Type Type;
+  const char *pField = std::is_integral_v<Type> ? "integer" : "real";
+  const auto *pData = Matrix.Data();
+  const auto Value = [&](size_t i, size_t j) {
+    return pData[i * Matrix.RowStride() + j * Matrix.ColStride()];
+  };
+
+  Internal::TextWriter Writer(strPath);
+  if (bCoordinate) {
+    size_t nEntries = 0;
+    for (size_t i = 0; i < Matrix.Size(); ++i)
+      nEntries += pData[i] != Type(0) ? 1 : 0;
+    Writer.Write(fmt::format("%%MatrixMarket matrix coordinate {} general\n{} {} {}\n", pField,
+                             Matrix.RowCount(), Matrix.ColCount(), nEntries));
+    for (size_t j = 0; j < Matrix.ColCount(); ++j)
+      for (size_t i = 0; i < Matrix.RowCount(); ++i)
+        if (Value(i, j) != Type(0)) {
+          Writer.WriteValue(i + 1);
+          Writer.Write(' ');
+          Writer.WriteValue(j + 1);
+          Writer.Write(' ');
+          Writer.WriteValue(Value(i, j));
+          Writer.Write('\n');
+        }
+  } else {
+    Writer.Write(fmt::format("%%MatrixMarket matrix array {} general\n{} {}\n", pField,
+                             Matrix.RowCount(), Matrix.ColCount()));
+    for (size_t j = 0; j < Matrix.ColCount(); ++j)
+      for (size_t i = 0; i < Matrix.RowCount(); ++i) {
+        Writer.WriteValue(Value(i, j));
+        Writer.Write('\n');
+      }
+  }
+  Writer.Flush();
+}
+}; // namespace Mafs
+
+#endif // MAFS_MATRIX_IO_TEXT_H
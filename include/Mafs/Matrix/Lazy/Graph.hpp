@@ -0,0 +1,543 @@
+#ifndef MAFS_MATRIX_LAZY_GRAPH_H
+#define MAFS_MATRIX_LAZY_GRAPH_H
+
+#include <Mafs/Matrix/Matrix.hpp>
+#include <Mafs/Matrix/Operations/Kernels/Blas.hpp>
+#include <Mafs/Matrix/Operations/Kernels/Gemm.hpp>
+#include <Mafs/Matrix/Operations/Kernels/Parallel.hpp>
+#include <Mafs/Matrix/Operations/Tuning.hpp>
+#include <Mafs/Utils/Instrumentation.hpp>
+#include <algorithm>
+#include <map>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace Mafs {
+/**
+ * @brief Report filled by Lazy::Graph::Evaluate.
+ */
+struct MtxLazyStats {
+  size_t nNodes = 0;      // Distinct nodes reachable from the outputs (after CSE).
+  size_t nSteps = 0;      // Kernels executed.
+  size_t nFusedGemms = 0; // Products accumulated straight into an element-wise result.
+  size_t nBuffers = 0;    // Intermediate buffers allocated (the others were reused).
+};
+}; // namespace Mafs
+
+/**
+ * Deferred evaluation of matrix expressions.
+ *
+ * Expressions built from the Graph inputs don't compute anything, they add nodes to a DAG. Nodes
+ * are hash-consed, so building the same subexpression twice returns the same node (common
+ * subexpression elimination, + is normalized as commutative). Evaluate plans and runs the DAG:
+ * - Chains of +, - and scalar * are flattened into one linear combination computed in a single
+ *   pass over the output.
+ * - Products used only by such a chain are accumulated into its output by the GEMM kernel with
+ *   the combination coefficient as alpha, so A * B + C and alpha * (A * B) take one pass over the
+ *   result instead of two or three.
+ * - Every other node is computed once, whatever its number of consumers, and its buffer is handed
+ *   back to a pool after its last consumer ran, to be reused by the next nodes.
+ *
+ * Inputs are referenced, not copied: they must outlive the graph (with the same dimensions) and
+ * their values are read at Evaluate time. Intermediates are row major, the outputs are converted
+ * to the requested type.
+ *
+ * Usage:
+ * Mafs::Lazy::Graph<double> G;
+ * auto A = G.Input(MatrixA), B = G.Input(MatrixB), C = G.Input(MatrixC);
+ * auto Y = 2.0 * (A * B) + C;
+ * auto Z = Mafs::Lazy::Transpose(A * B); // A * B is computed once for Y and Z.
+ * auto Results = G.Evaluate<Mafs::Matrix<double, 0, 0, Mafs::MtxRowMajor>>({Y, Z});
+ */
+namespace Mafs::Lazy {
+
+template <typename T> class Graph;
+
+/**
+ * @brief Handle to a node of a Graph. Cheap to copy, valid as long as the graph.
+ */
+template <typename T> class Expr {
+protected:
+  friend class Graph<T>;
+  Graph<T> *m_pGraph = nullptr;
+  size_t m_nNode = 0;
+
+  Expr(Graph<T> *pGraph, size_t nNode) : m_pGraph(pGraph), m_nNode(nNode) {}
+
+  // The operators go through these, the friend functions have no access to Graph.
+  enum BinaryOp { Add, Sub, MatMul };
+  static auto Combine(BinaryOp Op, const Expr &lExpr, const Expr &rExpr) -> Expr {
+    if (lExpr.m_pGraph == nullptr || lExpr.m_pGraph != rExpr.m_pGraph)
+      throw std::invalid_argument("Expressions belong to different graphs");
+    return lExpr.m_pGraph->Binary(Op == Add   ? Graph<T>::OpAdd
+                                  : Op == Sub ? Graph<T>::OpSub
+                                              : Graph<T>::OpMatMul,
+                                  lExpr.m_nNode, rExpr.m_nNode);
+  }
+
+  static auto Scaled(const T &Scalar, const Expr &Expression) -> Expr {
+    return Expression.m_pGraph->Scale(Scalar, Expression.m_nNode);
+  }
+
+public:
+  Expr() = default;
+
+  inline size_t RowCount() const { return m_pGraph->m_Nodes[m_nNode].nRows; }
+  inline size_t ColCount() const { return m_pGraph->m_Nodes[m_nNode].nCols; }
+
+  friend auto operator+(const Expr &lExpr, const Expr &rExpr) -> Expr {
+    return Combine(Add, lExpr, rExpr);
+  }
+
+  friend auto operator-(const Expr &lExpr, const Expr &rExpr) -> Expr {
+    return Combine(Sub, lExpr, rExpr);
+  }
+
+  // Matrix product.
+  friend auto operator*(const Expr &lExpr, const Expr &rExpr) -> Expr {
+    return Combine(MatMul, lExpr, rExpr);
+  }
+
+  friend auto operator*(const T &Scalar, const Expr &Expression) -> Expr {
+    return Scaled(Scalar, Expression);
+  }
+
+  friend auto operator*(const Expr &Expression, const T &Scalar) -> Expr {
+    return Scalar * Expression;
+  }
+
+  friend auto operator-(const Expr &Expression) -> Expr { return T(-1) * Expression; }
+
+  /**
+   * @brief Returns the transpose of this expression.
+   * @see Lazy::Transpose
+   */
+  auto Transposed() const -> Expr { return m_pGraph->Transpose(m_nNode); }
+
+  /**
+   * @brief Evaluates this expression alone.
+   * @see Graph::Evaluate
+   */
+  template <typename MatrixType> auto Eval(MtxLazyStats *pStats = nullptr) const -> MatrixType {
+    return m_pGraph->template Evaluate<MatrixType>(*this, pStats);
+  }
+};
+
+/**
+ * @brief Transpose of an expression (lazy).
+ *
+ * @param Expression
+ * @return Expr<T>
+ */
+template <typename T> auto Transpose(const Expr<T> &Expression) -> Expr<T> {
+  return Expression.Transposed();
+}
+
+template <typename T> class Graph {
+public:
+  typedef Lazy::Expr<T> Expr;
+
+protected:
+  friend class Lazy::Expr<T>;
+
+  enum NodeOp { OpInput, OpAdd, OpSub, OpScale, OpMatMul, OpTranspose };
+
+  struct Node {
+    NodeOp Op;
+    size_t nLhs = 0, nRhs = 0; // Operands (nLhs only for the unary ones).
+    T Scalar = T(0);           // OpScale factor.
+    size_t nRows = 0, nCols = 0;
+    // OpInput: the referenced matrix and its values, read at Evaluate time (a shared matrix
+    // written after Input moves to a storage of its own).
+    const void *pMatrix = nullptr;
+    const T *(*pValues)(const void *pMatrix) = nullptr;
+    size_t nRowStride = 0, nColStride = 0;
+  };
+
+  // One term of a linear combination: Coefficient * Node, or Coefficient * Lhs * Rhs if fused.
+  struct Term {
+    T Coefficient;
+    size_t nNode;
+    bool bFusedGemm;
+  };
+
+  // Kernel to execute, the result of nNode.
+  struct Step {
+    size_t nNode;
+    std::vector<Term> Terms; // Linear combinations only.
+  };
+
+  std::vector<Node> m_Nodes;
+  std::map<std::tuple<int, size_t, size_t, T>, size_t> m_Unique; // (Op, Lhs, Rhs, Scalar) -> node
+  std::map<const void *, size_t> m_Inputs; // Matrix -> node
+
+  auto Insert(const Node &NewNode) -> Expr {
+    const auto Key = std::make_tuple(static_cast<int>(NewNode.Op), NewNode.nLhs, NewNode.nRhs,
+                                     NewNode.Scalar);
+    const auto Iter = m_Unique.find(Key);
+    if (Iter != m_Unique.end())
+      return Expr(this, Iter->second);
+    m_Nodes.push_back(NewNode);
+    m_Unique.emplace(Key, m_Nodes.size() - 1);
+    return Expr(this, m_Nodes.size() - 1);
+  }
+
+  auto Binary(NodeOp Op, size_t nLhs, size_t nRhs) -> Expr {
+    const Node &Lhs = m_Nodes[nLhs], &Rhs = m_Nodes[nRhs];
+    Node NewNode;
+    NewNode.Op = Op;
+    if (Op == OpMatMul) {
+      if (Lhs.nCols != Rhs.nRows)
+        throw std::domain_error(
+            fmt::format("Lhs ColCount must match Rhs RowCount. Lhs[{}][{}] / Rhs[{}][{}]",
+                        Lhs.nRows, Lhs.nCols, Rhs.nRows, Rhs.nCols));
+      NewNode.nRows = Lhs.nRows;
+      NewNode.nCols = Rhs.nCols;
+    } else {
+      if (Lhs.nRows != Rhs.nRows || Lhs.nCols != Rhs.nCols)
+        throw std::domain_error(
+            fmt::format("RowCount and ColCount must be equal. Lhs[{}][{}] / Rhs[{}][{}]",
+                        Lhs.nRows, Lhs.nCols, Rhs.nRows, Rhs.nCols));
+      NewNode.nRows = Lhs.nRows;
+      NewNode.nCols = Lhs.nCols;
+    }
+    // A + B and B + A are the same node.
+    if (Op == OpAdd && nRhs < nLhs)
+      std::swap(nLhs, nRhs);
+    NewNode.nLhs = nLhs;
+    NewNode.nRhs = nRhs;
+    return Insert(NewNode);
+  }
+
+  auto Transpose(size_t nChild) -> Expr {
+    Node NewNode;
+    NewNode.Op = OpTranspose;
+    NewNode.nLhs = nChild;
+    NewNode.nRows = m_Nodes[nChild].nCols;
+    NewNode.nCols = m_Nodes[nChild].nRows;
+    return Insert(NewNode);
+  }
+
+  auto Scale(const T &Scalar, size_t nChild) -> Expr {
+    if (Scalar == T(1))
+      return Expr(this, nChild);
+    Node NewNode;
+    NewNode.Op = OpScale;
+    NewNode.nLhs = nChild;
+    NewNode.Scalar = Scalar;
+    NewNode.nRows = m_Nodes[nChild].nRows;
+    NewNode.nCols = m_Nodes[nChild].nCols;
+    return Insert(NewNode);
+  }
+
+  static auto IsLinear(NodeOp Op) -> bool { return Op == OpAdd || Op == OpSub || Op == OpScale; }
+
+  /**
+   * @brief Appends Coefficient * nNode to Terms, expanding the linear nodes that can be absorbed.
+   */
+  void Flatten(size_t nNode, T Coefficient, const std::vector<bool> &Absorbed,
+               std::vector<Term> &Terms) const {
+    const Node &Current = m_Nodes[nNode];
+    if (Absorbed[nNode] && IsLinear(Current.Op)) {
+      if (Current.Op == OpScale)
+        return Flatten(Current.nLhs, Coefficient * Current.Scalar, Absorbed, Terms);
+      Flatten(Current.nLhs, Coefficient, Absorbed, Terms);
+      Flatten(Current.nRhs, Current.Op == OpSub ? -Coefficient : Coefficient, Absorbed, Terms);
+      return;
+    }
+    const bool bFusedGemm = Absorbed[nNode] && Current.Op == OpMatMul;
+    for (Term &Existing : Terms)
+      if (Existing.nNode == nNode && Existing.bFusedGemm == bFusedGemm) {
+        Existing.Coefficient += Coefficient; // A + A = 2 * A
+        return;
+      }
+    Terms.push_back({Coefficient, nNode, bFusedGemm});
+  }
+
+  /**
+   * @brief Splits the DAG reachable from Outputs into kernels, in topological order.
+   */
+  auto Plan(const std::vector<size_t> &Outputs, MtxLazyStats &Stats) const -> std::vector<Step> {
+    // Consumers of every reachable node (node ids are already a topological order).
+    std::vector<size_t> Uses(m_Nodes.size(), 0);
+    std::vector<bool> Reachable(m_Nodes.size(), false), IsOutput(m_Nodes.size(), false);
+    for (size_t nOutput : Outputs)
+      Reachable[nOutput] = IsOutput[nOutput] = true;
+    for (size_t n = m_Nodes.size(); n-- > 0;) {
+      if (!Reachable[n])
+        continue;
+      Stats.nNodes++;
+      const Node &Current = m_Nodes[n];
+      if (Current.Op == OpInput)
+        continue;
+      Reachable[Current.nLhs] = true;
+      Uses[Current.nLhs]++;
+      if (Current.Op == OpAdd || Current.Op == OpSub || Current.Op == OpMatMul) {
+        Reachable[Current.nRhs] = true;
+        Uses[Current.nRhs]++;
+      }
+    }
+
+    // A node is absorbed into its consumer's linear combination if that is its only use.
+    std::vector<bool> Absorbed(m_Nodes.size(), false);
+    for (size_t n = 0; n < m_Nodes.size(); ++n) {
+      const Node &Current = m_Nodes[n];
+      if (!Reachable[n] || !IsLinear(Current.Op))
+        continue;
+      for (size_t nChild : {Current.nLhs, Current.nRhs}) {
+        const NodeOp ChildOp = m_Nodes[nChild].Op;
+        if (Uses[nChild] == 1 && !IsOutput[nChild] && (IsLinear(ChildOp) || ChildOp == OpMatMul))
+          Absorbed[nChild] = true;
+        if (Current.Op == OpScale)
+          break;
+      }
+    }
+
+    std::vector<Step> Steps;
+    for (size_t n = 0; n < m_Nodes.size(); ++n) {
+      if (!Reachable[n] || Absorbed[n])
+        continue;
+      Step NewStep{n, {}};
+      if (IsLinear(m_Nodes[n].Op)) {
+        // The root itself is expanded, absorbed or not.
+        std::vector<bool> RootAbsorbed = Absorbed;
+        RootAbsorbed[n] = true;
+        Flatten(n, T(1), RootAbsorbed, NewStep.Terms);
+      }
+      Steps.push_back(std::move(NewStep));
+    }
+    return Steps;
+  }
+
+  // Pooled row major buffers of the intermediate results.
+  struct BufferPool {
+    std::vector<std::vector<T>> Free;
+    size_t nAllocated = 0;
+
+    auto Acquire(size_t nSize) -> std::vector<T> {
+      auto Best = Free.end();
+      for (auto Iter = Free.begin(); Iter != Free.end(); ++Iter)
+        if (Iter->capacity() >= nSize &&
+            (Best == Free.end() || Iter->capacity() < Best->capacity()))
+          Best = Iter;
+      if (Best == Free.end()) {
+        nAllocated++;
+        return std::vector<T>(nSize);
+      }
+      std::vector<T> Buffer = std::move(*Best);
+      Free.erase(Best);
+      Buffer.resize(nSize);
+      return Buffer;
+    }
+
+    void Release(std::vector<T> &&Buffer) { Free.push_back(std::move(Buffer)); }
+  };
+
+  template <typename MatrixType> static auto MakeOutput(size_t nRows, size_t nCols) -> MatrixType {
+    typedef Internal::MatrixTraits<MatrixType> Traits;
+    if constexpr (AreEnumsEqual<Traits::Rows, MtxDynamic>() ||
+                  AreEnumsEqual<Traits::Cols, MtxDynamic>())
+      return MatrixType(nRows, nCols);
+    else {
+      if (nRows != Traits::Rows || nCols != Traits::Cols)
+        throw std::domain_error(fmt::format("Expression is [{}][{}], MatrixType is [{}][{}]", nRows,
+                                            nCols, static_cast<size_t>(Traits::Rows),
+                                            static_cast<size_t>(Traits::Cols)));
+      return MatrixType();
+    }
+  }
+
+public:
+  Graph() = default;
+  // Expressions point to the graph.
+  Graph(const Graph &) = delete;
+  Graph &operator=(const Graph &) = delete;
+
+  /**
+   * @brief Adds a matrix to the graph (by reference, it must outlive the graph).
+   *
+   * @param Matrix
+   * @return Expr
+   */
+  template <typename Derived> auto Input(const Internal::MatrixBase<Derived> &Matrix) -> Expr {
+    static_assert(std::is_same_v<typename Internal::MatrixTraits<Derived>::Type, T>,
+                  "Graph inputs must have the graph value type");
+    // Keyed by the matrix, not its values: copies sharing a storage are different inputs.
+    const void *pMatrix = static_cast<const void *>(&Matrix);
+    const auto Iter = m_Inputs.find(pMatrix);
+    if (Iter != m_Inputs.end())
+      return Expr(this, Iter->second);
+
+    Node NewNode;
+    NewNode.Op = OpInput;
+    NewNode.nRows = Matrix.RowCount();
+    NewNode.nCols = Matrix.ColCount();
+    NewNode.pMatrix = pMatrix;
+    NewNode.pValues = [](const void *pInput) {
+      return static_cast<const Internal::MatrixBase<Derived> *>(pInput)->Data();
+    };
+    NewNode.nRowStride = Matrix.RowStride();
+    NewNode.nColStride = Matrix.ColStride();
+    m_Nodes.push_back(NewNode);
+    m_Inputs.emplace(pMatrix, m_Nodes.size() - 1);
+    return Expr(this, m_Nodes.size() - 1);
+  }
+
+  /**
+   * @brief Number of distinct nodes in the graph.
+   *
+   * @return size_t
+   */
+  inline size_t NodeCount() const { return m_Nodes.size(); }
+
+  /**
+   * @brief Evaluates every expression of Outputs, sharing the common nodes.
+   * Static MatrixType must match the dimensions of every output (std::domain_error otherwise).
+   *
+   * @param Outputs
+   * @param pStats optional, filled with the plan statistics.
+   * @return std::vector<MatrixType> one matrix per output.
+   */
+  template <typename MatrixType>
+  auto Evaluate(const std::vector<Expr> &Outputs, MtxLazyStats *pStats = nullptr)
+      -> std::vector<MatrixType> {
+    static_assert(std::is_same_v<typename Internal::MatrixTraits<MatrixType>::Type, T>,
+                  "MatrixType must have the graph value type");
+    MAFS_OP_SCOPE("Lazy", "Evaluate", Outputs.size(), 0, 0);
+    std::vector<size_t> OutputNodes;
+    for (const Expr &Output : Outputs) {
+      if (Output.m_pGraph != this)
+        throw std::invalid_argument("Expression belongs to a different graph");
+      OutputNodes.push_back(Output.m_nNode);
+    }
+
+    MtxLazyStats Stats;
+    const std::vector<Step> Steps = Plan(OutputNodes, Stats);
+    const MtxTuningParams Params = Internal::Tuning::Instance().Get();
+
+    // Pending reads of every node result, its buffer is released when it drops to zero.
+    std::vector<size_t> Reads(m_Nodes.size(), 0);
+    auto ForEachOperand = [this](const Step &Current, auto &&Function) {
+      const Node &Current_ = m_Nodes[Current.nNode];
+      if (!Current.Terms.empty() || IsLinear(Current_.Op)) {
+        for (const Term &Operand : Current.Terms)
+          if (Operand.bFusedGemm) {
+            Function(m_Nodes[Operand.nNode].nLhs);
+            Function(m_Nodes[Operand.nNode].nRhs);
+          } else
+            Function(Operand.nNode);
+      } else if (Current_.Op == OpMatMul) {
+        Function(Current_.nLhs);
+        Function(Current_.nRhs);
+      } else if (Current_.Op == OpTranspose)
+        Function(Current_.nLhs);
+    };
+    for (const Step &Current : Steps)
+      ForEachOperand(Current, [&Reads](size_t nOperand) { Reads[nOperand]++; });
+    for (size_t nOutput : OutputNodes)
+      Reads[nOutput]++;
+
+    // Row major values of every computed node, inputs that are already row major aren't copied.
+    std::vector<const T *> Values(m_Nodes.size(), nullptr);
+    std::vector<std::vector<T>> Owned(m_Nodes.size());
+    BufferPool Pool;
+    for (const Step &Current : Steps) {
+      const Node &Target = m_Nodes[Current.nNode];
+      const size_t nSize = Target.nRows * Target.nCols;
+      if (Target.Op == OpInput && Target.nColStride == 1 && Target.nRowStride == Target.nCols) {
+        Values[Current.nNode] = Target.pValues(Target.pMatrix);
+        continue;
+      }
+
+      std::vector<T> Result = Pool.Acquire(nSize);
+      T *pResult = Result.data();
+      if (Target.Op == OpInput)
+        Internal::Kernels::Copy(Target.nRows, Target.nCols, Target.pValues(Target.pMatrix),
+                                Target.nRowStride, Target.nColStride, pResult, Target.nCols,
+                                size_t(1));
+      else if (Target.Op == OpTranspose)
+        Internal::Kernels::TransposeBlocked(Target.nCols, Target.nRows, Values[Target.nLhs],
+                                            Target.nRows, pResult, Target.nCols, Params);
+      else if (Target.Op == OpMatMul) {
+        const size_t nK = m_Nodes[Target.nLhs].nCols;
+        Internal::Kernels::GemmFused(Target.nRows, Target.nCols, nK, T(1), Values[Target.nLhs], nK,
+                                     Values[Target.nRhs], Target.nCols, T(0), pResult,
+                                     Target.nCols, MtxEpilogue<T>(), Params);
+      } else {
+        // One pass for the element-wise terms, then the fused products accumulate into it.
+        // Without element-wise terms the first product writes the result (Beta = 0).
+        std::vector<std::pair<T, const T *>> Elementwise;
+        for (const Term &Operand : Current.Terms)
+          if (!Operand.bFusedGemm)
+            Elementwise.emplace_back(Operand.Coefficient, Values[Operand.nNode]);
+        // Split among threads above Params.nParallelThreshold values, as the eager Map.
+        if (!Elementwise.empty()) {
+          const size_t nThreads = nSize >= Params.nParallelThreshold
+                                      ? Internal::Kernels::ThreadCount(Params.nThreads)
+                                      : 1;
+          Internal::Kernels::ParallelFor(
+              nSize, nThreads,
+              [&](size_t nBegin, size_t nEnd) {
+                for (size_t i = nBegin; i < nEnd; ++i) {
+                  T Value = T(0);
+                  for (const auto &[Coefficient, pOperand] : Elementwise)
+                    Value += Coefficient * pOperand[i];
+                  pResult[i] = Value;
+                }
+              },
+              pResult, sizeof(T));
+        }
+        T Beta = Elementwise.empty() ? T(0) : T(1);
+        for (const Term &Operand : Current.Terms) {
+          if (!Operand.bFusedGemm)
+            continue;
+          const Node &Product = m_Nodes[Operand.nNode];
+          const size_t nK = m_Nodes[Product.nLhs].nCols;
+          Internal::Kernels::GemmFused(Target.nRows, Target.nCols, nK, Operand.Coefficient,
+                                       Values[Product.nLhs], nK, Values[Product.nRhs],
+                                       Target.nCols, Beta, pResult, Target.nCols,
+                                       MtxEpilogue<T>(), Params);
+          Beta = T(1);
+          Stats.nFusedGemms++;
+        }
+      }
+      Stats.nSteps++;
+      Values[Current.nNode] = pResult;
+      Owned[Current.nNode] = std::move(Result);
+
+      ForEachOperand(Current, [&](size_t nOperand) {
+        if (--Reads[nOperand] == 0 && !Owned[nOperand].empty())
+          Pool.Release(std::move(Owned[nOperand]));
+      });
+    }
+
+    std::vector<MatrixType> Results;
+    Results.reserve(Outputs.size());
+    for (size_t nOutput : OutputNodes) {
+      const Node &Target = m_Nodes[nOutput];
+      Results.push_back(MakeOutput<MatrixType>(Target.nRows, Target.nCols));
+      MatrixType &Result = Results.back();
+      Internal::Kernels::Copy(Target.nRows, Target.nCols, Values[nOutput], Target.nCols, size_t(1),
+                              Result.Data(), Result.RowStride(), Result.ColStride());
+    }
+
+    Stats.nBuffers = Pool.nAllocated;
+    if (pStats != nullptr)
+      *pStats = Stats;
+    return Results;
+  }
+
+  /**
+   * @brief Evaluates a single expression.
+   * @see Evaluate
+   */
+  template <typename MatrixType>
+  auto Evaluate(const Expr &Output, MtxLazyStats *pStats = nullptr) -> MatrixType {
+    return MatrixType(Evaluate<MatrixType>(std::vector<Expr>{Output}, pStats).front());
+  }
+};
+}; // namespace Mafs::Lazy
+
+#endif // MAFS_MATRIX_LAZY_GRAPH_H
@@ -3,6 +3,7 @@
 
 #include <Mafs/Matrix/Operations/Operations.hpp>
 #include <string>
+#include <utility>
 
 namespace Mafs {
 template <typename T, size_t Rows_, size_t Cols_, size_t Options_>
@@ -16,6 +17,12 @@ public:
   Matrix(const Matrix &CopiedMatrix)
       : Internal::MatrixBase<Matrix<T, Rows_, Cols_, Options_>>(CopiedMatrix) {}
 
+  Matrix(Matrix &&MovedMatrix) noexcept
+      : Internal::MatrixBase<Matrix<T, Rows_, Cols_, Options_>>(std::move(MovedMatrix)) {}
+
+  Matrix &operator=(const Matrix &CopiedMatrix) = default;
+  Matrix &operator=(Matrix &&MovedMatrix) noexcept = default;
+
   template <typename Derived>
   Matrix(const Internal::MatrixBase<Derived> &Copy) : Internal::MatrixBase<Derived>(Copy) {}
 
@@ -2,8 +2,21 @@
 #define MAFS_MATRIXBASE_H
 
 #include <Mafs/Matrix/MatrixContainer.hpp>
+#include <Mafs/Matrix/Operations/Kernels/Blas.hpp>
+#include <Mafs/Matrix/Operations/Kernels/Generate.hpp>
+#include <Mafs/Matrix/Operations/Kernels/Math.hpp>
+#include <Mafs/Matrix/Operations/Kernels/Reduce.hpp>
+#include <Mafs/Matrix/Operations/Tuning.hpp>
 #include <Mafs/Utils/Utils.hpp>
-#include <fmt/core.h>
+#include <Mafs/Utils/Workspace.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fmt/format.h>
+#include <iterator>
+#include <type_traits>
+#include <typeinfo>
+#include <vector>
 
 namespace Mafs::Internal {
 template <typename T> struct MatrixTraits;
@@ -19,7 +32,9 @@ template <typename T> struct MatrixTraits;
 template <typename Derived> class MatrixBase {
 protected:
   typedef typename MatrixTraits<Derived>::Type Type;
-  Container<Type, MatrixTraits<Derived>::Rows, MatrixTraits<Derived>::Cols> m_Container;
+  Container<Type, MatrixTraits<Derived>::Rows, MatrixTraits<Derived>::Cols,
+            (size_t(MatrixTraits<Derived>::Options) & MtxSharedStorage) != 0>
+      m_Container;
 
   /**
    * @brief Matrix configurations
@@ -28,7 +43,8 @@ protected:
   enum {
     m_bIsDynamic = (AreEnumsEqual<MatrixTraits<Derived>::Rows, MtxDynamic>() ||
                     AreEnumsEqual<MatrixTraits<Derived>::Cols, MtxDynamic>()),
-    m_MtxStorage = MatrixTraits<Derived>::Options & 0x1
+    m_MtxStorage = MatrixTraits<Derived>::Options & 0x1,
+    m_bIsShared = m_bIsDynamic && (size_t(MatrixTraits<Derived>::Options) & MtxSharedStorage) != 0
   };
 
   /**
@@ -78,17 +94,16 @@ protected:
    * @param nOffset
    */
   void GenericMemSwap(size_t lIndex, size_t rIndex, size_t nOffset) {
-    // Save RIndex to swap.
-    std::memcpy(m_Container.Swap(), m_Container.Data() + (rIndex * nOffset),
-                sizeof(Type) * nOffset);
+    // Save RIndex to swap (borrowed from the thread scratch workspace).
+    ScratchBuffer<Type> Swap(nOffset);
+    std::memcpy(Swap.Data(), m_Container.Data() + (rIndex * nOffset), sizeof(Type) * nOffset);
 
     // Copy LIndex to RIndex
     std::memcpy(m_Container.Data() + (rIndex * nOffset), m_Container.Data() + (lIndex * nOffset),
                 sizeof(Type) * nOffset);
 
     // Copy swap to LIndex location
-    std::memcpy(m_Container.Data() + (lIndex * nOffset), m_Container.Swap(),
-                sizeof(Type) * nOffset);
+    std::memcpy(m_Container.Data() + (lIndex * nOffset), Swap.Data(), sizeof(Type) * nOffset);
   }
 
   /**
@@ -102,6 +117,7 @@ protected:
    * @param nOffset
    */
   void GenericLoopSwap(size_t lIndex, size_t rIndex, size_t nOffset) {
+    Type *pData = m_Container.Data();
     Type TmpValue;
     size_t aIndex, bIndex;
     for (size_t i = 0; i < nOffset; ++i) {
@@ -112,10 +128,225 @@ protected:
         aIndex = Index(lIndex, i);
         bIndex = Index(rIndex, i);
       }
-      TmpValue = m_Container[bIndex];
-      m_Container[bIndex] = m_Container[aIndex];
-      m_Container[aIndex] = TmpValue;
+      TmpValue = pData[bIndex];
+      pData[bIndex] = pData[aIndex];
+      pData[aIndex] = TmpValue;
+    }
+  }
+
+  /**
+   * @brief Throws if the matrix has no elements.
+   */
+  inline void EmptyCheck() const {
+    if (m_Container.Size() == 0)
+      throw std::domain_error("The matrix is empty");
+  }
+
+  static constexpr auto Abs(const Type &Value) -> Type { return Value < Type(0) ? -Value : Value; }
+
+  /**
+   * @brief Minimum/maximum value and its position.
+   *
+   * @param bMax
+   * @param pRow optional, row of the value.
+   * @param pCol optional, col of the value.
+   * @return Type
+   */
+  auto Extremum(bool bMax, size_t *pRow, size_t *pCol) const -> Type {
+    EmptyCheck();
+    size_t nIndex = Kernels::ParallelExtremumIndex(m_Container.Data(), m_Container.Size(), bMax,
+                                                   Tuning::Instance().Get());
+    if (nIndex == m_Container.Size())
+      nIndex = 0; // Only NaNs.
+    const size_t nInner = IsRowMajor() ? m_Container.ColCount() : m_Container.RowCount();
+    if (pRow != nullptr)
+      *pRow = IsRowMajor() ? nIndex / nInner : nIndex % nInner;
+    if (pCol != nullptr)
+      *pCol = IsRowMajor() ? nIndex % nInner : nIndex / nInner;
+    return m_Container[nIndex];
+  }
+
+  /**
+   * @brief Applies eOp to each of the nLines contiguous lines of nLength values of pData.
+   */
+  static void ReduceLines(const Type *pData, size_t nLines, size_t nLength, MtxReduction eOp,
+                          MtxSummation eMode, Type *pResult) {
+    const MtxTuningParams Params = Tuning::Instance().Get();
+    const size_t nThreads =
+        nLines * nLength >= Params.nParallelThreshold ? Kernels::ThreadCount(Params.nThreads) : 1;
+    auto Lines = [&](size_t nBegin, size_t nEnd) {
+      for (size_t l = nBegin; l < nEnd; ++l) {
+        const Type *pLine = pData + l * nLength;
+        auto Value = [pLine](size_t i) { return pLine[i]; };
+        auto AbsValue = [pLine](size_t i) { return Abs(pLine[i]); };
+        auto Square = [pLine](size_t i) { return pLine[i] * pLine[i]; };
+        if (eOp == MtxReduceMin || eOp == MtxReduceMax) {
+          const size_t nIndex = Kernels::ExtremumIndex(pLine, 0, nLength, eOp == MtxReduceMax);
+          pResult[l] = pLine[nIndex == nLength ? 0 : nIndex];
+        } else if (eOp == MtxReduceAbsSum)
+          pResult[l] = Kernels::Sum<Type>(0, nLength, AbsValue, eMode);
+        else if (eOp == MtxReduceNorm)
+          pResult[l] = static_cast<Type>(std::sqrt(Kernels::Sum<Type>(0, nLength, Square, eMode)));
+        else {
+          pResult[l] = Kernels::Sum<Type>(0, nLength, Value, eMode);
+          if (eOp == MtxReduceMean)
+            pResult[l] /= static_cast<Type>(nLength);
+        }
+      }
+    };
+    Kernels::ParallelFor(nLines, nThreads, Lines, pData, nLength * sizeof(Type));
+  }
+
+  /**
+   * @brief Reduction of every row (bRows) or col. Lines that are not contiguous in memory are
+   * reduced by streaming the storage once into one accumulator per line (see ReduceCols).
+   */
+  auto ReduceLines(bool bRows, MtxReduction eOp, MtxSummation eMode) const -> std::vector<Type> {
+    const size_t nLines = bRows ? m_Container.RowCount() : m_Container.ColCount();
+    const size_t nLength = bRows ? m_Container.ColCount() : m_Container.RowCount();
+    std::vector<Type> Result(nLines, Type(0));
+    if (m_Container.Size() == 0)
+      return Result;
+    if (bRows == IsRowMajor())
+      ReduceLines(m_Container.Data(), nLines, nLength, eOp, eMode, Result.data());
+    else
+      Kernels::ReduceCols(m_Container.Data(), nLength, nLines, eOp, eMode, Result.data(),
+                          Tuning::Instance().Get());
+    return Result;
+  }
+
+  /**
+   * @brief Number of contiguous lines of the storage (rows if row major, cols if col major) and
+   * their length.
+   */
+  inline size_t OuterCount() const { return IsRowMajor() ? RowCount() : ColCount(); }
+  inline size_t InnerCount() const { return IsRowMajor() ? ColCount() : RowCount(); }
+
+  /**
+   * @brief Sets the dimensions from the storage lines (see OuterCount), keeping the array.
+   */
+  inline void SetStorageShape(size_t nOuter, size_t nInner) {
+    if constexpr (AreEnumsEqual<m_MtxStorage, MtxRowMajor>())
+      m_Container.SetShape(nOuter, nInner);
+    else
+      m_Container.SetShape(nInner, nOuter);
+  }
+
+  /**
+   * @brief Inserts nCount lines of Value before line nAt of the storage. The lines are
+   * contiguous, so only the following ones move.
+   */
+  void InsertOuter(size_t nAt, size_t nCount, const Type &Value) {
+    const size_t nOuter = OuterCount(), nInner = InnerCount();
+    m_Container.Grow((nOuter + nCount) * nInner);
+    Type *pData = m_Container.Data();
+    std::move_backward(pData + nAt * nInner, pData + nOuter * nInner,
+                       pData + (nOuter + nCount) * nInner);
+    std::fill(pData + nAt * nInner, pData + (nAt + nCount) * nInner, Value);
+    SetStorageShape(nOuter + nCount, nInner);
+  }
+
+  /**
+   * @brief Inserts nCount values of Value before position nAt of every line of the storage. The
+   * lines are spread in place from the last one, so the array is only reallocated if it is full.
+   */
+  void InsertInner(size_t nAt, size_t nCount, const Type &Value) {
+    const size_t nOuter = OuterCount(), nInner = InnerCount(), nNewInner = nInner + nCount;
+    m_Container.Grow(nOuter * nNewInner);
+    Type *pData = m_Container.Data();
+    for (size_t l = nOuter; l-- > 0;) {
+      Type *pSource = pData + l * nInner, *pTarget = pData + l * nNewInner;
+      std::move_backward(pSource + nAt, pSource + nInner, pTarget + nNewInner);
+      std::move_backward(pSource, pSource + nAt, pTarget + nAt);
+      std::fill(pTarget + nAt, pTarget + nAt + nCount, Value);
     }
+    SetStorageShape(nOuter, nNewInner);
+  }
+
+  /**
+   * @brief Removes the lines [nAt, nAt + nCount) of the storage, the capacity is kept.
+   */
+  void RemoveOuter(size_t nAt, size_t nCount) {
+    const size_t nOuter = OuterCount(), nInner = InnerCount();
+    m_Container.Grow(m_Container.Size());
+    Type *pData = m_Container.Data();
+    std::move(pData + (nAt + nCount) * nInner, pData + nOuter * nInner, pData + nAt * nInner);
+    SetStorageShape(nOuter - nCount, nInner);
+  }
+
+  /**
+   * @brief Removes the positions [nAt, nAt + nCount) of every line of the storage, the capacity
+   * is kept.
+   */
+  void RemoveInner(size_t nAt, size_t nCount) {
+    const size_t nOuter = OuterCount(), nInner = InnerCount(), nNewInner = nInner - nCount;
+    m_Container.Grow(m_Container.Size());
+    Type *pData = m_Container.Data();
+    for (size_t l = 0; l < nOuter; ++l) {
+      Type *pSource = pData + l * nInner, *pTarget = pData + l * nNewInner;
+      if (pTarget != pSource)
+        std::move(pSource, pSource + nAt, pTarget);
+      std::move(pSource + nAt + nCount, pSource + nInner, pTarget + nAt);
+    }
+    SetStorageShape(nOuter, nNewInner);
+  }
+
+  /**
+   * @brief Inserts the rows (bRows) or cols of Other before nAt.
+   */
+  template <typename OtherDerived>
+  void InsertLines(bool bRows, size_t nAt, const MatrixBase<OtherDerived> &Other) {
+    static_assert(std::is_same_v<Type, typename MatrixTraits<OtherDerived>::Type>,
+                  "Inserted matrix must have the same type");
+    if (static_cast<const void *>(&Other) == static_cast<const void *>(this)) {
+      // The array may move while growing: insert a copy.
+      const Derived Copy(static_cast<const Derived &>(*this));
+      return InsertLines(bRows, nAt, Copy);
+    }
+    // An empty matrix takes the other dimension of Other.
+    if (Size() == 0 && (bRows ? RowCount() : ColCount()) == 0)
+      m_Container.SetShape(bRows ? 0 : Other.RowCount(), bRows ? Other.ColCount() : 0);
+    if ((bRows ? Other.ColCount() : Other.RowCount()) != (bRows ? ColCount() : RowCount()))
+      throw std::domain_error(fmt::format(
+          "{} must match. Matrix[{}][{}] / Other[{}][{}]", bRows ? "ColCount" : "RowCount",
+          RowCount(), ColCount(), Other.RowCount(), Other.ColCount()));
+    const size_t nCount = bRows ? Other.RowCount() : Other.ColCount();
+    if (bRows)
+      InsertRows(nAt, nCount);
+    else
+      InsertCols(nAt, nCount);
+    Type *pTarget = m_Container.Data() + (bRows ? nAt * RowStride() : nAt * ColStride());
+    Kernels::Copy(Other.RowCount(), Other.ColCount(), Other.Data(), Other.RowStride(),
+                  Other.ColStride(), pTarget, RowStride(), ColStride());
+  }
+
+  /**
+   * @brief Sets the diagonal to one, the other values are left unchanged.
+   */
+  void SetDiagonalOnes() {
+    Type *pData = m_Container.Data();
+    const size_t nStride = RowStride() + ColStride();
+    for (size_t i = 0; i < std::min(RowCount(), ColCount()); ++i)
+      pData[i * nStride] = Type(1);
+  }
+
+  /**
+   * @brief Uninitialized (or zero, bZero) nRows x nCols matrix for the factories. Static
+   * matrices throw std::domain_error if nRows x nCols isn't their size.
+   */
+  static auto Create(size_t nRows, size_t nCols, bool bZero) -> Derived {
+    Derived Result;
+    MatrixBase &Base = Result;
+    if constexpr (m_bIsDynamic)
+      Base.m_Container.Resize(nRows, nCols, bZero);
+    else {
+      if (nRows != Result.RowCount() || nCols != Result.ColCount())
+        throw std::domain_error(fmt::format("The matrix is static [{}][{}], it can't be [{}][{}]",
+                                            Result.RowCount(), Result.ColCount(), nRows, nCols));
+      if (bZero)
+        Base.SetZero();
+    }
+    return Result;
   }
 
 public:
@@ -147,23 +378,42 @@ public:
 
   /**
    * @brief Copy constructor
+   * With MtxSharedStorage the values are shared with CopiedMatrix instead of copied, until one of
+   * the two is modified.
    *
    * @param CopiedMatrix
    */
-  MatrixBase(const MatrixBase &CopiedMatrix) {
-    if constexpr (m_bIsDynamic)
-      m_Container.Resize(CopiedMatrix.RowCount(), CopiedMatrix.ColCount());
+  MatrixBase(const MatrixBase &CopiedMatrix) : m_Container(CopiedMatrix.m_Container) {}
 
-    std::memcpy(m_Container.Data(), CopiedMatrix.m_Container.Data(),
-                sizeof(Type) * CopiedMatrix.m_Container.Size());
+  /**
+   * @brief Move constructor, MovedMatrix is left empty (dynamic matrices) without copying.
+   *
+   * @param MovedMatrix
+   */
+  MatrixBase(MatrixBase &&MovedMatrix) noexcept = default;
+
+  /**
+   * @brief Copy assignment, the previous values are released.
+   * With MtxSharedStorage the values are shared with CopiedMatrix, like the copy constructor.
+   *
+   * @param CopiedMatrix
+   * @return MatrixBase&
+   */
+  MatrixBase &operator=(const MatrixBase &CopiedMatrix) {
+    m_Container = CopiedMatrix.m_Container;
+    return *this;
   }
 
+  MatrixBase &operator=(MatrixBase &&MovedMatrix) noexcept = default;
+
   /**
    * @brief Access an element inside the matrix.
    * Returns a reference to the element at position [nRow][nCol] in the matrix.
    * The function checks whether [nRow][nCol] is within the bounds of valid elements in the
    * matrix, throwing an out_of_range exception if it is not (i.e., if [nRow][nCol] is greater than
    * its size).
+   * With MtxSharedStorage this is a mutating access (see At): the reference must not be written
+   * through once the matrix has been copied again.
    * Usage: Matrix(row, col);
    *
    * @see At()
@@ -194,6 +444,9 @@ public:
    * The function checks whether [nRow][nCol] is within the bounds of valid elements in the
    * matrix, throwing an out_of_range exception if it is not (i.e., if [nRow][nCol] is greater than
    * its size).
+   * With MtxSharedStorage this is a mutating access: shared values are copied first, and the
+   * reference must not be written through once the matrix has been copied again (e.g. after
+   * auto &r = A(0, 0); B = A; writing r changes B as well).
    *
    * @param nRow
    * @param nCol
@@ -235,13 +488,483 @@ public:
   inline size_t ColCount() const { return m_Container.ColCount(); }
 
   /**
-   * @brief Fill the matrix with Value.
+   * @brief Returns the number of elements of this matrix (RowCount * ColCount).
+   *
+   * @return size_t
+   */
+  inline size_t Size() const { return m_Container.Size(); }
+
+  /**
+   * @brief Returns a pointer to the contiguous array holding the matrix values.
+   * The values are laid out according to the storage order.
+   * With MtxSharedStorage this is a mutating access: shared values are copied first, and the
+   * pointer must not be written through once the matrix has been copied again.
+   *
+   * @see IsRowMajor
+   * @return Type*
+   */
+  inline Type *Data() { return m_Container.Data(); }
+
+  /**
+   * @brief Returns a const pointer to the contiguous array holding the matrix values.
+   * The values are laid out according to the storage order.
+   *
+   * @see IsRowMajor
+   * @return const Type*
+   */
+  inline const Type *Data() const { return m_Container.Data(); }
+
+  /**
+   * @brief Returns true if the values are shared with a copy of the matrix (MtxSharedStorage),
+   * the next mutating access (At, operator(), Data, Fill, Apply, SwapRows, SwapCols, in place
+   * operations) copies them.
+   *
+   * @return bool
+   */
+  inline bool IsShared() const {
+    if constexpr (m_bIsShared)
+      return m_Container.IsShared();
+    else
+      return false;
+  }
+
+  /**
+   * @brief Number of matrices sharing the values (MtxSharedStorage), 1 if they aren't shared and
+   * 0 if the matrix owns no values.
+   *
+   * @return size_t
+   */
+  inline size_t ShareCount() const {
+    if constexpr (m_bIsShared)
+      return m_Container.ShareCount();
+    else
+      return m_Container.Size() > 0 ? 1 : 0;
+  }
+
+  /**
+   * @brief Returns true if the matrix is stored as row major, false if col major.
+   *
+   * @return bool
+   */
+  static constexpr auto IsRowMajor() -> bool {
+    return AreEnumsEqual<m_MtxStorage, MtxRowMajor>();
+  }
+
+  /**
+   * @brief Distance, in elements, between [i][j] and [i + 1][j] inside Data().
+   *
+   * @return size_t
+   */
+  inline size_t RowStride() const { return IsRowMajor() ? m_Container.ColCount() : 1; }
+
+  /**
+   * @brief Distance, in elements, between [i][j] and [i][j + 1] inside Data().
+   *
+   * @return size_t
+   */
+  inline size_t ColStride() const { return IsRowMajor() ? 1 : m_Container.RowCount(); }
+
+  /**
+   * @brief Fill the matrix with Value. Above the tuning parallel threshold the matrix is split
+   * among threads, and zero is written with memset.
    *
    * @param Value
    */
   void Fill(const Type &Value) {
-    for (size_t i = 0; i < m_Container.Size(); ++i)
-      m_Container[i] = Value;
+    Kernels::Fill(m_Container.Size(), m_Container.Data(), Value, Tuning::Instance().Get());
+  }
+
+  /**
+   * @brief Sets every value to zero.
+   */
+  void SetZero() { Fill(Type(0)); }
+
+  /**
+   * @brief Sets the diagonal to one and the other values to zero (rectangular matrices too).
+   */
+  void SetIdentity() {
+    SetZero();
+    SetDiagonalOnes();
+  }
+
+  /**
+   * @brief Sets the values to nRows * nCols evenly spaced values from Low to High (both included),
+   * in row order whatever the storage order: [i][j] = Low + (High - Low) * (i * ColCount + j) /
+   * (Size - 1). A single value is Low.
+   *
+   * @param Low
+   * @param High
+   */
+  void SetLinSpace(const Type &Low, const Type &High) {
+    const size_t nRows = RowCount(), nCols = ColCount();
+    const double Step = Size() > 1 ? (static_cast<double>(High) - static_cast<double>(Low)) /
+                                         static_cast<double>(Size() - 1)
+                                   : 0.0;
+    auto Value = [&](size_t nIndex) {
+      const size_t k = IsRowMajor() ? nIndex : (nIndex % nRows) * nCols + nIndex / nRows;
+      // The last value is High exactly, not Low plus the rounded steps.
+      if (k > 0 && k + 1 == nRows * nCols)
+        return High;
+      return static_cast<Type>(static_cast<double>(Low) + Step * static_cast<double>(k));
+    };
+    Kernels::Generate(Size(), m_Container.Data(), Value, Tuning::Instance().Get());
+  }
+
+  /**
+   * @brief Sets the values to uniform random values in [Low, High) ([Low, High] for integer
+   * types). The values only depend on nSeed and their position in Data(), not on the thread
+   * count (counter based Philox4x32-10 generator), so a seed always gives the same matrix.
+   *
+   * @param Low
+   * @param High
+   * @param nSeed
+   */
+  void SetRandom(const Type &Low = Type(0), const Type &High = Type(1), uint64_t nSeed = 0) {
+    Kernels::RandomUniform(Size(), m_Container.Data(), Low, High, nSeed,
+                           Tuning::Instance().Get());
+  }
+
+  /**
+   * @brief Sets the values to normal random values (floating point types only), reproducible
+   * like SetRandom.
+   *
+   * @see SetRandom
+   * @param Mean
+   * @param StdDev standard deviation.
+   * @param nSeed
+   */
+  void SetRandomNormal(const Type &Mean = Type(0), const Type &StdDev = Type(1),
+                       uint64_t nSeed = 0) {
+    Kernels::RandomNormal(Size(), m_Container.Data(), Mean, StdDev, nSeed,
+                          Tuning::Instance().Get());
+  }
+
+  /**
+   * @brief nRows x nCols matrix of zeros. Dynamic matrices of plain types are allocated zeroed
+   * (calloc or fresh pages), so the values are not written twice.
+   * Static matrices throw std::domain_error if nRows x nCols isn't their size.
+   *
+   * @param nRows
+   * @param nCols
+   * @return Derived
+   */
+  static auto Zero(size_t nRows, size_t nCols) -> Derived { return Create(nRows, nCols, true); }
+
+  /**
+   * @brief nRows x nCols matrix whose values are all Value.
+   *
+   * @see Zero
+   * @param nRows
+   * @param nCols
+   * @param Value
+   * @return Derived
+   */
+  static auto Constant(size_t nRows, size_t nCols, const Type &Value) -> Derived {
+    Derived Result = Create(nRows, nCols, false);
+    Result.Fill(Value);
+    return Result;
+  }
+
+  /**
+   * @brief nRows x nCols matrix with ones on the diagonal and zeros elsewhere.
+   *
+   * @see Zero
+   * @param nRows
+   * @param nCols
+   * @return Derived
+   */
+  static auto Identity(size_t nRows, size_t nCols) -> Derived {
+    // The values of Create are already zero, only the diagonal is written.
+    Derived Result = Create(nRows, nCols, true);
+    static_cast<MatrixBase &>(Result).SetDiagonalOnes();
+    return Result;
+  }
+
+  /**
+   * @brief nRows x nCols evenly spaced values from Low to High, in row order.
+   *
+   * @see SetLinSpace
+   * @param nRows
+   * @param nCols
+   * @param Low
+   * @param High
+   * @return Derived
+   */
+  static auto LinSpace(size_t nRows, size_t nCols, const Type &Low, const Type &High)
+      -> Derived {
+    Derived Result = Create(nRows, nCols, false);
+    Result.SetLinSpace(Low, High);
+    return Result;
+  }
+
+  /**
+   * @brief nRows x nCols uniform random values in [Low, High), reproducible for a given seed.
+   *
+   * @see SetRandom
+   * @param nRows
+   * @param nCols
+   * @param Low
+   * @param High
+   * @param nSeed
+   * @return Derived
+   */
+  static auto Random(size_t nRows, size_t nCols, const Type &Low = Type(0),
+                     const Type &High = Type(1), uint64_t nSeed = 0) -> Derived {
+    Derived Result = Create(nRows, nCols, false);
+    Result.SetRandom(Low, High, nSeed);
+    return Result;
+  }
+
+  /**
+   * @brief nRows x nCols normal random values, reproducible for a given seed.
+   *
+   * @see SetRandomNormal
+   * @param nRows
+   * @param nCols
+   * @param Mean
+   * @param StdDev
+   * @param nSeed
+   * @return Derived
+   */
+  static auto RandomNormal(size_t nRows, size_t nCols, const Type &Mean = Type(0),
+                           const Type &StdDev = Type(1), uint64_t nSeed = 0) -> Derived {
+    Derived Result = Create(nRows, nCols, false);
+    Result.SetRandomNormal(Mean, StdDev, nSeed);
+    return Result;
+  }
+
+  /**
+   * @brief Sum of every value. Above the tuning parallel threshold the matrix is split among
+   * threads.
+   *
+   * @param eMode summation algorithm (MtxSumPairwise/MtxSumKahan for better accuracy).
+   * @return Type
+   */
+  auto Sum(MtxSummation eMode = MtxSumFast) const -> Type {
+    const Type *pData = m_Container.Data();
+    return Kernels::ParallelSum<Type>(
+        m_Container.Size(), [pData](size_t i) { return pData[i]; }, eMode,
+        Tuning::Instance().Get(), pData);
+  }
+
+  /**
+   * @brief Mean of every value, throws std::domain_error if the matrix is empty.
+   *
+   * @param eMode summation algorithm.
+   * @return Type
+   */
+  auto Mean(MtxSummation eMode = MtxSumFast) const -> Type {
+    EmptyCheck();
+    return Sum(eMode) / static_cast<Type>(m_Container.Size());
+  }
+
+  /**
+   * @brief Minimum value (NaNs are skipped), throws std::domain_error if the matrix is empty.
+   * If it appears several times, the first one in memory order is reported.
+   *
+   * @param pRow optional, set to the row of the value.
+   * @param pCol optional, set to the col of the value.
+   * @return Type
+   */
+  auto Min(size_t *pRow = nullptr, size_t *pCol = nullptr) const -> Type {
+    return Extremum(false, pRow, pCol);
+  }
+
+  /**
+   * @brief Maximum value (NaNs are skipped), throws std::domain_error if the matrix is empty.
+   * If it appears several times, the first one in memory order is reported.
+   *
+   * @param pRow optional, set to the row of the value.
+   * @param pCol optional, set to the col of the value.
+   * @return Type
+   */
+  auto Max(size_t *pRow = nullptr, size_t *pCol = nullptr) const -> Type {
+    return Extremum(true, pRow, pCol);
+  }
+
+  /**
+   * @brief Sum of the element-wise products with Other (Frobenius inner product).
+   * Throws std::domain_error if the dimensions don't match.
+   *
+   * @param Other matrix of the same type, any storage order.
+   * @param eMode summation algorithm.
+   * @return Type
+   */
+  template <typename OtherDerived>
+  auto Dot(const MatrixBase<OtherDerived> &Other, MtxSummation eMode = MtxSumFast) const -> Type {
+    static_assert(std::is_same_v<Type, typename MatrixTraits<OtherDerived>::Type>,
+                  "Dot requires matrices of the same type");
+    if (RowCount() != Other.RowCount() || ColCount() != Other.ColCount())
+      throw std::domain_error(
+          fmt::format("RowCount and ColCount must be equal. lMatrix[{}][{}] / rMatrix[{}][{}]",
+                      RowCount(), ColCount(), Other.RowCount(), Other.ColCount()));
+    const Type *pData = m_Container.Data();
+    const Type *pOther = Other.Data();
+    if constexpr (IsRowMajor() == MatrixBase<OtherDerived>::IsRowMajor())
+      return Kernels::ParallelSum<Type>(
+          Size(), [pData, pOther](size_t i) { return pData[i] * pOther[i]; }, eMode,
+          Tuning::Instance().Get(), pData);
+    else {
+      // Element i of this storage is (i / nInner, i % nInner), transposed in Other's storage.
+      const size_t nInner = IsRowMajor() ? ColCount() : RowCount();
+      const size_t nOuter = IsRowMajor() ? RowCount() : ColCount();
+      return Kernels::ParallelSum<Type>(
+          Size(),
+          [pData, pOther, nInner, nOuter](size_t i) {
+            return pData[i] * pOther[(i % nInner) * nOuter + i / nInner];
+          },
+          eMode, Tuning::Instance().Get(), pData);
+    }
+  }
+
+  /**
+   * @brief Frobenius norm, sqrt(sum of the squares).
+   *
+   * @param eMode summation algorithm.
+   * @return Type
+   */
+  auto Norm(MtxSummation eMode = MtxSumFast) const -> Type {
+    const Type *pData = m_Container.Data();
+    return static_cast<Type>(std::sqrt(Kernels::ParallelSum<Type>(
+        m_Container.Size(), [pData](size_t i) { return pData[i] * pData[i]; }, eMode,
+        Tuning::Instance().Get(), pData)));
+  }
+
+  /**
+   * @brief 1-norm, maximum absolute col sum (0 if empty).
+   *
+   * @return Type
+   */
+  auto Norm1() const -> Type {
+    const std::vector<Type> Sums = ColReduce(MtxReduceAbsSum);
+    return Sums.empty() ? Type(0) : *std::max_element(Sums.begin(), Sums.end());
+  }
+
+  /**
+   * @brief Infinity norm, maximum absolute row sum (0 if empty).
+   *
+   * @return Type
+   */
+  auto NormInf() const -> Type {
+    const std::vector<Type> Sums = RowReduce(MtxReduceAbsSum);
+    return Sums.empty() ? Type(0) : *std::max_element(Sums.begin(), Sums.end());
+  }
+
+  /**
+   * @brief Sum of the diagonal, throws std::domain_error if the matrix is not square.
+   *
+   * @param eMode summation algorithm.
+   * @return Type
+   */
+  auto Trace(MtxSummation eMode = MtxSumFast) const -> Type {
+    if (RowCount() != ColCount())
+      throw std::domain_error(
+          fmt::format("The matrix must be square. Matrix[{}][{}]", RowCount(), ColCount()));
+    // [i][i] is at i * (n + 1) in both storage orders.
+    const Type *pData = m_Container.Data();
+    const size_t nStride = RowCount() + 1;
+    return Kernels::ParallelSum<Type>(
+        RowCount(), [pData, nStride](size_t i) { return pData[i * nStride]; }, eMode,
+        Tuning::Instance().Get());
+  }
+
+  /**
+   * @brief Reduces each row to a single value.
+   * Usage: auto Means = Matrix.RowReduce(Mafs::MtxReduceMean);
+   *
+   * @param eOp reduction.
+   * @param eMode summation algorithm of the sums/means/norms.
+   * @return std::vector<Type> RowCount values.
+   */
+  auto RowReduce(MtxReduction eOp, MtxSummation eMode = MtxSumFast) const -> std::vector<Type> {
+    return ReduceLines(true, eOp, eMode);
+  }
+
+  /**
+   * @brief Reduces each col to a single value.
+   * Usage: auto Norms = Matrix.ColReduce(Mafs::MtxReduceNorm);
+   *
+   * @param eOp reduction.
+   * @param eMode summation algorithm of the sums/means/norms.
+   * @return std::vector<Type> ColCount values.
+   */
+  auto ColReduce(MtxReduction eOp, MtxSummation eMode = MtxSumFast) const -> std::vector<Type> {
+    return ReduceLines(false, eOp, eMode);
+  }
+
+  /**
+   * @brief Replaces every value by Function(value), over the contiguous Data() so the loop is
+   * vectorized when Function is (e.g. Mafs::MtxExp, MtxLog, MtxTanh, MtxSigmoid, MtxSqrt, MtxPow
+   * or a lambda). Above the tuning parallel threshold the matrix is split among threads.
+   * Usage: Matrix.Apply(Mafs::MtxSigmoid{}); Matrix.Apply([](double x) { return x * x; });
+   *
+   * @param Function Type(Type), called concurrently.
+   * @return Derived& this matrix.
+   */
+  template <typename Func> auto Apply(Func Function) -> Derived & {
+    Kernels::Map(Size(), m_Container.Data(), m_Container.Data(), Function,
+                 Tuning::Instance().Get());
+    return static_cast<Derived &>(*this);
+  }
+
+  /**
+   * @brief Replaces every value by Function(value, Other value at the same position).
+   * Throws std::domain_error if the dimensions don't match.
+   * Usage: Matrix.Apply(Exponents, Mafs::MtxPow{});
+   *
+   * @param Other matrix of the same dimensions, any storage order.
+   * @param Function Type(Type, OtherType), called concurrently.
+   * @return Derived& this matrix.
+   */
+  template <typename OtherDerived, typename Func>
+  auto Apply(const MatrixBase<OtherDerived> &Other, Func Function) -> Derived & {
+    if (RowCount() != Other.RowCount() || ColCount() != Other.ColCount())
+      throw std::domain_error(
+          fmt::format("RowCount and ColCount must be equal. lMatrix[{}][{}] / rMatrix[{}][{}]",
+                      RowCount(), ColCount(), Other.RowCount(), Other.ColCount()));
+    typedef typename MatrixTraits<OtherDerived>::Type OtherType;
+    const MtxTuningParams Params = Tuning::Instance().Get();
+    if constexpr (IsRowMajor() == MatrixBase<OtherDerived>::IsRowMajor())
+      Kernels::Map(Size(), m_Container.Data(), Other.Data(), m_Container.Data(), Function, Params);
+    else {
+      // Other is transposed into this storage order first, so both are read contiguously.
+      const size_t nInner = IsRowMajor() ? ColCount() : RowCount();
+      const size_t nOuter = IsRowMajor() ? RowCount() : ColCount();
+      ScratchBuffer<OtherType> Buffer(Size());
+      Kernels::TransposeBlocked(nInner, nOuter, Other.Data(), nOuter, Buffer.Data(), nInner,
+                                Params);
+      Kernels::Map(Size(), m_Container.Data(), Buffer.Data(), m_Container.Data(), Function,
+                   Params);
+    }
+    return static_cast<Derived &>(*this);
+  }
+
+  /**
+   * @brief Copy of this matrix with Function applied to every value.
+   *
+   * @see Apply()
+   * @param Function Type(Type), called concurrently.
+   * @return Derived
+   */
+  template <typename Func> auto Map(Func Function) const -> Derived {
+    Derived Result(static_cast<const Derived &>(*this));
+    Result.Apply(Function);
+    return Result;
+  }
+
+  /**
+   * @brief Copy of this matrix with Function(value, Other value) at every position.
+   *
+   * @see Apply()
+   * @param Other matrix of the same dimensions, any storage order.
+   * @param Function Type(Type, OtherType), called concurrently.
+   * @return Derived
+   */
+  template <typename OtherDerived, typename Func>
+  auto Map(const MatrixBase<OtherDerived> &Other, Func Function) const -> Derived {
+    Derived Result(static_cast<const Derived &>(*this));
+    Result.Apply(Other, Function);
+    return Result;
   }
 
   /**
@@ -274,6 +997,197 @@ public:
       GenericLoopSwap(aCol, bCol, m_Container.RowCount());
   }
 
+  /**
+   * @brief Inserts nCount rows of Value before nRow (nRow = RowCount appends them). The values
+   * are kept and the array grows geometrically (see Reserve), so appending rows one at a time
+   * costs O(row) amortized in row major (O(size) per call in col major, where every col grows).
+   * Dynamic matrices only, throws std::out_of_range if nRow > RowCount.
+   *
+   * @param nRow
+   * @param nCount
+   * @param Value
+   */
+  void InsertRows(size_t nRow, size_t nCount, const Type &Value = Type(0)) {
+    static_assert(m_bIsDynamic, "InsertRows requires a dynamic matrix");
+    if (nRow > RowCount())
+      throw std::out_of_range(fmt::format("Row {} is out of range", nRow));
+    if constexpr (AreEnumsEqual<m_MtxStorage, MtxRowMajor>())
+      InsertOuter(nRow, nCount, Value);
+    else
+      InsertInner(nRow, nCount, Value);
+  }
+
+  /**
+   * @brief Inserts nCount cols of Value before nCol (nCol = ColCount appends them).
+   * Dynamic matrices only, throws std::out_of_range if nCol > ColCount.
+   *
+   * @see InsertRows
+   * @param nCol
+   * @param nCount
+   * @param Value
+   */
+  void InsertCols(size_t nCol, size_t nCount, const Type &Value = Type(0)) {
+    static_assert(m_bIsDynamic, "InsertCols requires a dynamic matrix");
+    if (nCol > ColCount())
+      throw std::out_of_range(fmt::format("Col {} is out of range", nCol));
+    if constexpr (AreEnumsEqual<m_MtxStorage, MtxColMajor>())
+      InsertOuter(nCol, nCount, Value);
+    else
+      InsertInner(nCol, nCount, Value);
+  }
+
+  /**
+   * @brief Inserts the rows of Rows (any storage order, same ColCount) before nRow. An empty
+   * matrix takes the ColCount of Rows.
+   *
+   * @see InsertRows
+   * @param nRow
+   * @param Rows
+   */
+  template <typename OtherDerived>
+  void InsertRows(size_t nRow, const MatrixBase<OtherDerived> &Rows) {
+    InsertLines(true, nRow, Rows);
+  }
+
+  /**
+   * @brief Inserts the cols of Cols (any storage order, same RowCount) before nCol. An empty
+   * matrix takes the RowCount of Cols.
+   *
+   * @see InsertCols
+   * @param nCol
+   * @param Cols
+   */
+  template <typename OtherDerived>
+  void InsertCols(size_t nCol, const MatrixBase<OtherDerived> &Cols) {
+    InsertLines(false, nCol, Cols);
+  }
+
+  /**
+   * @brief Appends the rows of Rows below the matrix (vertical concatenation).
+   * Usage: Samples.AppendRows(Sample); // Sample is 1 x n
+   *
+   * @see InsertRows
+   * @param Rows
+   */
+  template <typename OtherDerived> void AppendRows(const MatrixBase<OtherDerived> &Rows) {
+    InsertLines(true, RowCount(), Rows);
+  }
+
+  /**
+   * @brief Appends the cols of Cols right of the matrix (horizontal concatenation).
+   *
+   * @see InsertCols
+   * @param Cols
+   */
+  template <typename OtherDerived> void AppendCols(const MatrixBase<OtherDerived> &Cols) {
+    InsertLines(false, ColCount(), Cols);
+  }
+
+  /**
+   * @brief Removes the rows [nRow, nRow + nCount), keeping the capacity.
+   * Dynamic matrices only, throws std::out_of_range if the rows don't exist.
+   *
+   * @param nRow
+   * @param nCount
+   */
+  void RemoveRows(size_t nRow, size_t nCount = 1) {
+    static_assert(m_bIsDynamic, "RemoveRows requires a dynamic matrix");
+    if (nRow > RowCount() || nCount > RowCount() - nRow)
+      throw std::out_of_range(fmt::format("Rows [{}, {}) are out of range", nRow, nRow + nCount));
+    if constexpr (AreEnumsEqual<m_MtxStorage, MtxRowMajor>())
+      RemoveOuter(nRow, nCount);
+    else
+      RemoveInner(nRow, nCount);
+  }
+
+  /**
+   * @brief Removes the cols [nCol, nCol + nCount), keeping the capacity.
+   * Dynamic matrices only, throws std::out_of_range if the cols don't exist.
+   *
+   * @param nCol
+   * @param nCount
+   */
+  void RemoveCols(size_t nCol, size_t nCount = 1) {
+    static_assert(m_bIsDynamic, "RemoveCols requires a dynamic matrix");
+    if (nCol > ColCount() || nCount > ColCount() - nCol)
+      throw std::out_of_range(fmt::format("Cols [{}, {}) are out of range", nCol, nCol + nCount));
+    if constexpr (AreEnumsEqual<m_MtxStorage, MtxColMajor>())
+      RemoveOuter(nCol, nCount);
+    else
+      RemoveInner(nCol, nCount);
+  }
+
+  /**
+   * @brief Changes the dimensions keeping the values in storage order (element i of Data() stays
+   * element i), without copying them. Dynamic matrices only, throws std::domain_error if
+   * nRows * nCols != Size.
+   *
+   * @param nRows
+   * @param nCols
+   */
+  void Reshape(size_t nRows, size_t nCols) {
+    static_assert(m_bIsDynamic, "Reshape requires a dynamic matrix");
+    if (nRows * nCols != Size())
+      throw std::domain_error(fmt::format("Reshape must keep the size. Matrix[{}][{}] / [{}][{}]",
+                                          RowCount(), ColCount(), nRows, nCols));
+    m_Container.SetShape(nRows, nCols);
+  }
+
+  /**
+   * @brief Resizes the matrix keeping the values of the rows/cols that remain, the new ones are
+   * set to Value (unlike the dynamic constructor/Resize, which discard the values).
+   * Dynamic matrices only.
+   *
+   * @param nRows
+   * @param nCols
+   * @param Value
+   */
+  void ConservativeResize(size_t nRows, size_t nCols, const Type &Value = Type(0)) {
+    static_assert(m_bIsDynamic, "ConservativeResize requires a dynamic matrix");
+    // Removals first, then the array is grown once to the exact size.
+    const size_t nOuter = IsRowMajor() ? nRows : nCols, nInner = IsRowMajor() ? nCols : nRows;
+    if (nOuter < OuterCount())
+      RemoveOuter(nOuter, OuterCount() - nOuter);
+    if (nInner < InnerCount())
+      RemoveInner(nInner, InnerCount() - nInner);
+    m_Container.Reserve(nRows * nCols);
+    if (nInner > InnerCount())
+      InsertInner(InnerCount(), nInner - InnerCount(), Value);
+    if (nOuter > OuterCount())
+      InsertOuter(OuterCount(), nOuter - OuterCount(), Value);
+  }
+
+  /**
+   * @brief Makes room for nCapacity values, so the matrix can grow up to that size (InsertRows,
+   * AppendRows, ConservativeResize...) without being reallocated. Dynamic matrices only.
+   *
+   * @param nCapacity
+   */
+  void Reserve(size_t nCapacity) {
+    static_assert(m_bIsDynamic, "Reserve requires a dynamic matrix");
+    m_Container.Reserve(nCapacity);
+  }
+
+  /**
+   * @brief Number of values the matrix can hold without being reallocated.
+   *
+   * @return size_t
+   */
+  inline size_t Capacity() const {
+    if constexpr (m_bIsDynamic)
+      return m_Container.Capacity();
+    else
+      return m_Container.Size();
+  }
+
+  /**
+   * @brief Frees the capacity above Size (e.g. once a matrix built row by row is complete).
+   */
+  void ShrinkToFit() {
+    if constexpr (m_bIsDynamic)
+      m_Container.ShrinkToFit();
+  }
+
   /**
    * @brief Puts the matrix infos and values to string.
    * It'll print as follow:
@@ -286,6 +1200,7 @@ public:
    * @return std::string
    */
   inline auto ToString() -> std::string {
+    const auto &Values = m_Container; // Read only, doesn't copy shared values.
     std::string strOptions = "";
 
     if constexpr (AreEnumsEqual<m_MtxStorage, MtxRowMajor>())
@@ -298,16 +1213,18 @@ public:
     else
       strOptions += ", Static";
 
-    // @todo: improve this (maybe put on a function, use memmove, idk... just improve it)
-    std::string strData = "";
+    // Everything is formatted into a single growing buffer (no temporary string per value).
+    fmt::memory_buffer Buffer;
+    fmt::format_to(std::back_inserter(Buffer), "Matrix<{}>[{}][{}] // {}\n", typeid(Type).name(),
+                   m_Container.RowCount(), m_Container.ColCount(), strOptions);
     for (size_t i = 0; i < m_Container.RowCount(); ++i) {
       for (size_t j = 0; j < m_Container.ColCount(); ++j)
-        strData += fmt::format("{} ", m_Container[Index(i, j)]);
-      strData += "\n";
+        fmt::format_to(std::back_inserter(Buffer), "{} ", Values[Index(i, j)]);
+      Buffer.push_back('\n');
     }
+    Buffer.push_back('\n');
 
-    return fmt::format("Matrix<{}>[{}][{}] // {}\n{}\n", typeid(Type).name(),
-                       m_Container.RowCount(), m_Container.ColCount(), strOptions, strData);
+    return fmt::to_string(Buffer);
   }
 };
 }; // namespace Mafs::Internal
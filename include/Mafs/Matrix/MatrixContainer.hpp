@@ -2,22 +2,32 @@
 #define MAFS_MATRIXCONTAINER_H
 
 #include <Mafs/Matrix/MatrixDataTypes.hpp>
+#include <Mafs/Utils/Instrumentation.hpp>
+#include <Mafs/Utils/Memory.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <new>
 #include <stddef.h>
+#include <type_traits>
 
 namespace Mafs::Internal {
-template <typename T, size_t Rows_, size_t Cols_> class Container;
+template <typename T, size_t Rows_, size_t Cols_, bool Shared_ = false> class Container;
 
 /**
  * @brief Fixed size container.
  *
  * The size is defined in the template parameter.
  * There is no bound check, this class is suppose to be used by the MatrixBase and Matrix classes.
+ * The values are stored inline, so they are never shared (Shared_ is ignored).
  *
  * @tparam T
  * @tparam Rows_
  * @tparam Cols_
+ * @tparam Shared_
  */
-template <typename T, size_t Rows_, size_t Cols_> class Container {
+template <typename T, size_t Rows_, size_t Cols_, bool Shared_> class Container {
 protected:
   // Enum containing the container static data.
   enum {
@@ -26,8 +36,6 @@ protected:
     m_nSize = Rows_ * Cols_ // Container size (m_nRows * m_nCols).
   };
   T m_Array[m_nRows * m_nCols]; // Array containing the Data.
-  // Swap array, used to temporary store data when swapping row/col.
-  T m_SwapArray[m_nRows > m_nCols ? m_nRows : m_nCols];
 
 public:
   Container() = default;
@@ -40,7 +48,6 @@ public:
   inline size_t ColCount() const { return m_nCols; }
   inline T *Data() { return m_Array; }
   inline const T *Data() const { return m_Array; }
-  inline T *Swap() { return m_SwapArray; }
 };
 
 /**
@@ -49,84 +56,358 @@ public:
  * In the Rows_/Cols_ parameter pass zero or Mtx::Dynamic.
  * There is no bound check, this class is suppose to be used by the MatrixBase and Matrix classes.
  *
+ * With Shared_ the array is reference counted: Share makes two containers point to the same
+ * array, and the first non const access (operator[], Data) of a container whose array is shared
+ * copies it first (Detach), so the values are only copied if they are modified.
+ *
+ * The array may hold more values than the matrix (Capacity): Grow enlarges it geometrically, so
+ * a matrix grown one row/col at a time is reallocated only O(log(n)) times.
+ *
  * @tparam T
+ * @tparam Shared_
  */
-template <typename T> class Container<T, MtxDynamic, MtxDynamic> {
+template <typename T, bool Shared_> class Container<T, MtxDynamic, MtxDynamic, Shared_> {
 protected:
   T *m_Array = nullptr; // Array containing the Data.
-  // Swap array, used to temporary store data when swapping row/col.
-  T *m_SwapArray = nullptr;
+  // False when m_Array points to memory owned by someone else (see Attach).
+  bool m_bOwnsData = true;
+  // Size of the mapping when m_Array comes from MapMemory (large containers, see MtxMemoryPolicy).
+  size_t m_nMappedBytes = 0;
+  // Containers sharing m_Array (Shared_ only, nullptr if m_Array is not owned).
+  std::atomic<size_t> *m_pRefs = nullptr;
 
   size_t m_nRows = 0; // Number of rows.
   size_t m_nCols = 0; // Number of cols.
   size_t m_nSize = 0; // Container size (m_nRows * m_nCols).
+  size_t m_nCapacity = 0; // Values m_Array can hold (>= m_nSize).
 
   /**
-   * @brief Delete and set to nullptr the Array and SwapArray.
+   * @brief Frees an owned array of nCapacity values, or only drops a reference to it while other
+   * containers share it.
+   */
+  static void Release(T *pArray, std::atomic<size_t> *pRefs, size_t nMappedBytes,
+                      size_t nCapacity) {
+    if (pRefs != nullptr) {
+      if (pRefs->fetch_sub(1, std::memory_order_acq_rel) != 1)
+        return;
+      delete pRefs;
+    }
+    if (nMappedBytes > 0)
+      UnmapMemory(pArray, nMappedBytes);
+    else if constexpr (std::is_trivial_v<T>)
+      std::free(pArray);
+    else
+      delete[] pArray;
+    MAFS_RECORD_FREE(sizeof(T) * nCapacity);
+    (void)nCapacity;
+  }
+
+  /**
+   * @brief Delete and set to nullptr the Array.
    */
   void Dealloc() {
     if (m_Array != nullptr) {
-      delete[] m_Array;
-      delete[] m_SwapArray;
+      if (m_bOwnsData)
+        Release(m_Array, m_pRefs, m_nMappedBytes, m_nCapacity);
 
       m_Array = nullptr;
-      m_SwapArray = nullptr;
     }
+    m_bOwnsData = true;
+    m_nMappedBytes = 0;
+    m_pRefs = nullptr;
+    m_nCapacity = 0;
   }
 
   /**
-   * @brief Allocate the Array and SwapArray.
-   * The array size is m_nSize (m_nRow * m_nCol).
-   * The swap array size is the biggest value between "m_nRow and m_nCol".
+   * @brief Allocate the Array.
+   * The array size is nCapacity (m_nSize by default).
+   * Arrays above the MtxMemoryPolicy threshold are mapped with MapMemory.
+   * With bZero the values are zero: plain types come from calloc (or the mapping, whose pages are
+   * already zero), so large arrays are zeroed lazily by the OS instead of written twice.
    *
    * If the Array is allocated, the function first deallocate it by calling Dealloc.
    * @see Dealloc
    * @see m_nRow, m_nCol
    */
-  void Alloc() {
+  void Alloc(size_t nCapacity = 0, bool bZero = false) {
     if (m_Array != nullptr)
       Dealloc();
-    m_Array = new T[m_nSize];
-    m_SwapArray = new T[m_nRows > m_nCols ? m_nRows : m_nCols];
+    m_nCapacity = std::max(nCapacity, m_nSize);
+    // Large arrays of plain types may be mapped instead (NUMA placement, huge pages).
+    if constexpr (std::is_trivial_v<T>) {
+      const size_t nBytes = sizeof(T) * m_nCapacity;
+      if (UseMappedMemory(nBytes))
+        m_Array = static_cast<T *>(MapMemory(nBytes, m_nMappedBytes));
+      else {
+        m_Array = static_cast<T *>(bZero ? std::calloc(m_nCapacity, sizeof(T))
+                                         : std::malloc(std::max<size_t>(nBytes, 1)));
+        if (m_Array == nullptr)
+          throw std::bad_alloc();
+      }
+    } else {
+      m_Array = new T[m_nCapacity];
+      if (bZero)
+        std::fill(m_Array, m_Array + m_nCapacity, T(0));
+    }
+    MAFS_RECORD_ALLOC(sizeof(T) * m_nCapacity);
+    if constexpr (Shared_)
+      m_pRefs = new std::atomic<size_t>(1);
+  }
+
+  /**
+   * @brief Moves the values to a new array of nCapacity (>= m_nSize) values owned by this
+   * container only.
+   *
+   * @param nCapacity
+   */
+  void Relocate(size_t nCapacity) {
+    T *pPrevious = m_Array;
+    std::atomic<size_t> *pRefs = m_pRefs;
+    const size_t nMappedBytes = m_nMappedBytes, nPreviousCapacity = m_nCapacity;
+    const bool bOwned = m_bOwnsData;
+    m_Array = nullptr;
+    Dealloc();
+    if (nCapacity > 0) {
+      Alloc(nCapacity);
+      if constexpr (std::is_trivially_copyable_v<T>) {
+        if (m_nSize > 0)
+          std::memcpy(m_Array, pPrevious, sizeof(T) * m_nSize);
+      } else
+        std::copy(pPrevious, pPrevious + m_nSize, m_Array);
+    }
+    if (pPrevious != nullptr && bOwned)
+      Release(pPrevious, pRefs, nMappedBytes, nPreviousCapacity);
+  }
+
+  /**
+   * @brief Gives this container its own copy of the array if it is shared (Shared_ only).
+   */
+  void Detach() {
+    if (m_pRefs != nullptr && m_pRefs->load(std::memory_order_acquire) > 1)
+      Relocate(m_nSize);
+  }
+
+  /**
+   * @brief Takes the array of Other, which is left empty.
+   */
+  void Take(Container &Other) noexcept {
+    m_Array = Other.m_Array;
+    m_bOwnsData = Other.m_bOwnsData;
+    m_nMappedBytes = Other.m_nMappedBytes;
+    m_pRefs = Other.m_pRefs;
+    m_nRows = Other.m_nRows;
+    m_nCols = Other.m_nCols;
+    m_nSize = Other.m_nSize;
+    m_nCapacity = Other.m_nCapacity;
+    Other.m_Array = nullptr;
+    Other.m_bOwnsData = true;
+    Other.m_nMappedBytes = 0;
+    Other.m_pRefs = nullptr;
+    Other.m_nRows = Other.m_nCols = Other.m_nSize = Other.m_nCapacity = 0;
   }
 
 public:
   Container() = default;
-  Container(size_t nRows, size_t nCols) { Resize(nRows, nCols); }
+  Container(size_t nRows, size_t nCols, bool bZero = false) { Resize(nRows, nCols, bZero); }
+
+  /**
+   * @brief Copy: shares the array of Other (Shared_) or copies its values.
+   */
+  Container(const Container &Other) { *this = Other; }
+  Container(Container &&Other) noexcept { Take(Other); }
+
+  Container &operator=(const Container &Other) {
+    if (&Other == this)
+      return *this;
+    if constexpr (Shared_) {
+      Share(Other);
+      return *this;
+    }
+    Resize(Other.m_nRows, Other.m_nCols);
+    if constexpr (std::is_trivially_copyable_v<T>) {
+      if (m_nSize > 0)
+        std::memcpy(m_Array, Other.m_Array, sizeof(T) * m_nSize);
+    } else
+      std::copy(Other.m_Array, Other.m_Array + m_nSize, m_Array);
+    return *this;
+  }
+
+  Container &operator=(Container &&Other) noexcept {
+    if (&Other != this) {
+      Dealloc();
+      Take(Other);
+    }
+    return *this;
+  }
 
   ~Container() { Dealloc(); }
 
-  T &operator[](size_t nIndex) { return m_Array[nIndex]; }
-  T &operator[](size_t nIndex) const { return m_Array[nIndex]; }
+  T &operator[](size_t nIndex) {
+    if constexpr (Shared_)
+      Detach();
+    return m_Array[nIndex];
+  }
+  const T &operator[](size_t nIndex) const { return m_Array[nIndex]; }
 
   inline size_t Size() const { return m_nSize; }
   inline size_t RowCount() const { return m_nRows; }
   inline size_t ColCount() const { return m_nCols; }
-  inline T *Data() { return m_Array; }
+  inline size_t Capacity() const { return m_nCapacity; }
+  inline T *Data() {
+    if constexpr (Shared_)
+      Detach();
+    return m_Array;
+  }
   inline const T *Data() const { return m_Array; }
-  inline T *Swap() { return m_SwapArray; }
+
+  /**
+   * @brief True if other containers share the array (Shared_ only).
+   *
+   * @return bool
+   */
+  inline bool IsShared() const {
+    return m_pRefs != nullptr && m_pRefs->load(std::memory_order_acquire) > 1;
+  }
+
+  /**
+   * @brief Number of containers using the array (Shared_ only, 0 without an owned array).
+   *
+   * @return size_t
+   */
+  inline size_t ShareCount() const {
+    return m_pRefs != nullptr ? m_pRefs->load(std::memory_order_acquire) : 0;
+  }
+
+  /**
+   * @brief Makes the container point to the array of Other (Shared_ only): no copy, the array is
+   * freed with the last container using it. An array Other doesn't own (see Attach, e.g. a read
+   * only file mapping) may be read only or released first, so its values are copied instead.
+   *
+   * @param Other
+   */
+  void Share(const Container &Other) {
+    static_assert(Shared_, "Share requires a shared container");
+    if (&Other == this)
+      return;
+    Dealloc();
+    if (!Other.m_bOwnsData) {
+      m_nRows = Other.m_nRows;
+      m_nCols = Other.m_nCols;
+      m_nSize = Other.m_nSize;
+      if (m_nSize == 0)
+        return;
+      Alloc();
+      if constexpr (std::is_trivially_copyable_v<T>)
+        std::memcpy(m_Array, Other.m_Array, sizeof(T) * m_nSize);
+      else
+        std::copy(Other.m_Array, Other.m_Array + m_nSize, m_Array);
+      return;
+    }
+    if (Other.m_pRefs != nullptr)
+      Other.m_pRefs->fetch_add(1, std::memory_order_relaxed);
+    m_Array = Other.m_Array;
+    m_bOwnsData = Other.m_bOwnsData;
+    m_nMappedBytes = Other.m_nMappedBytes;
+    m_pRefs = Other.m_pRefs;
+    m_nRows = Other.m_nRows;
+    m_nCols = Other.m_nCols;
+    m_nSize = Other.m_nSize;
+    m_nCapacity = Other.m_nCapacity;
+  }
+
+  /**
+   * @brief Makes the container point to an external nRows * nCols array without copying it.
+   * The container doesn't own pData, it won't be deleted on Dealloc/destruction, so it must
+   * outlive the container. The container must be used as read only.
+   *
+   * @param pData
+   * @param nRows
+   * @param nCols
+   */
+  void Attach(T *pData, size_t nRows, size_t nCols) {
+    Dealloc();
+    m_Array = pData;
+    m_bOwnsData = false;
+    m_nRows = nRows;
+    m_nCols = nCols;
+    m_nSize = nRows * nCols;
+    m_nCapacity = m_nSize;
+  }
+
+  /**
+   * @brief Makes sure the array can hold nCapacity values, keeping the current ones.
+   *
+   * @param nCapacity
+   */
+  void Reserve(size_t nCapacity) {
+    if (nCapacity > m_nCapacity)
+      Relocate(nCapacity);
+  }
+
+  /**
+   * @brief Makes the array writable (owned and not shared) with room for nSize values, keeping
+   * the current ones. A larger array is at least twice as large as the previous one, so growing
+   * the container by small steps is amortized.
+   *
+   * @param nSize
+   */
+  void Grow(size_t nSize) {
+    if (nSize > m_nCapacity)
+      Relocate(std::max(nSize, 2 * m_nCapacity));
+    else if (!m_bOwnsData || IsShared())
+      Relocate(m_nCapacity);
+  }
+
+  /**
+   * @brief Frees the capacity above Size.
+   */
+  void ShrinkToFit() {
+    if (m_nCapacity > m_nSize && m_bOwnsData)
+      Relocate(m_nSize);
+  }
+
+  /**
+   * @brief Changes the dimensions without touching the array, nRows * nCols must fit in the
+   * capacity.
+   *
+   * @param nRows
+   * @param nCols
+   */
+  void SetShape(size_t nRows, size_t nCols) {
+    m_nRows = nRows;
+    m_nCols = nCols;
+    m_nSize = nRows * nCols;
+  }
 
   /**
    * @brief Resizes the container by nRows * nCols.
    * It deallocates the array by calling Dealloc, reassign the variables m_nRows, m_nCols, m_nSize
    * and then reallocates it by calling Alloc.
    *
+   * With bZero the values are set to zero, even if the size doesn't change.
+   *
    * @see Dealloc
    * @see Alloc
    * @param nRows
    * @param nCols
+   * @param bZero
    */
-  void Resize(size_t nRows, size_t nCols) {
-    if (nRows == m_nRows && nCols == m_nCols)
+  void Resize(size_t nRows, size_t nCols, bool bZero = false) {
+    if (nRows == m_nRows && nCols == m_nCols) {
+      if (bZero && m_nSize > 0)
+        std::fill(Data(), Data() + m_nSize, T(0));
       return; // Array set to same size.
-    else if (nRows <= 0 || nCols <= 0)
-      return Dealloc(); // Array set to zero, only dealloc.
+    }
+    else if (nRows <= 0 || nCols <= 0) {
+      Dealloc(); // Array set to zero, only dealloc.
+      SetShape(nRows, nCols);
+    }
     else {
       Dealloc();
       m_nRows = nRows;
       m_nCols = nCols;
       m_nSize = nRows * nCols;
-      Alloc();
+      Alloc(0, bZero);
     }
   }
 };
@@ -1,6 +1,8 @@
 #ifndef MAFS_MATRIX_DATA_TYPES_H
 #define MAFS_MATRIX_DATA_TYPES_H
 
+#include <stddef.h>
+
 namespace Mafs {
 /**
  * @brief Enum MtxOpMode
@@ -15,7 +17,7 @@ enum MtxOperationMode {
 
 /**
  * @brief Matrix options bitmask.
- * Use as follow: int Options = MtxColMajor
+ * Use as follow: int Options = MtxColMajor | MtxSharedStorage
  *
  * The default value is:
  * MtxDefaultOptions = MtxRowMajor
@@ -24,6 +26,9 @@ enum MtxOptions {
   // Matrix storage type, use only one
   MtxRowMajor = 0, // Stores the matrix as row major.
   MtxColMajor = 1, // Stores the matrix as col major.
+  // Copies share the values until one of them is modified (copy on write, dynamic matrices only).
+  // References and pointers from non const accesses must not be kept across a copy.
+  MtxSharedStorage = 2,
   // Default options for the Matrix (RowMajor).
   MtxDefaultOptions = (0 | MtxRowMajor),
 };
@@ -32,6 +37,127 @@ enum MtxType {
   MtxDynamic = 0 // Use this on Row_/Col_ template parameter to make the matrix dynamic
 };
 
+/**
+ * @brief Operand transformation of the general Multiplication: op(X) = X or X^T.
+ */
+enum MtxTransposeOp {
+  MtxNoTrans = 0, // op(X) = X
+  MtxTrans = 1    // op(X) = X^T
+};
+
+/**
+ * @brief Bias added by a Multiplication epilogue.
+ */
+enum MtxBiasMode {
+  MtxNoBias = 0,  // No bias.
+  MtxRowBias = 1, // C[i][j] += Bias[i], one value per row of C.
+  MtxColBias = 2  // C[i][j] += Bias[j], one value per col of C.
+};
+
+/**
+ * @brief Element-wise function that leaves the values unchanged (default epilogue function).
+ */
+struct MtxIdentity {
+  template <typename T> constexpr auto operator()(const T &Value) const -> T { return Value; }
+};
+
+/**
+ * @brief Work fused into the general Multiplication, applied to each block of C right after it
+ * is computed: C[i][j] = Function(C[i][j] + bias).
+ *
+ * Usage:
+ * Mafs::MtxEpilogue<double> AddBias{Mafs::MtxColBias, Bias.data()};
+ * Mafs::MtxEpilogue Relu{Mafs::MtxColBias, Bias.data(), [](double x) { return x > 0 ? x : 0; }};
+ *
+ * @tparam T matrix type.
+ * @tparam Func T(T) callable.
+ */
+template <typename T, typename Func = MtxIdentity> struct MtxEpilogue {
+  MtxBiasMode eBias = MtxNoBias;
+  const T *pBias = nullptr; // RowCount (MtxRowBias) or ColCount (MtxColBias) values.
+  Func Function = Func();
+};
+
+template <typename T> MtxEpilogue(MtxBiasMode, const T *) -> MtxEpilogue<T>;
+template <typename T, typename Func>
+MtxEpilogue(MtxBiasMode, const T *, Func) -> MtxEpilogue<T, Func>;
+
+/**
+ * @brief Summation algorithm of the reductions.
+ */
+enum MtxSummation {
+  MtxSumFast = 0,     // Several independent accumulators (vectorizable), error grows with n.
+  MtxSumPairwise = 1, // Recursive halves, error grows with log(n), same cost.
+  MtxSumKahan = 2     // Compensated summation, error independent of n, ~4x slower.
+};
+
+/**
+ * @brief Reduction applied to each row/col by MatrixBase::RowReduce/ColReduce.
+ */
+enum MtxReduction {
+  MtxReduceSum = 0,    // Sum of the values.
+  MtxReduceMean = 1,   // Mean of the values.
+  MtxReduceMin = 2,    // Minimum value.
+  MtxReduceMax = 3,    // Maximum value.
+  MtxReduceAbsSum = 4, // Sum of the absolute values (1-norm).
+  MtxReduceNorm = 5    // Square root of the sum of squares (2-norm).
+};
+
+/**
+ * @brief Part of the eigendecomposition computed by MatrixOperations::SymmetricEigen.
+ */
+enum MtxEigenJob {
+  MtxEigenValues = 0, // Eigenvalues only.
+  MtxEigenVectors = 1 // Eigenvalues and eigenvectors.
+};
+
+/**
+ * @brief Part of the singular value decomposition computed by MatrixOperations::Svd.
+ */
+enum MtxSvdJob {
+  MtxSvdValues = 0, // Singular values only.
+  MtxSvdVectors = 1 // Singular values and vectors.
+};
+
+/**
+ * @brief Report filled by the iterative refinement solvers.
+ * @see MatrixOperations::MixedPrecisionSolve
+ */
+struct MtxSolverInfo {
+  size_t nIterations = 0;  // Refinement steps performed (worst right hand side).
+  bool bConverged = false; // True if the low precision factorization reached full accuracy.
+  bool bFallback = false;  // True if a full precision factorization had to be used.
+};
+
+/**
+ * @brief Geometry of the 2D convolutions and correlations: the image is surrounded by nPaddingRow
+ * rows and nPaddingCol cols of zeros on each side, and the filter moves by nStrideRow rows and
+ * nStrideCol cols between output values.
+ * @see MatrixOperations::Correlation
+ */
+struct MtxConvolution {
+  size_t nStrideRow = 1;
+  size_t nStrideCol = 1;
+  size_t nPaddingRow = 0;
+  size_t nPaddingCol = 0;
+};
+
+/**
+ * @brief Block sizes and thresholds of the blocked kernels.
+ * The defaults are overridden by the per host tuning cache.
+ * @see MatrixOperations::AutoTune
+ */
+struct MtxTuningParams {
+  size_t nGemmBlockM = 64;              // Rows of C computed per block.
+  size_t nGemmBlockN = 256;             // Cols of C computed per block.
+  size_t nGemmBlockK = 128;             // Inner dimension per block.
+  size_t nTransposeBlock = 32;          // Square block of the transposes.
+  size_t nLUBlock = 64;                 // Panel width of the blocked LU.
+  size_t nParallelThreshold = 10000000; // Minimum work (flops/elements) to split among threads.
+  size_t nThreads = 0;                  // Threads used above the threshold (0 = all cores).
+  size_t nConvDirectTaps = 64;          // Largest filter (entries) of the direct convolutions.
+};
+
 #ifndef MAFS_MATRIX_OPERATION_MODE
 #define MAFS_MATRIX_OPERATION_MODE MtxOpBasic
 #endif
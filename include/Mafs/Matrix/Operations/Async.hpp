@@ -0,0 +1,287 @@
+#ifndef MAFS_MATRIX_ASYNC_H
+#define MAFS_MATRIX_ASYNC_H
+
+#include <Mafs/Matrix/Operations/Kernels/Parallel.hpp>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#ifdef MAFS_ENABLE_THREADS
+#include <condition_variable>
+#include <thread>
+#endif
+
+/**
+ * Asynchronous execution of matrix operations.
+ *
+ * MatrixOperations::Async queues a function on a background executor and returns a MtxFuture of
+ * its result. A task may depend on other futures: it is only queued once they are all finished
+ * and it receives their results as arguments (void futures only order it), so a chain such as
+ * load -> multiply -> save -> load is written without blocking, and independent chains run at the
+ * same time on different workers.
+ *
+ * Without MAFS_ENABLE_THREADS the task runs immediately on the calling thread (its dependencies
+ * are always finished then) and the returned future is ready.
+ */
+namespace Mafs {
+namespace Internal {
+/**
+ * @brief A queued task and the tasks waiting for it.
+ */
+struct AsyncNode {
+  std::function<void()> Run;
+  std::atomic<size_t> nPending{1}; // Unfinished dependencies, +1 while the task is submitted.
+  std::mutex Mutex;
+  bool bDone = false;
+  std::vector<std::shared_ptr<AsyncNode>> Dependents;
+};
+}; // namespace Internal
+
+/**
+ * @brief Result of an asynchronous operation (a copyable std::shared_future that can be used as a
+ * dependency of other asynchronous operations).
+ *
+ * @tparam T
+ */
+template <typename T> class MtxFuture {
+protected:
+  std::shared_future<T> m_Future;
+  std::shared_ptr<Internal::AsyncNode> m_pNode; // Null if the value was ready from the start.
+
+public:
+  MtxFuture() = default;
+  MtxFuture(std::shared_future<T> Future, std::shared_ptr<Internal::AsyncNode> pNode)
+      : m_Future(std::move(Future)), m_pNode(std::move(pNode)) {}
+
+  /**
+   * @brief Blocks until the operation finished and returns its result (rethrows its exception).
+   *
+   * @return const T& (void for MtxFuture<void>)
+   */
+  inline decltype(auto) Get() const { return m_Future.get(); }
+
+  /**
+   * @brief Blocks until the operation finished.
+   */
+  inline void Wait() const { m_Future.wait(); }
+
+  /**
+   * @brief Returns true if the operation finished (successfully or not).
+   *
+   * @return bool
+   */
+  inline bool IsReady() const {
+    return m_Future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+  }
+
+  /**
+   * @brief Returns false for a default constructed future.
+   *
+   * @return bool
+   */
+  inline bool IsValid() const { return m_Future.valid(); }
+
+  /**
+   * @brief Executor task producing the value (null for MakeReadyFuture).
+   */
+  inline auto Node() const -> const std::shared_ptr<Internal::AsyncNode> & { return m_pNode; }
+};
+
+/**
+ * @brief Wraps an existing value into a ready future, e.g. to use it as a dependency.
+ *
+ * @param Value
+ * @return MtxFuture<T>
+ */
+template <typename T> auto MakeReadyFuture(T Value) -> MtxFuture<T> {
+  std::promise<T> Promise;
+  Promise.set_value(std::move(Value));
+  return MtxFuture<T>(Promise.get_future().share(), nullptr);
+}
+
+namespace Internal {
+/**
+ * @brief Arguments a finished dependency passes to its dependent task: a reference to its value,
+ * or nothing for MtxFuture<void> (order only). Rethrows the exception of a failed dependency.
+ *
+ * @param Future
+ * @return std::tuple<const T &> (std::tuple<> for void)
+ */
+template <typename T> auto DependencyArgs(const MtxFuture<T> &Future) {
+  if constexpr (std::is_void_v<T>) {
+    Future.Get();
+    return std::tuple<>();
+  } else
+    return std::tuple<const T &>(Future.Get());
+}
+
+/**
+ * @brief Pool of background workers running the tasks whose dependencies are finished, in
+ * submission order. The kernels called by a task run on its worker only (ThreadLimit of 1), so
+ * concurrent tasks keep to one thread per core.
+ */
+class Executor {
+protected:
+#ifdef MAFS_ENABLE_THREADS
+  std::mutex m_Mutex;
+  std::condition_variable m_Condition;
+  std::deque<std::shared_ptr<AsyncNode>> m_Queue;
+  std::vector<std::thread> m_Workers;
+  bool m_bStop = false;
+
+  explicit Executor(size_t nThreads) {
+    for (size_t i = 0; i < nThreads; ++i)
+      m_Workers.emplace_back([this]() { Work(); });
+  }
+
+  void Work() {
+    // The tasks already run concurrently, their kernels stay on the worker.
+    Kernels::ThreadLimit Limit(1);
+    while (true) {
+      std::shared_ptr<AsyncNode> pNode;
+      {
+        std::unique_lock<std::mutex> Lock(m_Mutex);
+        m_Condition.wait(Lock, [this]() { return m_bStop || !m_Queue.empty(); });
+        if (m_Queue.empty())
+          return;
+        pNode = std::move(m_Queue.front());
+        m_Queue.pop_front();
+      }
+      pNode->Run();
+      Finish(pNode);
+    }
+  }
+
+  void Enqueue(std::shared_ptr<AsyncNode> pNode) {
+    {
+      std::lock_guard<std::mutex> Lock(m_Mutex);
+      m_Queue.push_back(std::move(pNode));
+    }
+    m_Condition.notify_one();
+  }
+#else
+  explicit Executor(size_t) {}
+
+  void Enqueue(std::shared_ptr<AsyncNode> pNode) {
+    pNode->Run();
+    Finish(pNode);
+  }
+#endif
+
+  /**
+   * @brief Marks pNode as done and queues the dependents that were only waiting for it.
+   *
+   * @param pNode
+   */
+  void Finish(const std::shared_ptr<AsyncNode> &pNode) {
+    std::vector<std::shared_ptr<AsyncNode>> Dependents;
+    {
+      std::lock_guard<std::mutex> Lock(pNode->Mutex);
+      pNode->bDone = true;
+      Dependents.swap(pNode->Dependents);
+    }
+    pNode->Run = nullptr; // Releases the dependency futures (and their values) held by the task.
+    for (auto &pDependent : Dependents)
+      if (--pDependent->nPending == 0)
+        Enqueue(std::move(pDependent));
+  }
+
+  /**
+   * @brief Registers pNode as a dependent of pDependency if it is not finished yet.
+   *
+   * @param pNode
+   * @param pDependency may be null (ready value).
+   */
+  static void AddDependency(const std::shared_ptr<AsyncNode> &pNode,
+                            const std::shared_ptr<AsyncNode> &pDependency) {
+    if (pDependency == nullptr)
+      return;
+    std::lock_guard<std::mutex> Lock(pDependency->Mutex);
+    if (pDependency->bDone)
+      return;
+    pNode->nPending++;
+    pDependency->Dependents.push_back(pNode);
+  }
+
+public:
+  Executor(const Executor &) = delete;
+  Executor &operator=(const Executor &) = delete;
+
+  ~Executor() {
+#ifdef MAFS_ENABLE_THREADS
+    // The queued tasks are still run, tasks waiting for dependencies are as well once those end.
+    {
+      std::lock_guard<std::mutex> Lock(m_Mutex);
+      m_bStop = true;
+    }
+    m_Condition.notify_all();
+    for (auto &Worker : m_Workers)
+      Worker.join();
+#endif
+  }
+
+  /**
+   * @brief Process wide executor, one worker per core.
+   *
+   * @return Executor&
+   */
+  static auto Instance() -> Executor & {
+    static Executor Exec(Kernels::ThreadCount(0));
+    return Exec;
+  }
+
+  /**
+   * @brief Number of background workers (0 without MAFS_ENABLE_THREADS).
+   *
+   * @return size_t
+   */
+  inline auto WorkerCount() const -> size_t {
+#ifdef MAFS_ENABLE_THREADS
+    return m_Workers.size();
+#else
+    return 0;
+#endif
+  }
+
+  /**
+   * @brief Queues Function(Dependencies.Get()...) to run once every dependency finished.
+   * MtxFuture<void> dependencies only order the tasks and pass no argument. If a dependency
+   * failed, Function is not called and the returned future holds its exception.
+   *
+   * Function must not wait for a future that isn't among its dependencies: it would hold a worker,
+   * and once every worker waits for tasks still in the queue the executor deadlocks.
+   *
+   * @param Function
+   * @param Dependencies
+   * @return MtxFuture<R> R = result of Function.
+   */
+  template <typename Func, typename... Deps>
+  auto Submit(Func &&Function, const MtxFuture<Deps> &...Dependencies) {
+    typedef decltype(std::apply(std::declval<Func &>(),
+                                std::tuple_cat(DependencyArgs(Dependencies)...))) Result;
+
+    auto pTask = std::make_shared<std::packaged_task<Result()>>(
+        [Function = std::forward<Func>(Function), Dependencies...]() mutable -> Result {
+          return std::apply(Function, std::tuple_cat(DependencyArgs(Dependencies)...));
+        });
+    auto pNode = std::make_shared<AsyncNode>();
+    pNode->Run = [pTask]() { (*pTask)(); };
+    MtxFuture<Result> Future(pTask->get_future().share(), pNode);
+
+    (AddDependency(pNode, Dependencies.Node()), ...);
+    if (--pNode->nPending == 0)
+      Enqueue(pNode);
+    return Future;
+  }
+};
+}; // namespace Internal
+}; // namespace Mafs
+
+#endif // MAFS_MATRIX_ASYNC_H
@@ -2,8 +2,76 @@
 #define MAFS_MATRIX_BASE_OPERATIONS_H
 
 #include <Mafs/Matrix/MatrixBase.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace Mafs {
+template <typename T, size_t Rows_, size_t Cols_, size_t Options_> class Matrix;
+};
 
 namespace Mafs::Internal {
+/**
+ * @brief Type of lMatrix * rMatrix: lMatrix type and storage, lMatrix rows and rMatrix cols.
+ */
+template <typename Derived, typename OtherDerived>
+using MultiplicationResult =
+    Matrix<typename MatrixTraits<Derived>::Type, MatrixTraits<Derived>::Rows,
+           MatrixTraits<OtherDerived>::Cols, MatrixTraits<Derived>::Options>;
+
+/**
+ * @brief Type of Matrix^T: Matrix type and storage with rows and cols swapped.
+ */
+template <typename Derived>
+using TransposeResult = Matrix<typename MatrixTraits<Derived>::Type, MatrixTraits<Derived>::Cols,
+                               MatrixTraits<Derived>::Rows, MatrixTraits<Derived>::Options>;
+
+/**
+ * @brief Type of the concatenations: dynamic matrix of lMatrix type and storage.
+ */
+template <typename Derived>
+using ConcatResult = Matrix<typename MatrixTraits<Derived>::Type, MtxDynamic, MtxDynamic,
+                            MatrixTraits<Derived>::Options>;
+
+/**
+ * @brief Type of the Gram matrices: dynamic square matrix of Matrix type and storage.
+ */
+template <typename Derived>
+using GramResult = Matrix<typename MatrixTraits<Derived>::Type, MtxDynamic, MtxDynamic,
+                          MatrixTraits<Derived>::Options>;
+
+/**
+ * @brief Type of the convolutions and correlations: dynamic matrix of Image type and storage.
+ */
+template <typename Derived>
+using ConvolutionResult = Matrix<typename MatrixTraits<Derived>::Type, MtxDynamic, MtxDynamic,
+                                 MatrixTraits<Derived>::Options>;
+
+/**
+ * @brief Eigenpairs of a symmetric matrix, largest eigenvalue first.
+ * Col j of Vectors is the unit eigenvector of Values[j], Vectors is empty if only the eigenvalues
+ * were computed.
+ */
+template <typename Derived> struct SymmetricEigenResult {
+  std::vector<typename MatrixTraits<Derived>::Type> Values;
+  Matrix<typename MatrixTraits<Derived>::Type, MtxDynamic, MtxDynamic,
+         MatrixTraits<Derived>::Options>
+      Vectors;
+};
+
+/**
+ * @brief Thin singular value decomposition Matrix = U * diag(Values) * V^T, largest singular
+ * value first. Col j of U (of V) is the left (right) singular vector of Values[j], U and V are
+ * empty if only the singular values were computed.
+ */
+template <typename Derived> struct SvdResult {
+  std::vector<typename MatrixTraits<Derived>::Type> Values;
+  Matrix<typename MatrixTraits<Derived>::Type, MtxDynamic, MtxDynamic,
+         MatrixTraits<Derived>::Options>
+      U;
+  Matrix<typename MatrixTraits<Derived>::Type, MtxDynamic, MtxDynamic,
+         MatrixTraits<Derived>::Options>
+      V;
+};
 
 /**
  * @brief "Base" class for the operations.
@@ -27,9 +95,104 @@ public:
   auto InplaceSubtraction(MatrixBase<Derived> &lMatrix, const MatrixBase<OtherDerived> &rMatrix)
       -> void;
 
+  /**
+   * @brief Matrix product lMatrix * rMatrix, lMatrix ColCount must match rMatrix RowCount.
+   */
   template <typename Derived, typename OtherDerived>
   auto Multiplication(const MatrixBase<Derived> &lMatrix, const MatrixBase<OtherDerived> &rMatrix)
-      -> Derived;
+      -> MultiplicationResult<Derived, OtherDerived>;
+
+  /**
+   * @brief General product Result = Function(Alpha * op(lMatrix) * op(rMatrix) + Beta * Result +
+   * bias), where op(X) is X or X^T (eOpL/eOpR).
+   * The scaling, bias and element-wise function are fused into the product (see MtxEpilogue), so
+   * Result is written once. Result must already be op(lMatrix).RowCount x op(rMatrix).ColCount and
+   * may be one of the operands.
+   */
+  template <typename Derived, typename OtherDerived, typename ResultDerived, typename Func>
+  void Multiplication(const MatrixBase<Derived> &lMatrix, MtxTransposeOp eOpL,
+                      const MatrixBase<OtherDerived> &rMatrix, MtxTransposeOp eOpR,
+                      MatrixBase<ResultDerived> &Result, typename MatrixTraits<Derived>::Type Alpha,
+                      typename MatrixTraits<Derived>::Type Beta,
+                      const MtxEpilogue<typename MatrixTraits<Derived>::Type, Func> &Epilogue);
+
+  /**
+   * @brief Gram matrix op(Matrix) * op(Matrix)^T: Matrix^T * Matrix (MtxTrans, ColCount x
+   * ColCount) or Matrix * Matrix^T (MtxNoTrans, RowCount x RowCount). Only one triangle is
+   * computed and then mirrored, half the flops of Multiplication.
+   */
+  template <typename Derived>
+  auto Gram(const MatrixBase<Derived> &Matrix, MtxTransposeOp eOp) -> GramResult<Derived>;
+
+  /**
+   * @brief Symmetric rank k update Result = Alpha * op(Matrix) * op(Matrix)^T + Beta * Result.
+   * Result must already be square of the size of op(Matrix) rows, any storage order; with Beta
+   * != 0 it must be symmetric and only its lower triangle is read. Matrix is read in place,
+   * whatever its storage order and eOp.
+   */
+  template <typename Derived, typename ResultDerived>
+  void Gram(const MatrixBase<Derived> &Matrix, MtxTransposeOp eOp,
+            MatrixBase<ResultDerived> &Result, typename MatrixTraits<Derived>::Type Alpha,
+            typename MatrixTraits<Derived>::Type Beta);
+
+  /**
+   * @brief Matrix^nExponent of the square Matrix (identity for 0), by binary exponentiation:
+   * about 2 log2(nExponent) products.
+   */
+  template <typename Derived>
+  auto Power(const MatrixBase<Derived> &Matrix, uint64_t nExponent) -> Derived;
+
+  /**
+   * @brief Result = Matrix^nExponent. Result must already be square of the size of Matrix, any
+   * storage order, and may be Matrix. The intermediate products ping-pong between Result and a
+   * scratch buffer, so a call in a loop allocates nothing.
+   */
+  template <typename Derived, typename ResultDerived>
+  void Power(const MatrixBase<Derived> &Matrix, uint64_t nExponent,
+             MatrixBase<ResultDerived> &Result);
+
+  /**
+   * @brief Matrix exponential exp(Matrix) of the square Matrix (not the element-wise MtxExp), by
+   * scaling and squaring with Pade approximants: about 6 to 8 products, plus one per doubling of
+   * the norm past 5.4, and one LU solve.
+   */
+  template <typename Derived> auto Exp(const MatrixBase<Derived> &Matrix) -> Derived;
+
+  /**
+   * @brief Result = exp(Matrix), same requirements and buffer reuse as Power into Result.
+   */
+  template <typename Derived, typename ResultDerived>
+  void Exp(const MatrixBase<Derived> &Matrix, MatrixBase<ResultDerived> &Result);
+
+  /**
+   * @brief 2D cross-correlation Result[i][j] = sum_u,v Filter[u][v] * Image[i * nStrideRow +
+   * u][j * nStrideCol + v] of the zero padded Image (see MtxConvolution), Result is
+   * ((Image.RowCount() + 2 nPaddingRow - Filter.RowCount()) / nStrideRow + 1) x (same for the
+   * cols). Filters of up to nConvDirectTaps entries (tuning) are applied by a direct vectorized
+   * kernel, larger ones as a product of the unrolled patches (im2col) by the filter.
+   */
+  template <typename Derived, typename FilterDerived>
+  auto Correlation(const MatrixBase<Derived> &Image, const MatrixBase<FilterDerived> &Filter,
+                   const MtxConvolution &Options) -> ConvolutionResult<Derived>;
+
+  /**
+   * @brief Correlation of Image with each filter of a bank (all of the same size), Image is
+   * unrolled once for all of them.
+   */
+  template <typename Derived, typename FilterDerived>
+  auto Correlation(const MatrixBase<Derived> &Image, const std::vector<FilterDerived> &Filters,
+                   const MtxConvolution &Options) -> std::vector<ConvolutionResult<Derived>>;
+
+  /**
+   * @brief 2D convolution: Correlation with the filter rotated by 180 degrees.
+   */
+  template <typename Derived, typename FilterDerived>
+  auto Convolution(const MatrixBase<Derived> &Image, const MatrixBase<FilterDerived> &Filter,
+                   const MtxConvolution &Options) -> ConvolutionResult<Derived>;
+
+  template <typename Derived, typename FilterDerived>
+  auto Convolution(const MatrixBase<Derived> &Image, const std::vector<FilterDerived> &Filters,
+                   const MtxConvolution &Options) -> std::vector<ConvolutionResult<Derived>>;
 
   template <typename Derived, typename OtherDerived>
   auto InplaceMultiplication(MatrixBase<Derived> &lMatrix, const MatrixBase<OtherDerived> &rMatrix)
@@ -41,7 +204,25 @@ public:
   template <typename Derived, typename ScalarType>
   auto InplaceScalarMultiplication(MatrixBase<Derived> &Matrix, const ScalarType &Scalar) -> void;
 
-  template <typename Derived> auto Transpose(const MatrixBase<Derived> &Matrix) -> Derived;
+  /**
+   * @brief Returns [lMatrix rMatrix] (same RowCount, any storage orders).
+   */
+  template <typename Derived, typename OtherDerived>
+  auto HorizontalConcat(const MatrixBase<Derived> &lMatrix, const MatrixBase<OtherDerived> &rMatrix)
+      -> ConcatResult<Derived>;
+
+  /**
+   * @brief Returns [lMatrix; rMatrix], lMatrix above rMatrix (same ColCount, any storage orders).
+   */
+  template <typename Derived, typename OtherDerived>
+  auto VerticalConcat(const MatrixBase<Derived> &lMatrix, const MatrixBase<OtherDerived> &rMatrix)
+      -> ConcatResult<Derived>;
+
+  /**
+   * @brief Returns Matrix^T.
+   */
+  template <typename Derived>
+  auto Transpose(const MatrixBase<Derived> &Matrix) -> TransposeResult<Derived>;
 
   template <typename Derived> auto InplaceTranspose(MatrixBase<Derived> &Matrix) -> void;
 
@@ -53,6 +234,56 @@ public:
 
   template <typename Derived, typename ScalarType>
   auto InplaceScalarDivision(MatrixBase<Derived> &Matrix, const ScalarType &Scalar) -> void;
+
+  /**
+   * @brief Solves lMatrix * X = rMatrix using a LU decomposition with partial pivoting.
+   * lMatrix must be square, rMatrix holds one right hand side per column.
+   */
+  template <typename Derived, typename OtherDerived>
+  auto Solve(const MatrixBase<Derived> &lMatrix, const MatrixBase<OtherDerived> &rMatrix)
+      -> OtherDerived;
+
+  /**
+   * @brief Same as Solve, but factorizes lMatrix in single precision and refines the solution
+   * with residuals computed in the matrix precision. Falls back to a full precision
+   * factorization if the refinement does not converge.
+   */
+  template <typename Derived, typename OtherDerived>
+  auto MixedPrecisionSolve(const MatrixBase<Derived> &lMatrix,
+                           const MatrixBase<OtherDerived> &rMatrix, MtxSolverInfo *pInfo)
+      -> OtherDerived;
+
+  /**
+   * @brief Eigenvalues and, for eJob = MtxEigenVectors, eigenvectors of the symmetric Matrix (only
+   * its lower triangle is read), largest first. nCount > 0 keeps only the nCount largest pairs,
+   * which is cheaper than computing all of them.
+   * Matrix is reduced to a tridiagonal by blocked Householder reflectors, whose eigenpairs are
+   * found by divide and conquer (all pairs), QL iterations (eigenvalues only) or bisection and
+   * inverse iteration (nCount pairs).
+   */
+  template <typename Derived>
+  auto SymmetricEigen(const MatrixBase<Derived> &Matrix, MtxEigenJob eJob, size_t nCount)
+      -> SymmetricEigenResult<Derived>;
+
+  /**
+   * @brief Thin SVD of Matrix (m x n): min(m, n) singular values and, for eJob = MtxSvdVectors,
+   * the m x min(m, n) U and n x min(m, n) V.
+   * Matrix is reduced to a bidiagonal by blocked Householder reflectors, whose SVD is found by
+   * implicit shifted QR sweeps.
+   */
+  template <typename Derived>
+  auto Svd(const MatrixBase<Derived> &Matrix, MtxSvdJob eJob) -> SvdResult<Derived>;
+
+  /**
+   * @brief Approximate nRank largest singular triplets of Matrix (randomized range finder, Halko,
+   * Martinsson and Tropp): the range of Matrix is sampled by Matrix * Omega, Omega a Gaussian
+   * n x (nRank + nOversampling) matrix drawn from nSeed, refined by nPowerIterations products by
+   * Matrix^T and Matrix, and Matrix is projected on it. Matrix is read 2 * nPowerIterations + 2
+   * times by GEMMs and never copied, so it fits matrices far larger than Svd.
+   */
+  template <typename Derived>
+  auto RandomizedSvd(const MatrixBase<Derived> &Matrix, size_t nRank, size_t nOversampling,
+                     size_t nPowerIterations, uint64_t nSeed) -> SvdResult<Derived>;
 };
 }; // namespace Mafs::Internal
 
@@ -2,9 +2,278 @@
 #define MAFS_MATRIX_BASIC_OPERATIONS_H
 
 #include <Mafs/Matrix/Operations/BaseOperations.hpp>
+#include <Mafs/Matrix/Operations/Kernels/Blas.hpp>
+#include <Mafs/Matrix/Operations/Kernels/Convolution.hpp>
+#include <Mafs/Matrix/Operations/Kernels/Eigen.hpp>
+#include <Mafs/Matrix/Operations/Kernels/Gemm.hpp>
+#include <Mafs/Matrix/Operations/Kernels/LU.hpp>
+#include <Mafs/Matrix/Operations/Kernels/MatrixFunctions.hpp>
+#include <Mafs/Matrix/Operations/Kernels/Svd.hpp>
+#include <Mafs/Matrix/Operations/Tuning.hpp>
+#include <Mafs/Utils/Workspace.hpp>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <type_traits>
+#include <vector>
 
 namespace Mafs::Internal {
 class BasicMatrixOperations : BaseMatrixOperations {
+protected:
+  // Maximum number of refinement steps before MixedPrecisionSolve falls back (same as LAPACK).
+  static constexpr size_t m_nMaxRefinementIterations = 30;
+  // Largest static square matrices whose powers and exponential use unrolled products.
+  static constexpr size_t m_nSmallStaticSize = 8;
+
+  /**
+   * @brief Throws if lMatrix is not square or if rMatrix row count doesn't match it.
+   *
+   * @param lMatrix
+   * @param rMatrix
+   */
+  template <typename Derived, typename OtherDerived>
+  static void CheckSolveDims(const MatrixBase<Derived> &lMatrix,
+                             const MatrixBase<OtherDerived> &rMatrix) {
+    if (lMatrix.RowCount() != lMatrix.ColCount() || lMatrix.RowCount() != rMatrix.RowCount())
+      throw std::domain_error(fmt::format(
+          "lMatrix must be square and match rMatrix RowCount. lMatrix[{}][{}] / rMatrix[{}][{}]",
+          lMatrix.RowCount(), lMatrix.ColCount(), rMatrix.RowCount(), rMatrix.ColCount()));
+  }
+
+  /**
+   * @brief Copies Matrix into a row major scratch buffer of type T.
+   *
+   * @param Matrix
+   * @param Buffer resized to Matrix.Size().
+   */
+  template <typename T, typename Derived>
+  static void ToRowMajor(const MatrixBase<Derived> &Matrix, ScratchBuffer<T> &Buffer) {
+    Buffer.Resize(Matrix.Size());
+    Kernels::Copy(Matrix.RowCount(), Matrix.ColCount(), Matrix.Data(), Matrix.RowStride(),
+                  Matrix.ColStride(), Buffer.Data(), Matrix.ColCount(), 1);
+  }
+
+  /**
+   * @brief Builds the nRows x nCols result of an operation, sized if MatrixType is dynamic.
+   *
+   * @param nRows
+   * @param nCols
+   * @return MatrixType
+   */
+  template <typename MatrixType> static auto MakeResult(size_t nRows, size_t nCols) -> MatrixType {
+    if constexpr (AreEnumsEqual<MatrixTraits<MatrixType>::Rows, MtxDynamic>() ||
+                  AreEnumsEqual<MatrixTraits<MatrixType>::Cols, MtxDynamic>())
+      return MatrixType(nRows, nCols);
+    else
+      return MatrixType();
+  }
+
+  /**
+   * @brief Row major op(Matrix): Matrix data if it already is stored that way (and !bCopy), a
+   * copy in Buffer otherwise.
+   *
+   * @param Matrix
+   * @param eOp
+   * @param Buffer scratch storage of the copy.
+   * @param bCopy always copy (e.g. Matrix is also the output).
+   * @return const T*
+   */
+  template <typename T, typename Derived>
+  static auto RowMajorOperand(const MatrixBase<Derived> &Matrix, MtxTransposeOp eOp,
+                              ScratchBuffer<T> &Buffer, bool bCopy) -> const T * {
+    // The storage is a row major (nOuter x nInner) array: Matrix if row major, Matrix^T if not.
+    const size_t nOuter = Matrix.IsRowMajor() ? Matrix.RowCount() : Matrix.ColCount();
+    const size_t nInner = Matrix.IsRowMajor() ? Matrix.ColCount() : Matrix.RowCount();
+    if ((eOp == MtxNoTrans) == Matrix.IsRowMajor()) {
+      if (!bCopy)
+        return Matrix.Data();
+      Buffer.Assign(Matrix.Data(), Matrix.Size());
+    } else {
+      Buffer.Resize(Matrix.Size());
+      Kernels::TransposeBlocked(nOuter, nInner, Matrix.Data(), nInner, Buffer.Data(), nOuter,
+                                Tuning::Instance().Get());
+    }
+    return Buffer.Data();
+  }
+
+  /**
+   * @brief nRows x nCols matrix holding lMatrix at [0][0] and rMatrix at [nRow][nCol].
+   */
+  template <typename Derived, typename OtherDerived>
+  static auto Concat(const MatrixBase<Derived> &lMatrix, const MatrixBase<OtherDerived> &rMatrix,
+                     size_t nRows, size_t nCols, size_t nRow, size_t nCol)
+      -> ConcatResult<Derived> {
+    static_assert(std::is_same_v<typename MatrixTraits<Derived>::Type,
+                                 typename MatrixTraits<OtherDerived>::Type>,
+                  "Concatenation requires matrices of the same type");
+    ConcatResult<Derived> MatrixRtn(nRows, nCols);
+    auto *pData = MatrixRtn.Data();
+    Kernels::Copy(lMatrix.RowCount(), lMatrix.ColCount(), lMatrix.Data(), lMatrix.RowStride(),
+                  lMatrix.ColStride(), pData, MatrixRtn.RowStride(), MatrixRtn.ColStride());
+    Kernels::Copy(rMatrix.RowCount(), rMatrix.ColCount(), rMatrix.Data(), rMatrix.RowStride(),
+                  rMatrix.ColStride(),
+                  pData + nRow * MatrixRtn.RowStride() + nCol * MatrixRtn.ColStride(),
+                  MatrixRtn.RowStride(), MatrixRtn.ColStride());
+    return MatrixRtn;
+  }
+
+  /**
+   * @brief Returns true if the storages of lMatrix and rMatrix overlap.
+   *
+   * @param lMatrix
+   * @param rMatrix
+   * @return bool
+   */
+  template <typename Derived, typename OtherDerived>
+  static bool Overlaps(const MatrixBase<Derived> &lMatrix,
+                       const MatrixBase<OtherDerived> &rMatrix) {
+    const void *pLeft = lMatrix.Data(), *pRight = rMatrix.Data();
+    const void *pLeftEnd = lMatrix.Data() + lMatrix.Size();
+    const void *pRightEnd = rMatrix.Data() + rMatrix.Size();
+    return std::less<const void *>()(pLeft, pRightEnd) &&
+           std::less<const void *>()(pRight, pLeftEnd);
+  }
+
+  static constexpr auto Flip(MtxTransposeOp eOp) -> MtxTransposeOp {
+    return eOp == MtxNoTrans ? MtxTrans : MtxNoTrans;
+  }
+
+  static constexpr auto Flip(MtxBiasMode eBias) -> MtxBiasMode {
+    return eBias == MtxRowBias ? MtxColBias : eBias == MtxColBias ? MtxRowBias : MtxNoBias;
+  }
+
+  /**
+   * @brief Size of a static square Derived up to m_nSmallStaticSize, whose matrix functions run
+   * on stack buffers with unrolled products; 0 for the other matrices.
+   */
+  template <typename Derived> static constexpr auto SmallStaticSize() -> size_t {
+    constexpr size_t nRows = MatrixTraits<Derived>::Rows, nCols = MatrixTraits<Derived>::Cols;
+    return nRows == nCols && nRows <= m_nSmallStaticSize ? nRows : 0;
+  }
+
+  /**
+   * @brief Throws if Matrix is not square or if Result doesn't have its dimensions.
+   */
+  template <typename Derived, typename ResultDerived>
+  static void CheckSquareResult(const MatrixBase<Derived> &Matrix,
+                                const MatrixBase<ResultDerived> &Result) {
+    if (Matrix.RowCount() != Matrix.ColCount() || Result.RowCount() != Matrix.RowCount() ||
+        Result.ColCount() != Matrix.ColCount())
+      throw std::domain_error(
+          fmt::format("Matrix must be square and Result of the same size. Matrix[{}][{}] / "
+                      "Result[{}][{}]",
+                      Matrix.RowCount(), Matrix.ColCount(), Result.RowCount(), Result.ColCount()));
+  }
+
+  /**
+   * @brief Runs Function(nSize, pA, pOut, pWork) on the storage of Result: (A^T)^n = (A^n)^T and
+   * exp(A^T) = exp(A)^T, so a col major Result is computed as the function of the row major
+   * Matrix^T. Matrix is read in place when it is stored like Result and doesn't overlap it.
+   * pWork holds nWork values: stack storage for the small static matrices, scratch otherwise.
+   */
+  template <typename Derived, typename ResultDerived, typename Func>
+  static void SquareFunction(const MatrixBase<Derived> &Matrix, MatrixBase<ResultDerived> &Result,
+                             size_t nWork, Func Function) {
+    typedef typename MatrixTraits<Derived>::Type Type;
+    static_assert(std::is_same_v<Type, typename MatrixTraits<ResultDerived>::Type>,
+                  "Matrix functions require matrices of the same type");
+    CheckSquareResult(Matrix, Result);
+    if (Result.Size() == 0)
+      return;
+    Type *pOut = Result.Data();
+    ScratchBuffer<Type> Operand;
+    const Type *pA = RowMajorOperand(Matrix, Result.IsRowMajor() ? MtxNoTrans : MtxTrans, Operand,
+                                     Overlaps(Matrix, Result));
+    constexpr size_t nSmall = SmallStaticSize<Derived>();
+    if constexpr (nSmall != 0) {
+      std::array<Type, 5 * nSmall * nSmall> Work;
+      Function(Matrix.RowCount(), pA, pOut, Work.data());
+    } else {
+      ScratchBuffer<Type> Work(nWork);
+      Function(Matrix.RowCount(), pA, pOut, Work.Data());
+    }
+  }
+
+  /**
+   * @brief Correlations of Image with each filter, or convolutions (bFlip: the filters rotated by
+   * 180 degrees). The filters are packed row major and Image is padded into scratch buffers (a
+   * row major Image without padding is read in place), so the kernels only read contiguous rows.
+   */
+  template <typename Derived, typename FilterDerived>
+  static auto Filter2D(const MatrixBase<Derived> &Image,
+                       const std::vector<const MatrixBase<FilterDerived> *> &Filters,
+                       const MtxConvolution &Options, bool bFlip)
+      -> std::vector<ConvolutionResult<Derived>> {
+    typedef typename MatrixTraits<Derived>::Type Type;
+    static_assert(std::is_same_v<Type, typename MatrixTraits<FilterDerived>::Type>,
+                  "Convolution requires matrices of the same type");
+    if (Options.nStrideRow == 0 || Options.nStrideCol == 0)
+      throw std::invalid_argument("Convolution strides must be positive");
+    std::vector<ConvolutionResult<Derived>> Results;
+    if (Filters.empty())
+      return Results;
+    const size_t nFilterRows = Filters[0]->RowCount(), nFilterCols = Filters[0]->ColCount();
+    const size_t nRows = Image.RowCount() + 2 * Options.nPaddingRow;
+    const size_t nCols = Image.ColCount() + 2 * Options.nPaddingCol;
+    for (const MatrixBase<FilterDerived> *pFilter : Filters)
+      if (pFilter->RowCount() != nFilterRows || pFilter->ColCount() != nFilterCols ||
+          nFilterRows == 0 || nFilterCols == 0 || nFilterRows > nRows || nFilterCols > nCols)
+        throw std::domain_error(fmt::format(
+            "Filters must have the same non zero size, at most the padded Image. Filter[{}][{}] "
+            "/ Filter[{}][{}] / padded Image[{}][{}]",
+            nFilterRows, nFilterCols, pFilter->RowCount(), pFilter->ColCount(), nRows, nCols));
+    const size_t nOutRows = (nRows - nFilterRows) / Options.nStrideRow + 1;
+    const size_t nOutCols = (nCols - nFilterCols) / Options.nStrideCol + 1;
+    const size_t nTaps = nFilterRows * nFilterCols, nPlane = nOutRows * nOutCols;
+
+    ScratchBuffer<Type> Packed(Filters.size() * nTaps);
+    for (size_t f = 0; f < Filters.size(); ++f) {
+      const MatrixBase<FilterDerived> &Filter = *Filters[f];
+      Type *pPacked = Packed.Data() + f * nTaps;
+      Kernels::Copy(nFilterRows, nFilterCols, Filter.Data(), Filter.RowStride(),
+                    Filter.ColStride(), pPacked, nFilterCols, 1);
+      if (bFlip)
+        std::reverse(pPacked, pPacked + nTaps);
+    }
+    const MtxTuningParams &Params = Tuning::Instance().Get();
+    ScratchBuffer<Type> Padded;
+    const Type *pPadded = nullptr;
+    if (Options.nPaddingRow == 0 && Options.nPaddingCol == 0) {
+      pPadded = RowMajorOperand(Image, MtxNoTrans, Padded, false);
+    } else {
+      Padded.Resize(nRows * nCols);
+      Kernels::PadImage(Image.RowCount(), Image.ColCount(), Image.Data(), Image.RowStride(),
+                        Image.ColStride(), Options.nPaddingRow, Options.nPaddingCol,
+                        Padded.Data(), Params);
+      pPadded = Padded.Data();
+    }
+
+    // A single row major result is written in place, the others are copied from the planes.
+    Results.reserve(Filters.size());
+    for (size_t f = 0; f < Filters.size(); ++f)
+      Results.emplace_back(nOutRows, nOutCols);
+    const bool bInPlace = Results.size() == 1 && Results[0].IsRowMajor();
+    ScratchBuffer<Type> Planes;
+    if (!bInPlace)
+      Planes.Resize(Results.size() * nPlane);
+    Type *pOut = bInPlace ? Results[0].Data() : Planes.Data();
+    Kernels::Correlation(pPadded, nCols, Filters.size(), nFilterRows, nFilterCols, Packed.Data(),
+                         nOutRows, nOutCols, Options, pOut, Params);
+    if (!bInPlace)
+      for (size_t f = 0; f < Results.size(); ++f) {
+        if (Results[f].IsRowMajor())
+          std::copy(pOut + f * nPlane, pOut + (f + 1) * nPlane, Results[f].Data());
+        else
+          Kernels::TransposeBlocked(nOutRows, nOutCols, pOut + f * nPlane, nOutCols,
+                                    Results[f].Data(), nOutRows, Params);
+      }
+    return Results;
+  }
+
 public:
   BasicMatrixOperations() = default;
 
@@ -24,6 +293,553 @@ public:
 
     return MatrixRtn;
   }
+
+  template <typename Derived, typename OtherDerived>
+  auto Multiplication(const MatrixBase<Derived> &lMatrix, const MatrixBase<OtherDerived> &rMatrix)
+      -> MultiplicationResult<Derived, OtherDerived> {
+    if (lMatrix.ColCount() != rMatrix.RowCount())
+      throw std::domain_error(fmt::format(
+          "lMatrix ColCount must match rMatrix RowCount. lMatrix[{}][{}] / rMatrix[{}][{}]",
+          lMatrix.RowCount(), lMatrix.ColCount(), rMatrix.RowCount(), rMatrix.ColCount()));
+
+    auto MatrixRtn = MakeResult<MultiplicationResult<Derived, OtherDerived>>(lMatrix.RowCount(),
+                                                                              rMatrix.ColCount());
+    Multiplication(lMatrix, MtxNoTrans, rMatrix, MtxNoTrans, MatrixRtn, 1, 0,
+                   MtxEpilogue<typename MatrixTraits<Derived>::Type>());
+    return MatrixRtn;
+  }
+
+  template <typename Derived, typename OtherDerived, typename ResultDerived, typename Func>
+  void Multiplication(const MatrixBase<Derived> &lMatrix, MtxTransposeOp eOpL,
+                      const MatrixBase<OtherDerived> &rMatrix, MtxTransposeOp eOpR,
+                      MatrixBase<ResultDerived> &Result, typename MatrixTraits<Derived>::Type Alpha,
+                      typename MatrixTraits<Derived>::Type Beta,
+                      const MtxEpilogue<typename MatrixTraits<Derived>::Type, Func> &Epilogue) {
+    typedef typename MatrixTraits<Derived>::Type Type;
+    static_assert(std::is_same_v<Type, typename MatrixTraits<OtherDerived>::Type> &&
+                      std::is_same_v<Type, typename MatrixTraits<ResultDerived>::Type>,
+                  "Multiplication requires matrices of the same type");
+    const size_t nM = eOpL == MtxNoTrans ? lMatrix.RowCount() : lMatrix.ColCount();
+    const size_t nK = eOpL == MtxNoTrans ? lMatrix.ColCount() : lMatrix.RowCount();
+    const size_t nRightK = eOpR == MtxNoTrans ? rMatrix.RowCount() : rMatrix.ColCount();
+    const size_t nN = eOpR == MtxNoTrans ? rMatrix.ColCount() : rMatrix.RowCount();
+    if (nK != nRightK || Result.RowCount() != nM || Result.ColCount() != nN)
+      throw std::domain_error(fmt::format(
+          "op(lMatrix) ColCount must match op(rMatrix) RowCount and Result must be their product. "
+          "op(lMatrix)[{}][{}] / op(rMatrix)[{}][{}] / Result[{}][{}]",
+          nM, nK, nRightK, nN, Result.RowCount(), Result.ColCount()));
+    if (Epilogue.eBias != MtxNoBias && Epilogue.pBias == nullptr)
+      throw std::invalid_argument("Epilogue bias values are missing");
+    if (Result.Size() == 0)
+      return;
+
+    // The kernel works on row major operands. A col major Result stores C^T, so it is computed as
+    // op(rMatrix)^T * op(lMatrix)^T; operands stored in the wrong order or overlapping Result are
+    // copied first. Result.Data() comes first so Result stops sharing its values (see
+    // MtxSharedStorage) before the overlaps are checked.
+    Type *pC = Result.Data();
+    ScratchBuffer<Type> BufferA, BufferB;
+    const bool bOverlapL = Overlaps(lMatrix, Result), bOverlapR = Overlaps(rMatrix, Result);
+    if (Result.IsRowMajor()) {
+      const Type *pA = RowMajorOperand(lMatrix, eOpL, BufferA, bOverlapL);
+      const Type *pB = RowMajorOperand(rMatrix, eOpR, BufferB, bOverlapR);
+      Kernels::GemmFused(nM, nN, nK, Alpha, pA, nK, pB, nN, Beta, pC, nN, Epilogue,
+                         Tuning::Instance().Get());
+    } else {
+      const Type *pA = RowMajorOperand(rMatrix, Flip(eOpR), BufferA, bOverlapR);
+      const Type *pB = RowMajorOperand(lMatrix, Flip(eOpL), BufferB, bOverlapL);
+      const MtxEpilogue<Type, Func> Transposed{Flip(Epilogue.eBias), Epilogue.pBias,
+                                               Epilogue.Function};
+      Kernels::GemmFused(nN, nM, nK, Alpha, pA, nK, pB, nM, Beta, pC, nM, Transposed,
+                         Tuning::Instance().Get());
+    }
+  }
+
+  template <typename Derived>
+  auto Gram(const MatrixBase<Derived> &Matrix, MtxTransposeOp eOp) -> GramResult<Derived> {
+    const size_t nN = eOp == MtxNoTrans ? Matrix.RowCount() : Matrix.ColCount();
+    GramResult<Derived> MatrixRtn(nN, nN);
+    Gram(Matrix, eOp, MatrixRtn, 1, 0);
+    return MatrixRtn;
+  }
+
+  template <typename Derived, typename ResultDerived>
+  void Gram(const MatrixBase<Derived> &Matrix, MtxTransposeOp eOp,
+            MatrixBase<ResultDerived> &Result, typename MatrixTraits<Derived>::Type Alpha,
+            typename MatrixTraits<Derived>::Type Beta) {
+    typedef typename MatrixTraits<Derived>::Type Type;
+    static_assert(std::is_same_v<Type, typename MatrixTraits<ResultDerived>::Type>,
+                  "Gram requires matrices of the same type");
+    const size_t nN = eOp == MtxNoTrans ? Matrix.RowCount() : Matrix.ColCount();
+    const size_t nK = eOp == MtxNoTrans ? Matrix.ColCount() : Matrix.RowCount();
+    if (Result.RowCount() != nN || Result.ColCount() != nN)
+      throw std::domain_error(
+          fmt::format("Result must be op(Matrix) * op(Matrix)^T. op(Matrix)[{}][{}] / "
+                      "Result[{}][{}]",
+                      nN, nK, Result.RowCount(), Result.ColCount()));
+    if (nN == 0)
+      return;
+
+    // op(Matrix) is read through its strides, so neither the storage order nor eOp costs a copy
+    // (unless Matrix overlaps Result). Result is symmetric: its storage order doesn't matter.
+    Type *pC = Result.Data();
+    const Type *pA = Matrix.Data();
+    size_t nRowStride = eOp == MtxNoTrans ? Matrix.RowStride() : Matrix.ColStride();
+    size_t nColStride = eOp == MtxNoTrans ? Matrix.ColStride() : Matrix.RowStride();
+    ScratchBuffer<Type> Buffer;
+    if (Overlaps(Matrix, Result)) {
+      pA = RowMajorOperand(Matrix, eOp, Buffer, true);
+      nRowStride = nK;
+      nColStride = 1;
+    }
+    Kernels::Syrk(nN, nK, Alpha, pA, nRowStride, nColStride, Beta, pC, nN,
+                  Tuning::Instance().Get());
+  }
+
+  template <typename Derived>
+  auto Power(const MatrixBase<Derived> &Matrix, uint64_t nExponent) -> Derived {
+    auto MatrixRtn = MakeResult<Derived>(Matrix.RowCount(), Matrix.ColCount());
+    Power(Matrix, nExponent, MatrixRtn);
+    return MatrixRtn;
+  }
+
+  template <typename Derived, typename ResultDerived>
+  void Power(const MatrixBase<Derived> &Matrix, uint64_t nExponent,
+             MatrixBase<ResultDerived> &Result) {
+    typedef typename MatrixTraits<Derived>::Type Type;
+    constexpr size_t nSmall = SmallStaticSize<Derived>();
+    SquareFunction(Matrix, Result, Kernels::PowerWorkSize(Matrix.RowCount()),
+                   [nExponent](size_t nSize, const Type *pA, Type *pOut, Type *pWork) {
+                     Kernels::MatrixPower<nSmall>(nSize, pA, nExponent, pOut, pWork,
+                                                  Tuning::Instance().Get());
+                   });
+  }
+
+  template <typename Derived> auto Exp(const MatrixBase<Derived> &Matrix) -> Derived {
+    auto MatrixRtn = MakeResult<Derived>(Matrix.RowCount(), Matrix.ColCount());
+    Exp(Matrix, MatrixRtn);
+    return MatrixRtn;
+  }
+
+  template <typename Derived, typename ResultDerived>
+  void Exp(const MatrixBase<Derived> &Matrix, MatrixBase<ResultDerived> &Result) {
+    typedef typename MatrixTraits<Derived>::Type Type;
+    constexpr size_t nSmall = SmallStaticSize<Derived>();
+    SquareFunction(Matrix, Result, Kernels::ExpWorkSize(Matrix.RowCount()),
+                   [](size_t nSize, const Type *pA, Type *pOut, Type *pWork) {
+                     ScratchBuffer<size_t> Pivots(nSize);
+                     if (!Kernels::MatrixExp<nSmall>(nSize, pA, pOut, pWork, Pivots.Data(),
+                                                     Tuning::Instance().Get()))
+                       throw std::domain_error("Matrix exponential of a non finite matrix");
+                   });
+  }
+
+  template <typename Derived, typename FilterDerived>
+  auto Correlation(const MatrixBase<Derived> &Image, const MatrixBase<FilterDerived> &Filter,
+                   const MtxConvolution &Options) -> ConvolutionResult<Derived> {
+    return std::move(Filter2D(Image, std::vector{&Filter}, Options, false)[0]);
+  }
+
+  template <typename Derived, typename FilterDerived>
+  auto Correlation(const MatrixBase<Derived> &Image, const std::vector<FilterDerived> &Filters,
+                   const MtxConvolution &Options) -> std::vector<ConvolutionResult<Derived>> {
+    std::vector<const MatrixBase<FilterDerived> *> Pointers;
+    for (const FilterDerived &Filter : Filters)
+      Pointers.push_back(&Filter);
+    return Filter2D(Image, Pointers, Options, false);
+  }
+
+  template <typename Derived, typename FilterDerived>
+  auto Convolution(const MatrixBase<Derived> &Image, const MatrixBase<FilterDerived> &Filter,
+                   const MtxConvolution &Options) -> ConvolutionResult<Derived> {
+    return std::move(Filter2D(Image, std::vector{&Filter}, Options, true)[0]);
+  }
+
+  template <typename Derived, typename FilterDerived>
+  auto Convolution(const MatrixBase<Derived> &Image, const std::vector<FilterDerived> &Filters,
+                   const MtxConvolution &Options) -> std::vector<ConvolutionResult<Derived>> {
+    std::vector<const MatrixBase<FilterDerived> *> Pointers;
+    for (const FilterDerived &Filter : Filters)
+      Pointers.push_back(&Filter);
+    return Filter2D(Image, Pointers, Options, true);
+  }
+
+  template <typename Derived, typename OtherDerived>
+  auto HorizontalConcat(const MatrixBase<Derived> &lMatrix, const MatrixBase<OtherDerived> &rMatrix)
+      -> ConcatResult<Derived> {
+    if (lMatrix.RowCount() != rMatrix.RowCount())
+      throw std::domain_error(
+          fmt::format("RowCount must be equal. lMatrix[{}][{}] / rMatrix[{}][{}]",
+                      lMatrix.RowCount(), lMatrix.ColCount(), rMatrix.RowCount(),
+                      rMatrix.ColCount()));
+    return Concat(lMatrix, rMatrix, lMatrix.RowCount(), lMatrix.ColCount() + rMatrix.ColCount(),
+                  0, lMatrix.ColCount());
+  }
+
+  template <typename Derived, typename OtherDerived>
+  auto VerticalConcat(const MatrixBase<Derived> &lMatrix, const MatrixBase<OtherDerived> &rMatrix)
+      -> ConcatResult<Derived> {
+    if (lMatrix.ColCount() != rMatrix.ColCount())
+      throw std::domain_error(
+          fmt::format("ColCount must be equal. lMatrix[{}][{}] / rMatrix[{}][{}]",
+                      lMatrix.RowCount(), lMatrix.ColCount(), rMatrix.RowCount(),
+                      rMatrix.ColCount()));
+    return Concat(lMatrix, rMatrix, lMatrix.RowCount() + rMatrix.RowCount(), lMatrix.ColCount(),
+                  lMatrix.RowCount(), 0);
+  }
+
+  template <typename Derived>
+  auto Transpose(const MatrixBase<Derived> &Matrix) -> TransposeResult<Derived> {
+    auto MatrixRtn = MakeResult<TransposeResult<Derived>>(Matrix.ColCount(), Matrix.RowCount());
+    // Same storage order in and out: a row major transpose of the stored (nOuter x nInner) array.
+    const size_t nOuter = Matrix.IsRowMajor() ? Matrix.RowCount() : Matrix.ColCount();
+    const size_t nInner = Matrix.IsRowMajor() ? Matrix.ColCount() : Matrix.RowCount();
+    Kernels::TransposeBlocked(nOuter, nInner, Matrix.Data(), nInner, MatrixRtn.Data(), nOuter,
+                              Tuning::Instance().Get());
+    return MatrixRtn;
+  }
+
+  template <typename Derived, typename OtherDerived>
+  auto Solve(const MatrixBase<Derived> &lMatrix, const MatrixBase<OtherDerived> &rMatrix)
+      -> OtherDerived {
+    typedef typename MatrixTraits<Derived>::Type Type;
+    CheckSolveDims(lMatrix, rMatrix);
+
+    const size_t nSize = lMatrix.RowCount();
+    ScratchBuffer<Type> LU;
+    ToRowMajor(lMatrix, LU);
+    ScratchBuffer<size_t> Pivots(nSize);
+    if (!Kernels::LUFactorBlocked(LU.Data(), nSize, Pivots.Data(), Tuning::Instance().Get()))
+      throw std::domain_error("lMatrix is singular");
+
+    OtherDerived MatrixRtn(rMatrix);
+    auto *pX = MatrixRtn.Data();
+    ScratchBuffer<typename MatrixTraits<OtherDerived>::Type> Column(nSize);
+    for (size_t j = 0; j < MatrixRtn.ColCount(); ++j) {
+      Kernels::Copy(nSize, 1, pX + j * MatrixRtn.ColStride(), MatrixRtn.RowStride(), 0,
+                    Column.Data(), 1, 0);
+      Kernels::LUSolve(LU.Data(), nSize, Pivots.Data(), Column.Data());
+      Kernels::Copy(nSize, 1, Column.Data(), 1, 0, pX + j * MatrixRtn.ColStride(),
+                    MatrixRtn.RowStride(), 0);
+    }
+    return MatrixRtn;
+  }
+
+  template <typename Derived, typename OtherDerived>
+  auto MixedPrecisionSolve(const MatrixBase<Derived> &lMatrix,
+                           const MatrixBase<OtherDerived> &rMatrix, MtxSolverInfo *pInfo = nullptr)
+      -> OtherDerived {
+    typedef typename MatrixTraits<Derived>::Type Type;
+    static_assert(std::is_floating_point_v<Type>, "MixedPrecisionSolve requires a floating point "
+                                                  "matrix");
+    CheckSolveDims(lMatrix, rMatrix);
+
+    MtxSolverInfo Info;
+    // Nothing to gain if the matrix is already single precision.
+    if constexpr (sizeof(Type) <= sizeof(float)) {
+      Info.bFallback = true;
+      if (pInfo != nullptr)
+        *pInfo = Info;
+      return Solve(lMatrix, rMatrix);
+    }
+
+    const size_t nSize = lMatrix.RowCount();
+    const Type *pA = lMatrix.Data();
+    const MtxTuningParams Params = Tuning::Instance().Get();
+
+    // ||A||_inf, also used to reject matrices that would overflow in float.
+    Type NormA = Type(0);
+    for (size_t i = 0; i < nSize; ++i) {
+      Type RowSum = Type(0);
+      for (size_t j = 0; j < nSize; ++j)
+        RowSum += std::abs(pA[i * lMatrix.RowStride() + j * lMatrix.ColStride()]);
+      NormA = std::max(NormA, RowSum);
+    }
+    const Type Tolerance =
+        NormA * std::numeric_limits<Type>::epsilon() * std::sqrt(static_cast<Type>(nSize));
+
+    ScratchBuffer<size_t> Pivots(nSize);
+    ScratchBuffer<float> LowLU;
+    bool bFactored = NormA <= static_cast<Type>(std::numeric_limits<float>::max());
+    if (bFactored) {
+      ToRowMajor(lMatrix, LowLU);
+      bFactored = Kernels::LUFactorBlocked(LowLU.Data(), nSize, Pivots.Data(), Params);
+    }
+
+    // Full precision factorization, only built if some column fails to converge.
+    ScratchBuffer<Type> HighLU;
+    ScratchBuffer<size_t> HighPivots;
+
+    OtherDerived MatrixRtn(rMatrix);
+    auto *pX = MatrixRtn.Data();
+    ScratchBuffer<Type> B(nSize), X(nSize), R(nSize);
+    Info.bConverged = bFactored;
+    for (size_t j = 0; j < MatrixRtn.ColCount(); ++j) {
+      Kernels::Copy(nSize, 1, pX + j * MatrixRtn.ColStride(), MatrixRtn.RowStride(), 0, B.Data(),
+                    1, 0);
+
+      bool bColConverged = false;
+      if (bFactored) {
+        std::copy(B.Data(), B.Data() + nSize, X.Data());
+        Kernels::LUSolve(LowLU.Data(), nSize, Pivots.Data(), X.Data());
+        for (size_t nIter = 0; nIter <= m_nMaxRefinementIterations; ++nIter) {
+          // R = B - A * X, in full precision.
+          std::copy(B.Data(), B.Data() + nSize, R.Data());
+          Kernels::Gemv(nSize, nSize, Type(-1), pA, lMatrix.RowStride(), lMatrix.ColStride(),
+                        X.Data(), R.Data());
+
+          Type NormR = Type(0), NormX = Type(0);
+          for (size_t i = 0; i < nSize; ++i) {
+            NormR = std::max(NormR, std::abs(R[i]));
+            NormX = std::max(NormX, std::abs(X[i]));
+          }
+          if (!std::isfinite(NormR) || !std::isfinite(NormX))
+            break;
+          if (NormR <= NormX * Tolerance) {
+            bColConverged = true;
+            Info.nIterations = std::max(Info.nIterations, nIter);
+            break;
+          }
+          if (nIter == m_nMaxRefinementIterations)
+            break;
+
+          Kernels::LUSolve(LowLU.Data(), nSize, Pivots.Data(), R.Data());
+          for (size_t i = 0; i < nSize; ++i)
+            X[i] += R[i];
+        }
+      }
+
+      if (!bColConverged) {
+        Info.bConverged = false;
+        Info.bFallback = true;
+        if (HighLU.Empty()) {
+          ToRowMajor(lMatrix, HighLU);
+          HighPivots.Resize(nSize);
+          if (!Kernels::LUFactorBlocked(HighLU.Data(), nSize, HighPivots.Data(), Params))
+            throw std::domain_error("lMatrix is singular");
+        }
+        std::copy(B.Data(), B.Data() + nSize, X.Data());
+        Kernels::LUSolve(HighLU.Data(), nSize, HighPivots.Data(), X.Data());
+      }
+
+      Kernels::Copy(nSize, 1, X.Data(), 1, 0, pX + j * MatrixRtn.ColStride(),
+                    MatrixRtn.RowStride(), 0);
+    }
+
+    if (pInfo != nullptr)
+      *pInfo = Info;
+    return MatrixRtn;
+  }
+
+  template <typename Derived>
+  auto SymmetricEigen(const MatrixBase<Derived> &Matrix, MtxEigenJob eJob = MtxEigenVectors,
+                      size_t nCount = 0) -> SymmetricEigenResult<Derived> {
+    typedef typename MatrixTraits<Derived>::Type Type;
+    static_assert(std::is_floating_point_v<Type>, "SymmetricEigen requires a floating point "
+                                                  "matrix");
+    if (Matrix.RowCount() != Matrix.ColCount())
+      throw std::domain_error(fmt::format("Matrix must be square. Matrix[{}][{}]",
+                                          Matrix.RowCount(), Matrix.ColCount()));
+
+    const size_t nSize = Matrix.RowCount();
+    nCount = nCount == 0 ? nSize : std::min(nCount, nSize);
+    const MtxTuningParams Params = Tuning::Instance().Get();
+
+    // Symmetric row major copy of the lower triangle, scaled to a largest magnitude of 1 so the
+    // reflectors and the secular equations can't overflow.
+    ScratchBuffer<Type> A;
+    ToRowMajor(Matrix, A);
+    Type Scale = Type(0);
+    for (size_t i = 0; i < nSize; ++i)
+      for (size_t j = 0; j <= i; ++j)
+        Scale = std::max(Scale, std::abs(A[i * nSize + j]));
+    if (!std::isfinite(Scale))
+      throw std::domain_error("Matrix has non finite values");
+    if (Scale == Type(0))
+      Scale = Type(1);
+    for (size_t i = 0; i < nSize; ++i)
+      for (size_t j = 0; j <= i; ++j)
+        A[j * nSize + i] = A[i * nSize + j] /= Scale;
+
+    ScratchBuffer<Type> D(nSize), E(nSize), Tau(nSize);
+    Kernels::Tridiagonalize(A.Data(), nSize, D.Data(), E.Data(), Tau.Data(), Params);
+
+    // Eigenvalues of the tridiagonal and its eigenvectors (one per row), nValues of them.
+    const Type *pValues = D.Data();
+    size_t nValues = nSize;
+    ScratchBuffer<Type> Selected, Vectors;
+    bool bConverged = true;
+    if (eJob == MtxEigenValues)
+      bConverged =
+          Kernels::TridiagonalQL(D.Data(), E.Data(), nSize, static_cast<Type *>(nullptr), 0);
+    else if (nCount < nSize) {
+      Selected.Resize(nCount);
+      Vectors.Resize(nCount * nSize);
+      Kernels::TridiagonalSelect(D.Data(), E.Data(), nSize, nCount, Selected.Data(),
+                                 Vectors.Data(), Params);
+      pValues = Selected.Data();
+      nValues = nCount;
+    } else {
+      Vectors.Resize(nSize * nSize);
+      bConverged = Kernels::TridiagonalDivide(D.Data(), E.Data(), nSize, Vectors.Data(), nSize,
+                                              Params);
+    }
+    if (!bConverged)
+      throw std::domain_error("SymmetricEigen did not converge");
+    if (eJob == MtxEigenVectors)
+      Kernels::ApplyReflectors(A.Data(), nSize, 1, 1, nSize > 0 ? nSize - 1 : 0, Tau.Data(),
+                               Vectors.Data(), nValues, nSize, Params);
+
+    ScratchBuffer<size_t> Order(nValues);
+    std::iota(Order.Data(), Order.Data() + nValues, size_t(0));
+    std::stable_sort(Order.Data(), Order.Data() + nValues,
+                     [pValues](size_t a, size_t b) { return pValues[a] > pValues[b]; });
+    SymmetricEigenResult<Derived> Result{
+        std::vector<Type>(nCount),
+        eJob == MtxEigenVectors ? decltype(Result.Vectors)(nSize, nCount)
+                                : decltype(Result.Vectors)()};
+    for (size_t j = 0; j < nCount; ++j) {
+      Result.Values[j] = pValues[Order[j]] * Scale;
+      if (eJob == MtxEigenVectors)
+        Kernels::Copy(nSize, 1, Vectors.Data() + Order[j] * nSize, 1, 0,
+                      Result.Vectors.Data() + j * Result.Vectors.ColStride(),
+                      Result.Vectors.RowStride(), 0);
+    }
+    return Result;
+  }
+
+  template <typename Derived>
+  auto Svd(const MatrixBase<Derived> &Matrix, MtxSvdJob eJob = MtxSvdVectors)
+      -> SvdResult<Derived> {
+    typedef typename MatrixTraits<Derived>::Type Type;
+    static_assert(std::is_floating_point_v<Type>, "Svd requires a floating point matrix");
+    const size_t nRows = Matrix.RowCount(), nCols = Matrix.ColCount();
+    // The kernel takes a tall matrix: a wide Matrix is decomposed through Matrix^T = V * S * U^T.
+    const bool bWide = nRows < nCols;
+    const size_t nTall = std::max(nRows, nCols), nThin = std::min(nRows, nCols);
+    const MtxTuningParams Params = Tuning::Instance().Get();
+
+    // Row major copy of Matrix (Matrix^T if wide), scaled to a largest magnitude of 1.
+    ScratchBuffer<Type> A(Matrix.Size());
+    Kernels::Copy(nRows, nCols, Matrix.Data(), Matrix.RowStride(), Matrix.ColStride(), A.Data(),
+                  bWide ? 1 : nCols, bWide ? nRows : 1);
+    Type Scale = Type(0);
+    for (size_t i = 0; i < A.Size(); ++i)
+      Scale = std::max(Scale, std::abs(A[i]));
+    if (!std::isfinite(Scale))
+      throw std::domain_error("Matrix has non finite values");
+    if (Scale == Type(0))
+      Scale = Type(1);
+    for (size_t i = 0; i < A.Size(); ++i)
+      A[i] /= Scale;
+
+    const bool bVectors = eJob == MtxSvdVectors;
+    ScratchBuffer<Type> Values(nThin), Ut(bVectors ? nThin * nTall : 0),
+        Vt(bVectors ? nThin * nThin : 0);
+    if (!Kernels::Svd(A.Data(), nTall, nThin, Values.Data(), bVectors ? Ut.Data() : nullptr,
+                      bVectors ? Vt.Data() : nullptr, Params))
+      throw std::domain_error("Svd did not converge");
+
+    SvdResult<Derived> Result{
+        std::vector<Type>(nThin),
+        bVectors ? decltype(Result.U)(nRows, nThin) : decltype(Result.U)(),
+        bVectors ? decltype(Result.V)(nCols, nThin) : decltype(Result.V)()};
+    const Type *pLeft = bWide ? Vt.Data() : Ut.Data(), *pRight = bWide ? Ut.Data() : Vt.Data();
+    for (size_t j = 0; j < nThin; ++j) {
+      Result.Values[j] = Values[j] * Scale;
+      if (!bVectors)
+        continue;
+      Kernels::Copy(nRows, 1, pLeft + j * nRows, 1, 0, Result.U.Data() + j * Result.U.ColStride(),
+                    Result.U.RowStride(), 0);
+      Kernels::Copy(nCols, 1, pRight + j * nCols, 1, 0,
+                    Result.V.Data() + j * Result.V.ColStride(), Result.V.RowStride(), 0);
+    }
+    return Result;
+  }
+
+  template <typename Derived>
+  auto RandomizedSvd(const MatrixBase<Derived> &Matrix, size_t nRank, size_t nOversampling = 10,
+                     size_t nPowerIterations = 2, uint64_t nSeed = 0) -> SvdResult<Derived> {
+    typedef typename MatrixTraits<Derived>::Type Type;
+    static_assert(std::is_floating_point_v<Type>, "RandomizedSvd requires a floating point "
+                                                  "matrix");
+    const size_t nRows = Matrix.RowCount(), nCols = Matrix.ColCount();
+    if (nRank == 0 || nRank > std::min(nRows, nCols))
+      throw std::domain_error(fmt::format("nRank must be in [1, min(RowCount, ColCount)]. "
+                                          "nRank = {} / Matrix[{}][{}]",
+                                          nRank, nRows, nCols));
+    const size_t nSketch = std::min(nRank + nOversampling, std::min(nRows, nCols));
+    const MtxTuningParams Params = Tuning::Instance().Get();
+    const MtxEpilogue<Type> Epilogue;
+    // The storage of Matrix is a row major array of A (row major) or A^T (col major), it is read
+    // in place by the GEMMs.
+    const Type *pA = Matrix.Data();
+    const bool bRowMajor = Matrix.IsRowMajor();
+
+    // Sketches, stored transposed (one vector per row): Qt (nSketch x nRows) spans the range
+    // of Matrix and Zt (nSketch x nCols) the range of Matrix^T.
+    ScratchBuffer<Type> Qt(nSketch * nRows), Zt(nSketch * nCols), Tall(nRows * nSketch),
+        Wide(nCols * nSketch);
+    // Qt = (Matrix * Z)^T.
+    auto Range = [&]() {
+      if (bRowMajor) {
+        Kernels::TransposeBlocked(nSketch, nCols, Zt.Data(), nCols, Wide.Data(), nSketch, Params);
+        Kernels::GemmFused(nRows, nSketch, nCols, Type(1), pA, nCols, Wide.Data(), nSketch,
+                           Type(0), Tall.Data(), nSketch, Epilogue, Params);
+        Kernels::TransposeBlocked(nRows, nSketch, Tall.Data(), nSketch, Qt.Data(), nRows, Params);
+      } else
+        Kernels::GemmFused(nSketch, nRows, nCols, Type(1), Zt.Data(), nCols, pA, nRows, Type(0),
+                           Qt.Data(), nRows, Epilogue, Params);
+    };
+    // Zt = Q^T * Matrix.
+    auto CoRange = [&]() {
+      if (bRowMajor)
+        Kernels::GemmFused(nSketch, nCols, nRows, Type(1), Qt.Data(), nRows, pA, nCols, Type(0),
+                           Zt.Data(), nCols, Epilogue, Params);
+      else {
+        Kernels::TransposeBlocked(nSketch, nRows, Qt.Data(), nRows, Tall.Data(), nSketch, Params);
+        Kernels::GemmFused(nCols, nSketch, nRows, Type(1), pA, nRows, Tall.Data(), nSketch,
+                           Type(0), Wide.Data(), nSketch, Epilogue, Params);
+        Kernels::TransposeBlocked(nCols, nSketch, Wide.Data(), nSketch, Zt.Data(), nCols, Params);
+      }
+    };
+
+    // Gaussian test matrix, drawn in the same order whatever the storage of Matrix.
+    std::mt19937_64 Generator(nSeed);
+    std::normal_distribution<Type> Normal;
+    for (size_t i = 0; i < nSketch * nCols; ++i)
+      Zt[i] = Normal(Generator);
+    Range();
+    Kernels::OrthonormalizeRows(Qt.Data(), nSketch, nRows, Params);
+    for (size_t q = 0; q < nPowerIterations; ++q) {
+      CoRange();
+      Kernels::OrthonormalizeRows(Zt.Data(), nSketch, nCols, Params);
+      Range();
+      Kernels::OrthonormalizeRows(Qt.Data(), nSketch, nRows, Params);
+    }
+    CoRange();
+    if (!std::all_of(Zt.Data(), Zt.Data() + Zt.Size(), [](Type x) { return std::isfinite(x); }))
+      throw std::domain_error("Matrix has non finite values");
+
+    // B = Q^T * Matrix = Zt, B^T = Ub * S * Vb^T, so Matrix ~ (Q * Vb) * S * Ub^T.
+    Kernels::TransposeBlocked(nSketch, nCols, Zt.Data(), nCols, Wide.Data(), nSketch, Params);
+    ScratchBuffer<Type> Values(nSketch), Ub(nSketch * nCols), Vb(nSketch * nSketch),
+        Left(nRank * nRows);
+    if (!Kernels::Svd(Wide.Data(), nCols, nSketch, Values.Data(), Ub.Data(), Vb.Data(), Params))
+      throw std::domain_error("RandomizedSvd did not converge");
+    Kernels::GemmFused(nRank, nRows, nSketch, Type(1), Vb.Data(), nSketch, Qt.Data(), nRows,
+                       Type(0), Left.Data(), nRows, Epilogue, Params);
+
+    SvdResult<Derived> Result{std::vector<Type>(Values.Data(), Values.Data() + nRank),
+                              decltype(Result.U)(nRows, nRank), decltype(Result.V)(nCols, nRank)};
+    for (size_t j = 0; j < nRank; ++j) {
+      Kernels::Copy(nRows, 1, Left.Data() + j * nRows, 1, 0,
+                    Result.U.Data() + j * Result.U.ColStride(), Result.U.RowStride(), 0);
+      Kernels::Copy(nCols, 1, Ub.Data() + j * nCols, 1, 0,
+                    Result.V.Data() + j * Result.V.ColStride(), Result.V.RowStride(), 0);
+    }
+    return Result;
+  }
 };
 }; // namespace Mafs::Internal
 
@@ -0,0 +1,74 @@
+#ifndef MAFS_MATRIX_KERNELS_BLAS_H
+#define MAFS_MATRIX_KERNELS_BLAS_H
+
+#include <stddef.h>
+
+namespace Mafs::Internal::Kernels {
+
+/**
+ * @brief Strided copy with type conversion: B[i][j] = A[i][j].
+ *
+ * Used to move a matrix between storage orders and/or precisions (e.g. into a row major float
+ * buffer before a factorization).
+ *
+ * @tparam T Source type.
+ * @tparam U Destination type.
+ * @param nRows
+ * @param nCols
+ * @param pA
+ * @param nRowStrideA
+ * @param nColStrideA
+ * @param pB
+ * @param nRowStrideB
+ * @param nColStrideB
+ */
+template <typename T, typename U>
+void Copy(size_t nRows, size_t nCols, const T *pA, size_t nRowStrideA, size_t nColStrideA, U *pB,
+          size_t nRowStrideB, size_t nColStrideB) {
+  for (size_t i = 0; i < nRows; ++i)
+    for (size_t j = 0; j < nCols; ++j)
+      pB[i * nRowStrideB + j * nColStrideB] = U(pA[i * nRowStrideA + j * nColStrideA]);
+}
+
+/**
+ * @brief Strided matrix-vector product: y += Alpha * A * x.
+ *
+ * Element [i][j] of A is pA[i * nRowStride + j * nColStride], so the same kernel reads row and
+ * col major matrices. The loop order follows whichever stride is contiguous.
+ *
+ * @tparam T Accumulation type (x, y, Alpha).
+ * @tparam U Matrix type.
+ * @param nRows
+ * @param nCols
+ * @param Alpha
+ * @param pA
+ * @param nRowStride
+ * @param nColStride
+ * @param pX
+ * @param pY
+ */
+template <typename T, typename U>
+void Gemv(size_t nRows, size_t nCols, T Alpha, const U *pA, size_t nRowStride, size_t nColStride,
+          const T *pX, T *pY) {
+  if (nColStride == 1) {
+    // Row major: dot product per row.
+    for (size_t i = 0; i < nRows; ++i) {
+      const U *pRow = pA + i * nRowStride;
+      T Acc = T(0);
+      for (size_t j = 0; j < nCols; ++j)
+        Acc += T(pRow[j]) * pX[j];
+      pY[i] += Alpha * Acc;
+    }
+  } else {
+    // Col major: axpy per column.
+    for (size_t j = 0; j < nCols; ++j) {
+      const U *pCol = pA + j * nColStride;
+      const T Scale = Alpha * pX[j];
+      for (size_t i = 0; i < nRows; ++i)
+        pY[i] += Scale * T(pCol[i * nRowStride]);
+    }
+  }
+}
+}; // namespace Mafs::Internal::Kernels
+
+#endif // MAFS_MATRIX_KERNELS_BLAS_H
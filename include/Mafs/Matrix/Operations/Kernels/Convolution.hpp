@@ -0,0 +1,165 @@
+#ifndef MAFS_MATRIX_KERNELS_CONVOLUTION_H
+#define MAFS_MATRIX_KERNELS_CONVOLUTION_H
+
+#include <Mafs/Matrix/MatrixDataTypes.hpp>
+#include <Mafs/Matrix/Operations/Kernels/Blas.hpp>
+#include <Mafs/Matrix/Operations/Kernels/Gemm.hpp>
+#include <Mafs/Matrix/Operations/Kernels/Parallel.hpp>
+#include <Mafs/Utils/Workspace.hpp>
+#include <algorithm>
+#include <limits>
+#include <stddef.h>
+
+/**
+ * 2D cross-correlation of an image with a bank of filters:
+ * Out[f][i][j] = sum_u,v Filter[f][u][v] * Image[i * nStrideRow + u][j * nStrideCol + v].
+ *
+ * The image is the padded (zeros on every side) row major copy made by PadImage, so the kernels
+ * never test the borders. The filters are nFilters consecutive row major nFilterRows x
+ * nFilterCols arrays and the output nFilters consecutive row major nOutRows x nOutCols planes.
+ * Above Params.nParallelThreshold flops the rows of the output are split among threads.
+ */
+namespace Mafs::Internal::Kernels {
+/**
+ * @brief Copies the nRows x nCols image (any strides) into the row major pPadded of (nRows + 2
+ * nPadRow) x (nCols + 2 nPadCol), zeros around it. A col major image is transposed by blocks.
+ */
+template <typename T>
+void PadImage(size_t nRows, size_t nCols, const T *pImage, size_t nRowStride, size_t nColStride,
+              size_t nPadRow, size_t nPadCol, T *pPadded, const MtxTuningParams &Params) {
+  const size_t nPaddedCols = nCols + 2 * nPadCol;
+  if (nRows == 0 || nCols == 0) {
+    std::fill(pPadded, pPadded + (nRows + 2 * nPadRow) * nPaddedCols, T(0));
+    return;
+  }
+  T *pInterior = pPadded + nPadRow * nPaddedCols + nPadCol;
+  if (nRowStride == 1 && nRows > 1)
+    TransposeBlocked(nCols, nRows, pImage, nColStride, pInterior, nPaddedCols, Params);
+  else
+    Copy(nRows, nCols, pImage, nRowStride, nColStride, pInterior, nPaddedCols, size_t(1));
+  std::fill(pPadded, pInterior, T(0));
+  for (size_t i = 0; i + 1 < nRows; ++i)
+    std::fill(pInterior + i * nPaddedCols + nCols, pInterior + (i + 1) * nPaddedCols, T(0));
+  T *pEnd = pPadded + (nRows + 2 * nPadRow) * nPaddedCols;
+  std::fill(pInterior + (nRows - 1) * nPaddedCols + nCols, pEnd, T(0));
+}
+
+/**
+ * @brief Threads of a correlation of nFlops.
+ */
+inline auto CorrelationThreads(double Flops, const MtxTuningParams &Params) -> size_t {
+  return Flops >= static_cast<double>(Params.nParallelThreshold) ? ThreadCount(Params.nThreads)
+                                                                 : 1;
+}
+
+/**
+ * @brief Direct correlation: each output row accumulates, for every filter entry, the scaled
+ * input row it covers. The output row stays in L1 and the inner loop walks contiguous values
+ * (stride 1), which the compiler vectorizes; best for small filters.
+ *
+ * @param pPadded padded image, nPaddedCols values per row.
+ * @param nPaddedCols
+ * @param nFilters
+ * @param nFilterRows
+ * @param nFilterCols
+ * @param pFilters
+ * @param nOutRows
+ * @param nOutCols
+ * @param Options strides (the padding is already in pPadded).
+ * @param pOut
+ * @param Params
+ */
+template <typename T>
+void CorrelationDirect(const T *pPadded, size_t nPaddedCols, size_t nFilters, size_t nFilterRows,
+                       size_t nFilterCols, const T *pFilters, size_t nOutRows, size_t nOutCols,
+                       const MtxConvolution &Options, T *pOut, const MtxTuningParams &Params) {
+  const size_t nTaps = nFilterRows * nFilterCols, nPlane = nOutRows * nOutCols;
+  const size_t nStrideRow = Options.nStrideRow, nStrideCol = Options.nStrideCol;
+  const double Flops = 2.0 * static_cast<double>(nFilters) * static_cast<double>(nPlane) *
+                       static_cast<double>(nTaps);
+  ParallelFor(nOutRows, CorrelationThreads(Flops, Params), [&](size_t nBegin, size_t nEnd) {
+    for (size_t i = nBegin; i < nEnd; ++i)
+      for (size_t f = 0; f < nFilters; ++f) {
+        T *pRow = pOut + f * nPlane + i * nOutCols;
+        std::fill(pRow, pRow + nOutCols, T(0));
+        for (size_t u = 0; u < nFilterRows; ++u) {
+          const T *pInput = pPadded + (i * nStrideRow + u) * nPaddedCols;
+          const T *pWeights = pFilters + f * nTaps + u * nFilterCols;
+          for (size_t v = 0; v < nFilterCols; ++v) {
+            const T Weight = pWeights[v];
+            const T *pIn = pInput + v;
+            if (nStrideCol == 1)
+              for (size_t j = 0; j < nOutCols; ++j)
+                pRow[j] += Weight * pIn[j];
+            else
+              for (size_t j = 0; j < nOutCols; ++j)
+                pRow[j] += Weight * pIn[j * nStrideCol];
+          }
+        }
+      }
+  });
+}
+
+/**
+ * @brief Correlation as a product (im2col): the patches covered by a block of output rows are
+ * unrolled into a nTaps x (rows * nOutCols) scratch matrix, one col per output value, and the
+ * filters (nFilters x nTaps) multiply it with GemmFused into the output planes. The blocks keep
+ * the unrolled patches around 2^16 values, in cache and far below the nTaps times the image a
+ * whole im2col would take; each thread unrolls its blocks into its own scratch buffer. Best for
+ * large filters, whose taps make a deep enough product.
+ *
+ * @see CorrelationDirect for the parameters.
+ */
+template <typename T>
+void CorrelationIm2Col(const T *pPadded, size_t nPaddedCols, size_t nFilters, size_t nFilterRows,
+                       size_t nFilterCols, const T *pFilters, size_t nOutRows, size_t nOutCols,
+                       const MtxConvolution &Options, T *pOut, const MtxTuningParams &Params) {
+  constexpr size_t nColumnValues = size_t(1) << 16;
+  const size_t nTaps = nFilterRows * nFilterCols, nPlane = nOutRows * nOutCols;
+  const size_t nStrideRow = Options.nStrideRow, nStrideCol = Options.nStrideCol;
+  const size_t nBlockRows =
+      std::clamp<size_t>(nColumnValues / std::max<size_t>(nTaps * nOutCols, 1), 1, nOutRows);
+  const size_t nBlocks = (nOutRows + nBlockRows - 1) / nBlockRows;
+  const double Flops = 2.0 * static_cast<double>(nFilters) * static_cast<double>(nPlane) *
+                       static_cast<double>(nTaps);
+  // The threads already split the blocks, each product runs on one.
+  MtxTuningParams Serial = Params;
+  Serial.nParallelThreshold = std::numeric_limits<size_t>::max();
+  ParallelFor(nBlocks, CorrelationThreads(Flops, Params), [&](size_t nBegin, size_t nEnd) {
+    ScratchBuffer<T> Columns(nTaps * nBlockRows * nOutCols);
+    for (size_t b = nBegin; b < nEnd; ++b) {
+      const size_t nFirst = b * nBlockRows, nRows = std::min(nBlockRows, nOutRows - nFirst);
+      const size_t nN = nRows * nOutCols;
+      for (size_t u = 0; u < nFilterRows; ++u)
+        for (size_t v = 0; v < nFilterCols; ++v) {
+          T *pDst = Columns.Data() + (u * nFilterCols + v) * nN;
+          for (size_t r = 0; r < nRows; ++r) {
+            const T *pIn = pPadded + ((nFirst + r) * nStrideRow + u) * nPaddedCols + v;
+            for (size_t j = 0; j < nOutCols; ++j)
+              pDst[r * nOutCols + j] = pIn[j * nStrideCol];
+          }
+        }
+      GemmFused(nFilters, nN, nTaps, T(1), pFilters, nTaps, Columns.Data(), nN, T(0),
+                pOut + nFirst * nOutCols, nPlane, MtxEpilogue<T>(), Serial);
+    }
+  });
+}
+
+/**
+ * @brief Correlation by CorrelationDirect for filters of up to Params.nConvDirectTaps entries,
+ * by CorrelationIm2Col above.
+ */
+template <typename T>
+void Correlation(const T *pPadded, size_t nPaddedCols, size_t nFilters, size_t nFilterRows,
+                 size_t nFilterCols, const T *pFilters, size_t nOutRows, size_t nOutCols,
+                 const MtxConvolution &Options, T *pOut, const MtxTuningParams &Params) {
+  if (nFilterRows * nFilterCols <= Params.nConvDirectTaps)
+    CorrelationDirect(pPadded, nPaddedCols, nFilters, nFilterRows, nFilterCols, pFilters,
+                      nOutRows, nOutCols, Options, pOut, Params);
+  else
+    CorrelationIm2Col(pPadded, nPaddedCols, nFilters, nFilterRows, nFilterCols, pFilters,
+                      nOutRows, nOutCols, Options, pOut, Params);
+}
+}; // namespace Mafs::Internal::Kernels
+
+#endif // MAFS_MATRIX_KERNELS_CONVOLUTION_H
@@ -0,0 +1,737 @@
+#ifndef MAFS_MATRIX_KERNELS_EIGEN_H
+#define MAFS_MATRIX_KERNELS_EIGEN_H
+
+#include <Mafs/Matrix/Operations/Kernels/Gemm.hpp>
+#include <Mafs/Matrix/Operations/Kernels/Reduce.hpp>
+#include <Mafs/Utils/Workspace.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <stddef.h>
+
+/**
+ * Symmetric eigensolver.
+ *
+ * A is reduced to a tridiagonal T = Q^T * A * Q by Householder reflectors (Tridiagonalize), the
+ * eigenpairs of T are computed by divide and conquer (TridiagonalDivide), QL iterations
+ * (TridiagonalQL, eigenvalues only) or bisection and inverse iteration (TridiagonalSelect, a few
+ * pairs), and the eigenvectors of T are mapped back to A by the reflectors (ApplyReflectors).
+ *
+ * Eigenvectors are stored one per row of a row major array.
+ */
+namespace Mafs::Internal::Kernels {
+// Tridiagonals up to this size are not split by TridiagonalDivide.
+inline constexpr size_t nDivideMin = 32;
+// QL sweeps per eigenvalue before giving up (same as EISPACK).
+inline constexpr size_t nQLMaxIterations = 60;
+// Iterations of the secular equation solver per root.
+inline constexpr size_t nSecularMaxIterations = 100;
+// Inverse iteration steps per eigenvector.
+inline constexpr size_t nInverseIterations = 4;
+
+/**
+ * @brief Dot product of p[0, nSize) and q[0, nSize).
+ */
+template <typename T> auto Dot(const T *p, const T *q, size_t nSize) -> T {
+  auto Product = [p, q](size_t i) { return p[i] * q[i]; };
+  return SumLanes<T>(0, nSize, Product);
+}
+
+/**
+ * @brief Householder reflector H = I - Tau * v * v^T with H * x = (Beta, 0, ..., 0).
+ *
+ * @tparam T
+ * @param pX x (nSize values), overwritten with v (v[0] = 1).
+ * @param nSize
+ * @param Beta
+ * @return T Tau, 0 if x already has that form (H = I).
+ */
+template <typename T> auto Householder(T *pX, size_t nSize, T &Beta) -> T {
+  const T Alpha = pX[0];
+  const T Sigma = Dot(pX + 1, pX + 1, nSize - 1);
+  pX[0] = T(1);
+  Beta = Alpha;
+  if (Sigma == T(0))
+    return T(0);
+  Beta = -std::copysign(std::sqrt(Alpha * Alpha + Sigma), Alpha);
+  const T Scale = T(1) / (Alpha - Beta);
+  for (size_t i = 1; i < nSize; ++i)
+    pX[i] *= Scale;
+  return (Beta - Alpha) / Beta;
+}
+
+/**
+ * @brief Reduces the symmetric nSize x nSize row major array pA to a tridiagonal matrix
+ * T = Q^T * A * Q, Q = H(0) * ... * H(nSize - 2) (blocked, LAPACK sytrd).
+ *
+ * Panels of Params.nLUBlock columns are reduced one column at a time, the updates of the panel
+ * being accumulated in two tall matrices V and W. The rest of the matrix is then updated at once
+ * by A -= V * W^T + W * V^T, a GEMM with an inner dimension of twice the panel width, which is
+ * where most of the flops are. The products by A inside the panel are split among threads above
+ * Params.nParallelThreshold.
+ *
+ * On return row k of pA holds the vector of H(k) in its cols k + 1 to nSize - 1 (see
+ * ApplyReflectors), the rest of pA is overwritten.
+ *
+ * @tparam T
+ * @param pA both triangles must be filled.
+ * @param nSize
+ * @param pD diagonal of T (nSize values).
+ * @param pE off-diagonal of T, pE[k] = T[k][k + 1] (nSize values, the last one is 0).
+ * @param pTau Tau of H(k) (nSize values).
+ * @param Params panel width and threads.
+ */
+template <typename T>
+void Tridiagonalize(T *pA, size_t nSize, T *pD, T *pE, T *pTau, const MtxTuningParams &Params) {
+  if (nSize == 0)
+    return;
+  const size_t nBlock = std::max<size_t>(Params.nLUBlock, 1);
+  const size_t nThreads = ThreadCount(Params.nThreads);
+  // W(p) in rows [0, nPanel), V(p) in rows [nPanel, 2 * nPanel): the rows nPanel to 2 * nPanel
+  // of the GEMM right operand [W^T; V^T] (the left one, [V W], is a transposed copy).
+  ScratchBuffer<T> Pairs(2 * nBlock * nSize);
+
+  for (size_t k0 = 0; k0 + 1 < nSize; k0 += nBlock) {
+    const size_t nPanel = std::min(nBlock, nSize - 1 - k0);
+    T *pW = Pairs.Data(), *pV = Pairs.Data() + nPanel * nSize;
+    std::fill(Pairs.Data(), Pairs.Data() + 2 * nPanel * nSize, T(0));
+
+    for (size_t c = 0; c < nPanel; ++c) {
+      const size_t j = k0 + c, nLen = nSize - j - 1;
+      T *pRow = pA + j * nSize;
+      // Row j (= col j) with the updates of the previous cols of the panel.
+      for (size_t p = 0; p < c; ++p) {
+        const T *pVp = pV + p * nSize, *pWp = pW + p * nSize;
+        const T Vj = pVp[j], Wj = pWp[j];
+        for (size_t i = j; i < nSize; ++i)
+          pRow[i] -= pVp[i] * Wj + pWp[i] * Vj;
+      }
+      pD[j] = pRow[j];
+      pTau[j] = Householder(pRow + j + 1, nLen, pE[j]);
+
+      T *pVc = pV + c * nSize, *pWc = pW + c * nSize;
+      std::copy(pRow + j + 1, pRow + nSize, pVc + j + 1);
+      if (pTau[j] == T(0))
+        continue;
+
+      // w = Tau * (A - V * W^T - W * V^T) * v, rows > j of A are still untouched by the panel.
+      const T *pVec = pVc + j + 1;
+      T *pOut = pWc + j + 1;
+      ParallelFor(nLen, nLen * nLen >= Params.nParallelThreshold ? nThreads : 1,
+                  [&](size_t nBegin, size_t nEnd) {
+                    for (size_t i = nBegin; i < nEnd; ++i)
+                      pOut[i] = Dot(pA + (j + 1 + i) * nSize + j + 1, pVec, nLen);
+                  });
+      for (size_t p = 0; p < c; ++p) {
+        const T *pVp = pV + p * nSize + j + 1, *pWp = pW + p * nSize + j + 1;
+        const T WDot = Dot(pWp, pVec, nLen), VDot = Dot(pVp, pVec, nLen);
+        for (size_t i = 0; i < nLen; ++i)
+          pOut[i] -= pVp[i] * WDot + pWp[i] * VDot;
+      }
+      // w -= Tau / 2 * (w . v) * v, so the update is the symmetric rank 2 v * w^T + w * v^T.
+      const T Tau = pTau[j];
+      for (size_t i = 0; i < nLen; ++i)
+        pOut[i] *= Tau;
+      const T Alpha = -T(0.5) * Tau * Dot(pOut, pVec, nLen);
+      for (size_t i = 0; i < nLen; ++i)
+        pOut[i] += Alpha * pVec[i];
+    }
+
+    const size_t nNext = k0 + nPanel, nRest = nSize - nNext;
+    ScratchBuffer<T> Left(nRest * 2 * nPanel);
+    TransposeBlocked(nPanel, nRest, pV + nNext, nSize, Left.Data(), 2 * nPanel, Params);
+    TransposeBlocked(nPanel, nRest, pW + nNext, nSize, Left.Data() + nPanel, 2 * nPanel, Params);
+    GemmFused(nRest, nRest, 2 * nPanel, T(-1), Left.Data(), 2 * nPanel, pW + nNext, nSize, T(1),
+              pA + nNext * nSize + nNext, nSize, MtxEpilogue<T>(), Params);
+  }
+  pD[nSize - 1] = pA[(nSize - 1) * nSize + nSize - 1];
+  pE[nSize - 1] = T(0);
+  pTau[nSize - 1] = T(0);
+}
+
+/**
+ * @brief X = X * H(nReflectors - 1) * ... * H(0), H(k) = I - pTau[k] * v(k) * v(k)^T: maps vectors
+ * (rows of X) through the reflectors of a Householder reduction, e.g. the eigenvectors of the
+ * tridiagonal of Tridiagonalize to those of A.
+ *
+ * v(k) is zero before a unit value at k + nShift, its next values are pY[k * nLdY + i * nIncY].
+ * Blocks of Params.nLUBlock reflectors are applied at once in their compact WY form
+ * I - Y * F * Y^T (LAPACK larft/larfb), two GEMMs per block.
+ *
+ * @tparam T
+ * @param pY reflectors, e.g. Tridiagonalize: pA, nLdY = nSize, nIncY = 1, nShift = 1.
+ * @param nLdY elements between the storage of consecutive reflectors.
+ * @param nIncY elements between consecutive values of a reflector.
+ * @param nShift
+ * @param nReflectors nReflectors + nShift <= nSize.
+ * @param pTau
+ * @param pX nRows x nSize row major array.
+ * @param nRows
+ * @param nSize
+ * @param Params block size and threads.
+ */
+template <typename T>
+void ApplyReflectors(const T *pY, size_t nLdY, size_t nIncY, size_t nShift, size_t nReflectors,
+                     const T *pTau, T *pX, size_t nRows, size_t nSize,
+                     const MtxTuningParams &Params) {
+  const size_t nBlock = std::max<size_t>(Params.nLUBlock, 1);
+  // Last block first, the block starts are multiples of nBlock.
+  for (size_t nEnd = nReflectors; nEnd > 0;) {
+    const size_t k0 = (nEnd - 1) / nBlock * nBlock, nCount = nEnd - k0;
+    const size_t nOffset = k0 + nShift, nLen = nSize - nOffset;
+
+    // Y^T: one reflector per row, zero before its unit value.
+    ScratchBuffer<T> Yt(nCount * nLen);
+    for (size_t c = 0; c < nCount; ++c) {
+      T *pRow = Yt.Data() + c * nLen;
+      const T *pSource = pY + (k0 + c) * nLdY;
+      std::fill(pRow, pRow + c, T(0));
+      pRow[c] = T(1);
+      for (size_t i = c + 1; i < nLen; ++i)
+        pRow[i] = pSource[(nOffset + i) * nIncY];
+    }
+    ScratchBuffer<T> Y(nLen * nCount);
+    TransposeBlocked(nCount, nLen, Yt.Data(), nLen, Y.Data(), nCount, Params);
+
+    // Upper triangular F of H(k0) * ... * H(k0 + nCount - 1) = I - Y * F * Y^T.
+    ScratchBuffer<T> F(nCount * nCount), Column(nCount);
+    std::fill(F.Data(), F.Data() + nCount * nCount, T(0));
+    for (size_t i = 0; i < nCount; ++i) {
+      const T Tau = pTau[k0 + i];
+      for (size_t r = 0; r < i; ++r)
+        Column[r] = -Tau * Dot(Yt.Data() + r * nLen + i, Yt.Data() + i * nLen + i, nLen - i);
+      for (size_t r = 0; r < i; ++r) {
+        T Value = T(0);
+        for (size_t s = r; s < i; ++s)
+          Value += F[r * nCount + s] * Column[s];
+        F[r * nCount + i] = Value;
+      }
+      F[i * nCount + i] = Tau;
+    }
+
+    // X -= X * Y * F^T * Y^T.
+    ScratchBuffer<T> XY(nRows * nCount), XYF(nRows * nCount);
+    GemmFused(nRows, nCount, nLen, T(1), pX + nOffset, nSize, Y.Data(), nCount, T(0), XY.Data(),
+              nCount, MtxEpilogue<T>(), Params);
+    for (size_t r = 0; r < nRows; ++r)
+      for (size_t c = 0; c < nCount; ++c) {
+        T Value = T(0);
+        for (size_t s = c; s < nCount; ++s)
+          Value += XY[r * nCount + s] * F[c * nCount + s];
+        XYF[r * nCount + c] = Value;
+      }
+    GemmFused(nRows, nLen, nCount, T(-1), XYF.Data(), nCount, Yt.Data(), nLen, T(1),
+              pX + nOffset, nSize, MtxEpilogue<T>(), Params);
+    nEnd = k0;
+  }
+}
+
+/**
+ * @brief Eigenvalues (and eigenvectors) of the nSize x nSize tridiagonal (pD, pE) by implicit QL
+ * iterations with Wilkinson shifts (EISPACK tql2).
+ *
+ * @tparam T
+ * @param pD diagonal, overwritten with the eigenvalues (unordered).
+ * @param pE off-diagonal (nSize values, the last one is ignored), destroyed.
+ * @param nSize
+ * @param pZ nullptr or nSize x nSize row major array, the rotations are applied to its rows (pass
+ * the identity to get the eigenvectors, row i for pD[i]).
+ * @param nLdZ elements between consecutive rows of pZ.
+ * @return false if an eigenvalue did not converge.
+ */
+template <typename T>
+auto TridiagonalQL(T *pD, T *pE, size_t nSize, T *pZ, size_t nLdZ) -> bool {
+  if (nSize == 0)
+    return true;
+  const T Eps = std::numeric_limits<T>::epsilon();
+  pE[nSize - 1] = T(0);
+  for (size_t l = 0; l < nSize; ++l)
+    for (size_t nIter = 0;; ++nIter) {
+      // Smallest m >= l with a negligible pE[m]: [l, m] is an unreduced block.
+      size_t m = l;
+      for (; m + 1 < nSize; ++m)
+        if (std::abs(pE[m]) <= Eps * (std::abs(pD[m]) + std::abs(pD[m + 1])))
+          break;
+      if (m == l)
+        break;
+      if (nIter == nQLMaxIterations)
+        return false;
+
+      T g = (pD[l + 1] - pD[l]) / (T(2) * pE[l]);
+      T r = std::hypot(g, T(1));
+      g = pD[m] - pD[l] + pE[l] / (g + std::copysign(r, g));
+      T s = T(1), c = T(1), p = T(0);
+      bool bSplit = false;
+      for (size_t i = m; i-- > l;) {
+        const T f = s * pE[i], b = c * pE[i];
+        r = std::hypot(f, g);
+        pE[i + 1] = r;
+        if (r == T(0)) {
+          // Underflow: the block splits, start again.
+          pD[i + 1] -= p;
+          pE[m] = T(0);
+          bSplit = true;
+          break;
+        }
+        s = f / r;
+        c = g / r;
+        g = pD[i + 1] - p;
+        r = (pD[i] - g) * s + T(2) * c * b;
+        p = s * r;
+        pD[i + 1] = g + p;
+        g = c * r - b;
+        if (pZ != nullptr) {
+          T *pRow = pZ + i * nLdZ, *pNext = pRow + nLdZ;
+          for (size_t k = 0; k < nSize; ++k) {
+            const T Value = pNext[k];
+            pNext[k] = s * pRow[k] + c * Value;
+            pRow[k] = c * pRow[k] - s * Value;
+          }
+        }
+      }
+      if (bSplit)
+        continue;
+      pD[l] -= p;
+      pE[l] = g;
+      pE[m] = T(0);
+    }
+  return true;
+}
+
+/**
+ * @brief Root j of the secular equation 1 + Rho * sum(z[i]^2 / (d[i] - x)) = 0, pD increasing,
+ * Rho > 0: the j-th eigenvalue of diag(d) + Rho * z * z^T.
+ *
+ * The root is searched as an offset from the closest pole, so the differences d[i] - x keep their
+ * accuracy. Each step solves a model with the two poles around the root (LAPACK laed4 "middle
+ * way"), falling back to bisection when it leaves the bracket.
+ *
+ * @tparam T
+ * @param pD
+ * @param pZ
+ * @param nSize
+ * @param Rho
+ * @param j
+ * @param pDelta d[i] - x (nSize values).
+ * @return T the root x.
+ */
+template <typename T>
+auto SecularRoot(const T *pD, const T *pZ, size_t nSize, T Rho, size_t j, T *pDelta) -> T {
+  const T Eps = std::numeric_limits<T>::epsilon();
+  const bool bLast = j + 1 == nSize;
+  size_t nOrigin = j;
+  T Lo = T(0), Hi = T(0);
+  if (bLast)
+    Hi = Rho * Dot(pZ, pZ, nSize);
+  else {
+    // The sign at the middle of (d[j], d[j + 1]) tells which pole is closer.
+    const T Half = (pD[j + 1] - pD[j]) / T(2);
+    T Value = T(1);
+    for (size_t i = 0; i < nSize; ++i)
+      Value += Rho * pZ[i] * pZ[i] / ((pD[i] - pD[j]) - Half);
+    if (Value >= T(0))
+      Hi = Half;
+    else {
+      nOrigin = j + 1;
+      Lo = -Half;
+    }
+  }
+  const T Origin = pD[nOrigin];
+  for (size_t i = 0; i < nSize; ++i)
+    pDelta[i] = pD[i] - Origin;
+
+  T Tau = (Lo + Hi) / T(2);
+  for (size_t nIter = 0; nIter < nSecularMaxIterations; ++nIter) {
+    // Terms of the poles left (Psi) and right (Phi) of the root, and their derivatives.
+    T Psi = T(0), dPsi = T(0), Phi = T(0), dPhi = T(0);
+    for (size_t i = 0; i < nSize; ++i) {
+      const T Delta = pDelta[i] - Tau;
+      const T Term = Rho * pZ[i] * pZ[i] / Delta;
+      if (i <= j) {
+        Psi += Term;
+        dPsi += Term / Delta;
+      } else {
+        Phi += Term;
+        dPhi += Term / Delta;
+      }
+    }
+    const T Value = T(1) + Psi + Phi;
+    if (std::abs(Value) <= T(8) * Eps * (T(1) + Phi - Psi) * static_cast<T>(nSize))
+      break;
+    (Value < T(0) ? Lo : Hi) = Tau;
+    if (Hi - Lo <= T(2) * Eps * std::max(std::abs(Lo), std::abs(Hi)))
+      break;
+
+    // Zero of Value + s / (DeltaL - Eta) + S / (DeltaR - Eta) - s / DeltaL - S / DeltaR, the
+    // model matching the value and derivative of the equation at Tau.
+    const T DeltaL = pDelta[j] - Tau, SL = dPsi * DeltaL * DeltaL;
+    T Eta;
+    if (bLast) {
+      const T C = Value - SL / DeltaL;
+      Eta = DeltaL + SL / C;
+    } else {
+      const T DeltaR = pDelta[j + 1] - Tau, SR = dPhi * DeltaR * DeltaR;
+      const T C = Value - SL / DeltaL - SR / DeltaR;
+      const T B = -(C * (DeltaL + DeltaR) + SL + SR);
+      const T A = C * DeltaL * DeltaR + SL * DeltaR + SR * DeltaL;
+      if (C == T(0))
+        Eta = -A / B;
+      else {
+        const T Q = -(B + std::copysign(std::sqrt(std::max(B * B - T(4) * C * A, T(0))), B)) / 2;
+        Eta = Q / C;
+        if (!(Eta > DeltaL && Eta < DeltaR) && Q != T(0))
+          Eta = A / Q;
+      }
+    }
+    T Next = Tau + Eta;
+    if (!(Next > Lo && Next < Hi))
+      Next = (Lo + Hi) / T(2);
+    if (Next == Tau)
+      break;
+    Tau = Next;
+  }
+  for (size_t i = 0; i < nSize; ++i)
+    pDelta[i] -= Tau;
+  return Origin + Tau;
+}
+
+/**
+ * @brief Eigenpairs of diag(pD) + Rho * z * z^T, Rho >= 0 (LAPACK laed2/laed3).
+ *
+ * Components of z that are negligible, and pairs of (nearly) equal values of pD, are deflated:
+ * their eigenpairs are (rotated) values of pD and unit vectors. The others are the roots of the
+ * secular equation, solved in parallel above Params.nParallelThreshold. Their eigenvectors are
+ * built from a z recomputed from the roots (Gu and Eisenstat), so they are orthogonal to working
+ * precision even for close roots.
+ *
+ * @tparam T
+ * @param pD nSize values.
+ * @param pZ nSize values, destroyed.
+ * @param Rho
+ * @param nSize
+ * @param pLambda eigenvalues (nSize values, unordered).
+ * @param pU nSize x nSize row major array, row i is the eigenvector of pLambda[i].
+ * @param Params threads.
+ */
+template <typename T>
+void RankOneEigen(const T *pD, T *pZ, T Rho, size_t nSize, T *pLambda, T *pU,
+                  const MtxTuningParams &Params) {
+  struct Rotation {
+    size_t nFirst, nSecond;
+    T C, S;
+  };
+  const T Eps = std::numeric_limits<T>::epsilon();
+  const T Norm = std::sqrt(Dot(pZ, pZ, nSize));
+  if (Norm > T(0)) {
+    for (size_t i = 0; i < nSize; ++i)
+      pZ[i] /= Norm;
+    Rho *= Norm * Norm;
+  }
+
+  ScratchBuffer<size_t> Order(nSize);
+  std::iota(Order.Data(), Order.Data() + nSize, size_t(0));
+  std::sort(Order.Data(), Order.Data() + nSize, [pD](size_t a, size_t b) { return pD[a] < pD[b]; });
+  ScratchBuffer<T> D(nSize), Z(nSize);
+  T MaxD = T(0);
+  for (size_t k = 0; k < nSize; ++k) {
+    D[k] = pD[Order[k]];
+    Z[k] = pZ[Order[k]];
+    MaxD = std::max(MaxD, std::abs(D[k]));
+  }
+  const T Tolerance = T(8) * Eps * std::max(MaxD, Rho);
+
+  // Deflation, in increasing order of D. nPrevious is the last candidate kept.
+  ScratchBuffer<size_t> Kept(nSize), Deflated(nSize);
+  ScratchBuffer<Rotation> Rotations(nSize);
+  size_t nKept = 0, nDeflated = 0, nRotations = 0, nPrevious = nSize;
+  for (size_t k = 0; k < nSize; ++k) {
+    if (Rho * std::abs(Z[k]) <= Tolerance) {
+      Deflated[nDeflated++] = k;
+      continue;
+    }
+    if (nPrevious != nSize) {
+      // Rotation in the (nPrevious, k) plane that zeroes Z[nPrevious].
+      const T Radius = std::hypot(Z[nPrevious], Z[k]);
+      const T C = Z[k] / Radius, S = -Z[nPrevious] / Radius;
+      if (std::abs((D[k] - D[nPrevious]) * C * S) <= Tolerance) {
+        Z[k] = Radius;
+        Z[nPrevious] = T(0);
+        const T Value = D[nPrevious] * C * C + D[k] * S * S;
+        D[k] = D[nPrevious] * S * S + D[k] * C * C;
+        D[nPrevious] = Value;
+        Rotations[nRotations++] = {Order[nPrevious], Order[k], C, S};
+        Deflated[nDeflated++] = nPrevious;
+      } else
+        Kept[nKept++] = nPrevious;
+    }
+    nPrevious = k;
+  }
+  if (nPrevious != nSize)
+    Kept[nKept++] = nPrevious;
+
+  std::fill(pU, pU + nSize * nSize, T(0));
+  const size_t nThreads =
+      nKept * nKept >= Params.nParallelThreshold ? ThreadCount(Params.nThreads) : 1;
+  if (nKept > 0) {
+    ScratchBuffer<T> KeptD(nKept), KeptZ(nKept), Delta(nKept * nKept), Zhat(nKept);
+    for (size_t i = 0; i < nKept; ++i) {
+      KeptD[i] = D[Kept[i]];
+      KeptZ[i] = Z[Kept[i]];
+    }
+    ParallelFor(nKept, nThreads, [&](size_t nBegin, size_t nEnd) {
+      for (size_t j = nBegin; j < nEnd; ++j)
+        pLambda[j] =
+            SecularRoot(KeptD.Data(), KeptZ.Data(), nKept, Rho, j, Delta.Data() + j * nKept);
+    });
+    // z[i]^2 = (x[last] - d[i]) / Rho * prod((x[j] - d[i]) / (d[j(+1)] - d[i])), the factors are
+    // positive by interlacing.
+    ParallelFor(nKept, nThreads, [&](size_t nBegin, size_t nEnd) {
+      for (size_t i = nBegin; i < nEnd; ++i) {
+        T Product = -Delta[(nKept - 1) * nKept + i] / Rho;
+        for (size_t j = 0; j + 1 < nKept; ++j)
+          Product *= -Delta[j * nKept + i] / (KeptD[j < i ? j : j + 1] - KeptD[i]);
+        Zhat[i] = std::copysign(std::sqrt(std::max(Product, T(0))), KeptZ[i]);
+      }
+    });
+    ParallelFor(nKept, nThreads, [&](size_t nBegin, size_t nEnd) {
+      for (size_t j = nBegin; j < nEnd; ++j) {
+        T *pRow = pU + j * nSize;
+        T SumSquares = T(0);
+        for (size_t i = 0; i < nKept; ++i) {
+          const T Value = Zhat[i] / Delta[j * nKept + i];
+          pRow[Order[Kept[i]]] = Value;
+          SumSquares += Value * Value;
+        }
+        const T InvNorm = T(1) / std::sqrt(SumSquares);
+        for (size_t i = 0; i < nKept; ++i)
+          pRow[Order[Kept[i]]] *= InvNorm;
+      }
+    });
+  }
+  for (size_t i = 0; i < nDeflated; ++i) {
+    pLambda[nKept + i] = D[Deflated[i]];
+    pU[(nKept + i) * nSize + Order[Deflated[i]]] = T(1);
+  }
+
+  // Back to the coordinates of pD, last rotation first.
+  if (nRotations > 0)
+    ParallelFor(nSize, nThreads, [&](size_t nBegin, size_t nEnd) {
+      for (size_t j = nBegin; j < nEnd; ++j) {
+        T *pRow = pU + j * nSize;
+        for (size_t r = nRotations; r-- > 0;) {
+          const Rotation &Current = Rotations[r];
+          const T a = pRow[Current.nFirst], b = pRow[Current.nSecond];
+          pRow[Current.nFirst] = Current.C * a - Current.S * b;
+          pRow[Current.nSecond] = Current.S * a + Current.C * b;
+        }
+      }
+    });
+}
+
+/**
+ * @brief Eigenpairs of the nSize x nSize tridiagonal (pD, pE) by divide and conquer (Cuppen,
+ * LAPACK stedc).
+ *
+ * T is split in two halves coupled by a rank one term, each half is solved recursively and the
+ * eigenpairs of T follow from a rank one update of their eigenvalues (RankOneEigen). The
+ * eigenvectors are then the products of those of the update by those of the halves, two GEMMs per
+ * merge which hold most of the flops. Tridiagonals up to nDivideMin are solved by TridiagonalQL.
+ *
+ * @tparam T
+ * @param pD diagonal, overwritten with the eigenvalues (unordered).
+ * @param pE off-diagonal (nSize values, the last one is ignored), destroyed.
+ * @param nSize
+ * @param pQ nSize x nSize row major array, row i is set to the eigenvector of pD[i].
+ * @param nLdQ elements between consecutive rows of pQ.
+ * @param Params block sizes and threads of the GEMMs.
+ * @return false if an eigenvalue did not converge.
+ */
+template <typename T>
+auto TridiagonalDivide(T *pD, T *pE, size_t nSize, T *pQ, size_t nLdQ,
+                       const MtxTuningParams &Params) -> bool {
+  if (nSize <= nDivideMin) {
+    for (size_t i = 0; i < nSize; ++i) {
+      std::fill(pQ + i * nLdQ, pQ + i * nLdQ + nSize, T(0));
+      pQ[i * nLdQ + i] = T(1);
+    }
+    return TridiagonalQL(pD, pE, nSize, pQ, nLdQ);
+  }
+
+  // T = diag(T1, T2) + Rho * u * u^T, u = e(m - 1) + sign(Rho) * e(m).
+  const size_t m = nSize / 2, nSecond = nSize - m;
+  const T Rho = std::abs(pE[m - 1]), Sign = std::copysign(T(1), pE[m - 1]);
+  pD[m - 1] -= Rho;
+  pD[m] -= Rho;
+  for (size_t i = 0; i < m; ++i)
+    std::fill(pQ + i * nLdQ + m, pQ + i * nLdQ + nSize, T(0));
+  for (size_t i = m; i < nSize; ++i)
+    std::fill(pQ + i * nLdQ, pQ + i * nLdQ + m, T(0));
+  T *pSecond = pQ + m * nLdQ + m;
+  if (!TridiagonalDivide(pD, pE, m, pQ, nLdQ, Params) ||
+      !TridiagonalDivide(pD + m, pE + m, nSecond, pSecond, nLdQ, Params))
+    return false;
+
+  // z = diag(Q1, Q2)^T * u: last components of the eigenvectors of T1, first ones of T2.
+  ScratchBuffer<T> Z(nSize), Lambda(nSize), U(nSize * nSize), Product(nSize * nSize);
+  for (size_t i = 0; i < m; ++i)
+    Z[i] = pQ[i * nLdQ + m - 1];
+  for (size_t i = 0; i < nSecond; ++i)
+    Z[m + i] = Sign * pSecond[i * nLdQ];
+  RankOneEigen(pD, Z.Data(), Rho, nSize, Lambda.Data(), U.Data(), Params);
+
+  GemmFused(nSize, m, m, T(1), U.Data(), nSize, pQ, nLdQ, T(0), Product.Data(), nSize,
+            MtxEpilogue<T>(), Params);
+  GemmFused(nSize, nSecond, nSecond, T(1), U.Data() + m, nSize, pSecond, nLdQ, T(0),
+            Product.Data() + m, nSize, MtxEpilogue<T>(), Params);
+  for (size_t i = 0; i < nSize; ++i)
+    std::copy(Product.Data() + i * nSize, Product.Data() + (i + 1) * nSize, pQ + i * nLdQ);
+  std::copy(Lambda.Data(), Lambda.Data() + nSize, pD);
+  return true;
+}
+
+/**
+ * @brief Number of eigenvalues of the tridiagonal (pD, pE) smaller than x (Sturm sequence).
+ *
+ * @tparam T
+ * @param pD
+ * @param pE
+ * @param nSize
+ * @param x
+ * @param PivMin smallest pivot magnitude allowed.
+ * @return size_t
+ */
+template <typename T>
+auto SturmCount(const T *pD, const T *pE, size_t nSize, T x, T PivMin) -> size_t {
+  size_t nCount = 0;
+  T q = T(1);
+  for (size_t i = 0; i < nSize; ++i) {
+    q = pD[i] - x - (i > 0 ? pE[i - 1] * pE[i - 1] / q : T(0));
+    if (std::abs(q) < PivMin)
+      q = -PivMin;
+    nCount += q < T(0);
+  }
+  return nCount;
+}
+
+/**
+ * @brief The nCount largest eigenpairs of the nSize x nSize tridiagonal (pD, pE): eigenvalues by
+ * bisection (in parallel above Params.nParallelThreshold), eigenvectors by inverse iteration,
+ * reorthogonalized within clusters of close eigenvalues (LAPACK stebz/stein).
+ *
+ * Costs O(nSize * nCount) instead of the O(nSize^3) of TridiagonalDivide.
+ *
+ * @tparam T
+ * @param pD
+ * @param pE off-diagonal (nSize - 1 values).
+ * @param nSize
+ * @param nCount
+ * @param pLambda eigenvalues, largest first (nCount values).
+ * @param pZ nCount x nSize row major array, row i is the eigenvector of pLambda[i].
+ * @param Params threads.
+ */
+template <typename T>
+void TridiagonalSelect(const T *pD, const T *pE, size_t nSize, size_t nCount, T *pLambda, T *pZ,
+                       const MtxTuningParams &Params) {
+  const T Eps = std::numeric_limits<T>::epsilon();
+  // Gershgorin bounds.
+  T Lower = std::numeric_limits<T>::max(), Upper = std::numeric_limits<T>::lowest();
+  T MaxSquare = T(1);
+  for (size_t i = 0; i < nSize; ++i) {
+    const T Radius =
+        (i > 0 ? std::abs(pE[i - 1]) : T(0)) + (i + 1 < nSize ? std::abs(pE[i]) : T(0));
+    Lower = std::min(Lower, pD[i] - Radius);
+    Upper = std::max(Upper, pD[i] + Radius);
+    if (i + 1 < nSize)
+      MaxSquare = std::max(MaxSquare, pE[i] * pE[i]);
+  }
+  const T Norm = std::max({std::abs(Lower), std::abs(Upper), std::numeric_limits<T>::min()});
+  const T PivMin = std::numeric_limits<T>::min() * MaxSquare;
+
+  const size_t nThreads =
+      nSize * nCount >= Params.nParallelThreshold ? ThreadCount(Params.nThreads) : 1;
+  ParallelFor(nCount, nThreads, [&](size_t nBegin, size_t nEnd) {
+    for (size_t r = nBegin; r < nEnd; ++r) {
+      // Eigenvalue nSize - 1 - r in increasing order.
+      T Lo = Lower, Hi = Upper;
+      while (Hi - Lo > T(2) * Eps * std::max(std::abs(Lo), std::abs(Hi)) + PivMin) {
+        const T Middle = Lo + (Hi - Lo) / T(2);
+        if (Middle <= Lo || Middle >= Hi)
+          break;
+        (SturmCount(pD, pE, nSize, Middle, PivMin) > nSize - 1 - r ? Hi : Lo) = Middle;
+      }
+      pLambda[r] = Lo + (Hi - Lo) / T(2);
+    }
+  });
+
+  // LU with partial pivoting of T - x * I: diagonal, two superdiagonals and multipliers.
+  ScratchBuffer<T> Diag(nSize), Upper1(nSize), Upper2(nSize), Lower1(nSize);
+  ScratchBuffer<unsigned char> Swapped(nSize);
+  const T MinPivot = Eps * Norm, Cluster = T(1e-3) * Norm;
+  size_t nClusterBegin = 0;
+  for (size_t r = 0; r < nCount; ++r) {
+    for (size_t i = 0; i < nSize; ++i) {
+      Diag[i] = pD[i] - pLambda[r];
+      Upper1[i] = i + 1 < nSize ? pE[i] : T(0);
+      Upper2[i] = T(0);
+      Lower1[i] = i + 1 < nSize ? pE[i] : T(0);
+    }
+    for (size_t i = 0; i + 1 < nSize; ++i) {
+      Swapped[i] = std::abs(Diag[i]) < std::abs(Lower1[i]);
+      if (Swapped[i]) {
+        const T Factor = Diag[i] / Lower1[i];
+        Diag[i] = Lower1[i];
+        Lower1[i] = Factor;
+        const T Value = Upper1[i];
+        Upper1[i] = Diag[i + 1];
+        Diag[i + 1] = Value - Factor * Diag[i + 1];
+        Upper2[i] = Upper1[i + 1];
+        Upper1[i + 1] *= -Factor;
+      } else {
+        if (std::abs(Diag[i]) < MinPivot)
+          Diag[i] = std::copysign(MinPivot, Diag[i]);
+        Lower1[i] /= Diag[i];
+        Diag[i + 1] -= Lower1[i] * Upper1[i];
+      }
+    }
+    if (std::abs(Diag[nSize - 1]) < MinPivot)
+      Diag[nSize - 1] = std::copysign(MinPivot, Diag[nSize - 1]);
+
+    if (r > 0 && pLambda[r - 1] - pLambda[r] > Cluster)
+      nClusterBegin = r;
+    T *pX = pZ + r * nSize;
+    // Deterministic start vector with no special direction.
+    for (size_t i = 0; i < nSize; ++i)
+      pX[i] = T(1) + static_cast<T>((i * 2654435761u + r * 40503u) % 1021u) / T(1021);
+    for (size_t nIter = 0; nIter <= nInverseIterations; ++nIter) {
+      for (size_t p = nClusterBegin; p < r; ++p) {
+        const T *pOther = pZ + p * nSize;
+        const T Projection = Dot(pX, pOther, nSize);
+        for (size_t i = 0; i < nSize; ++i)
+          pX[i] -= Projection * pOther[i];
+      }
+      const T InvNorm = T(1) / std::sqrt(Dot(pX, pX, nSize));
+      for (size_t i = 0; i < nSize; ++i)
+        pX[i] *= InvNorm;
+      if (nIter == nInverseIterations)
+        break;
+      // Solve (T - x * I) * y = x.
+      for (size_t i = 0; i + 1 < nSize; ++i) {
+        if (Swapped[i])
+          std::swap(pX[i], pX[i + 1]);
+        pX[i + 1] -= Lower1[i] * pX[i];
+      }
+      for (size_t i = nSize; i-- > 0;) {
+        T Value = pX[i];
+        if (i + 1 < nSize)
+          Value -= Upper1[i] * pX[i + 1];
+        if (i + 2 < nSize)
+          Value -= Upper2[i] * pX[i + 2];
+        pX[i] = Value / Diag[i];
+      }
+    }
+  }
+}
+}; // namespace Mafs::Internal::Kernels
+
+#endif // MAFS_MATRIX_KERNELS_EIGEN_H
@@ -0,0 +1,265 @@
+#ifndef MAFS_MATRIX_KERNELS_GEMM_H
+#define MAFS_MATRIX_KERNELS_GEMM_H
+
+#include <Mafs/Matrix/MatrixDataTypes.hpp>
+#include <Mafs/Matrix/Operations/Kernels/Parallel.hpp>
+#include <Mafs/Utils/Workspace.hpp>
+#include <algorithm>
+#include <stddef.h>
+#include <type_traits>
+
+namespace Mafs::Internal::Kernels {
+
+/**
+ * @brief Row major matrix product: C += Alpha * A * B.
+ *
+ * A is nM x nK, B is nK x nN and C is nM x nN, nLdA/nLdB/nLdC are the number of elements between
+ * consecutive rows. The i-k-j loop order streams rows of B and C so the inner loop vectorizes.
+ *
+ * @tparam T
+ * @param nM
+ * @param nN
+ * @param nK
+ * @param Alpha
+ * @param pA
+ * @param nLdA
+ * @param pB
+ * @param nLdB
+ * @param pC
+ * @param nLdC
+ */
+template <typename T>
+void Gemm(size_t nM, size_t nN, size_t nK, T Alpha, const T *pA, size_t nLdA, const T *pB,
+          size_t nLdB, T *pC, size_t nLdC) {
+  for (size_t i = 0; i < nM; ++i) {
+    T *pRowC = pC + i * nLdC;
+    for (size_t k = 0; k < nK; ++k) {
+      const T Factor = Alpha * pA[i * nLdA + k];
+      const T *pRowB = pB + k * nLdB;
+      for (size_t j = 0; j < nN; ++j)
+        pRowC[j] += Factor * pRowB[j];
+    }
+  }
+}
+
+/**
+ * @brief Cache blocked (and, above Params.nParallelThreshold flops, multithreaded)
+ * C = Function(Alpha * A * B + Beta * C + bias). Same layout as Gemm.
+ *
+ * C is split in nGemmBlockM x nGemmBlockN blocks and the inner dimension in nGemmBlockK steps, so
+ * the block of B being streamed stays in cache while it is reused by the rows of A. Each block of
+ * C is scaled by Beta before its first product and goes through the epilogue right after its last
+ * one, while it is still in cache, so neither costs an extra pass over C. The threads share the
+ * rows of blocks of C, they never write the same element.
+ *
+ * @see Gemm
+ * @param Beta 0 overwrites C (its previous values are never read, as in BLAS).
+ * @param Epilogue bias (nM or nN values) and element-wise function.
+ * @param Params block sizes and threads.
+ */
+template <typename T, typename Func>
+void GemmFused(size_t nM, size_t nN, size_t nK, T Alpha, const T *pA, size_t nLdA, const T *pB,
+               size_t nLdB, T Beta, T *pC, size_t nLdC, const MtxEpilogue<T, Func> &Epilogue,
+               const MtxTuningParams &Params) {
+  constexpr bool bFunction = !std::is_same_v<Func, MtxIdentity>;
+  const size_t nBlockM = std::max<size_t>(Params.nGemmBlockM, 1);
+  const size_t nBlockN = std::max<size_t>(Params.nGemmBlockN, 1);
+  const size_t nBlockK = std::max<size_t>(Params.nGemmBlockK, 1);
+  const double Flops = 2.0 * static_cast<double>(nM) * static_cast<double>(nN) *
+                       static_cast<double>(nK);
+  const size_t nThreads =
+      Flops >= static_cast<double>(Params.nParallelThreshold) ? ThreadCount(Params.nThreads) : 1;
+
+  auto RowBlocks = [&](size_t nBegin, size_t nEnd) {
+    for (size_t ii = nBegin * nBlockM; ii < std::min(nM, nEnd * nBlockM); ii += nBlockM)
+      for (size_t jj = 0; jj < nN; jj += nBlockN) {
+        const size_t nRows = std::min(nBlockM, nM - ii), nCols = std::min(nBlockN, nN - jj);
+        T *pBlock = pC + ii * nLdC + jj;
+        if (Beta == T(0))
+          for (size_t i = 0; i < nRows; ++i)
+            std::fill(pBlock + i * nLdC, pBlock + i * nLdC + nCols, T(0));
+        else if (Beta != T(1))
+          for (size_t i = 0; i < nRows; ++i)
+            for (size_t j = 0; j < nCols; ++j)
+              pBlock[i * nLdC + j] *= Beta;
+
+        for (size_t kk = 0; kk < nK; kk += nBlockK)
+          Gemm(nRows, nCols, std::min(nBlockK, nK - kk), Alpha, pA + ii * nLdA + kk, nLdA,
+               pB + kk * nLdB + jj, nLdB, pBlock, nLdC);
+
+        if (Epilogue.eBias == MtxNoBias && !bFunction)
+          continue;
+        for (size_t i = 0; i < nRows; ++i) {
+          T *pRow = pBlock + i * nLdC;
+          const T RowBias = Epilogue.eBias == MtxRowBias ? Epilogue.pBias[ii + i] : T(0);
+          for (size_t j = 0; j < nCols; ++j) {
+            T Value = pRow[j] + RowBias;
+            if (Epilogue.eBias == MtxColBias)
+              Value += Epilogue.pBias[jj + j];
+            if constexpr (bFunction)
+              Value = Epilogue.Function(Value);
+            pRow[j] = Value;
+          }
+        }
+      }
+  };
+  // Each row block of C is computed on the node owning it.
+  ParallelFor((nM + nBlockM - 1) / nBlockM, nThreads, RowBlocks, pC, nBlockM * nLdC * sizeof(T));
+}
+
+/**
+ * @brief Cache blocked (and, above Params.nParallelThreshold flops, multithreaded) C += Alpha * A *
+ * B. Same layout as Gemm.
+ *
+ * @see GemmFused
+ * @param Params block sizes and threads.
+ */
+template <typename T>
+void GemmBlocked(size_t nM, size_t nN, size_t nK, T Alpha, const T *pA, size_t nLdA, const T *pB,
+                 size_t nLdB, T *pC, size_t nLdC, const MtxTuningParams &Params) {
+  GemmFused(nM, nN, nK, Alpha, pA, nLdA, pB, nLdB, T(1), pC, nLdC, MtxEpilogue<T>(), Params);
+}
+
+/**
+ * @brief Cache blocked (and, above Params.nParallelThreshold flops, multithreaded) symmetric rank
+ * k update: C = Alpha * A * A^T + Beta * C.
+ *
+ * A is nN x nK with A[i][k] = pA[i * nRowStrideA + k * nColStrideA], so A^T * A of a stored matrix
+ * is read in place (swap the strides). C is nN x nN (row major, nLdC). Only the blocks of the
+ * lower triangle are computed, half the flops of the product, and each of them is mirrored into
+ * the upper triangle right after by the thread that computed it. With Beta != 0 only the lower
+ * triangle of C is read (C is assumed symmetric).
+ * The rows of blocks are dealt to the threads in pairs (first, last, second, second to last...),
+ * so every thread gets the same share of the triangle.
+ * The kernel streams rows of A^T: they are read in place when A is stored by cols
+ * (nRowStrideA == 1), otherwise each nGemmBlockK x nGemmBlockN panel is transposed into a scratch
+ * buffer first (an extra 1 / nGemmBlockM of the work, the whole A^T is never built).
+ *
+ * @param nN
+ * @param nK
+ * @param Alpha
+ * @param pA
+ * @param nRowStrideA
+ * @param nColStrideA
+ * @param Beta 0 overwrites C (its previous values are never read).
+ * @param pC
+ * @param nLdC
+ * @param Params block sizes and threads.
+ */
+template <typename T>
+void Syrk(size_t nN, size_t nK, T Alpha, const T *pA, size_t nRowStrideA, size_t nColStrideA,
+          T Beta, T *pC, size_t nLdC, const MtxTuningParams &Params) {
+  const size_t nBlockM = std::max<size_t>(Params.nGemmBlockM, 1);
+  const size_t nBlockN = std::max<size_t>(Params.nGemmBlockN, 1);
+  const size_t nBlockK = std::max<size_t>(Params.nGemmBlockK, 1);
+  const double Flops = static_cast<double>(nN) * static_cast<double>(nN + 1) *
+                       static_cast<double>(nK);
+  const size_t nThreads =
+      Flops >= static_cast<double>(Params.nParallelThreshold) ? ThreadCount(Params.nThreads) : 1;
+  const bool bPack = nRowStrideA != 1;
+  const size_t nRowBlocks = (nN + nBlockM - 1) / nBlockM;
+
+  ParallelFor(nRowBlocks, nThreads, [&](size_t nBegin, size_t nEnd) {
+    ScratchBuffer<T> Panel(bPack ? std::min(nBlockK, nK) * std::min(nBlockN, nN) : 0);
+    for (size_t t = nBegin; t < nEnd; ++t) {
+      const size_t ii = (t % 2 == 0 ? t / 2 : nRowBlocks - 1 - t / 2) * nBlockM;
+      const size_t nRows = std::min(nBlockM, nN - ii);
+      for (size_t jj = 0; jj < ii + nRows; jj += nBlockN) {
+        const size_t nCols = std::min({nBlockN, nN - jj, ii + nRows - jj});
+        T *pBlock = pC + ii * nLdC + jj;
+        // Cols of row i of the block in the lower triangle (global col <= global row).
+        auto RowCols = [&](size_t i) {
+          return ii + i < jj ? size_t(0) : std::min(nCols, ii + i + 1 - jj);
+        };
+        for (size_t i = 0; i < nRows; ++i) {
+          T *pRow = pBlock + i * nLdC;
+          if (Beta == T(0))
+            std::fill(pRow, pRow + RowCols(i), T(0));
+          else if (Beta != T(1))
+            for (size_t j = 0; j < RowCols(i); ++j)
+              pRow[j] *= Beta;
+        }
+
+        for (size_t kk = 0; kk < nK; kk += nBlockK) {
+          const size_t nDepth = std::min(nBlockK, nK - kk);
+          // Rows of A^T (k, cols jj...): B[k][j] = A[jj + j][kk + k].
+          const T *pB = pA + jj * nRowStrideA + kk * nColStrideA;
+          size_t nLdB = nColStrideA;
+          if (bPack) {
+            for (size_t k = 0; k < nDepth; ++k)
+              for (size_t j = 0; j < nCols; ++j)
+                Panel[k * nCols + j] = pB[j * nRowStrideA + k * nColStrideA];
+            pB = Panel.Data();
+            nLdB = nCols;
+          }
+          for (size_t i = 0; i < nRows; ++i) {
+            T *pRow = pBlock + i * nLdC;
+            const T *pRowA = pA + (ii + i) * nRowStrideA + kk * nColStrideA;
+            const size_t nRowCols = RowCols(i);
+            for (size_t k = 0; k < nDepth; ++k) {
+              const T Factor = Alpha * pRowA[k * nColStrideA];
+              const T *pRowB = pB + k * nLdB;
+              for (size_t j = 0; j < nRowCols; ++j)
+                pRow[j] += Factor * pRowB[j];
+            }
+          }
+        }
+
+        // Mirror: C[jj + j][ii + i] = C[ii + i][jj + j].
+        for (size_t i = 0; i < nRows; ++i)
+          for (size_t j = 0; j < RowCols(i); ++j)
+            pC[(jj + j) * nLdC + ii + i] = pBlock[i * nLdC + j];
+      }
+    }
+  });
+}
+
+/**
+ * @brief Out of place transpose: B = A^T.
+ *
+ * A is nRows x nCols (row major, nLdA between rows), B is nCols x nRows (row major, nLdB).
+ *
+ * @tparam T
+ * @param nRows
+ * @param nCols
+ * @param pA
+ * @param nLdA
+ * @param pB
+ * @param nLdB
+ */
+template <typename T>
+void Transpose(size_t nRows, size_t nCols, const T *pA, size_t nLdA, T *pB, size_t nLdB) {
+  for (size_t i = 0; i < nRows; ++i)
+    for (size_t j = 0; j < nCols; ++j)
+      pB[j * nLdB + i] = pA[i * nLdA + j];
+}
+
+/**
+ * @brief Cache blocked (and, above Params.nParallelThreshold elements, multithreaded) transpose.
+ * Same layout as Transpose, the matrix is walked in nTransposeBlock square blocks so both the
+ * reads and the strided writes stay in cache.
+ *
+ * @see Transpose
+ * @param Params block size and threads.
+ */
+template <typename T>
+void TransposeBlocked(size_t nRows, size_t nCols, const T *pA, size_t nLdA, T *pB, size_t nLdB,
+                      const MtxTuningParams &Params) {
+  const size_t nBlock = std::max<size_t>(Params.nTransposeBlock, 1);
+  const size_t nThreads =
+      nRows * nCols >= Params.nParallelThreshold ? ThreadCount(Params.nThreads) : 1;
+
+  // Each row block of A is read on the node owning it.
+  ParallelFor(
+      (nRows + nBlock - 1) / nBlock, nThreads,
+      [&](size_t nBegin, size_t nEnd) {
+        for (size_t ii = nBegin * nBlock; ii < std::min(nRows, nEnd * nBlock); ii += nBlock)
+          for (size_t jj = 0; jj < nCols; jj += nBlock)
+            Transpose(std::min(nBlock, nRows - ii), std::min(nBlock, nCols - jj),
+                      pA + ii * nLdA + jj, nLdA, pB + jj * nLdB + ii, nLdB);
+      },
+      pA, nBlock * nLdA * sizeof(T));
+}
+}; // namespace Mafs::Internal::Kernels
+
+#endif // MAFS_MATRIX_KERNELS_GEMM_H
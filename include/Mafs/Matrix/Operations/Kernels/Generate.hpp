@@ -0,0 +1,216 @@
+#ifndef MAFS_MATRIX_KERNELS_GENERATE_H
+#define MAFS_MATRIX_KERNELS_GENERATE_H
+
+#include <Mafs/Matrix/MatrixDataTypes.hpp>
+#include <Mafs/Matrix/Operations/Kernels/Math.hpp>
+#include <Mafs/Matrix/Operations/Kernels/Parallel.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stddef.h>
+#include <stdint.h>
+#include <type_traits>
+
+/**
+ * Initialization kernels (constant, sequences and random values).
+ *
+ * Every value only depends on its index, never on the values before it, so the arrays are split
+ * among threads above Params.nParallelThreshold values and the results are the same for any
+ * thread count. The random values come from the Philox4x32-10 counter based generator (Salmon et
+ * al., "Parallel random numbers: as easy as 1, 2, 3"): value i is a function of (seed, i / 2).
+ */
+namespace Mafs::Internal::Kernels {
+/**
+ * @brief Threads used to initialize nCount values.
+ */
+inline auto GenerateThreads(size_t nCount, const MtxTuningParams &Params) -> size_t {
+  return nCount >= Params.nParallelThreshold ? ThreadCount(Params.nThreads) : 1;
+}
+
+/**
+ * @brief pOut[i] = Value for i in [0, nCount). Zero of trivially copyable types is a memset.
+ */
+template <typename T>
+void Fill(size_t nCount, T *pOut, const T &Value, const MtxTuningParams &Params) {
+  bool bZero = false;
+  if constexpr (std::is_trivially_copyable_v<T> && std::is_arithmetic_v<T>)
+    bZero = Value == T(0) && !std::signbit(static_cast<double>(Value));
+  ParallelFor(
+      nCount, GenerateThreads(nCount, Params),
+      [&](size_t nBegin, size_t nEnd) {
+        if (bZero)
+          std::memset(static_cast<void *>(pOut + nBegin), 0, sizeof(T) * (nEnd - nBegin));
+        else
+          std::fill(pOut + nBegin, pOut + nEnd, Value);
+      },
+      pOut, sizeof(T));
+}
+
+/**
+ * @brief pOut[i] = Function(i) for i in [0, nCount).
+ */
+template <typename T, typename Func>
+void Generate(size_t nCount, T *pOut, Func &Function, const MtxTuningParams &Params) {
+  ParallelFor(
+      nCount, GenerateThreads(nCount, Params),
+      [&](size_t nBegin, size_t nEnd) {
+        for (size_t i = nBegin; i < nEnd; ++i)
+          pOut[i] = Function(i);
+      },
+      pOut, sizeof(T));
+}
+
+/**
+ * @brief One Philox4x32 round followed by the key bump.
+ */
+inline void PhiloxRound(uint32_t &c0, uint32_t &c1, uint32_t &c2, uint32_t &c3, uint32_t &k0,
+                        uint32_t &k1) {
+  const uint64_t p0 = uint64_t(0xD2511F53) * c0, p1 = uint64_t(0xCD9E8D57) * c2;
+  c0 = uint32_t(p1 >> 32) ^ c1 ^ k0;
+  c2 = uint32_t(p0 >> 32) ^ c3 ^ k1;
+  c1 = uint32_t(p1);
+  c3 = uint32_t(p0);
+  k0 += 0x9E3779B9;
+  k1 += 0xBB67AE85;
+}
+
+/**
+ * @brief Philox4x32-10 block: 4 random words from a 128 bits counter and a 64 bits key. The
+ * rounds are written out (no loop), so a loop over blocks is vectorized.
+ *
+ * @param Counter
+ * @param Key
+ * @param Result
+ */
+inline void Philox4x32(const uint32_t (&Counter)[4], const uint32_t (&Key)[2],
+                       uint32_t (&Result)[4]) {
+  uint32_t c0 = Counter[0], c1 = Counter[1], c2 = Counter[2], c3 = Counter[3];
+  uint32_t k0 = Key[0], k1 = Key[1];
+  PhiloxRound(c0, c1, c2, c3, k0, k1);
+  PhiloxRound(c0, c1, c2, c3, k0, k1);
+  PhiloxRound(c0, c1, c2, c3, k0, k1);
+  PhiloxRound(c0, c1, c2, c3, k0, k1);
+  PhiloxRound(c0, c1, c2, c3, k0, k1);
+  PhiloxRound(c0, c1, c2, c3, k0, k1);
+  PhiloxRound(c0, c1, c2, c3, k0, k1);
+  PhiloxRound(c0, c1, c2, c3, k0, k1);
+  PhiloxRound(c0, c1, c2, c3, k0, k1);
+  PhiloxRound(c0, c1, c2, c3, k0, k1);
+  Result[0] = c0;
+  Result[1] = c1;
+  Result[2] = c2;
+  Result[3] = c3;
+}
+
+/**
+ * @brief Uniform double in [0, 1) from the 53 high bits of nBits.
+ */
+inline auto UnitInterval(uint64_t nBits) -> double {
+  return static_cast<double>(nBits >> 11) * 0x1.0p-53;
+}
+
+/**
+ * @brief Generates the 64 bits random values [0, nCount) of the stream nSeed (values 2k and 2k + 1
+ * come from the Philox block of counter k) by batches, calling Function(pValues, nOffset, nBegin,
+ * nEnd) for each: value i in [nBegin, nEnd) is pValues[i - nOffset], nOffset is even.
+ * The blocks of a batch are generated in a loop without dependencies, which the compiler
+ * vectorizes. pOut, the values written (of nUnitBytes each), places the threads (see ParallelFor).
+ */
+template <typename Func>
+void ForEachRandom(size_t nCount, uint64_t nSeed, Func Function, const MtxTuningParams &Params,
+                   const void *pOut, size_t nUnitBytes) {
+  constexpr size_t nBatch = 64; // Blocks per batch.
+  auto Chunk = [&](size_t nBegin, size_t nEnd) {
+    uint64_t Values[2 * nBatch];
+    const uint32_t Key[2] = {uint32_t(nSeed), uint32_t(nSeed >> 32)};
+    for (size_t nFirst = nBegin / 2; 2 * nFirst < nEnd; nFirst += nBatch) {
+      const size_t nBlocks = std::min(nBatch, (nEnd + 1) / 2 - nFirst);
+      for (size_t b = 0; b < nBlocks; ++b) {
+        const uint64_t nBlock = nFirst + b;
+        const uint32_t Counter[4] = {uint32_t(nBlock), uint32_t(nBlock >> 32), 0, 0};
+        uint32_t Words[4];
+        Philox4x32(Counter, Key, Words);
+        Values[2 * b] = (uint64_t(Words[1]) << 32) | Words[0];
+        Values[2 * b + 1] = (uint64_t(Words[3]) << 32) | Words[2];
+      }
+      const size_t nLow = std::max(nBegin, 2 * nFirst);
+      const size_t nHigh = std::min(nEnd, 2 * (nFirst + nBlocks));
+      Function(Values, 2 * nFirst, nLow, nHigh);
+    }
+  };
+  ParallelFor(nCount, GenerateThreads(nCount, Params), Chunk, pOut, nUnitBytes);
+}
+
+/**
+ * @brief Uniform values: [Low, High) for floating point types, [Low, High] for integers (modulo
+ * the range, whose bias is below 2^-32 for ranges under 2^32).
+ *
+ * @param nCount
+ * @param pOut
+ * @param Low
+ * @param High
+ * @param nSeed
+ * @param Params
+ */
+template <typename T>
+void RandomUniform(size_t nCount, T *pOut, T Low, T High, uint64_t nSeed,
+                   const MtxTuningParams &Params) {
+  static_assert(std::is_arithmetic_v<T>, "Random values require an arithmetic type");
+  auto Convert = [Low, High](uint64_t nBits) -> T {
+    if constexpr (std::is_floating_point_v<T>) {
+      // float uses 24 bits, so Low + Width * u never rounds up to High.
+      const double u = sizeof(T) < sizeof(double)
+                           ? static_cast<double>(nBits >> 40) * 0x1.0p-24
+                           : UnitInterval(nBits);
+      const T Value = static_cast<T>(Low + (High - Low) * u);
+      return Value < High ? Value : Low;
+    } else {
+      const uint64_t nRange = uint64_t(High) - uint64_t(Low) + 1;
+      return static_cast<T>(uint64_t(Low) + (nRange == 0 ? nBits : nBits % nRange));
+    }
+  };
+  ForEachRandom(
+      nCount, nSeed,
+      [pOut, &Convert](const uint64_t *pValues, size_t nOffset, size_t nBegin, size_t nEnd) {
+        for (size_t i = nBegin; i < nEnd; ++i)
+          pOut[i] = Convert(pValues[i - nOffset]);
+      },
+      Params, pOut, sizeof(T));
+}
+
+/**
+ * @brief Normal values of mean Mean and standard deviation StdDev (Box-Muller transform, each
+ * block gives the two values of a pair).
+ *
+ * @param nCount
+ * @param pOut
+ * @param Mean
+ * @param StdDev
+ * @param nSeed
+ * @param Params
+ */
+template <typename T>
+void RandomNormal(size_t nCount, T *pOut, T Mean, T StdDev, uint64_t nSeed,
+                  const MtxTuningParams &Params) {
+  static_assert(std::is_floating_point_v<T>, "Normal values require a floating point type");
+  constexpr double TwoPi = 6.283185307179586476925286766559;
+  ForEachRandom(
+      nCount, nSeed,
+      [=](const uint64_t *pValues, size_t nOffset, size_t nBegin, size_t nEnd) {
+        for (size_t i = nBegin - nBegin % 2; i < nEnd; i += 2) {
+          const uint64_t *pPair = pValues + (i - nOffset);
+          // u1 in (0, 1], so the log is finite.
+          const double u1 = static_cast<double>((pPair[0] >> 11) + 1) * 0x1.0p-53;
+          const double Radius = StdDev * std::sqrt(-2.0 * Log(u1));
+          const double Angle = TwoPi * UnitInterval(pPair[1]);
+          if (i >= nBegin)
+            pOut[i] = static_cast<T>(Mean + Radius * std::cos(Angle));
+          if (i + 1 < nEnd)
+            pOut[i + 1] = static_cast<T>(Mean + Radius * std::sin(Angle));
+        }
+      },
+      Params, pOut, sizeof(T));
+}
+}; // namespace Mafs::Internal::Kernels
+
+#endif // MAFS_MATRIX_KERNELS_GENERATE_H
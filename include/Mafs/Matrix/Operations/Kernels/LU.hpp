@@ -0,0 +1,222 @@
+#ifndef MAFS_MATRIX_KERNELS_LU_H
+#define MAFS_MATRIX_KERNELS_LU_H
+
+#include <Mafs/Matrix/Operations/Kernels/Gemm.hpp>
+#include <algorithm>
+#include <cmath>
+#include <stddef.h>
+
+namespace Mafs::Internal::Kernels {
+
+/**
+ * @brief In-place LU decomposition with partial pivoting of a nRows x nCols panel (nRows >= nCols,
+ * Doolittle, right-looking).
+ *
+ * pData is a row major array with nLd elements between consecutive rows. On return it holds L
+ * (unit diagonal, not stored) below the diagonal and U on and above it. pPivots[k] is the row
+ * (relative to the panel) swapped with row k at step k, rows are swapped across the whole panel.
+ *
+ * The update of the trailing matrix walks contiguous rows so the inner loop vectorizes.
+ *
+ * @tparam T
+ * @param pData
+ * @param nRows
+ * @param nCols
+ * @param nLd
+ * @param pPivots nCols entries.
+ * @return false if the panel is singular (a zero pivot was found), true otherwise.
+ */
+template <typename T>
+auto LUFactorPanel(T *pData, size_t nRows, size_t nCols, size_t nLd, size_t *pPivots) -> bool {
+  for (size_t k = 0; k < nCols; ++k) {
+    // Find the pivot row.
+    size_t nPivot = k;
+    T MaxValue = std::abs(pData[k * nLd + k]);
+    for (size_t i = k + 1; i < nRows; ++i) {
+      const T Value = std::abs(pData[i * nLd + k]);
+      if (Value > MaxValue) {
+        MaxValue = Value;
+        nPivot = i;
+      }
+    }
+
+    pPivots[k] = nPivot;
+    if (MaxValue == T(0) || !std::isfinite(MaxValue))
+      return false;
+
+    if (nPivot != k)
+      for (size_t j = 0; j < nCols; ++j) {
+        const T TmpValue = pData[k * nLd + j];
+        pData[k * nLd + j] = pData[nPivot * nLd + j];
+        pData[nPivot * nLd + j] = TmpValue;
+      }
+
+    // Eliminate below the pivot and update the trailing matrix.
+    const T *pRowK = pData + k * nLd;
+    const T InvPivot = T(1) / pRowK[k];
+    for (size_t i = k + 1; i < nRows; ++i) {
+      T *pRowI = pData + i * nLd;
+      const T Factor = pRowI[k] * InvPivot;
+      pRowI[k] = Factor;
+      for (size_t j = k + 1; j < nCols; ++j)
+        pRowI[j] -= Factor * pRowK[j];
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief In-place LU decomposition with partial pivoting of a nSize x nSize row major array.
+ *
+ * @see LUFactorPanel
+ * @tparam T
+ * @param pData
+ * @param nSize
+ * @param pPivots
+ * @return false if the matrix is singular (a zero pivot was found), true otherwise.
+ */
+template <typename T> auto LUFactor(T *pData, size_t nSize, size_t *pPivots) -> bool {
+  return LUFactorPanel(pData, nSize, nSize, nSize, pPivots);
+}
+
+/**
+ * @brief Solves L * X = B in place, L being unit lower triangular (nSize x nSize).
+ * B has nCols columns, both arrays are row major with nLdL/nLdB elements between rows.
+ *
+ * @tparam T
+ * @param pL
+ * @param nLdL
+ * @param nSize
+ * @param pB
+ * @param nLdB
+ * @param nCols
+ */
+template <typename T>
+void LowerUnitSolve(const T *pL, size_t nLdL, size_t nSize, T *pB, size_t nLdB, size_t nCols) {
+  for (size_t i = 1; i < nSize; ++i) {
+    T *pRowI = pB + i * nLdB;
+    for (size_t k = 0; k < i; ++k) {
+      const T Factor = pL[i * nLdL + k];
+      const T *pRowK = pB + k * nLdB;
+      for (size_t j = 0; j < nCols; ++j)
+        pRowI[j] -= Factor * pRowK[j];
+    }
+  }
+}
+
+/**
+ * @brief Blocked version of LUFactor (right-looking), same factors up to rounding.
+ *
+ * Each panel of Params.nLUBlock columns is factorized with LUFactorPanel, its row swaps are
+ * applied to the other columns, then the block row of U is solved and the trailing matrix is
+ * updated with GemmBlocked, which is where most of the flops go.
+ *
+ * @see LUFactor
+ * @param Params panel width, Gemm blocking and threads.
+ * @return false if the matrix is singular (a zero pivot was found), true otherwise.
+ */
+template <typename T>
+auto LUFactorBlocked(T *pData, size_t nSize, size_t *pPivots, const MtxTuningParams &Params)
+    -> bool {
+  const size_t nBlock = std::max<size_t>(Params.nLUBlock, 1);
+  for (size_t k = 0; k < nSize; k += nBlock) {
+    const size_t nPanel = std::min(nBlock, nSize - k);
+    T *pPanel = pData + k * nSize + k;
+    if (!LUFactorPanel(pPanel, nSize - k, nPanel, nSize, pPivots + k))
+      return false;
+
+    for (size_t i = k; i < k + nPanel; ++i) {
+      pPivots[i] += k;
+      if (pPivots[i] == i)
+        continue;
+      T *pRowA = pData + i * nSize;
+      T *pRowB = pData + pPivots[i] * nSize;
+      std::swap_ranges(pRowA, pRowA + k, pRowB);
+      std::swap_ranges(pRowA + k + nPanel, pRowA + nSize, pRowB + k + nPanel);
+    }
+
+    const size_t nTrailing = nSize - k - nPanel;
+    if (nTrailing == 0)
+      continue;
+    // U12 = L11^-1 * A12
+    LowerUnitSolve(pPanel, nSize, nPanel, pPanel + nPanel, nSize, nTrailing);
+    // A22 -= L21 * U12
+    GemmBlocked(nTrailing, nTrailing, nPanel, T(-1), pPanel + nPanel * nSize, nSize,
+                pPanel + nPanel, nSize, pPanel + nPanel * nSize + nPanel, nSize, Params);
+  }
+  return true;
+}
+
+/**
+ * @brief Solves LUx = Pb in place for a single right hand side.
+ *
+ * pLU and pPivots must come from LUFactor. The factors and the rhs may have different types so a
+ * low precision factorization can be applied to a high precision vector.
+ *
+ * @tparam T Factorization type.
+ * @tparam U Right hand side type.
+ * @param pLU
+ * @param nSize
+ * @param pPivots
+ * @param pB
+ */
+template <typename T, typename U>
+void LUSolve(const T *pLU, size_t nSize, const size_t *pPivots, U *pB) {
+  for (size_t i = 0; i < nSize; ++i)
+    if (pPivots[i] != i) {
+      const U TmpValue = pB[i];
+      pB[i] = pB[pPivots[i]];
+      pB[pPivots[i]] = TmpValue;
+    }
+
+  // Forward substitution (L has unit diagonal).
+  for (size_t i = 1; i < nSize; ++i) {
+    const T *pRow = pLU + i * nSize;
+    U Acc = pB[i];
+    for (size_t j = 0; j < i; ++j)
+      Acc -= U(pRow[j]) * pB[j];
+    pB[i] = Acc;
+  }
+
+  // Backward substitution.
+  for (size_t i = nSize; i-- > 0;) {
+    const T *pRow = pLU + i * nSize;
+    U Acc = pB[i];
+    for (size_t j = i + 1; j < nSize; ++j)
+      Acc -= U(pRow[j]) * pB[j];
+    pB[i] = Acc / U(pRow[i]);
+  }
+}
+
+/**
+ * @brief Solves LUX = PB in place for the nCols right hand sides of the row major pB (nLdB
+ * elements between rows). Same as LUSolve on each col, but the substitutions combine whole rows
+ * of B, so the inner loops vectorize.
+ *
+ * @see LUSolve
+ */
+template <typename T>
+void LUSolveMatrix(const T *pLU, size_t nSize, const size_t *pPivots, T *pB, size_t nLdB,
+                   size_t nCols) {
+  for (size_t i = 0; i < nSize; ++i)
+    if (pPivots[i] != i)
+      std::swap_ranges(pB + i * nLdB, pB + i * nLdB + nCols, pB + pPivots[i] * nLdB);
+  LowerUnitSolve(pLU, nSize, nSize, pB, nLdB, nCols);
+
+  for (size_t i = nSize; i-- > 0;) {
+    const T *pRow = pLU + i * nSize;
+    T *pRowI = pB + i * nLdB;
+    for (size_t k = i + 1; k < nSize; ++k) {
+      const T Factor = pRow[k];
+      const T *pRowK = pB + k * nLdB;
+      for (size_t j = 0; j < nCols; ++j)
+        pRowI[j] -= Factor * pRowK[j];
+    }
+    const T Inverse = T(1) / pRow[i];
+    for (size_t j = 0; j < nCols; ++j)
+      pRowI[j] *= Inverse;
+  }
+}
+}; // namespace Mafs::Internal::Kernels
+
+#endif // MAFS_MATRIX_KERNELS_LU_H
@@ -0,0 +1,268 @@
+#ifndef MAFS_MATRIX_KERNELS_MATRIXFUNCTIONS_H
+#define MAFS_MATRIX_KERNELS_MATRIXFUNCTIONS_H
+
+#include <Mafs/Matrix/MatrixDataTypes.hpp>
+#include <Mafs/Matrix/Operations/Kernels/Gemm.hpp>
+#include <Mafs/Matrix/Operations/Kernels/LU.hpp>
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <stddef.h>
+#include <stdint.h>
+#include <type_traits>
+
+/**
+ * Functions of square matrices (integer powers and exponential).
+ *
+ * The matrices are nSize x nSize row major arrays and every product goes into a caller provided
+ * work buffer: the steps ping-pong between the work buffers and the output, so a call allocates
+ * nothing and the last product lands in the output without a copy. Size_ != 0 is the compile
+ * time size of a small static matrix: its products are plain loops of known trip counts that the
+ * compiler unrolls, instead of the blocked GemmFused.
+ */
+namespace Mafs::Internal::Kernels {
+/**
+ * @brief pC = Alpha * pA * pB (nSize x nSize, pC overlapping neither operand).
+ */
+template <size_t Size_, typename T>
+void SquareProduct(size_t nSize, T Alpha, const T *pA, const T *pB, T *pC,
+                   const MtxTuningParams &Params) {
+  if constexpr (Size_ != 0) {
+    for (size_t i = 0; i < Size_; ++i) {
+      T Row[Size_] = {};
+      for (size_t k = 0; k < Size_; ++k)
+        for (size_t j = 0; j < Size_; ++j)
+          Row[j] += pA[i * Size_ + k] * pB[k * Size_ + j];
+      for (size_t j = 0; j < Size_; ++j)
+        pC[i * Size_ + j] = Alpha * Row[j];
+    }
+  } else {
+    GemmFused(nSize, nSize, nSize, Alpha, pA, nSize, pB, nSize, T(0), pC, nSize, MtxEpilogue<T>(),
+              Params);
+  }
+}
+
+/**
+ * @brief Returns true if every entry off the diagonal is zero.
+ */
+template <typename T> auto IsDiagonal(size_t nSize, const T *pA) -> bool {
+  for (size_t i = 0; i < nSize; ++i)
+    for (size_t j = 0; j < nSize; ++j)
+      if (i != j && pA[i * nSize + j] != T(0))
+        return false;
+  return true;
+}
+
+/**
+ * @brief pOut = diag(Function(pA[i][i])).
+ */
+template <typename T, typename Func>
+void DiagonalFunction(size_t nSize, const T *pA, T *pOut, Func Function) {
+  std::fill(pOut, pOut + nSize * nSize, T(0));
+  for (size_t i = 0; i < nSize; ++i)
+    pOut[i * nSize + i] = Function(pA[i * nSize + i]);
+}
+
+/**
+ * @brief Work buffer values of MatrixPower.
+ */
+inline constexpr auto PowerWorkSize(size_t nSize) -> size_t { return nSize * nSize; }
+
+/**
+ * @brief pOut = pA^nExponent by left to right binary exponentiation: one squaring per bit after
+ * the highest and one product by pA per other set bit (e.g. 10 squarings and 2 products for
+ * 1000). The products alternate between pWork and pOut, starting where the last one ends in pOut.
+ * Diagonal matrices only raise their diagonal.
+ *
+ * @param nSize
+ * @param pA
+ * @param nExponent 0 gives the identity.
+ * @param pOut must not overlap pA.
+ * @param pWork PowerWorkSize(nSize) values.
+ * @param Params
+ */
+template <size_t Size_, typename T>
+void MatrixPower(size_t nSize, const T *pA, uint64_t nExponent, T *pOut, T *pWork,
+                 const MtxTuningParams &Params) {
+  if (nExponent == 0 || IsDiagonal(nSize, pA)) {
+    DiagonalFunction(nSize, pA, pOut, [nExponent](T Value) {
+      T Result = T(1);
+      for (uint64_t n = nExponent; n != 0; n >>= 1, Value *= Value)
+        if (n & 1)
+          Result *= Value;
+      return Result;
+    });
+    return;
+  }
+
+  const int nHighBit = std::bit_width(nExponent) - 1;
+  const size_t nProducts = static_cast<size_t>(nHighBit + std::popcount(nExponent) - 1);
+  if (nProducts == 0) {
+    std::copy(pA, pA + nSize * nSize, pOut);
+    return;
+  }
+  const T *pCurrent = pA;
+  size_t nRemaining = nProducts;
+  auto Step = [&](const T *pFactor) {
+    T *pNext = --nRemaining % 2 == 0 ? pOut : pWork;
+    SquareProduct<Size_>(nSize, T(1), pCurrent, pFactor, pNext, Params);
+    pCurrent = pNext;
+  };
+  for (int nBit = nHighBit - 1; nBit >= 0; --nBit) {
+    Step(pCurrent);
+    if ((nExponent >> nBit) & 1)
+      Step(pA);
+  }
+}
+
+/**
+ * @brief Work buffer values of MatrixExp.
+ */
+inline constexpr auto ExpWorkSize(size_t nSize) -> size_t { return 5 * nSize * nSize; }
+
+/**
+ * @brief pOut = exp(pA) by scaling and squaring with Pade approximants (Higham, "The scaling and
+ * squaring method for the matrix exponential revisited", 2005).
+ *
+ * The degree m is the smallest of 3, 5, 7, 9, 13 (double) or 3, 5, 7 (float) whose backward error
+ * bound theta_m covers the 1-norm of pA; above the last bound pA is scaled by 2^-s, its
+ * approximant squared s times. r_m = (V - U)^-1 (V + U) with U, V the odd and even parts of the
+ * Pade numerator, built from the even powers of pA (the scaling is folded into the product
+ * coefficients, pA is never copied) and solved by one LU decomposition. Diagonal matrices only
+ * exponentiate their diagonal.
+ *
+ * @param nSize
+ * @param pA
+ * @param pOut must not overlap pA.
+ * @param pWork ExpWorkSize(nSize) values.
+ * @param pPivots nSize values.
+ * @param Params
+ * @return false if the denominator V - U is singular (only for non finite entries).
+ */
+template <size_t Size_, typename T>
+auto MatrixExp(size_t nSize, const T *pA, T *pOut, T *pWork, size_t *pPivots,
+               const MtxTuningParams &Params) -> bool {
+  static_assert(std::is_floating_point_v<T>, "The exponential requires a floating point type");
+  if (IsDiagonal(nSize, pA)) {
+    DiagonalFunction(nSize, pA, pOut, [](T Value) { return std::exp(Value); });
+    return true;
+  }
+
+  // Pade degrees, their theta bounds (unit roundoff 2^-53 and 2^-24) and coefficients.
+  static constexpr size_t Degrees[] = {3, 5, 7, 9, 13};
+  static constexpr double ThetaDouble[] = {1.495585217958292e-2, 2.539398330063230e-1,
+                                           9.504178996162932e-1, 2.097847961257068e+0,
+                                           5.371920351148152e+0};
+  static constexpr double ThetaFloat[] = {4.258730016922831e-1, 1.880152677804762e+0,
+                                          3.925724783138660e+0};
+  static constexpr double Coefficients[][14] = {
+      {120, 60, 12, 1},
+      {30240, 15120, 3360, 420, 30, 1},
+      {17297280, 8648640, 1995840, 277200, 25200, 1512, 56, 1},
+      {17643225600, 8821612800, 2075673600, 302702400, 30270240, 2162160, 110880, 3960, 90, 1},
+      {64764752532480000, 32382376266240000, 7771770303897600, 1187353796428800,
+       129060195264000, 10559470521600, 670442572800, 33522128640, 1323241920, 40840800, 960960,
+       16380, 182, 1}};
+  constexpr bool bSingle = sizeof(T) <= sizeof(float);
+  const double *pTheta = bSingle ? ThetaFloat : ThetaDouble;
+  const size_t nLast = bSingle ? 2 : 4;
+
+  const size_t nSquare = nSize * nSize;
+  double Norm = 0;
+  for (size_t j = 0; j < nSize; ++j) {
+    double Sum = 0;
+    for (size_t i = 0; i < nSize; ++i)
+      Sum += std::abs(static_cast<double>(pA[i * nSize + j]));
+    Norm = std::max(Norm, Sum);
+  }
+  size_t nDegree = 0;
+  while (nDegree < nLast && Norm > pTheta[nDegree])
+    ++nDegree;
+  int nSquarings = 0;
+  if (Norm > pTheta[nLast])
+    nSquarings = static_cast<int>(std::ceil(std::log2(Norm / pTheta[nLast])));
+  const double *b = Coefficients[nDegree];
+  const T Scale = static_cast<T>(std::ldexp(1.0, -nSquarings));
+
+  // Even powers A^2, A^4, A^6 (and A^8 for m = 9) of the scaled matrix.
+  T *pW[5];
+  for (size_t k = 0; k < 5; ++k)
+    pW[k] = pWork + k * nSquare;
+  const size_t nPowers = Degrees[nDegree] == 13 ? 3 : Degrees[nDegree] / 2;
+  const T *pPowers[4] = {pW[0], pW[1], pW[2], pW[3]};
+  SquareProduct<Size_>(nSize, Scale * Scale, pA, pA, pW[0], Params);
+  if (nPowers > 1)
+    SquareProduct<Size_>(nSize, T(1), pW[0], pW[0], pW[1], Params);
+  if (nPowers > 2)
+    SquareProduct<Size_>(nSize, T(1), pW[1], pW[0], pW[2], Params);
+  if (nPowers > 3)
+    SquareProduct<Size_>(nSize, T(1), pW[1], pW[1], pW[3], Params);
+
+  // pDst = c_0 I + sum c_k A^2k, with c_k = b[2 k + nOffset] for k in [nFirst, nPowers].
+  auto Combine = [&](T *pDst, size_t nOffset, size_t nFirst, bool bIdentity) {
+    for (size_t i = 0; i < nSquare; ++i) {
+      T Value = 0;
+      for (size_t k = nFirst; k <= nPowers; ++k)
+        Value += static_cast<T>(b[2 * k + nOffset]) * pPowers[k - 1][i];
+      pDst[i] = Value;
+    }
+    if (bIdentity)
+      for (size_t i = 0; i < nSize; ++i)
+        pDst[i * nSize + i] += static_cast<T>(b[nOffset]);
+  };
+  // Odd part U into pU, even part V into pOut.
+  T *pU;
+  if (Degrees[nDegree] == 13) {
+    // U = A (A^6 (b13 A^6 + b11 A^4 + b9 A^2) + b7 A^6 + ... + b1 I)
+    const T *pA6 = pW[2];
+    for (size_t i = 0; i < nSquare; ++i)
+      pW[3][i] = static_cast<T>(b[13]) * pA6[i] + static_cast<T>(b[11]) * pW[1][i] +
+                 static_cast<T>(b[9]) * pW[0][i];
+    SquareProduct<Size_>(nSize, T(1), pA6, pW[3], pW[4], Params);
+    for (size_t i = 0; i < nSquare; ++i)
+      pW[4][i] += static_cast<T>(b[7]) * pA6[i] + static_cast<T>(b[5]) * pW[1][i] +
+                  static_cast<T>(b[3]) * pW[0][i];
+    for (size_t i = 0; i < nSize; ++i)
+      pW[4][i * nSize + i] += static_cast<T>(b[1]);
+    SquareProduct<Size_>(nSize, Scale, pA, pW[4], pW[3], Params);
+    pU = pW[3];
+    // V = A^6 (b12 A^6 + b10 A^4 + b8 A^2) + b6 A^6 + ... + b0 I
+    for (size_t i = 0; i < nSquare; ++i)
+      pW[4][i] = static_cast<T>(b[12]) * pA6[i] + static_cast<T>(b[10]) * pW[1][i] +
+                 static_cast<T>(b[8]) * pW[0][i];
+    SquareProduct<Size_>(nSize, T(1), pA6, pW[4], pOut, Params);
+    for (size_t i = 0; i < nSquare; ++i)
+      pOut[i] += static_cast<T>(b[6]) * pA6[i] + static_cast<T>(b[4]) * pW[1][i] +
+                 static_cast<T>(b[2]) * pW[0][i];
+    for (size_t i = 0; i < nSize; ++i)
+      pOut[i * nSize + i] += static_cast<T>(b[0]);
+  } else {
+    Combine(pW[4], 1, 1, true);
+    Combine(pOut, 0, 1, true);
+    SquareProduct<Size_>(nSize, Scale, pA, pW[4], pW[0], Params);
+    pU = pW[0];
+  }
+
+  // Q = V - U into pW[2], P = V + U where the squarings end in pOut, then P = Q^-1 P.
+  T *pP = nSquarings % 2 == 0 ? pOut : pW[1];
+  T *pQ = pW[2];
+  for (size_t i = 0; i < nSquare; ++i) {
+    const T V = pOut[i], U = pU[i];
+    pQ[i] = V - U;
+    pP[i] = V + U;
+  }
+  if (!LUFactorBlocked(pQ, nSize, pPivots, Params))
+    return false;
+  LUSolveMatrix(pQ, nSize, pPivots, pP, nSize, nSize);
+
+  T *pCurrent = pP;
+  for (int s = 0; s < nSquarings; ++s) {
+    T *pNext = pCurrent == pOut ? pW[1] : pOut;
+    SquareProduct<Size_>(nSize, T(1), pCurrent, pCurrent, pNext, Params);
+    pCurrent = pNext;
+  }
+  return true;
+}
+}; // namespace Mafs::Internal::Kernels
+
+#endif // MAFS_MATRIX_KERNELS_MATRIXFUNCTIONS_H
@@ -0,0 +1,304 @@
+#ifndef MAFS_MATRIX_KERNELS_PARALLEL_H
+#define MAFS_MATRIX_KERNELS_PARALLEL_H
+
+#include <Mafs/Utils/Memory.hpp>
+#include <Mafs/Utils/PerfCounters.hpp>
+#include <algorithm>
+#include <exception>
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+#include <type_traits>
+#include <vector>
+#ifdef MAFS_ENABLE_THREADS
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+namespace Mafs::Internal::Kernels {
+
+/**
+ * @brief Caps ThreadCount on the calling thread while it lives, e.g. to 1 on the workers of the
+ * Executor: they already run one task per core, kernels splitting each task again would run about
+ * cores^2 threads.
+ */
+class ThreadLimit {
+protected:
+  inline static thread_local size_t m_nLimit = 0; // 0 = no limit.
+  size_t m_nPrevious;
+
+public:
+  explicit ThreadLimit(size_t nLimit) : m_nPrevious(m_nLimit) { m_nLimit = nLimit; }
+  ThreadLimit(const ThreadLimit &) = delete;
+  ThreadLimit &operator=(const ThreadLimit &) = delete;
+  ~ThreadLimit() { m_nLimit = m_nPrevious; }
+
+  /**
+   * @brief Limit of the calling thread, 0 if there is none.
+   *
+   * @return size_t
+   */
+  static inline auto Get() -> size_t { return m_nLimit; }
+};
+
+/**
+ * @brief Number of threads to use: nThreads, or every core if it is 0, at most the ThreadLimit of
+ * the calling thread. Always 1 without MAFS_ENABLE_THREADS.
+ *
+ * @param nThreads
+ * @return size_t
+ */
+inline auto ThreadCount(size_t nThreads) -> size_t {
+#ifdef MAFS_ENABLE_THREADS
+  if (nThreads == 0)
+    nThreads = std::thread::hardware_concurrency();
+  if (ThreadLimit::Get() > 0)
+    nThreads = std::min(nThreads, ThreadLimit::Get());
+  return std::max<size_t>(nThreads, 1);
+#else
+  (void)nThreads;
+  return 1;
+#endif
+}
+
+#ifdef MAFS_ENABLE_THREADS
+/**
+ * @brief Process wide workers running the chunks of ParallelFor.
+ *
+ * The workers are started on demand, up to the largest number of helpers a call asked for, and
+ * live until the exit: their thread local workspaces are kept between the calls, and a call costs
+ * a wake up instead of thread creations. A call publishes a Job living on the caller's stack, the
+ * caller and the workers claim its chunks with an atomic counter, and the caller withdraws it
+ * once every chunk is finished and no worker holds it anymore.
+ */
+class ThreadPool {
+public:
+  /**
+   * @brief nChunks chunks of nChunk iterations of [0, nCount), or, bound to the nodes, nPerNode
+   * chunks of the iterations of each node of Partition.
+   */
+  struct Job {
+    void (*pRun)(void *pFunction, size_t nBegin, size_t nEnd) = nullptr;
+    void *pFunction = nullptr;
+    size_t nCount = 0;
+    size_t nChunk = 0;
+    size_t nChunks = 0;
+    bool bBind = false;             // Chunk t runs on a worker bound to node t / nPerNode.
+    size_t nPerNode = 0;            // Chunks per node.
+    NumaPartition Partition;        // Pages of the data, iteration i works on the nUnitBytes
+    size_t nOffset = 0;             // at nOffset + i * nUnitBytes.
+    size_t nUnitBytes = 0;
+    PerfScope *pScope = nullptr;    // Scope of the caller, credited with the workers' events.
+    std::atomic<size_t> nNext = 0;  // Next chunk to claim.
+    std::atomic<size_t> nDone = 0;  // Finished chunks.
+    size_t nUsers = 0;              // Workers running chunks, guarded by m_Mutex.
+    size_t nErrorChunk = SIZE_MAX;  // First chunk that threw, guarded by m_Mutex.
+    std::exception_ptr Error;       // Its exception.
+  };
+
+protected:
+  std::mutex m_Mutex;
+  std::condition_variable m_Wake; // A job was published.
+  std::condition_variable m_Done; // A worker left a job.
+  std::vector<Job *> m_Jobs;      // Published jobs, in order.
+  std::vector<std::thread> m_Workers;
+  bool m_bStop = false;
+
+  inline static thread_local bool m_bWorker = false;
+
+  ThreadPool() = default;
+
+  // Iterations of chunk t.
+  static void ChunkRange(const Job &Current, size_t t, size_t &nBegin, size_t &nEnd) {
+    if (!Current.bBind) {
+      nBegin = t * Current.nChunk;
+      nEnd = std::min(Current.nCount, (t + 1) * Current.nChunk);
+      return;
+    }
+    const size_t nNode = t / Current.nPerNode, nPart = t % Current.nPerNode;
+    const size_t nFirst = PartitionBegin(nNode, Current.Partition, Current.nOffset,
+                                         Current.nUnitBytes, Current.nCount);
+    const size_t nLength = PartitionBegin(nNode + 1, Current.Partition, Current.nOffset,
+                                          Current.nUnitBytes, Current.nCount) -
+                           nFirst;
+    nBegin = nFirst + nPart * nLength / Current.nPerNode;
+    nEnd = nFirst + (nPart + 1) * nLength / Current.nPerNode;
+  }
+
+  void RunChunks(Job &Current) {
+    // The caller's own counters already include the chunks it runs.
+    PerfScope *pScope = m_bWorker ? Current.pScope : nullptr;
+    const MtxPerfCounters Start =
+        pScope != nullptr ? Internal::PerfGroup::ThreadInstance().Read() : MtxPerfCounters();
+    size_t t = Current.nNext++;
+    while (t < Current.nChunks) {
+      try {
+        size_t nBegin, nEnd;
+        ChunkRange(Current, t, nBegin, nEnd);
+        // A worker leaves the node of a bound job when it runs an unbound one.
+        if (m_bWorker && nBegin < nEnd)
+          BindThreadToNode(Current.bBind ? t / Current.nPerNode : SIZE_MAX);
+        if (nBegin < nEnd)
+          Current.pRun(Current.pFunction, nBegin, nEnd);
+      } catch (...) {
+        std::lock_guard<std::mutex> Lock(m_Mutex);
+        if (t < Current.nErrorChunk) {
+          Current.nErrorChunk = t;
+          Current.Error = std::current_exception();
+        }
+      }
+      // The next chunk is claimed first: after the last one the events must reach the scope
+      // before the caller can see every chunk done.
+      const size_t nNext = Current.nNext++;
+      if (pScope != nullptr && nNext >= Current.nChunks)
+        pScope->AddWorkers(
+            Internal::PerfGroup::Difference(Start, Internal::PerfGroup::ThreadInstance().Read()));
+      Current.nDone++;
+      t = nNext;
+    }
+  }
+
+  // First job with chunks left to claim. m_Mutex must be held.
+  auto Claimable() const -> Job * {
+    for (Job *pJob : m_Jobs)
+      if (pJob->nNext < pJob->nChunks)
+        return pJob;
+    return nullptr;
+  }
+
+  void Work() {
+    m_bWorker = true;
+    std::unique_lock<std::mutex> Lock(m_Mutex);
+    while (true) {
+      Job *pJob = nullptr;
+      m_Wake.wait(Lock, [&]() { return m_bStop || (pJob = Claimable()) != nullptr; });
+      if (m_bStop)
+        return;
+      pJob->nUsers++;
+      Lock.unlock();
+      RunChunks(*pJob);
+      Lock.lock();
+      pJob->nUsers--;
+      m_Done.notify_all();
+    }
+  }
+
+public:
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  ~ThreadPool() {
+    {
+      std::lock_guard<std::mutex> Lock(m_Mutex);
+      m_bStop = true;
+    }
+    m_Wake.notify_all();
+    for (auto &Worker : m_Workers)
+      Worker.join();
+  }
+
+  static auto Instance() -> ThreadPool & {
+    static ThreadPool Pool;
+    return Pool;
+  }
+
+  /**
+   * @brief true on a worker of the pool.
+   */
+  static inline bool InWorker() { return m_bWorker; }
+
+  /**
+   * @brief Number of workers started so far.
+   *
+   * @return size_t
+   */
+  auto WorkerCount() -> size_t {
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+    return m_Workers.size();
+  }
+
+  /**
+   * @brief Runs every chunk of Current, on the calling thread too unless the chunks are bound to
+   * the nodes, and rethrows the exception of the first chunk that threw.
+   *
+   * @param Current
+   */
+  void Run(Job &Current) {
+    {
+      std::lock_guard<std::mutex> Lock(m_Mutex);
+      const size_t nHelpers = Current.bBind ? Current.nChunks : Current.nChunks - 1;
+      while (m_Workers.size() < nHelpers)
+        m_Workers.emplace_back([this]() { Work(); });
+      m_Jobs.push_back(&Current);
+    }
+    m_Wake.notify_all();
+    if (!Current.bBind)
+      RunChunks(Current);
+
+    std::unique_lock<std::mutex> Lock(m_Mutex);
+    m_Done.wait(Lock, [&]() { return Current.nDone == Current.nChunks && Current.nUsers == 0; });
+    m_Jobs.erase(std::find(m_Jobs.begin(), m_Jobs.end(), &Current));
+    if (Current.Error)
+      std::rethrow_exception(Current.Error);
+  }
+};
+#endif
+
+/**
+ * @brief Calls Function(nBegin, nEnd) over nThreads contiguous chunks of [0, nCount).
+ *
+ * The chunks run on the calling thread and the workers of the ThreadPool. If iteration i works on
+ * the nUnitBytes at pData + i * nUnitBytes and pData is in a MtxNumaPartition container, the
+ * chunks instead follow its page blocks, about nThreads / nodes of them per node, and only the
+ * workers run them, each bound to the node of its chunk (the caller is never rebound).
+ * Exceptions thrown by a chunk are rethrown after every chunk finished. Without
+ * MAFS_ENABLE_THREADS, with nThreads <= 1 or on a worker of the pool (a chunk of another
+ * ParallelFor, the other workers are busy) it is a single Function(0, nCount) call.
+ *
+ * @tparam Func void(size_t nBegin, size_t nEnd)
+ * @param nCount
+ * @param nThreads
+ * @param Function
+ * @param pData optional, data split by the iterations.
+ * @param nUnitBytes bytes of pData per iteration.
+ */
+template <typename Func>
+void ParallelFor(size_t nCount, size_t nThreads, Func &&Function, const void *pData = nullptr,
+                 size_t nUnitBytes = 0) {
+  if (nCount == 0)
+    return;
+#ifdef MAFS_ENABLE_THREADS
+  nThreads = std::min(nThreads, nCount);
+  if (nThreads > 1 && !ThreadPool::InWorker()) {
+    typedef std::remove_reference_t<Func> Callable;
+    ThreadPool::Job Current;
+    Current.pRun = [](void *pFunction, size_t nBegin, size_t nEnd) {
+      (*static_cast<Callable *>(pFunction))(nBegin, nEnd);
+    };
+    Current.pFunction = const_cast<void *>(static_cast<const void *>(std::addressof(Function)));
+    Current.nCount = nCount;
+    Current.nChunk = (nCount + nThreads - 1) / nThreads;
+    Current.nChunks = (nCount + Current.nChunk - 1) / Current.nChunk;
+    if (pData != nullptr && nUnitBytes > 0 &&
+        FindPartition(pData, Current.Partition, Current.nOffset)) {
+      Current.bBind = true;
+      Current.nUnitBytes = nUnitBytes;
+      Current.nPerNode = (nThreads + Current.Partition.nNodes - 1) / Current.Partition.nNodes;
+      Current.nChunks = Current.Partition.nNodes * Current.nPerNode;
+    }
+    Current.pScope = PerfScope::Current();
+    ThreadPool::Instance().Run(Current);
+    return;
+  }
+#else
+  (void)nThreads;
+  (void)pData;
+  (void)nUnitBytes;
+#endif
+  Function(size_t(0), nCount);
+}
+}; // namespace Mafs::Internal::Kernels
+
+#endif // MAFS_MATRIX_KERNELS_PARALLEL_H
@@ -0,0 +1,320 @@
+#ifndef MAFS_MATRIX_KERNELS_REDUCE_H
+#define MAFS_MATRIX_KERNELS_REDUCE_H
+
+#include <Mafs/Matrix/MatrixDataTypes.hpp>
+#include <Mafs/Matrix/Operations/Kernels/Parallel.hpp>
+#include <Mafs/Utils/Workspace.hpp>
+#include <algorithm>
+#include <cmath>
+#include <stddef.h>
+#include <type_traits>
+#include <vector>
+
+namespace Mafs::Internal::Kernels {
+// Independent accumulators of the reductions: the additions of different lanes don't depend on
+// each other, so the compiler keeps the lanes in vector registers without reassociating.
+inline constexpr size_t nReduceLanes = 8;
+// Block below which the pairwise summation stops splitting.
+inline constexpr size_t nPairwiseBlock = 128;
+
+/**
+ * @brief Sum of Value(i) for i in [nBegin, nEnd), nReduceLanes accumulators.
+ *
+ * @tparam T accumulation type.
+ * @tparam Func T(size_t i)
+ */
+template <typename T, typename Func> auto SumLanes(size_t nBegin, size_t nEnd, Func &Value) -> T {
+  T Lanes[nReduceLanes] = {};
+  size_t i = nBegin;
+  for (; i + nReduceLanes <= nEnd; i += nReduceLanes)
+    for (size_t l = 0; l < nReduceLanes; ++l)
+      Lanes[l] += Value(i + l);
+  for (size_t l = 0; i < nEnd; ++i, ++l)
+    Lanes[l] += Value(i);
+  for (size_t nWidth = nReduceLanes / 2; nWidth > 0; nWidth /= 2)
+    for (size_t l = 0; l < nWidth; ++l)
+      Lanes[l] += Lanes[l + nWidth];
+  return Lanes[0];
+}
+
+/**
+ * @brief Compensated (Kahan-Babuska/Neumaier) sum of Value(i) for i in [nBegin, nEnd).
+ * The error doesn't grow with the number of values, at ~4x the cost of SumLanes.
+ */
+template <typename T, typename Func> auto SumKahan(size_t nBegin, size_t nEnd, Func &Value) -> T {
+  if constexpr (!std::is_floating_point_v<T>)
+    return SumLanes<T>(nBegin, nEnd, Value);
+  else {
+    T Lanes[nReduceLanes] = {}, Errors[nReduceLanes] = {};
+    auto Add = [&](size_t l, T x) {
+      const T Total = Lanes[l] + x;
+      Errors[l] += std::abs(Lanes[l]) >= std::abs(x) ? (Lanes[l] - Total) + x
+                                                     : (x - Total) + Lanes[l];
+      Lanes[l] = Total;
+    };
+    size_t i = nBegin;
+    for (; i + nReduceLanes <= nEnd; i += nReduceLanes)
+      for (size_t l = 0; l < nReduceLanes; ++l)
+        Add(l, Value(i + l));
+    for (size_t l = 0; i < nEnd; ++i, ++l)
+      Add(l, Value(i));
+    for (size_t l = 1; l < nReduceLanes; ++l) {
+      Add(0, Lanes[l]);
+      Errors[0] += Errors[l];
+    }
+    return Lanes[0] + Errors[0];
+  }
+}
+
+/**
+ * @brief Pairwise sum of Value(i) for i in [nBegin, nEnd): the error grows with log(n) instead of
+ * n, at the cost of SumLanes.
+ */
+template <typename T, typename Func>
+auto SumPairwise(size_t nBegin, size_t nEnd, Func &Value) -> T {
+  if (nEnd - nBegin <= nPairwiseBlock)
+    return SumLanes<T>(nBegin, nEnd, Value);
+  const size_t nMiddle = nBegin + (nEnd - nBegin) / 2;
+  return SumPairwise<T>(nBegin, nMiddle, Value) + SumPairwise<T>(nMiddle, nEnd, Value);
+}
+
+/**
+ * @brief Sum of Value(i) for i in [nBegin, nEnd) with the eMode algorithm.
+ */
+template <typename T, typename Func>
+auto Sum(size_t nBegin, size_t nEnd, Func &Value, MtxSummation eMode) -> T {
+  if (eMode == MtxSumKahan)
+    return SumKahan<T>(nBegin, nEnd, Value);
+  if (eMode == MtxSumPairwise)
+    return SumPairwise<T>(nBegin, nEnd, Value);
+  return SumLanes<T>(nBegin, nEnd, Value);
+}
+
+/**
+ * @brief Sum of Value(i) for i in [0, nCount), split among threads above
+ * Params.nParallelThreshold values. The partial sums are combined with the same algorithm, so the
+ * result only depends on the thread count.
+ *
+ * @tparam T accumulation type.
+ * @tparam Func T(size_t i), called concurrently.
+ * @param nCount
+ * @param Value
+ * @param eMode
+ * @param Params threshold and threads.
+ * @param pData optional, Value(i) reads pData[i] (places the threads, see ParallelFor).
+ * @return T
+ */
+template <typename T, typename Func>
+auto ParallelSum(size_t nCount, Func &&Value, MtxSummation eMode, const MtxTuningParams &Params,
+                 const T *pData = nullptr) -> T {
+  const size_t nThreads = nCount >= Params.nParallelThreshold
+                              ? std::min(ThreadCount(Params.nThreads), nCount)
+                              : 1;
+  if (nThreads <= 1)
+    return Sum<T>(0, nCount, Value, eMode);
+  std::vector<T> Partials(nThreads, T(0));
+  const size_t nChunk = (nCount + nThreads - 1) / nThreads;
+  ParallelFor(
+      nThreads, nThreads,
+      [&](size_t nBegin, size_t nEnd) {
+        for (size_t t = nBegin; t < nEnd; ++t)
+          Partials[t] = Sum<T>(std::min(nCount, t * nChunk), std::min(nCount, (t + 1) * nChunk),
+                               Value, eMode);
+      },
+      pData, nChunk * sizeof(T));
+  auto Partial = [&](size_t t) { return Partials[t]; };
+  return Sum<T>(0, nThreads, Partial, eMode);
+}
+
+/**
+ * @brief Index of the first minimum (bMax false) or maximum (bMax true) of p[nBegin, nEnd), NaNs
+ * are skipped (nEnd if every value is NaN).
+ */
+template <typename T>
+auto ExtremumIndex(const T *p, size_t nBegin, size_t nEnd, bool bMax) -> size_t {
+  size_t Indices[nReduceLanes];
+  T Values[nReduceLanes] = {};
+  std::fill(Indices, Indices + nReduceLanes, nEnd);
+  auto Better = [bMax](T a, T b) { return bMax ? a > b : a < b; };
+  auto Visit = [&](size_t l, size_t i) {
+    if (p[i] == p[i] && (Indices[l] == nEnd || Better(p[i], Values[l]))) {
+      Values[l] = p[i];
+      Indices[l] = i;
+    }
+  };
+  size_t i = nBegin;
+  for (; i + nReduceLanes <= nEnd; i += nReduceLanes)
+    for (size_t l = 0; l < nReduceLanes; ++l)
+      Visit(l, i + l);
+  for (size_t l = 0; i < nEnd; ++i, ++l)
+    Visit(l, i);
+
+  size_t nBest = nEnd;
+  for (size_t l = 0; l < nReduceLanes; ++l)
+    if (Indices[l] != nEnd &&
+        (nBest == nEnd || Better(Values[l], p[nBest]) ||
+         (!Better(p[nBest], Values[l]) && Indices[l] < nBest)))
+      nBest = Indices[l];
+  return nBest;
+}
+
+/**
+ * @brief ExtremumIndex over p[0, nCount), split among threads above Params.nParallelThreshold.
+ */
+template <typename T>
+auto ParallelExtremumIndex(const T *p, size_t nCount, bool bMax, const MtxTuningParams &Params)
+    -> size_t {
+  const size_t nThreads = nCount >= Params.nParallelThreshold
+                              ? std::min(ThreadCount(Params.nThreads), nCount)
+                              : 1;
+  if (nThreads <= 1)
+    return ExtremumIndex(p, 0, nCount, bMax);
+  std::vector<size_t> Partials(nThreads, nCount);
+  const size_t nChunk = (nCount + nThreads - 1) / nThreads;
+  ParallelFor(
+      nThreads, nThreads,
+      [&](size_t nBegin, size_t nEnd) {
+        for (size_t t = nBegin; t < nEnd; ++t) {
+          const size_t nFirst = std::min(nCount, t * nChunk);
+          const size_t nLast = std::min(nCount, (t + 1) * nChunk);
+          const size_t nIndex = ExtremumIndex(p, nFirst, nLast, bMax);
+          Partials[t] = nIndex == nLast ? nCount : nIndex;
+        }
+      },
+      p, nChunk * sizeof(T));
+  // The chunks are in order, so keeping the first of equal values keeps the lowest index.
+  size_t nBest = nCount;
+  for (size_t nIndex : Partials)
+    if (nIndex != nCount &&
+        (nBest == nCount || (bMax ? p[nIndex] > p[nBest] : p[nIndex] < p[nBest])))
+      nBest = nIndex;
+  return nBest;
+}
+
+/**
+ * @brief pSum[l] = sum of Value(pData[k * nLines + l]) for the rows k in [nBegin, nEnd) of the row
+ * major pData, with the eMode algorithm applied to every col. The rows are read once, the inner
+ * loops run across the cols (vectorized).
+ *
+ * @tparam T accumulation type.
+ * @tparam Func T(T x)
+ */
+template <typename T, typename Func>
+void SumRows(const T *pData, size_t nLines, size_t nBegin, size_t nEnd, Func &Value,
+             MtxSummation eMode, T *pSum) {
+  if (eMode == MtxSumPairwise && nEnd - nBegin > nPairwiseBlock) {
+    const size_t nMiddle = nBegin + (nEnd - nBegin) / 2;
+    SumRows(pData, nLines, nBegin, nMiddle, Value, eMode, pSum);
+    ScratchBuffer<T> Right(nLines);
+    SumRows(pData, nLines, nMiddle, nEnd, Value, eMode, Right.Data());
+    for (size_t l = 0; l < nLines; ++l)
+      pSum[l] += Right[l];
+    return;
+  }
+  std::fill(pSum, pSum + nLines, T(0));
+  if constexpr (std::is_floating_point_v<T>)
+    if (eMode == MtxSumKahan) {
+      ScratchBuffer<T> Errors(nLines);
+      std::fill(Errors.Data(), Errors.Data() + nLines, T(0));
+      for (size_t k = nBegin; k < nEnd; ++k) {
+        const T *pRow = pData + k * nLines;
+        for (size_t l = 0; l < nLines; ++l) {
+          const T x = Value(pRow[l]), Total = pSum[l] + x;
+          Errors[l] += std::abs(pSum[l]) >= std::abs(x) ? (pSum[l] - Total) + x
+                                                        : (x - Total) + pSum[l];
+          pSum[l] = Total;
+        }
+      }
+      for (size_t l = 0; l < nLines; ++l)
+        pSum[l] += Errors[l];
+      return;
+    }
+  for (size_t k = nBegin; k < nEnd; ++k) {
+    const T *pRow = pData + k * nLines;
+    for (size_t l = 0; l < nLines; ++l)
+      pSum[l] += Value(pRow[l]);
+  }
+}
+
+/**
+ * @brief pBest[l] = minimum (bMax false) or maximum (bMax true) of the col l of the rows [nBegin,
+ * nEnd) (nEnd > nBegin) of the row major pData, NaNs are skipped (NaN if the col only has NaNs).
+ */
+template <typename T>
+void ExtremumRows(const T *pData, size_t nLines, size_t nBegin, size_t nEnd, bool bMax, T *pBest) {
+  std::copy(pData + nBegin * nLines, pData + (nBegin + 1) * nLines, pBest);
+  for (size_t k = nBegin + 1; k < nEnd; ++k) {
+    const T *pRow = pData + k * nLines;
+    for (size_t l = 0; l < nLines; ++l) {
+      const T Value = pRow[l], Best = pBest[l];
+      const bool bBetter = Best != Best || (bMax ? Value > Best : Value < Best);
+      pBest[l] = bBetter && Value == Value ? Value : Best;
+    }
+  }
+}
+
+/**
+ * @brief Applies eOp to each col of the nLength x nLines row major pData (e.g. to the rows of a
+ * col major matrix): the rows are streamed once into one accumulator per col, so the lines that
+ * are not contiguous are reduced without a transposed copy. Above Params.nParallelThreshold
+ * values the rows are split among threads and their partial results combined with the same
+ * algorithm, so the result only depends on the thread count.
+ *
+ * @param pData
+ * @param nLength values per line (rows of pData).
+ * @param nLines
+ * @param eOp
+ * @param eMode summation algorithm of the sums.
+ * @param pResult nLines values.
+ * @param Params threshold and threads.
+ */
+template <typename T>
+void ReduceCols(const T *pData, size_t nLength, size_t nLines, MtxReduction eOp,
+                MtxSummation eMode, T *pResult, const MtxTuningParams &Params) {
+  if (nLength == 0 || nLines == 0)
+    return;
+  auto Value = [](T x) { return x; };
+  auto AbsValue = [](T x) { return x < T(0) ? -x : x; };
+  auto Square = [](T x) { return x * x; };
+  auto Reduce = [&](size_t nBegin, size_t nEnd, T *pOut) {
+    if (eOp == MtxReduceMin || eOp == MtxReduceMax)
+      ExtremumRows(pData, nLines, nBegin, nEnd, eOp == MtxReduceMax, pOut);
+    else if (eOp == MtxReduceAbsSum)
+      SumRows(pData, nLines, nBegin, nEnd, AbsValue, eMode, pOut);
+    else if (eOp == MtxReduceNorm)
+      SumRows(pData, nLines, nBegin, nEnd, Square, eMode, pOut);
+    else
+      SumRows(pData, nLines, nBegin, nEnd, Value, eMode, pOut);
+  };
+
+  const size_t nThreads = nLength * nLines >= Params.nParallelThreshold
+                              ? std::min(ThreadCount(Params.nThreads), nLength)
+                              : 1;
+  if (nThreads <= 1)
+    Reduce(0, nLength, pResult);
+  else {
+    const size_t nChunk = (nLength + nThreads - 1) / nThreads;
+    const size_t nParts = (nLength + nChunk - 1) / nChunk;
+    std::vector<T> Partials(nParts * nLines);
+    ParallelFor(
+        nParts, nThreads,
+        [&](size_t nBegin, size_t nEnd) {
+          for (size_t t = nBegin; t < nEnd; ++t)
+            Reduce(t * nChunk, std::min(nLength, (t + 1) * nChunk), Partials.data() + t * nLines);
+        },
+        pData, nChunk * nLines * sizeof(T));
+    if (eOp == MtxReduceMin || eOp == MtxReduceMax)
+      ExtremumRows(Partials.data(), nLines, 0, nParts, eOp == MtxReduceMax, pResult);
+    else
+      SumRows(Partials.data(), nLines, 0, nParts, Value, eMode, pResult);
+  }
+  if (eOp == MtxReduceMean)
+    for (size_t l = 0; l < nLines; ++l)
+      pResult[l] /= static_cast<T>(nLength);
+  else if (eOp == MtxReduceNorm)
+    for (size_t l = 0; l < nLines; ++l)
+      pResult[l] = static_cast<T>(std::sqrt(pResult[l]));
+}
+}; // namespace Mafs::Internal::Kernels
+
+#endif // MAFS_MATRIX_KERNELS_REDUCE_H
@@ -0,0 +1,370 @@
+#ifndef MAFS_MATRIX_KERNELS_SVD_H
+#define MAFS_MATRIX_KERNELS_SVD_H
+
+#include <Mafs/Matrix/Operations/Kernels/Eigen.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <stddef.h>
+
+/**
+ * Singular value decomposition.
+ *
+ * A (nRows >= nCols) is reduced to an upper bidiagonal B = Q^T * A * P by Householder reflectors
+ * from both sides (Bidiagonalize), the SVD of B is computed by implicit QR sweeps
+ * (BidiagonalQR) and the singular vectors of B are mapped back to A by the reflectors
+ * (ApplyReflectors). Like the eigensolver, singular vectors are stored one per row.
+ */
+namespace Mafs::Internal::Kernels {
+// QR sweeps per singular value before giving up.
+inline constexpr size_t nSvdMaxIterations = 75;
+
+/**
+ * @brief Reduces the nRows x nCols row major array pA (nRows >= nCols) to an upper bidiagonal
+ * B = Q^T * A * P, Q = H(0) * ... * H(nCols - 1), P = G(0) * ... * G(nCols - 2) (blocked, LAPACK
+ * gebrd).
+ *
+ * Panels of Params.nLUBlock rows and cols are reduced one at a time. The updates of the panel are
+ * accumulated as A - V * Y^T - X * U^T (V, U the reflectors), so the rest of the matrix is updated
+ * at once by a GEMM with an inner dimension of twice the panel width. The products by A inside
+ * the panel are split among threads above Params.nParallelThreshold.
+ *
+ * On return col k of pA holds the vector of H(k) in its rows k to nRows - 1 and row k holds the
+ * vector of G(k) in its cols k + 1 to nCols - 1 (see ApplyReflectors).
+ *
+ * @tparam T
+ * @param pA
+ * @param nRows
+ * @param nCols
+ * @param pD diagonal of B (nCols values).
+ * @param pE superdiagonal of B, pE[k] = B[k][k + 1] (nCols values, the last one is 0).
+ * @param pTauQ Tau of H(k) (nCols values).
+ * @param pTauP Tau of G(k) (nCols values, the last one is 0).
+ * @param Params panel width and threads.
+ */
+template <typename T>
+void Bidiagonalize(T *pA, size_t nRows, size_t nCols, T *pD, T *pE, T *pTauQ, T *pTauP,
+                   const MtxTuningParams &Params) {
+  const size_t m = nRows, n = nCols;
+  const size_t nBlock = std::max<size_t>(Params.nLUBlock, 1);
+  const size_t nThreads = ThreadCount(Params.nThreads);
+  // [V^T; X^T] (m values per row) and [Y^T; U^T] (n values per row): the GEMM operands.
+  ScratchBuffer<T> Columns(2 * nBlock * m), Rows(2 * nBlock * n), Column(m);
+
+  for (size_t k0 = 0; k0 < n; k0 += nBlock) {
+    const size_t nPanel = std::min(nBlock, n - k0);
+    T *pVt = Columns.Data(), *pXt = Columns.Data() + nPanel * m;
+    T *pYt = Rows.Data(), *pUt = Rows.Data() + nPanel * n;
+    std::fill(Columns.Data(), Columns.Data() + 2 * nPanel * m, T(0));
+    std::fill(Rows.Data(), Rows.Data() + 2 * nPanel * n, T(0));
+
+    for (size_t c = 0; c < nPanel; ++c) {
+      const size_t j = k0 + c, nHeight = m - j, nLen = n - j - 1;
+      // Col j (rows j to m - 1) with the updates of the panel, H(j) zeroes it below the diagonal.
+      T *pCol = Column.Data();
+      for (size_t r = j; r < m; ++r)
+        pCol[r - j] = pA[r * n + j];
+      for (size_t p = 0; p < c; ++p) {
+        const T Yj = pYt[p * n + j], Uj = pUt[p * n + j];
+        const T *pVp = pVt + p * m + j, *pXp = pXt + p * m + j;
+        for (size_t r = 0; r < nHeight; ++r)
+          pCol[r] -= pVp[r] * Yj + pXp[r] * Uj;
+      }
+      pTauQ[j] = Householder(pCol, nHeight, pD[j]);
+      std::copy(pCol, pCol + nHeight, pVt + c * m + j);
+      for (size_t r = j; r < m; ++r)
+        pA[r * n + j] = pCol[r - j];
+      if (nLen == 0) {
+        pE[j] = T(0);
+        pTauP[j] = T(0);
+        continue;
+      }
+
+      // y = TauQ * (A^T * v - Y * V^T * v - U * X^T * v), cols j + 1 to n - 1.
+      const T *pVec = pCol;
+      T *pY = pYt + c * n + j + 1;
+      if (pTauQ[j] != T(0)) {
+        ParallelFor(nLen, nHeight * nLen >= Params.nParallelThreshold ? nThreads : 1,
+                    [&](size_t nBegin, size_t nEnd) {
+                      for (size_t r = 0; r < nHeight; ++r) {
+                        const T *pRow = pA + (j + r) * n + j + 1;
+                        const T Value = pVec[r];
+                        for (size_t i = nBegin; i < nEnd; ++i)
+                          pY[i] += Value * pRow[i];
+                      }
+                    });
+        for (size_t p = 0; p < c; ++p) {
+          const T VDot = Dot(pVt + p * m + j, pVec, nHeight);
+          const T XDot = Dot(pXt + p * m + j, pVec, nHeight);
+          const T *pYp = pYt + p * n + j + 1, *pUp = pUt + p * n + j + 1;
+          for (size_t i = 0; i < nLen; ++i)
+            pY[i] -= pYp[i] * VDot + pUp[i] * XDot;
+        }
+        for (size_t i = 0; i < nLen; ++i)
+          pY[i] *= pTauQ[j];
+      }
+
+      // Row j (cols j + 1 to n - 1) with the updates of the panel, G(j) zeroes it after the
+      // superdiagonal.
+      T *pRow = pA + j * n + j + 1;
+      for (size_t p = 0; p <= c; ++p) {
+        const T Vj = pVt[p * m + j], Xj = p < c ? pXt[p * m + j] : T(0);
+        const T *pYp = pYt + p * n + j + 1, *pUp = pUt + p * n + j + 1;
+        for (size_t i = 0; i < nLen; ++i)
+          pRow[i] -= Vj * pYp[i] + Xj * pUp[i];
+      }
+      pTauP[j] = Householder(pRow, nLen, pE[j]);
+      std::copy(pRow, pRow + nLen, pUt + c * n + j + 1);
+      if (pTauP[j] == T(0))
+        continue;
+
+      // x = TauP * (A * u - V * Y^T * u - X * U^T * u), rows j + 1 to m - 1.
+      const size_t nBelow = nHeight - 1;
+      const T *pU = pRow;
+      T *pX = pXt + c * m + j + 1;
+      ParallelFor(nBelow, nBelow * nLen >= Params.nParallelThreshold ? nThreads : 1,
+                  [&](size_t nBegin, size_t nEnd) {
+                    for (size_t i = nBegin; i < nEnd; ++i)
+                      pX[i] = Dot(pA + (j + 1 + i) * n + j + 1, pU, nLen);
+                  });
+      for (size_t p = 0; p <= c; ++p) {
+        const T YDot = Dot(pYt + p * n + j + 1, pU, nLen);
+        const T UDot = p < c ? Dot(pUt + p * n + j + 1, pU, nLen) : T(0);
+        const T *pVp = pVt + p * m + j + 1, *pXp = pXt + p * m + j + 1;
+        for (size_t i = 0; i < nBelow; ++i)
+          pX[i] -= pVp[i] * YDot + pXp[i] * UDot;
+      }
+      for (size_t i = 0; i < nBelow; ++i)
+        pX[i] *= pTauP[j];
+    }
+
+    const size_t nNext = k0 + nPanel;
+    if (nNext == n)
+      break;
+    const size_t nRestRows = m - nNext, nRestCols = n - nNext;
+    ScratchBuffer<T> Left(nRestRows * 2 * nPanel);
+    TransposeBlocked(2 * nPanel, nRestRows, Columns.Data() + nNext, m, Left.Data(), 2 * nPanel,
+                     Params);
+    GemmFused(nRestRows, nRestCols, 2 * nPanel, T(-1), Left.Data(), 2 * nPanel,
+              Rows.Data() + nNext, n, T(1), pA + nNext * n + nNext, n, MtxEpilogue<T>(), Params);
+  }
+}
+
+/**
+ * @brief Singular values (and vectors) of the nSize x nSize upper bidiagonal (pD, pE) by implicit
+ * shifted QR sweeps (Golub and Reinsch).
+ *
+ * @tparam T
+ * @param pD diagonal, overwritten with the singular values (unordered, >= 0).
+ * @param pE superdiagonal, pE[k] = B[k][k + 1] (nSize values, the last one is ignored), destroyed.
+ * @param nSize
+ * @param pU nullptr or nSize x nSize row major array, the left rotations are applied to its rows
+ * (pass the identity to get the left singular vectors, row i for pD[i]).
+ * @param pV same for the right rotations and singular vectors.
+ * @return false if a singular value did not converge.
+ */
+template <typename T> auto BidiagonalQR(T *pD, T *pE, size_t nSize, T *pU, T *pV) -> bool {
+  if (nSize == 0)
+    return true;
+  const T Eps = std::numeric_limits<T>::epsilon();
+  auto Rotate = [nSize](T *pRows, size_t a, size_t b, T c, T s) {
+    if (pRows == nullptr)
+      return;
+    T *pFirst = pRows + a * nSize, *pSecond = pRows + b * nSize;
+    for (size_t k = 0; k < nSize; ++k) {
+      const T x = pFirst[k], y = pSecond[k];
+      pFirst[k] = x * c + y * s;
+      pSecond[k] = y * c - x * s;
+    }
+  };
+
+  // Super[k] = B[k - 1][k], Super[0] = 0.
+  ScratchBuffer<T> Super(nSize);
+  Super[0] = T(0);
+  std::copy(pE, pE + nSize - 1, Super.Data() + 1);
+  T Norm = T(0);
+  for (size_t k = 0; k < nSize; ++k)
+    Norm = std::max(Norm, std::abs(pD[k]) + std::abs(Super[k]));
+  const T Negligible = Eps * Norm;
+
+  for (size_t k = nSize; k-- > 0;)
+    for (size_t nIter = 0;; ++nIter) {
+      // Largest l <= k with a negligible Super[l] (the block [l, k] is unreduced), or with a
+      // negligible pD[l - 1], in which case Super[l] is zeroed first.
+      size_t l = k;
+      bool bCancel = false;
+      for (;; --l) {
+        if (l == 0 || std::abs(Super[l]) <= Negligible)
+          break;
+        if (std::abs(pD[l - 1]) <= Negligible) {
+          bCancel = true;
+          break;
+        }
+      }
+      if (bCancel) {
+        T c = T(0), s = T(1);
+        for (size_t i = l; i <= k; ++i) {
+          const T f = s * Super[i];
+          Super[i] *= c;
+          if (std::abs(f) <= Negligible)
+            break;
+          const T g = pD[i], h = std::hypot(f, g);
+          pD[i] = h;
+          c = g / h;
+          s = -f / h;
+          Rotate(pU, l - 1, i, c, s);
+        }
+      }
+
+      const T z = pD[k];
+      if (l == k) {
+        if (z < T(0)) {
+          pD[k] = -z;
+          if (pV != nullptr)
+            for (size_t i = 0; i < nSize; ++i)
+              pV[k * nSize + i] = -pV[k * nSize + i];
+        }
+        break;
+      }
+      if (nIter == nSvdMaxIterations)
+        return false;
+
+      // Shift from the trailing 2 x 2 block of B^T * B, then chase the bulge down [l, k].
+      T x = pD[l], y = pD[k - 1], g = Super[k - 1], h = Super[k];
+      T f = ((y - z) * (y + z) + (g - h) * (g + h)) / (T(2) * h * y);
+      g = std::hypot(f, T(1));
+      f = ((x - z) * (x + z) + h * ((y / (f + std::copysign(g, f))) - h)) / x;
+      T c = T(1), s = T(1);
+      for (size_t j = l; j < k; ++j) {
+        const size_t i = j + 1;
+        g = Super[i];
+        y = pD[i];
+        h = s * g;
+        g = c * g;
+        T r = std::hypot(f, h);
+        Super[j] = r;
+        c = f / r;
+        s = h / r;
+        f = x * c + g * s;
+        g = g * c - x * s;
+        h = y * s;
+        y *= c;
+        Rotate(pV, j, i, c, s);
+        r = std::hypot(f, h);
+        pD[j] = r;
+        if (r != T(0)) {
+          c = f / r;
+          s = h / r;
+        }
+        f = c * g + s * y;
+        x = c * y - s * g;
+        Rotate(pU, j, i, c, s);
+      }
+      Super[l] = T(0);
+      Super[k] = f;
+      pD[k] = x;
+    }
+  return true;
+}
+
+/**
+ * @brief Replaces the rows of the nRows x nCols row major array pX (nRows <= nCols) by
+ * orthonormal rows spanning the same space: X^T = Q * R by Householder, X = Q^T.
+ * The reflectors are applied to the remaining rows in parallel above Params.nParallelThreshold.
+ *
+ * @tparam T
+ * @param pX
+ * @param nRows
+ * @param nCols
+ * @param Params
+ */
+template <typename T>
+void OrthonormalizeRows(T *pX, size_t nRows, size_t nCols, const MtxTuningParams &Params) {
+  ScratchBuffer<T> Reflectors, Tau(nRows);
+  Reflectors.Assign(pX, nRows * nCols);
+  const size_t nThreads =
+      nRows * nCols >= Params.nParallelThreshold ? ThreadCount(Params.nThreads) : 1;
+  for (size_t j = 0; j < nRows; ++j) {
+    T *pVec = Reflectors.Data() + j * nCols + j;
+    const size_t nLen = nCols - j;
+    T Beta;
+    Tau[j] = Householder(pVec, nLen, Beta);
+    if (Tau[j] == T(0))
+      continue;
+    ParallelFor(nRows - j - 1, nThreads, [&](size_t nBegin, size_t nEnd) {
+      for (size_t r = j + 1 + nBegin; r < j + 1 + nEnd; ++r) {
+        T *pRow = Reflectors.Data() + r * nCols + j;
+        const T Value = Tau[j] * Dot(pRow, pVec, nLen);
+        for (size_t i = 0; i < nLen; ++i)
+          pRow[i] -= Value * pVec[i];
+      }
+    });
+  }
+  // Rows of Q^T: the first nRows unit vectors times H(nRows - 1) * ... * H(0).
+  std::fill(pX, pX + nRows * nCols, T(0));
+  for (size_t i = 0; i < nRows; ++i)
+    pX[i * nCols + i] = T(1);
+  ApplyReflectors(Reflectors.Data(), nCols, size_t(1), size_t(0), nRows, Tau.Data(), pX, nRows,
+                  nCols, Params);
+}
+
+/**
+ * @brief Thin SVD A = U * diag(S) * V^T of the nRows x nCols row major array pA
+ * (nRows >= nCols): Bidiagonalize, BidiagonalQR and ApplyReflectors.
+ *
+ * @tparam T
+ * @param pA destroyed.
+ * @param nRows
+ * @param nCols
+ * @param pS singular values, decreasing (nCols values).
+ * @param pUt nullptr or nCols x nRows row major array, row i is the left singular vector of pS[i].
+ * @param pVt nullptr or nCols x nCols row major array, row i is the right singular vector of pS[i].
+ * @param Params block sizes and threads.
+ * @return false if a singular value did not converge.
+ */
+template <typename T>
+auto Svd(T *pA, size_t nRows, size_t nCols, T *pS, T *pUt, T *pVt, const MtxTuningParams &Params)
+    -> bool {
+  ScratchBuffer<T> E(nCols), TauQ(nCols), TauP(nCols), U, V;
+  Bidiagonalize(pA, nRows, nCols, pS, E.Data(), TauQ.Data(), TauP.Data(), Params);
+  for (ScratchBuffer<T> *pVectors : {pUt != nullptr ? &U : nullptr, pVt != nullptr ? &V : nullptr})
+    if (pVectors != nullptr) {
+      pVectors->Resize(nCols * nCols);
+      std::fill(pVectors->Data(), pVectors->Data() + nCols * nCols, T(0));
+      for (size_t i = 0; i < nCols; ++i)
+        (*pVectors)[i * nCols + i] = T(1);
+    }
+  if (!BidiagonalQR(pS, E.Data(), nCols, pUt != nullptr ? U.Data() : nullptr,
+                    pVt != nullptr ? V.Data() : nullptr))
+    return false;
+
+  ScratchBuffer<size_t> Order(nCols);
+  ScratchBuffer<T> Sorted(nCols);
+  std::iota(Order.Data(), Order.Data() + nCols, size_t(0));
+  std::stable_sort(Order.Data(), Order.Data() + nCols,
+                   [pS](size_t a, size_t b) { return pS[a] > pS[b]; });
+  for (size_t i = 0; i < nCols; ++i)
+    Sorted[i] = pS[Order[i]];
+  std::copy(Sorted.Data(), Sorted.Data() + nCols, pS);
+
+  if (pUt != nullptr) {
+    for (size_t i = 0; i < nCols; ++i) {
+      const T *pSource = U.Data() + Order[i] * nCols;
+      std::copy(pSource, pSource + nCols, pUt + i * nRows);
+      std::fill(pUt + i * nRows + nCols, pUt + (i + 1) * nRows, T(0));
+    }
+    ApplyReflectors(pA, size_t(1), nCols, size_t(0), nCols, TauQ.Data(), pUt, nCols, nRows,
+                    Params);
+  }
+  if (pVt != nullptr) {
+    for (size_t i = 0; i < nCols; ++i)
+      std::copy(V.Data() + Order[i] * nCols, V.Data() + (Order[i] + 1) * nCols, pVt + i * nCols);
+    ApplyReflectors(pA, nCols, size_t(1), size_t(1), nCols > 0 ? nCols - 1 : 0, TauP.Data(), pVt,
+                    nCols, nCols, Params);
+  }
+  return true;
+}
+}; // namespace Mafs::Internal::Kernels
+
+#endif // MAFS_MATRIX_KERNELS_SVD_H
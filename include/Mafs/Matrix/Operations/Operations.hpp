@@ -2,10 +2,16 @@
 #define MAFS_MATRIXOPERATIONS_H
 
 #include <Mafs/Matrix/MatrixBase.hpp>
+#include <Mafs/Matrix/Operations/Async.hpp>
 #include <Mafs/Matrix/Operations/BasicOperations.hpp>
 #include <Mafs/Matrix/Operations/CudaOperations.hpp>
+#include <Mafs/Matrix/Operations/Tuning.hpp>
+#include <Mafs/Utils/Instrumentation.hpp>
+#include <Mafs/Utils/PerfCounters.hpp>
+#include <algorithm>
 #include <stdexcept>
 #include <type_traits>
+#include <vector>
 
 namespace Mafs::Internal {
 
@@ -30,14 +36,385 @@ protected:
       return BasicOperations;
   }
 
+  /**
+   * @brief Cost of a nSize x nSize Gram matrix of depth nDepth (one triangle, see Gram).
+   */
+  static constexpr auto GramFlops(size_t nSize, size_t nDepth) -> double {
+    return static_cast<double>(nSize) * static_cast<double>(nSize + 1) *
+           static_cast<double>(nDepth);
+  }
+
+  /**
+   * @brief Cost of Power: one nSize x nSize product per bit of nExponent after the highest and
+   * per other set bit.
+   */
+  static constexpr auto PowerFlops(size_t nSize, uint64_t nExponent) -> double {
+    size_t nProducts = 0;
+    for (uint64_t n = nExponent; n > 1; n >>= 1)
+      nProducts += 1 + (n & 1);
+    return 2.0 * static_cast<double>(nProducts) * static_cast<double>(nSize) *
+           static_cast<double>(nSize) * static_cast<double>(nSize);
+  }
+
+  /**
+   * @brief Estimated cost of solving a nSize x nSize system with nRhs right hand sides through a
+   * LU decomposition (factorization + substitutions).
+   */
+  static constexpr auto SolveFlops(size_t nSize, size_t nRhs) -> double {
+    return 2.0 / 3.0 * static_cast<double>(nSize) * static_cast<double>(nSize) *
+               static_cast<double>(nSize) +
+           2.0 * static_cast<double>(nSize) * static_cast<double>(nSize) *
+               static_cast<double>(nRhs);
+  }
+
+  /**
+   * @brief Estimated cost of Exp without scaling (degree 13 Pade approximant: 6 products and a
+   * solve with nSize right hand sides).
+   */
+  static constexpr auto ExpFlops(size_t nSize) -> double {
+    return 12.0 * static_cast<double>(nSize) * static_cast<double>(nSize) *
+               static_cast<double>(nSize) +
+           SolveFlops(nSize, nSize);
+  }
+
+  /**
+   * @brief Estimated cost of the correlation of Image with nFilters filters of nFilterRows x
+   * nFilterCols (a multiply-add per filter entry and output value).
+   */
+  template <typename Derived>
+  static auto CorrelationFlops(const MatrixBase<Derived> &Image, size_t nFilters,
+                               size_t nFilterRows, size_t nFilterCols,
+                               const MtxConvolution &Options) -> double {
+    const size_t nRows = Image.RowCount() + 2 * Options.nPaddingRow;
+    const size_t nCols = Image.ColCount() + 2 * Options.nPaddingCol;
+    if (nFilterRows > nRows || nFilterCols > nCols || Options.nStrideRow == 0 ||
+        Options.nStrideCol == 0)
+      return 0;
+    const size_t nOutRows = (nRows - nFilterRows) / Options.nStrideRow + 1;
+    const size_t nOutCols = (nCols - nFilterCols) / Options.nStrideCol + 1;
+    return 2.0 * static_cast<double>(nFilters) * static_cast<double>(nOutRows * nOutCols) *
+           static_cast<double>(nFilterRows * nFilterCols);
+  }
+
+  /**
+   * @brief Estimated cost of the eigendecomposition of a nSize x nSize symmetric matrix
+   * (tridiagonal reduction + back transformation of the eigenvectors, see SymmetricEigen).
+   */
+  static constexpr auto EigenFlops(size_t nSize, MtxEigenJob eJob, size_t nCount) -> double {
+    const size_t nVectors = eJob == MtxEigenValues ? 0 : nCount == 0 ? nSize : nCount;
+    return 4.0 / 3.0 * static_cast<double>(nSize) * static_cast<double>(nSize) *
+               static_cast<double>(nSize) +
+           2.0 * static_cast<double>(nSize) * static_cast<double>(nSize) *
+               static_cast<double>(std::min(nVectors, nSize));
+  }
+
+  /**
+   * @brief Estimated cost of the SVD of a nRows x nCols matrix (bidiagonal reduction + back
+   * transformation of the singular vectors, see Svd).
+   */
+  static constexpr auto SvdFlops(size_t nRows, size_t nCols, MtxSvdJob eJob) -> double {
+    const double Tall = static_cast<double>(std::max(nRows, nCols));
+    const double Thin = static_cast<double>(std::min(nRows, nCols));
+    return 4.0 * Tall * Thin * Thin - 4.0 / 3.0 * Thin * Thin * Thin +
+           (eJob == MtxSvdValues ? 0.0 : 2.0 * (Tall + Thin) * Thin * Thin);
+  }
+
+  /**
+   * @brief Estimated cost of RandomizedSvd: 2 * nPowerIterations + 2 products of the nRows x
+   * nCols matrix by nSketch vectors.
+   */
+  static constexpr auto RandomizedSvdFlops(size_t nRows, size_t nCols, size_t nSketch,
+                                           size_t nPowerIterations) -> double {
+    return 2.0 * static_cast<double>(2 * nPowerIterations + 2) * static_cast<double>(nRows) *
+           static_cast<double>(nCols) * static_cast<double>(nSketch);
+  }
+
 public:
   MatrixOperations() = default;
 
+  /**
+   * @brief Name of the backend selected by MAFS_MATRIX_OPERATION_MODE.
+   */
+  static constexpr auto BackendName() -> const char * {
+    return AreEnumsEqual<m_OpMode, MtxOpCuda>() ? "Cuda" : "Basic";
+  }
+
   template <typename Derived, typename OtherDerived>
   auto Sum(const MatrixBase<Derived> &lMatrix, const MatrixBase<OtherDerived> &rMatrix) -> Derived {
+    MAFS_OP_SCOPE(BackendName(), "Sum", lMatrix.Size(), lMatrix.Size(),
+                  3 * sizeof(typename MatrixTraits<Derived>::Type) * lMatrix.Size());
+    MAFS_PERF_SCOPE(BackendName(), "Sum");
     return Operations().Sum(lMatrix, rMatrix);
   }
 
+  template <typename Derived, typename OtherDerived>
+  auto Multiplication(const MatrixBase<Derived> &lMatrix, const MatrixBase<OtherDerived> &rMatrix)
+      -> MultiplicationResult<Derived, OtherDerived> {
+    MAFS_OP_SCOPE(BackendName(), "Multiplication", lMatrix.RowCount() * rMatrix.ColCount(),
+                  2.0 * static_cast<double>(lMatrix.RowCount()) *
+                      static_cast<double>(rMatrix.ColCount()) *
+                      static_cast<double>(lMatrix.ColCount()),
+                  sizeof(typename MatrixTraits<Derived>::Type) *
+                      (lMatrix.Size() + rMatrix.Size() + lMatrix.RowCount() * rMatrix.ColCount()));
+    MAFS_PERF_SCOPE(BackendName(), "Multiplication");
+    return Operations().Multiplication(lMatrix, rMatrix);
+  }
+
+  template <typename Derived, typename OtherDerived, typename ResultDerived,
+            typename Func = MtxIdentity>
+  void Multiplication(const MatrixBase<Derived> &lMatrix, MtxTransposeOp eOpL,
+                      const MatrixBase<OtherDerived> &rMatrix, MtxTransposeOp eOpR,
+                      MatrixBase<ResultDerived> &Result,
+                      typename MatrixTraits<Derived>::Type Alpha = 1,
+                      typename MatrixTraits<Derived>::Type Beta = 0,
+                      const MtxEpilogue<typename MatrixTraits<Derived>::Type, Func> &Epilogue =
+                          {}) {
+    MAFS_OP_SCOPE(BackendName(), "Multiplication", Result.Size(),
+                  2.0 * static_cast<double>(Result.Size()) *
+                      static_cast<double>(eOpL == MtxNoTrans ? lMatrix.ColCount()
+                                                             : lMatrix.RowCount()),
+                  sizeof(typename MatrixTraits<Derived>::Type) *
+                      (lMatrix.Size() + rMatrix.Size() + (Beta != 0 ? 2 : 1) * Result.Size()));
+    MAFS_PERF_SCOPE(BackendName(), "Multiplication");
+    Operations().Multiplication(lMatrix, eOpL, rMatrix, eOpR, Result, Alpha, Beta, Epilogue);
+  }
+
+  template <typename Derived>
+  auto Gram(const MatrixBase<Derived> &Matrix, MtxTransposeOp eOp) -> GramResult<Derived> {
+    MAFS_OP_SCOPE(BackendName(), "Gram",
+                  eOp == MtxNoTrans ? Matrix.RowCount() * Matrix.RowCount()
+                                    : Matrix.ColCount() * Matrix.ColCount(),
+                  eOp == MtxNoTrans ? GramFlops(Matrix.RowCount(), Matrix.ColCount())
+                                    : GramFlops(Matrix.ColCount(), Matrix.RowCount()),
+                  sizeof(typename MatrixTraits<Derived>::Type) * Matrix.Size());
+    MAFS_PERF_SCOPE(BackendName(), "Gram");
+    return Operations().Gram(Matrix, eOp);
+  }
+
+  template <typename Derived, typename ResultDerived>
+  void Gram(const MatrixBase<Derived> &Matrix, MtxTransposeOp eOp,
+            MatrixBase<ResultDerived> &Result, typename MatrixTraits<Derived>::Type Alpha = 1,
+            typename MatrixTraits<Derived>::Type Beta = 0) {
+    MAFS_OP_SCOPE(BackendName(), "Gram", Result.Size(),
+                  GramFlops(Result.RowCount(), eOp == MtxNoTrans ? Matrix.ColCount()
+                                                                 : Matrix.RowCount()),
+                  sizeof(typename MatrixTraits<Derived>::Type) *
+                      (Matrix.Size() + (Beta != 0 ? 2 : 1) * Result.Size()));
+    MAFS_PERF_SCOPE(BackendName(), "Gram");
+    Operations().Gram(Matrix, eOp, Result, Alpha, Beta);
+  }
+
+  template <typename Derived>
+  auto Power(const MatrixBase<Derived> &Matrix, uint64_t nExponent) -> Derived {
+    MAFS_OP_SCOPE(BackendName(), "Power", Matrix.Size(), PowerFlops(Matrix.RowCount(), nExponent),
+                  2 * sizeof(typename MatrixTraits<Derived>::Type) * Matrix.Size());
+    MAFS_PERF_SCOPE(BackendName(), "Power");
+    return Operations().Power(Matrix, nExponent);
+  }
+
+  template <typename Derived, typename ResultDerived>
+  void Power(const MatrixBase<Derived> &Matrix, uint64_t nExponent,
+             MatrixBase<ResultDerived> &Result) {
+    MAFS_OP_SCOPE(BackendName(), "Power", Result.Size(), PowerFlops(Matrix.RowCount(), nExponent),
+                  2 * sizeof(typename MatrixTraits<Derived>::Type) * Matrix.Size());
+    MAFS_PERF_SCOPE(BackendName(), "Power");
+    Operations().Power(Matrix, nExponent, Result);
+  }
+
+  template <typename Derived> auto Exp(const MatrixBase<Derived> &Matrix) -> Derived {
+    MAFS_OP_SCOPE(BackendName(), "Exp", Matrix.Size(), ExpFlops(Matrix.RowCount()),
+                  2 * sizeof(typename MatrixTraits<Derived>::Type) * Matrix.Size());
+    MAFS_PERF_SCOPE(BackendName(), "Exp");
+    return Operations().Exp(Matrix);
+  }
+
+  template <typename Derived, typename ResultDerived>
+  void Exp(const MatrixBase<Derived> &Matrix, MatrixBase<ResultDerived> &Result) {
+    MAFS_OP_SCOPE(BackendName(), "Exp", Result.Size(), ExpFlops(Matrix.RowCount()),
+                  2 * sizeof(typename MatrixTraits<Derived>::Type) * Matrix.Size());
+    MAFS_PERF_SCOPE(BackendName(), "Exp");
+    Operations().Exp(Matrix, Result);
+  }
+
+  template <typename Derived, typename FilterDerived>
+  auto Correlation(const MatrixBase<Derived> &Image, const MatrixBase<FilterDerived> &Filter,
+                   const MtxConvolution &Options = {}) -> ConvolutionResult<Derived> {
+    MAFS_OP_SCOPE(BackendName(), "Correlation", Image.Size(),
+                  CorrelationFlops(Image, 1, Filter.RowCount(), Filter.ColCount(), Options),
+                  2 * sizeof(typename MatrixTraits<Derived>::Type) * Image.Size());
+    MAFS_PERF_SCOPE(BackendName(), "Correlation");
+    return Operations().Correlation(Image, Filter, Options);
+  }
+
+  template <typename Derived, typename FilterDerived>
+  auto Correlation(const MatrixBase<Derived> &Image, const std::vector<FilterDerived> &Filters,
+                   const MtxConvolution &Options = {}) -> std::vector<ConvolutionResult<Derived>> {
+    MAFS_OP_SCOPE(BackendName(), "Correlation", Image.Size() * Filters.size(),
+                  Filters.empty() ? 0
+                                  : CorrelationFlops(Image, Filters.size(), Filters[0].RowCount(),
+                                                     Filters[0].ColCount(), Options),
+                  2 * sizeof(typename MatrixTraits<Derived>::Type) * Image.Size());
+    MAFS_PERF_SCOPE(BackendName(), "Correlation");
+    return Operations().Correlation(Image, Filters, Options);
+  }
+
+  template <typename Derived, typename FilterDerived>
+  auto Convolution(const MatrixBase<Derived> &Image, const MatrixBase<FilterDerived> &Filter,
+                   const MtxConvolution &Options = {}) -> ConvolutionResult<Derived> {
+    MAFS_OP_SCOPE(BackendName(), "Convolution", Image.Size(),
+                  CorrelationFlops(Image, 1, Filter.RowCount(), Filter.ColCount(), Options),
+                  2 * sizeof(typename MatrixTraits<Derived>::Type) * Image.Size());
+    MAFS_PERF_SCOPE(BackendName(), "Convolution");
+    return Operations().Convolution(Image, Filter, Options);
+  }
+
+  template <typename Derived, typename FilterDerived>
+  auto Convolution(const MatrixBase<Derived> &Image, const std::vector<FilterDerived> &Filters,
+                   const MtxConvolution &Options = {}) -> std::vector<ConvolutionResult<Derived>> {
+    MAFS_OP_SCOPE(BackendName(), "Convolution", Image.Size() * Filters.size(),
+                  Filters.empty() ? 0
+                                  : CorrelationFlops(Image, Filters.size(), Filters[0].RowCount(),
+                                                     Filters[0].ColCount(), Options),
+                  2 * sizeof(typename MatrixTraits<Derived>::Type) * Image.Size());
+    MAFS_PERF_SCOPE(BackendName(), "Convolution");
+    return Operations().Convolution(Image, Filters, Options);
+  }
+
+  template <typename Derived, typename OtherDerived>
+  auto HorizontalConcat(const MatrixBase<Derived> &lMatrix, const MatrixBase<OtherDerived> &rMatrix)
+      -> ConcatResult<Derived> {
+    MAFS_OP_SCOPE(BackendName(), "HorizontalConcat", lMatrix.Size() + rMatrix.Size(), 0,
+                  2 * sizeof(typename MatrixTraits<Derived>::Type) *
+                      (lMatrix.Size() + rMatrix.Size()));
+    MAFS_PERF_SCOPE(BackendName(), "HorizontalConcat");
+    return Operations().HorizontalConcat(lMatrix, rMatrix);
+  }
+
+  template <typename Derived, typename OtherDerived>
+  auto VerticalConcat(const MatrixBase<Derived> &lMatrix, const MatrixBase<OtherDerived> &rMatrix)
+      -> ConcatResult<Derived> {
+    MAFS_OP_SCOPE(BackendName(), "VerticalConcat", lMatrix.Size() + rMatrix.Size(), 0,
+                  2 * sizeof(typename MatrixTraits<Derived>::Type) *
+                      (lMatrix.Size() + rMatrix.Size()));
+    MAFS_PERF_SCOPE(BackendName(), "VerticalConcat");
+    return Operations().VerticalConcat(lMatrix, rMatrix);
+  }
+
+  template <typename Derived>
+  auto Transpose(const MatrixBase<Derived> &Matrix) -> TransposeResult<Derived> {
+    MAFS_OP_SCOPE(BackendName(), "Transpose", Matrix.Size(), 0,
+                  2 * sizeof(typename MatrixTraits<Derived>::Type) * Matrix.Size());
+    MAFS_PERF_SCOPE(BackendName(), "Transpose");
+    return Operations().Transpose(Matrix);
+  }
+
+  template <typename Derived, typename OtherDerived>
+  auto Solve(const MatrixBase<Derived> &lMatrix, const MatrixBase<OtherDerived> &rMatrix)
+      -> OtherDerived {
+    MAFS_OP_SCOPE(BackendName(), "Solve", rMatrix.Size(),
+                  SolveFlops(lMatrix.RowCount(), rMatrix.ColCount()),
+                  sizeof(typename MatrixTraits<Derived>::Type) *
+                      (lMatrix.Size() + 2 * rMatrix.Size()));
+    MAFS_PERF_SCOPE(BackendName(), "Solve");
+    return Operations().Solve(lMatrix, rMatrix);
+  }
+
+  template <typename Derived, typename OtherDerived>
+  auto MixedPrecisionSolve(const MatrixBase<Derived> &lMatrix,
+                           const MatrixBase<OtherDerived> &rMatrix, MtxSolverInfo *pInfo = nullptr)
+      -> OtherDerived {
+    MAFS_OP_SCOPE(BackendName(), "MixedPrecisionSolve", rMatrix.Size(),
+                  SolveFlops(lMatrix.RowCount(), rMatrix.ColCount()),
+                  sizeof(typename MatrixTraits<Derived>::Type) *
+                      (lMatrix.Size() + 2 * rMatrix.Size()));
+    MAFS_PERF_SCOPE(BackendName(), "MixedPrecisionSolve");
+    return Operations().MixedPrecisionSolve(lMatrix, rMatrix, pInfo);
+  }
+
+  template <typename Derived>
+  auto SymmetricEigen(const MatrixBase<Derived> &Matrix, MtxEigenJob eJob = MtxEigenVectors,
+                      size_t nCount = 0) -> SymmetricEigenResult<Derived> {
+    MAFS_OP_SCOPE(BackendName(), "SymmetricEigen", Matrix.Size(),
+                  EigenFlops(Matrix.RowCount(), eJob, nCount),
+                  2 * sizeof(typename MatrixTraits<Derived>::Type) * Matrix.Size());
+    MAFS_PERF_SCOPE(BackendName(), "SymmetricEigen");
+    return Operations().SymmetricEigen(Matrix, eJob, nCount);
+  }
+
+  template <typename Derived>
+  auto Svd(const MatrixBase<Derived> &Matrix, MtxSvdJob eJob = MtxSvdVectors)
+      -> SvdResult<Derived> {
+    MAFS_OP_SCOPE(BackendName(), "Svd", Matrix.Size(),
+                  SvdFlops(Matrix.RowCount(), Matrix.ColCount(), eJob),
+                  2 * sizeof(typename MatrixTraits<Derived>::Type) * Matrix.Size());
+    MAFS_PERF_SCOPE(BackendName(), "Svd");
+    return Operations().Svd(Matrix, eJob);
+  }
+
+  template <typename Derived>
+  auto RandomizedSvd(const MatrixBase<Derived> &Matrix, size_t nRank, size_t nOversampling = 10,
+                     size_t nPowerIterations = 2, uint64_t nSeed = 0) -> SvdResult<Derived> {
+    MAFS_OP_SCOPE(BackendName(), "RandomizedSvd", Matrix.Size(),
+                  RandomizedSvdFlops(Matrix.RowCount(), Matrix.ColCount(),
+                                     nRank + nOversampling, nPowerIterations),
+                  (2 * nPowerIterations + 2) * sizeof(typename MatrixTraits<Derived>::Type) *
+                      Matrix.Size());
+    MAFS_PERF_SCOPE(BackendName(), "RandomizedSvd");
+    return Operations().RandomizedSvd(Matrix, nRank, nOversampling, nPowerIterations, nSeed);
+  }
+
+  /**
+   * @brief Block sizes and thresholds used by the kernels (loaded from the tuning cache on first
+   * use, see Tuning.hpp).
+   *
+   * @return MtxTuningParams
+   */
+  auto TuningParams() -> MtxTuningParams { return Tuning::Instance().Get(); }
+
+  /**
+   * @brief Overrides the tuning parameters for this process (the cache file is not changed).
+   *
+   * @param Params
+   */
+  void SetTuningParams(const MtxTuningParams &Params) { Tuning::Instance().Set(Params); }
+
+  /**
+   * @brief Benchmarks the kernels on this host, uses the best parameters from now on and, if
+   * bSave, stores them in the tuning cache under the CPU model.
+   *
+   * @param bSave
+   * @param nSize problem size of the benchmarks (see RunAutoTune).
+   * @return MtxTuningParams
+   */
+  auto AutoTune(bool bSave = true, size_t nSize = 256) -> MtxTuningParams {
+    const MtxTuningParams Params = RunAutoTune(nSize);
+    Tuning::Instance().Set(Params);
+    if (bSave)
+      SaveTuning(TuningCachePath(), CpuModel(), Params);
+    return Params;
+  }
+
+  /**
+   * @brief Runs Function(Dependencies.Get()...) on the background executor once every dependency
+   * finished and returns the future of its result (see Async.hpp).
+   *
+   * Usage:
+   * auto A = MtxOperation.Async([]() { return Mafs::Load<MatrixType>("a.mtx"); });
+   * auto B = MtxOperation.Async([]() { return Mafs::Load<MatrixType>("b.mtx"); });
+   * auto C = MtxOperation.Async([](const MatrixType &a, const MatrixType &b) {
+   *   return MtxOperation.Multiplication(a, b); }, A, B);
+   * auto Saved = MtxOperation.Async([](const auto &c) { Mafs::Save(c, "c.mtx"); }, C);
+   * auto D = MtxOperation.Async([]() { return Mafs::Load<MatrixType>("c.mtx"); }, Saved);
+   *
+   * @param Function
+   * @param Dependencies futures whose values are passed to Function (void ones only order it).
+   * @return MtxFuture<R> R = result of Function.
+   */
+  template <typename Func, typename... Deps>
+  auto Async(Func &&Function, const MtxFuture<Deps> &...Dependencies) {
+    return Executor::Instance().Submit(std::forward<Func>(Function), Dependencies...);
+  }
+
   template <typename Derived, typename OtherDerived>
   bool Equals(const MatrixBase<Derived> &lMatrix, const MatrixBase<OtherDerived> &rMatrix) {
     return true;
@@ -0,0 +1,364 @@
+#ifndef MAFS_MATRIX_TUNING_H
+#define MAFS_MATRIX_TUNING_H
+
+#include <Mafs/Matrix/MatrixDataTypes.hpp>
+#include <Mafs/Matrix/Operations/Kernels/Convolution.hpp>
+#include <Mafs/Matrix/Operations/Kernels/Gemm.hpp>
+#include <Mafs/Matrix/Operations/Kernels/LU.hpp>
+#include <Mafs/Matrix/Operations/Kernels/Parallel.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fmt/format.h>
+#include <fstream>
+#include <initializer_list>
+#include <limits>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * Per host tuning of the blocked kernels.
+ *
+ * The MtxTuningParams are cached in a text file with one section per host, keyed by the CPU model
+ * and the number of hardware threads:
+ *
+ * [Intel(R) Core(TM) i7-8700K CPU @ 3.70GHz (12 threads)]
+ * GemmBlockM = 64
+ * ...
+ *
+ * The file is MAFS_TUNING_FILE if set, otherwise $XDG_CACHE_HOME/mafs/tuning.cfg or
+ * $HOME/.cache/mafs/tuning.cfg. The parameters are loaded on the first operation; if the host is
+ * not in the file they are the MtxTuningParams defaults, unless MAFS_ENABLE_AUTOTUNE is defined
+ * (CMake option ENABLE_AUTOTUNE) or the MAFS_AUTOTUNE environment variable is 1, in which case
+ * the host is tuned once and the result saved. The mafs_tune tool (benchmarks/) does the same on
+ * demand.
+ */
+namespace Mafs::Internal {
+
+/**
+ * @brief Key of the host in the tuning cache: "<CPU model> (<n> threads)".
+ *
+ * @return std::string
+ */
+inline auto CpuModel() -> std::string {
+  std::string strModel;
+  std::ifstream CpuInfo("/proc/cpuinfo");
+  for (std::string strLine; strModel.empty() && std::getline(CpuInfo, strLine);) {
+    // "model name" on x86, "Model"/"CPU part" elsewhere.
+    for (const char *pKey : {"model name", "Model", "CPU part"})
+      if (strLine.rfind(pKey, 0) == 0 && strLine.find(':') != std::string::npos) {
+        strModel = strLine.substr(strLine.find(':') + 1);
+        strModel.erase(0, strModel.find_first_not_of(" \t"));
+        break;
+      }
+  }
+  if (strModel.empty())
+    strModel = "Unknown CPU";
+  return fmt::format("{} ({} threads)", strModel, std::thread::hardware_concurrency());
+}
+
+/**
+ * @brief Path of the tuning cache file.
+ *
+ * @return std::string
+ */
+inline auto TuningCachePath() -> std::string {
+  if (const char *pPath = std::getenv("MAFS_TUNING_FILE"); pPath != nullptr && *pPath != '\0')
+    return pPath;
+  if (const char *pCache = std::getenv("XDG_CACHE_HOME"); pCache != nullptr && *pCache != '\0')
+    return fmt::format("{}/mafs/tuning.cfg", pCache);
+  if (const char *pHome = std::getenv("HOME"); pHome != nullptr && *pHome != '\0')
+    return fmt::format("{}/.cache/mafs/tuning.cfg", pHome);
+  return "mafs_tuning.cfg";
+}
+
+/**
+ * @brief Names of the MtxTuningParams fields in the cache file.
+ */
+inline constexpr std::pair<const char *, size_t MtxTuningParams::*> TuningFields[] = {
+    {"GemmBlockM", &MtxTuningParams::nGemmBlockM},
+    {"GemmBlockN", &MtxTuningParams::nGemmBlockN},
+    {"GemmBlockK", &MtxTuningParams::nGemmBlockK},
+    {"TransposeBlock", &MtxTuningParams::nTransposeBlock},
+    {"LUBlock", &MtxTuningParams::nLUBlock},
+    {"ParallelThreshold", &MtxTuningParams::nParallelThreshold},
+    {"Threads", &MtxTuningParams::nThreads},
+    {"ConvDirectTaps", &MtxTuningParams::nConvDirectTaps}};
+
+/**
+ * @brief Reads the section strKey of the cache file into Params.
+ * Fields missing from the section keep their value.
+ *
+ * @param strPath
+ * @param strKey
+ * @param Params
+ * @return false if the file or the section doesn't exist.
+ */
+inline auto LoadTuning(const std::string &strPath, const std::string &strKey,
+                       MtxTuningParams &Params) -> bool {
+  std::ifstream File(strPath);
+  bool bFound = false, bInSection = false;
+  for (std::string strLine; std::getline(File, strLine);) {
+    if (!strLine.empty() && strLine.back() == '\r')
+      strLine.pop_back();
+    if (!strLine.empty() && strLine.front() == '[') {
+      bInSection = strLine == "[" + strKey + "]";
+      bFound = bFound || bInSection;
+      continue;
+    }
+    const size_t nEqual = strLine.find('=');
+    if (!bInSection || nEqual == std::string::npos)
+      continue;
+    std::string strName = strLine.substr(0, nEqual);
+    strName.erase(strName.find_last_not_of(" \t") + 1);
+    for (const auto &[pName, pField] : TuningFields)
+      if (strName == pName)
+        Params.*pField = std::strtoull(strLine.c_str() + nEqual + 1, nullptr, 10);
+  }
+  return bFound;
+}
+
+/**
+ * @brief Writes Params as the section strKey of the cache file, the other sections are kept.
+ * Throws std::runtime_error if the file can't be written.
+ *
+ * @param strPath
+ * @param strKey
+ * @param Params
+ */
+inline void SaveTuning(const std::string &strPath, const std::string &strKey,
+                       const MtxTuningParams &Params) {
+  std::string strContent;
+  {
+    std::ifstream File(strPath);
+    bool bInSection = false;
+    for (std::string strLine; std::getline(File, strLine);) {
+      if (!strLine.empty() && strLine.front() == '[')
+        bInSection = strLine == "[" + strKey + "]";
+      if (!bInSection)
+        strContent += strLine + "\n";
+    }
+  }
+  strContent += fmt::format("[{}]\n", strKey);
+  for (const auto &[pName, pField] : TuningFields)
+    strContent += fmt::format("{} = {}\n", pName, Params.*pField);
+
+  const std::filesystem::path Path(strPath);
+  std::error_code Error;
+  if (Path.has_parent_path())
+    std::filesystem::create_directories(Path.parent_path(), Error);
+
+  // Written aside and renamed, so a concurrent reader never sees a partial file.
+  const std::string strTmpPath = strPath + ".tmp";
+  {
+    std::ofstream File(strTmpPath, std::ios::trunc);
+    if (!(File << strContent))
+      throw std::runtime_error(fmt::format("Could not write {}", strTmpPath));
+  }
+  if (std::rename(strTmpPath.c_str(), strPath.c_str()) != 0)
+    throw std::runtime_error(fmt::format("Could not write {}", strPath));
+}
+
+/**
+ * @brief Benchmarks candidate parameters on this host (double precision) and returns the best.
+ *
+ * The Gemm blocks are searched one dimension at a time on a nSize^3 product, the transpose block on
+ * a (4 nSize)^2 matrix and the LU panel on a nSize^2 matrix. The direct convolutions are used up
+ * to the largest square filter they still correlate faster than im2col on a nSize^2 image. With
+ * MAFS_ENABLE_THREADS the parallel threshold is the smallest product that runs faster on every
+ * core than on one. Takes a few seconds with the default size.
+ *
+ * @param nSize
+ * @return MtxTuningParams
+ */
+inline auto RunAutoTune(size_t nSize = 256) -> MtxTuningParams {
+  // Best of 3 runs, in seconds.
+  auto Measure = [](auto &&Function) {
+    double Best = std::numeric_limits<double>::max();
+    for (int nRun = 0; nRun < 3; ++nRun) {
+      const auto Start = std::chrono::steady_clock::now();
+      Function();
+      Best = std::min(
+          Best, std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count());
+    }
+    return Best;
+  };
+  // Picks the candidate of *pField with the lowest Time(Params).
+  auto Search = [](MtxTuningParams &Params, size_t MtxTuningParams::*pField,
+                   std::initializer_list<size_t> Candidates, auto &&Time) {
+    double Best = std::numeric_limits<double>::max();
+    size_t nBest = Params.*pField;
+    for (const size_t nCandidate : Candidates) {
+      Params.*pField = nCandidate;
+      const double Seconds = Time(Params);
+      if (Seconds < Best) {
+        Best = Seconds;
+        nBest = nCandidate;
+      }
+    }
+    Params.*pField = nBest;
+  };
+
+  std::mt19937 Generator(1);
+  std::uniform_real_distribution<double> Distribution(-1, 1);
+  const size_t nTransposeSize = 4 * nSize;
+  std::vector<double> A(nTransposeSize * nTransposeSize), B(A.size()), C(nSize * nSize);
+  for (auto &Value : A)
+    Value = Distribution(Generator);
+  for (auto &Value : B)
+    Value = Distribution(Generator);
+  volatile double Sink = 0;
+
+  // The blocks are tuned for a single thread.
+  MtxTuningParams Params;
+  Params.nParallelThreshold = std::numeric_limits<size_t>::max();
+  auto GemmTime = [&](const MtxTuningParams &Candidate, size_t nM) {
+    return Measure([&]() {
+      std::fill(C.begin(), C.begin() + static_cast<std::ptrdiff_t>(nM * nM), 0.0);
+      Kernels::GemmBlocked(nM, nM, nM, 1.0, A.data(), nM, B.data(), nM, C.data(), nM, Candidate);
+      Sink = Sink + C[0];
+    });
+  };
+  auto FullGemmTime = [&](const MtxTuningParams &Candidate) { return GemmTime(Candidate, nSize); };
+  Search(Params, &MtxTuningParams::nGemmBlockK, {32, 64, 128, 256}, FullGemmTime);
+  Search(Params, &MtxTuningParams::nGemmBlockM, {16, 32, 64, 128}, FullGemmTime);
+  Search(Params, &MtxTuningParams::nGemmBlockN, {64, 128, 256, 512}, FullGemmTime);
+
+  Search(Params, &MtxTuningParams::nTransposeBlock, {8, 16, 32, 64, 128},
+         [&](const MtxTuningParams &Candidate) {
+           return Measure([&]() {
+             Kernels::TransposeBlocked(nTransposeSize, nTransposeSize, A.data(), nTransposeSize,
+                                       B.data(), nTransposeSize, Candidate);
+             Sink = Sink + B[1];
+           });
+         });
+
+  // Diagonally dominant, so no candidate fails on a singular panel.
+  std::vector<double> LU(nSize * nSize);
+  std::vector<size_t> Pivots(nSize);
+  Search(Params, &MtxTuningParams::nLUBlock, {16, 32, 64, 128},
+         [&](const MtxTuningParams &Candidate) {
+           return Measure([&]() {
+             std::copy(A.begin(), A.begin() + static_cast<std::ptrdiff_t>(LU.size()), LU.begin());
+             for (size_t i = 0; i < nSize; ++i)
+               LU[i * nSize + i] += static_cast<double>(nSize);
+             Kernels::LUFactorBlocked(LU.data(), nSize, Pivots.data(), Candidate);
+             Sink = Sink + LU[0];
+           });
+         });
+
+  Params.nConvDirectTaps = 1;
+  for (size_t k = 2; k <= std::min<size_t>(16, nSize); ++k) {
+    const size_t nOut = nSize - k + 1;
+    auto CorrelationTime = [&](bool bDirect) {
+      return Measure([&]() {
+        if (bDirect)
+          Kernels::CorrelationDirect(A.data(), nSize, 1, k, k, B.data(), nOut, nOut,
+                                     MtxConvolution(), C.data(), Params);
+        else
+          Kernels::CorrelationIm2Col(A.data(), nSize, 1, k, k, B.data(), nOut, nOut,
+                                     MtxConvolution(), C.data(), Params);
+        Sink = Sink + C[0];
+      });
+    };
+    if (CorrelationTime(false) < CorrelationTime(true))
+      break;
+    Params.nConvDirectTaps = k * k;
+  }
+
+  Params.nParallelThreshold = MtxTuningParams().nParallelThreshold;
+#ifdef MAFS_ENABLE_THREADS
+  if (Kernels::ThreadCount(0) > 1) {
+    MtxTuningParams Serial = Params, Parallel = Params;
+    Serial.nParallelThreshold = std::numeric_limits<size_t>::max();
+    Parallel.nParallelThreshold = 0;
+    for (size_t nM = 16; nM <= nSize; nM += nM / 2)
+      if (GemmTime(Parallel, nM) < GemmTime(Serial, nM)) {
+        Params.nParallelThreshold = 2 * nM * nM * nM;
+        break;
+      }
+  }
+#endif
+  return Params;
+}
+
+/**
+ * @brief Process wide tuning parameters, loaded from the cache file on first use.
+ *
+ * The kernels read them on every call: each thread keeps a copy, refreshed only when Set changed
+ * the generation, so Get takes no lock once the parameters are loaded.
+ */
+class Tuning {
+protected:
+  std::once_flag m_Loaded;
+  std::mutex m_Mutex; // Guards m_Params.
+  MtxTuningParams m_Params;
+  std::atomic<uint64_t> m_nGeneration = 1; // Bumped by every change of m_Params.
+
+  static auto AutoTuneOnFirstUse() -> bool {
+#ifdef MAFS_ENABLE_AUTOTUNE
+    return true;
+#else
+    const char *pValue = std::getenv("MAFS_AUTOTUNE");
+    return pValue != nullptr && std::strcmp(pValue, "1") == 0;
+#endif
+  }
+
+  // Called once, before any Get returns.
+  void Load() {
+    const std::string strPath = TuningCachePath(), strKey = CpuModel();
+    MtxTuningParams Params;
+    if (!LoadTuning(strPath, strKey, Params) && AutoTuneOnFirstUse()) {
+      Params = RunAutoTune();
+      try {
+        SaveTuning(strPath, strKey, Params);
+      } catch (const std::runtime_error &) {
+        // Read only cache location, the parameters are still used by this process.
+      }
+    }
+    Publish(Params);
+  }
+
+  void Publish(const MtxTuningParams &Params) {
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+    m_Params = Params;
+    m_nGeneration.fetch_add(1, std::memory_order_release);
+  }
+
+public:
+  static auto Instance() -> Tuning & {
+    static Tuning Registry;
+    return Registry;
+  }
+
+  auto Get() -> MtxTuningParams {
+    std::call_once(m_Loaded, [this]() { Load(); });
+    thread_local uint64_t nSeen = 0;
+    thread_local MtxTuningParams Local;
+    if (m_nGeneration.load(std::memory_order_acquire) != nSeen) {
+      std::lock_guard<std::mutex> Lock(m_Mutex);
+      Local = m_Params;
+      nSeen = m_nGeneration.load(std::memory_order_relaxed);
+    }
+    return Local;
+  }
+
+  void Set(const MtxTuningParams &Params) {
+    // The cache file is not read anymore once the parameters were set.
+    std::call_once(m_Loaded, []() {});
+    Publish(Params);
+  }
+};
+}; // namespace Mafs::Internal
+
+#endif // MAFS_MATRIX_TUNING_H
@@ -0,0 +1,395 @@
+#ifndef MAFS_MATRIX_OUTOFCORE_TILEDMATRIX_H
+#define MAFS_MATRIX_OUTOFCORE_TILEDMATRIX_H
+
+#include <Mafs/Matrix/Matrix.hpp>
+#include <Mafs/Matrix/Operations/Kernels/Blas.hpp>
+#include <algorithm>
+#include <fstream>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace Mafs::OutOfCore {
+/**
+ * @brief How TiledMatrix opens its backing file.
+ */
+enum MtxTiledMode {
+  MtxTiledCreate = 0, // Creates (or truncates) the file, the matrix is zero.
+  MtxTiledOpen = 1    // Opens the file of a previous TiledMatrix with the same shape and tiles.
+};
+
+/**
+ * @brief Disk backed matrix, split in square tiles of nTileSize x nTileSize elements.
+ *
+ * Each tile is stored row major and contiguous in the backing file, tile [ti][tj] sits at
+ * (ti * TileColCount() + tj) * TileBytes(). Edge tiles are padded to the full tile size.
+ *
+ * Only the tiles being used are kept in memory, in a LRU cache bounded by nCacheBytes. Tiles are
+ * pinned while a TileGuard is alive and are never evicted while pinned, so the budget must hold
+ * at least the working set of the algorithm (see TiledOperations.hpp). Modified tiles are written
+ * back on eviction, on Flush and on destruction.
+ *
+ * Prefetch asks the OS to read tiles ahead (posix_fadvise(POSIX_FADV_WILLNEED)), so I/O overlaps
+ * compute without threads or cache budget.
+ *
+ * @tparam T trivially copyable element type.
+ */
+template <typename T> class TiledMatrix {
+  static_assert(std::is_trivially_copyable_v<T>, "TiledMatrix requires a trivially copyable type");
+
+protected:
+  // Resident tile.
+  struct TileEntry {
+    std::vector<T> Data;                 // nTileSize * nTileSize values.
+    size_t nPins = 0;                    // Number of TileGuard using the tile.
+    bool bDirty = false;                 // Modified since it was read.
+    std::list<size_t>::iterator LruIter; // Position in m_Lru.
+  };
+
+  size_t m_nRows = 0;       // Number of rows.
+  size_t m_nCols = 0;       // Number of cols.
+  size_t m_nTileSize = 0;   // Tile edge in elements.
+  size_t m_nTileRows = 0;   // Number of tile rows.
+  size_t m_nTileCols = 0;   // Number of tile cols.
+  size_t m_nCacheBytes = 0; // Resident tiles budget.
+
+  std::string m_strPath;
+  std::fstream m_File;
+  std::mutex m_FileMutex; // Guards m_File.
+  int m_nAdviseFd = -1;   // Read only descriptor of the file for the read ahead hints.
+
+  std::mutex m_Mutex; // Guards everything below.
+  std::unordered_map<size_t, TileEntry> m_Tiles;
+  std::list<size_t> m_Lru; // Front = most recently used.
+  size_t m_nResidentBytes = 0;
+
+  inline size_t TileKey(size_t nTileRow, size_t nTileCol) const {
+    return nTileRow * m_nTileCols + nTileCol;
+  }
+
+  void ReadTile(size_t nKey, T *pData) {
+    std::lock_guard<std::mutex> Lock(m_FileMutex);
+    m_File.clear();
+    m_File.seekg(static_cast<std::streamoff>(nKey * TileBytes()));
+    if (!m_File.read(reinterpret_cast<char *>(pData), static_cast<std::streamsize>(TileBytes())))
+      throw std::runtime_error(fmt::format("Could not read tile {} of {}", nKey, m_strPath));
+  }
+
+  void WriteTile(size_t nKey, const T *pData) {
+    std::lock_guard<std::mutex> Lock(m_FileMutex);
+    m_File.clear();
+    m_File.seekp(static_cast<std::streamoff>(nKey * TileBytes()));
+    if (!m_File.write(reinterpret_cast<const char *>(pData),
+                      static_cast<std::streamsize>(TileBytes())))
+      throw std::runtime_error(fmt::format("Could not write tile {} of {}", nKey, m_strPath));
+  }
+
+  /**
+   * @brief Evicts unpinned tiles, least recently used first, until nBytes more fit in the budget.
+   * m_Mutex must be held.
+   *
+   * @param nBytes
+   * @return true if there is room for nBytes.
+   */
+  auto MakeRoom(size_t nBytes) -> bool {
+    auto Iter = m_Lru.end();
+    while (m_nResidentBytes + nBytes > m_nCacheBytes && Iter != m_Lru.begin()) {
+      --Iter;
+      auto &Entry = m_Tiles.at(*Iter);
+      if (Entry.nPins > 0)
+        continue;
+      if (Entry.bDirty)
+        WriteTile(*Iter, Entry.Data.data());
+      m_nResidentBytes -= TileBytes();
+      m_Tiles.erase(*Iter);
+      Iter = m_Lru.erase(Iter);
+    }
+    return m_nResidentBytes + nBytes <= m_nCacheBytes;
+  }
+
+  /**
+   * @brief Inserts a freshly read tile in the cache. m_Mutex must be held.
+   *
+   * @param nKey
+   * @param Data
+   * @return TileEntry&
+   */
+  auto Insert(size_t nKey, std::vector<T> &&Data) -> TileEntry & {
+    MakeRoom(TileBytes()); // Over budget if everything is pinned.
+    m_Lru.push_front(nKey);
+    TileEntry &Entry = m_Tiles[nKey];
+    Entry.Data = std::move(Data);
+    Entry.LruIter = m_Lru.begin();
+    m_nResidentBytes += TileBytes();
+    return Entry;
+  }
+
+public:
+  /**
+   * @brief Pins a tile in memory while alive.
+   * Data() points to nTileSize * nTileSize row major values, padding included.
+   */
+  class TileGuard {
+  protected:
+    TiledMatrix *m_pMatrix;
+    size_t m_nKey;
+    T *m_pData;
+
+  public:
+    TileGuard(TiledMatrix &Matrix, size_t nTileRow, size_t nTileCol, bool bWrite)
+        : m_pMatrix(&Matrix), m_nKey(Matrix.TileKey(nTileRow, nTileCol)),
+          m_pData(Matrix.Acquire(nTileRow, nTileCol, bWrite)) {}
+    TileGuard(const TileGuard &) = delete;
+    TileGuard &operator=(const TileGuard &) = delete;
+    ~TileGuard() { m_pMatrix->Release(m_nKey); }
+
+    inline T *Data() { return m_pData; }
+    inline const T *Data() const { return m_pData; }
+  };
+
+  /**
+   * @brief Creates (or truncates) strPath to hold a zero initialized nRows x nCols matrix, or
+   * opens the file of a previous TiledMatrix with the same dimensions and tile size.
+   *
+   * @param strPath backing file.
+   * @param nRows
+   * @param nCols
+   * @param nTileSize tile edge in elements.
+   * @param nCacheBytes memory budget for resident tiles.
+   * @param eMode MtxTiledOpen requires strPath to have the size of this layout.
+   */
+  TiledMatrix(const std::string &strPath, size_t nRows, size_t nCols, size_t nTileSize,
+              size_t nCacheBytes, MtxTiledMode eMode = MtxTiledCreate)
+      : m_nRows(nRows), m_nCols(nCols), m_nTileSize(nTileSize), m_nCacheBytes(nCacheBytes),
+        m_strPath(strPath) {
+    if (nRows == 0 || nCols == 0 || nTileSize == 0)
+      throw std::invalid_argument(fmt::format(
+          "Invalid TiledMatrix[{}][{}] with tile size {}", nRows, nCols, nTileSize));
+    m_nTileRows = (nRows + nTileSize - 1) / nTileSize;
+    m_nTileCols = (nCols + nTileSize - 1) / nTileSize;
+    const size_t nFileBytes = m_nTileRows * m_nTileCols * TileBytes();
+
+    if (eMode == MtxTiledOpen) {
+      m_File.open(strPath, std::ios::in | std::ios::out | std::ios::binary);
+      if (!m_File)
+        throw std::runtime_error(fmt::format("Could not open {}", strPath));
+      m_File.seekg(0, std::ios::end);
+      const auto nSize = static_cast<size_t>(m_File.tellg());
+      if (nSize != nFileBytes)
+        throw std::runtime_error(
+            fmt::format("{} has {} bytes, TiledMatrix[{}][{}] with tile size {} needs {}", strPath,
+                        nSize, nRows, nCols, nTileSize, nFileBytes));
+    } else {
+      m_File.open(strPath, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+      if (!m_File)
+        throw std::runtime_error(fmt::format("Could not create {}", strPath));
+      // Extend the file to its final size, the unwritten part reads as zeros.
+      const char Zero = 0;
+      m_File.seekp(static_cast<std::streamoff>(nFileBytes - 1));
+      m_File.write(&Zero, 1);
+    }
+#if defined(POSIX_FADV_WILLNEED)
+    m_nAdviseFd = ::open(strPath.c_str(), O_RDONLY); // Without it Prefetch does nothing.
+#endif
+  }
+
+  TiledMatrix(const TiledMatrix &) = delete;
+  TiledMatrix &operator=(const TiledMatrix &) = delete;
+
+  ~TiledMatrix() {
+    try {
+      Flush();
+    } catch (...) {
+      // Destructors must not throw, data that couldn't be written is lost.
+    }
+#if defined(__unix__) || defined(__APPLE__)
+    if (m_nAdviseFd >= 0)
+      ::close(m_nAdviseFd);
+#endif
+  }
+
+  inline size_t RowCount() const { return m_nRows; }
+  inline size_t ColCount() const { return m_nCols; }
+  inline size_t TileSize() const { return m_nTileSize; }
+  inline size_t TileRowCount() const { return m_nTileRows; }
+  inline size_t TileColCount() const { return m_nTileCols; }
+  inline size_t TileBytes() const { return sizeof(T) * m_nTileSize * m_nTileSize; }
+  inline size_t CacheBytes() const { return m_nCacheBytes; }
+
+  /**
+   * @brief Number of valid (non padding) rows in tile row nTileRow.
+   */
+  inline size_t TileRows(size_t nTileRow) const {
+    return std::min(m_nTileSize, m_nRows - nTileRow * m_nTileSize);
+  }
+
+  /**
+   * @brief Number of valid (non padding) cols in tile col nTileCol.
+   */
+  inline size_t TileCols(size_t nTileCol) const {
+    return std::min(m_nTileSize, m_nCols - nTileCol * m_nTileSize);
+  }
+
+  /**
+   * @brief Pins a tile in memory and returns its data, loading it if needed.
+   * Every Acquire must be paired with a Release, prefer TileGuard.
+   *
+   * @param nTileRow
+   * @param nTileCol
+   * @param bWrite mark the tile as modified.
+   * @return T*
+   */
+  auto Acquire(size_t nTileRow, size_t nTileCol, bool bWrite) -> T * {
+    if (nTileRow >= m_nTileRows || nTileCol >= m_nTileCols)
+      throw std::out_of_range(fmt::format("Tile [{}][{}] is out of range", nTileRow, nTileCol));
+    const size_t nKey = TileKey(nTileRow, nTileCol);
+
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+    TileEntry *pEntry = nullptr;
+    auto Iter = m_Tiles.find(nKey);
+    if (Iter == m_Tiles.end()) {
+      std::vector<T> Data(m_nTileSize * m_nTileSize);
+      ReadTile(nKey, Data.data());
+      pEntry = &Insert(nKey, std::move(Data));
+    } else {
+      pEntry = &Iter->second;
+      m_Lru.splice(m_Lru.begin(), m_Lru, pEntry->LruIter);
+    }
+
+    pEntry->nPins++;
+    pEntry->bDirty |= bWrite;
+    return pEntry->Data.data();
+  }
+
+  /**
+   * @brief Unpins a tile acquired with Acquire.
+   *
+   * @param nKey
+   */
+  void Release(size_t nKey) {
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+    auto Iter = m_Tiles.find(nKey);
+    if (Iter != m_Tiles.end() && Iter->second.nPins > 0)
+      Iter->second.nPins--;
+  }
+
+  /**
+   * @brief Hints that a tile will be used soon: the OS starts reading it in the page cache and
+   * Acquire copies it from there. Does nothing where posix_fadvise isn't available or for a tile
+   * already resident.
+   *
+   * @param nTileRow
+   * @param nTileCol
+   */
+  void Prefetch(size_t nTileRow, size_t nTileCol) {
+#if defined(POSIX_FADV_WILLNEED)
+    if (m_nAdviseFd < 0 || nTileRow >= m_nTileRows || nTileCol >= m_nTileCols)
+      return;
+    const size_t nKey = TileKey(nTileRow, nTileCol);
+    {
+      std::lock_guard<std::mutex> Lock(m_Mutex);
+      if (m_Tiles.count(nKey) != 0)
+        return;
+    }
+    // A hint, failures are ignored.
+    (void)::posix_fadvise(m_nAdviseFd, static_cast<off_t>(nKey * TileBytes()),
+                          static_cast<off_t>(TileBytes()), POSIX_FADV_WILLNEED);
+#else
+    (void)nTileRow;
+    (void)nTileCol;
+#endif
+  }
+
+  /**
+   * @brief Writes every modified tile back to the file.
+   */
+  void Flush() {
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+    for (auto &[nKey, Entry] : m_Tiles)
+      if (Entry.bDirty) {
+        WriteTile(nKey, Entry.Data.data());
+        Entry.bDirty = false;
+      }
+    std::lock_guard<std::mutex> FileLock(m_FileMutex);
+    m_File.flush();
+  }
+
+  /**
+   * @brief Reads element [nRow][nCol] through the tile cache.
+   * Convenient but slow, use TileGuard for bulk access.
+   */
+  auto Get(size_t nRow, size_t nCol) -> T {
+    BoundCheck(nRow, nCol);
+    TileGuard Tile(*this, nRow / m_nTileSize, nCol / m_nTileSize, false);
+    return Tile.Data()[(nRow % m_nTileSize) * m_nTileSize + nCol % m_nTileSize];
+  }
+
+  /**
+   * @brief Writes element [nRow][nCol] through the tile cache.
+   * Convenient but slow, use TileGuard for bulk access.
+   */
+  void Set(size_t nRow, size_t nCol, const T &Value) {
+    BoundCheck(nRow, nCol);
+    TileGuard Tile(*this, nRow / m_nTileSize, nCol / m_nTileSize, true);
+    Tile.Data()[(nRow % m_nTileSize) * m_nTileSize + nCol % m_nTileSize] = Value;
+  }
+
+  /**
+   * @brief Copies an in memory matrix with the same dimensions into the tiles.
+   *
+   * @param Matrix
+   */
+  template <typename Derived> void Assign(const Internal::MatrixBase<Derived> &Matrix) {
+    if (Matrix.RowCount() != m_nRows || Matrix.ColCount() != m_nCols)
+      throw std::domain_error(fmt::format("Matrix[{}][{}] doesn't match TiledMatrix[{}][{}]",
+                                          Matrix.RowCount(), Matrix.ColCount(), m_nRows, m_nCols));
+    for (size_t ti = 0; ti < m_nTileRows; ++ti)
+      for (size_t tj = 0; tj < m_nTileCols; ++tj) {
+        TileGuard Tile(*this, ti, tj, true);
+        const size_t nOffset = ti * m_nTileSize * Matrix.RowStride() +
+                               tj * m_nTileSize * Matrix.ColStride();
+        Internal::Kernels::Copy(TileRows(ti), TileCols(tj), Matrix.Data() + nOffset,
+                                Matrix.RowStride(), Matrix.ColStride(), Tile.Data(), m_nTileSize,
+                                1);
+      }
+  }
+
+  /**
+   * @brief Copies the tiles into an in memory matrix (dynamic MatrixType).
+   *
+   * @tparam MatrixType
+   * @return MatrixType
+   */
+  template <typename MatrixType> auto ToMatrix() -> MatrixType {
+    MatrixType MatrixRtn(m_nRows, m_nCols);
+    for (size_t ti = 0; ti < m_nTileRows; ++ti)
+      for (size_t tj = 0; tj < m_nTileCols; ++tj) {
+        TileGuard Tile(*this, ti, tj, false);
+        const size_t nOffset = ti * m_nTileSize * MatrixRtn.RowStride() +
+                               tj * m_nTileSize * MatrixRtn.ColStride();
+        Internal::Kernels::Copy(TileRows(ti), TileCols(tj), Tile.Data(), m_nTileSize, 1,
+                                MatrixRtn.Data() + nOffset, MatrixRtn.RowStride(),
+                                MatrixRtn.ColStride());
+      }
+    return MatrixRtn;
+  }
+
+protected:
+  inline void BoundCheck(size_t nRow, size_t nCol) const {
+    if (nRow >= m_nRows || nCol >= m_nCols)
+      throw std::out_of_range(fmt::format("Index [{}][{}] is out of range", nRow, nCol));
+  }
+};
+}; // namespace Mafs::OutOfCore
+
+#endif // MAFS_MATRIX_OUTOFCORE_TILEDMATRIX_H
@@ -0,0 +1,188 @@
+#ifndef MAFS_MATRIX_OUTOFCORE_TILEDOPERATIONS_H
+#define MAFS_MATRIX_OUTOFCORE_TILEDOPERATIONS_H
+
+#include <Mafs/Matrix/OutOfCore/TiledMatrix.hpp>
+#include <Mafs/Matrix/Operations/Kernels/Gemm.hpp>
+#include <Mafs/Matrix/Operations/Kernels/LU.hpp>
+#include <Mafs/Utils/Workspace.hpp>
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+/**
+ * Tiled algorithms for TiledMatrix.
+ *
+ * Every algorithm walks the tiles in an order that reuses the resident ones and calls Prefetch on
+ * the next tiles it will need, so the reads ahead of the OS overlap the tile kernels.
+ * Working sets (the cache budget must hold at least this many tiles):
+ * - Multiplication: 3 tiles; a row of A tiles is reused across j if it fits.
+ * - Transpose: 2 tiles.
+ * - LUDecomposition: one column of tiles, plus a panel buffer of the same size outside the cache.
+ */
+namespace Mafs::OutOfCore {
+
+/**
+ * @brief C = A * B, C must be [A.RowCount()][B.ColCount()] and all tile sizes must match.
+ *
+ * @param lMatrix A
+ * @param rMatrix B
+ * @param Result C, overwritten.
+ */
+template <typename T>
+void Multiplication(TiledMatrix<T> &lMatrix, TiledMatrix<T> &rMatrix, TiledMatrix<T> &Result) {
+  if (lMatrix.ColCount() != rMatrix.RowCount() || Result.RowCount() != lMatrix.RowCount() ||
+      Result.ColCount() != rMatrix.ColCount() || lMatrix.TileSize() != rMatrix.TileSize() ||
+      Result.TileSize() != lMatrix.TileSize())
+    throw std::domain_error(fmt::format(
+        "Invalid dimensions/tile sizes. lMatrix[{}][{}] / rMatrix[{}][{}] / Result[{}][{}]",
+        lMatrix.RowCount(), lMatrix.ColCount(), rMatrix.RowCount(), rMatrix.ColCount(),
+        Result.RowCount(), Result.ColCount()));
+
+  typedef typename TiledMatrix<T>::TileGuard TileGuard;
+  const size_t nTile = lMatrix.TileSize();
+  const size_t nTilesK = lMatrix.TileColCount();
+  for (size_t ti = 0; ti < Result.TileRowCount(); ++ti)
+    for (size_t tj = 0; tj < Result.TileColCount(); ++tj) {
+      TileGuard TileC(Result, ti, tj, true);
+      std::fill(TileC.Data(), TileC.Data() + nTile * nTile, T(0));
+
+      for (size_t tk = 0; tk < nTilesK; ++tk) {
+        // Next pair of tiles: same C tile with k + 1, or the next C tile starting at k = 0.
+        if (tk + 1 < nTilesK) {
+          lMatrix.Prefetch(ti, tk + 1);
+          rMatrix.Prefetch(tk + 1, tj);
+        } else if (tj + 1 < Result.TileColCount()) {
+          lMatrix.Prefetch(ti, 0);
+          rMatrix.Prefetch(0, tj + 1);
+        } else {
+          lMatrix.Prefetch(ti + 1, 0);
+          rMatrix.Prefetch(0, 0);
+        }
+
+        TileGuard TileA(lMatrix, ti, tk, false);
+        TileGuard TileB(rMatrix, tk, tj, false);
+        Internal::Kernels::Gemm(Result.TileRows(ti), Result.TileCols(tj), lMatrix.TileCols(tk),
+                                T(1), TileA.Data(), nTile, TileB.Data(), nTile, TileC.Data(),
+                                nTile);
+      }
+    }
+}
+
+/**
+ * @brief Result = Matrix^T, Result must be [Matrix.ColCount()][Matrix.RowCount()] with the same
+ * tile size.
+ *
+ * @param Matrix
+ * @param Result overwritten.
+ */
+template <typename T> void Transpose(TiledMatrix<T> &Matrix, TiledMatrix<T> &Result) {
+  if (Result.RowCount() != Matrix.ColCount() || Result.ColCount() != Matrix.RowCount() ||
+      Result.TileSize() != Matrix.TileSize())
+    throw std::domain_error(
+        fmt::format("Invalid dimensions/tile sizes. Matrix[{}][{}] / Result[{}][{}]",
+                    Matrix.RowCount(), Matrix.ColCount(), Result.RowCount(), Result.ColCount()));
+
+  typedef typename TiledMatrix<T>::TileGuard TileGuard;
+  const size_t nTile = Matrix.TileSize();
+  for (size_t ti = 0; ti < Matrix.TileRowCount(); ++ti)
+    for (size_t tj = 0; tj < Matrix.TileColCount(); ++tj) {
+      if (tj + 1 < Matrix.TileColCount())
+        Matrix.Prefetch(ti, tj + 1);
+      else
+        Matrix.Prefetch(ti + 1, 0);
+
+      TileGuard TileA(Matrix, ti, tj, false);
+      TileGuard TileB(Result, tj, ti, true);
+      Internal::Kernels::Transpose(Matrix.TileRows(ti), Matrix.TileCols(tj), TileA.Data(), nTile,
+                                   TileB.Data(), nTile);
+    }
+}
+
+/**
+ * @brief In-place blocked LU decomposition with partial pivoting (right-looking).
+ *
+ * For each tile column k the panel (tiles k..end of column k) is copied to a contiguous buffer and
+ * factorized, the row swaps are applied to every other tile column and the trailing tiles are
+ * updated with one TRSM and one GEMM per tile, reading each column of tiles once per step.
+ *
+ * On return Matrix holds L (unit diagonal) and U, Pivots[r] is the row swapped with row r.
+ * Throws std::domain_error if the matrix is not square or singular.
+ *
+ * @param Matrix
+ * @param Pivots resized to RowCount().
+ */
+template <typename T> void LUDecomposition(TiledMatrix<T> &Matrix, std::vector<size_t> &Pivots) {
+  if (Matrix.RowCount() != Matrix.ColCount())
+    throw std::domain_error(fmt::format("LUDecomposition requires a square matrix. Matrix[{}][{}]",
+                                        Matrix.RowCount(), Matrix.ColCount()));
+
+  typedef typename TiledMatrix<T>::TileGuard TileGuard;
+  const size_t nTile = Matrix.TileSize();
+  const size_t nTiles = Matrix.TileRowCount();
+  Pivots.resize(Matrix.RowCount());
+
+  // The first panel is the tallest, the next ones reuse its buffer.
+  Internal::ScratchBuffer<T> Panel(Matrix.RowCount() * nTile);
+  Internal::ScratchBuffer<size_t> PanelPivots(nTile);
+  for (size_t tk = 0; tk < nTiles; ++tk) {
+    const size_t nFirstRow = tk * nTile;
+    const size_t nPanelRows = Matrix.RowCount() - nFirstRow;
+    const size_t nPanelCols = Matrix.TileCols(tk);
+
+    // Gather and factorize the panel.
+    std::fill(Panel.Data(), Panel.Data() + nPanelRows * nTile, T(0));
+    for (size_t ti = tk; ti < nTiles; ++ti) {
+      TileGuard Tile(Matrix, ti, tk, false);
+      std::copy(Tile.Data(), Tile.Data() + Matrix.TileRows(ti) * nTile,
+                Panel.Data() + (ti - tk) * nTile * nTile);
+    }
+    if (!Internal::Kernels::LUFactorPanel(Panel.Data(), nPanelRows, nPanelCols, nTile,
+                                          PanelPivots.Data()))
+      throw std::domain_error("Matrix is singular");
+    for (size_t ti = tk; ti < nTiles; ++ti) {
+      TileGuard Tile(Matrix, ti, tk, true);
+      std::copy(Panel.Data() + (ti - tk) * nTile * nTile,
+                Panel.Data() + (ti - tk) * nTile * nTile + Matrix.TileRows(ti) * nTile,
+                Tile.Data());
+    }
+    for (size_t k = 0; k < nPanelCols; ++k)
+      Pivots[nFirstRow + k] = nFirstRow + PanelPivots[k];
+
+    // Apply the swaps to the other tile columns and update the trailing ones.
+    for (size_t tj = 0; tj < nTiles; ++tj) {
+      if (tj == tk)
+        continue;
+      for (size_t ti = tk; ti < nTiles; ++ti)
+        Matrix.Prefetch(ti, tj + 1 == tk ? tj + 2 : tj + 1);
+
+      std::vector<std::unique_ptr<TileGuard>> Column;
+      for (size_t ti = tk; ti < nTiles; ++ti)
+        Column.push_back(std::make_unique<TileGuard>(Matrix, ti, tj, true));
+
+      for (size_t k = 0; k < nPanelCols; ++k) {
+        const size_t nSwap = PanelPivots[k];
+        if (nSwap == k)
+          continue;
+        T *pRowA = Column[k / nTile]->Data() + (k % nTile) * nTile;
+        T *pRowB = Column[nSwap / nTile]->Data() + (nSwap % nTile) * nTile;
+        std::swap_ranges(pRowA, pRowA + nTile, pRowB);
+      }
+
+      if (tj < tk)
+        continue; // Left of the panel only the swaps are needed.
+
+      // U[k][j] = L[k][k]^-1 * A[k][j]
+      const size_t nCols = Matrix.TileCols(tj);
+      Internal::Kernels::LowerUnitSolve(Panel.Data(), nTile, nPanelCols, Column[0]->Data(), nTile,
+                                        nCols);
+      // A[i][j] -= L[i][k] * U[k][j]
+      for (size_t ti = tk + 1; ti < nTiles; ++ti)
+        Internal::Kernels::Gemm(Matrix.TileRows(ti), nCols, nPanelCols, T(-1),
+                                Panel.Data() + (ti - tk) * nTile * nTile, nTile,
+                                Column[0]->Data(), nTile, Column[ti - tk]->Data(), nTile);
+    }
+  }
+}
+}; // namespace Mafs::OutOfCore
+
+#endif // MAFS_MATRIX_OUTOFCORE_TILEDOPERATIONS_H
@@ -0,0 +1,365 @@
+#ifndef MAFS_INSTRUMENTATION_H
+#define MAFS_INSTRUMENTATION_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fmt/format.h>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+#ifdef MAFS_ENABLE_INSTRUMENTATION
+#include <chrono>
+#endif
+
+/**
+ * Opt-in instrumentation of the matrix operations and container allocations.
+ *
+ * Build with MAFS_ENABLE_INSTRUMENTATION (CMake option ENABLE_INSTRUMENTATION) to record, per
+ * operation and per backend, the number of calls, elements, wall time, estimated FLOPs and bytes
+ * moved, plus the container allocations. Without it the MAFS_OP_SCOPE/MAFS_RECORD_* hooks expand
+ * to nothing and the query functions return empty statistics.
+ */
+namespace Mafs {
+/**
+ * @brief Accumulated statistics of one operation on one backend.
+ */
+struct MtxOpStats {
+  uint64_t nCalls = 0;    // Number of calls.
+  uint64_t nElements = 0; // Elements produced (sum over the calls).
+  double Seconds = 0;     // Wall time.
+  double Flops = 0;       // Estimated floating point operations.
+  double Bytes = 0;       // Estimated bytes read + written.
+};
+
+/**
+ * @brief Container allocation statistics.
+ */
+struct MtxAllocStats {
+  uint64_t nAllocs = 0;   // Number of allocations.
+  uint64_t nFrees = 0;    // Number of deallocations.
+  uint64_t nBytes = 0;    // Bytes allocated (sum over the allocations).
+  int64_t nLiveBytes = 0; // Bytes currently allocated.
+};
+
+namespace Internal {
+/**
+ * @brief Process wide statistics registry.
+ *
+ * Every thread records in its own statistics, indexed by call site (see MAFS_OP_SCOPE), under a
+ * mutex that is only contended while a report is taken. The names are only formatted and the
+ * threads merged by the queries. A thread's statistics are merged into the retired ones when it
+ * exits.
+ */
+class Instrumentation {
+protected:
+  // Statistics recorded by one thread.
+  struct ThreadStats {
+    std::mutex Mutex;
+    std::vector<MtxOpStats> Ops; // Indexed by call site.
+    MtxAllocStats Allocs;
+  };
+
+  // Retires the statistics of the thread when its thread_local storage is destroyed.
+  struct ThreadOwner {
+    ThreadStats *pStats = nullptr;
+    ~ThreadOwner() {
+      m_pLocal = nullptr;
+      m_bExited = true;
+      if (pStats != nullptr)
+        Instance().Retire(pStats);
+    }
+  };
+
+  inline static thread_local ThreadStats *m_pLocal = nullptr;
+  inline static thread_local bool m_bExited = false; // Records now go to m_Retired.
+
+  std::mutex m_Mutex; // Guards everything below.
+  std::vector<std::pair<const char *, const char *>> m_Sites; // (Backend, Operation) by site.
+  std::vector<std::unique_ptr<ThreadStats>> m_Threads;        // Running threads.
+  ThreadStats m_Retired; // Exited threads, and what they record during their exit.
+
+  static void Merge(MtxOpStats &Total, const MtxOpStats &Stats) {
+    Total.nCalls += Stats.nCalls;
+    Total.nElements += Stats.nElements;
+    Total.Seconds += Stats.Seconds;
+    Total.Flops += Stats.Flops;
+    Total.Bytes += Stats.Bytes;
+  }
+
+  static void Merge(MtxAllocStats &Total, const MtxAllocStats &Stats) {
+    Total.nAllocs += Stats.nAllocs;
+    Total.nFrees += Stats.nFrees;
+    Total.nBytes += Stats.nBytes;
+    Total.nLiveBytes += Stats.nLiveBytes;
+  }
+
+  static void MergeInto(ThreadStats &Total, const ThreadStats &Stats) {
+    if (Total.Ops.size() < Stats.Ops.size())
+      Total.Ops.resize(Stats.Ops.size());
+    for (size_t i = 0; i < Stats.Ops.size(); ++i)
+      Merge(Total.Ops[i], Stats.Ops[i]);
+    Merge(Total.Allocs, Stats.Allocs);
+  }
+
+  /**
+   * @brief Statistics of the calling thread, nullptr once it is exiting.
+   *
+   * @return ThreadStats*
+   */
+  auto Local() -> ThreadStats * {
+    if (m_pLocal == nullptr && !m_bExited) {
+      thread_local ThreadOwner Owner;
+      std::lock_guard<std::mutex> Lock(m_Mutex);
+      m_Threads.push_back(std::make_unique<ThreadStats>());
+      Owner.pStats = m_pLocal = m_Threads.back().get();
+    }
+    return m_pLocal;
+  }
+
+  void Retire(ThreadStats *pStats) {
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+    {
+      std::lock_guard<std::mutex> ThreadLock(pStats->Mutex);
+      MergeInto(m_Retired, *pStats);
+    }
+    m_Threads.erase(std::find_if(m_Threads.begin(), m_Threads.end(), [pStats](const auto &pThread) {
+      return pThread.get() == pStats;
+    }));
+  }
+
+  /**
+   * @brief Applies Update to the statistics of the calling thread (to the retired ones once it
+   * is exiting).
+   */
+  template <typename Func> void Record(Func &&Update) {
+    if (ThreadStats *pStats = Local()) {
+      std::lock_guard<std::mutex> Lock(pStats->Mutex);
+      Update(*pStats);
+    } else {
+      std::lock_guard<std::mutex> Lock(m_Mutex);
+      Update(m_Retired);
+    }
+  }
+
+  /**
+   * @brief Adds the retired statistics and those of every running thread to Result. m_Mutex must
+   * be held.
+   */
+  void Total(ThreadStats &Result) {
+    MergeInto(Result, m_Retired);
+    for (const auto &pThread : m_Threads) {
+      std::lock_guard<std::mutex> ThreadLock(pThread->Mutex);
+      MergeInto(Result, *pThread);
+    }
+  }
+
+public:
+  static auto Instance() -> Instrumentation & {
+    // Never destroyed: static matrices and thread workspaces still record frees during the exit.
+    static Instrumentation *pRegistry = new Instrumentation;
+    return *pRegistry;
+  }
+
+  /**
+   * @brief Index of the statistics of pOperation on pBackend. Called once per call site.
+   *
+   * @param pBackend
+   * @param pOperation
+   * @return size_t
+   */
+  auto Site(const char *pBackend, const char *pOperation) -> size_t {
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+    for (size_t i = 0; i < m_Sites.size(); ++i)
+      if (std::strcmp(m_Sites[i].first, pBackend) == 0 &&
+          std::strcmp(m_Sites[i].second, pOperation) == 0)
+        return i;
+    m_Sites.emplace_back(pBackend, pOperation);
+    return m_Sites.size() - 1;
+  }
+
+  void RecordOp(size_t nSite, uint64_t nElements, double Seconds, double Flops, double Bytes) {
+    Record([&](ThreadStats &Stats) {
+      if (Stats.Ops.size() <= nSite)
+        Stats.Ops.resize(nSite + 1);
+      MtxOpStats &Op = Stats.Ops[nSite];
+      Op.nCalls++;
+      Op.nElements += nElements;
+      Op.Seconds += Seconds;
+      Op.Flops += Flops;
+      Op.Bytes += Bytes;
+    });
+  }
+
+  void RecordAlloc(uint64_t nBytes) {
+    Record([nBytes](ThreadStats &Stats) {
+      Stats.Allocs.nAllocs++;
+      Stats.Allocs.nBytes += nBytes;
+      Stats.Allocs.nLiveBytes += static_cast<int64_t>(nBytes);
+    });
+  }
+
+  void RecordFree(uint64_t nBytes) {
+    Record([nBytes](ThreadStats &Stats) {
+      Stats.Allocs.nFrees++;
+      Stats.Allocs.nLiveBytes -= static_cast<int64_t>(nBytes);
+    });
+  }
+
+  auto Ops() -> std::map<std::string, MtxOpStats> {
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+    ThreadStats Sum;
+    Total(Sum);
+    std::map<std::string, MtxOpStats> Result;
+    for (size_t i = 0; i < Sum.Ops.size(); ++i)
+      if (Sum.Ops[i].nCalls > 0)
+        Merge(Result[fmt::format("{}::{}", m_Sites[i].first, m_Sites[i].second)], Sum.Ops[i]);
+    return Result;
+  }
+
+  auto Allocs() -> MtxAllocStats {
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+    ThreadStats Sum;
+    Total(Sum);
+    return Sum.Allocs;
+  }
+
+  void Reset() {
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+    // The live bytes are kept, they will be freed later.
+    int64_t nLiveBytes = m_Retired.Allocs.nLiveBytes;
+    for (const auto &pThread : m_Threads) {
+      std::lock_guard<std::mutex> ThreadLock(pThread->Mutex);
+      nLiveBytes += pThread->Allocs.nLiveBytes;
+      pThread->Ops.clear();
+      pThread->Allocs = MtxAllocStats();
+    }
+    m_Retired.Ops.clear();
+    m_Retired.Allocs = MtxAllocStats();
+    m_Retired.Allocs.nLiveBytes = nLiveBytes;
+  }
+};
+
+#ifdef MAFS_ENABLE_INSTRUMENTATION
+/**
+ * @brief Times an operation from construction to destruction and records it.
+ * Used through MAFS_OP_SCOPE.
+ */
+class OpScope {
+protected:
+  size_t m_nSite;
+  uint64_t m_nElements;
+  double m_Flops;
+  double m_Bytes;
+  std::chrono::steady_clock::time_point m_Start;
+
+public:
+  OpScope(size_t nSite, uint64_t nElements, double Flops, double Bytes)
+      : m_nSite(nSite), m_nElements(nElements), m_Flops(Flops), m_Bytes(Bytes),
+        m_Start(std::chrono::steady_clock::now()) {}
+  OpScope(const OpScope &) = delete;
+  OpScope &operator=(const OpScope &) = delete;
+
+  ~OpScope() {
+    const double Seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - m_Start).count();
+    Instrumentation::Instance().RecordOp(m_nSite, m_nElements, Seconds, m_Flops, m_Bytes);
+  }
+};
+#endif
+}; // namespace Internal
+
+#ifdef MAFS_ENABLE_INSTRUMENTATION
+#define MAFS_INSTRUMENTATION_CAT2(a, b) a##b
+#define MAFS_INSTRUMENTATION_CAT(a, b) MAFS_INSTRUMENTATION_CAT2(a, b)
+// Records the enclosing scope as one call of pOperation on pBackend (constant strings, looked up
+// once per call site).
+#define MAFS_OP_SCOPE(pBackend, pOperation, nElements, Flops, Bytes)                               \
+  static const size_t MAFS_INSTRUMENTATION_CAT(nMafsOpSite, __LINE__) =                            \
+      ::Mafs::Internal::Instrumentation::Instance().Site(pBackend, pOperation);                    \
+  ::Mafs::Internal::OpScope MAFS_INSTRUMENTATION_CAT(MafsOpScope, __LINE__)(                       \
+      MAFS_INSTRUMENTATION_CAT(nMafsOpSite, __LINE__), static_cast<uint64_t>(nElements),           \
+      static_cast<double>(Flops), static_cast<double>(Bytes))
+#define MAFS_RECORD_ALLOC(nBytes)                                                                  \
+  ::Mafs::Internal::Instrumentation::Instance().RecordAlloc(static_cast<uint64_t>(nBytes))
+#define MAFS_RECORD_FREE(nBytes)                                                                   \
+  ::Mafs::Internal::Instrumentation::Instance().RecordFree(static_cast<uint64_t>(nBytes))
+#else
+#define MAFS_OP_SCOPE(pBackend, pOperation, nElements, Flops, Bytes)
+#define MAFS_RECORD_ALLOC(nBytes)
+#define MAFS_RECORD_FREE(nBytes)
+#endif
+
+/**
+ * @brief Returns the statistics of every operation called so far, keyed by
+ * "<Backend>::<Operation>" (e.g. "Basic::Sum").
+ *
+ * @return std::map<std::string, MtxOpStats>
+ */
+inline auto OperationStats() -> std::map<std::string, MtxOpStats> {
+  return Internal::Instrumentation::Instance().Ops();
+}
+
+/**
+ * @brief Returns the statistics of a single operation (zero if it was never called).
+ *
+ * @param strBackend e.g. "Basic"
+ * @param strOperation e.g. "Sum"
+ * @return MtxOpStats
+ */
+inline auto OperationStats(const std::string &strBackend, const std::string &strOperation)
+    -> MtxOpStats {
+  const auto Ops = OperationStats();
+  const auto Iter = Ops.find(strBackend + "::" + strOperation);
+  return Iter != Ops.end() ? Iter->second : MtxOpStats();
+}
+
+/**
+ * @brief Returns the container allocation statistics.
+ *
+ * @return MtxAllocStats
+ */
+inline auto AllocationStats() -> MtxAllocStats {
+  return Internal::Instrumentation::Instance().Allocs();
+}
+
+/**
+ * @brief Clears every statistic (the live bytes are kept).
+ */
+inline void ResetStats() { Internal::Instrumentation::Instance().Reset(); }
+
+/**
+ * @brief Formats every statistic as a table, most expensive operations first.
+ *
+ * @return std::string
+ */
+inline auto DumpStats() -> std::string {
+  std::multimap<double, std::pair<std::string, MtxOpStats>, std::greater<double>> Sorted;
+  for (const auto &[strName, Stats] : OperationStats())
+    Sorted.emplace(Stats.Seconds, std::make_pair(strName, Stats));
+
+  fmt::memory_buffer Buffer;
+  fmt::format_to(std::back_inserter(Buffer), "{:<32} {:>10} {:>14} {:>12} {:>10} {:>10}\n",
+                 "Operation", "Calls", "Elements", "Time (ms)", "GFLOP/s", "GB/s");
+  for (const auto &[Seconds, Entry] : Sorted) {
+    const MtxOpStats &Stats = Entry.second;
+    const double Rate = Seconds > 0 ? 1e-9 / Seconds : 0;
+    fmt::format_to(std::back_inserter(Buffer),
+                   "{:<32} {:>10} {:>14} {:>12.3f} {:>10.3f} {:>10.3f}\n", Entry.first,
+                   Stats.nCalls, Stats.nElements, Seconds * 1e3, Stats.Flops * Rate,
+                   Stats.Bytes * Rate);
+  }
+  const MtxAllocStats Allocs = AllocationStats();
+  fmt::format_to(std::back_inserter(Buffer),
+                 "Allocations: {} ({} bytes), frees: {}, live bytes: {}\n", Allocs.nAllocs,
+                 Allocs.nBytes, Allocs.nFrees, Allocs.nLiveBytes);
+  return fmt::to_string(Buffer);
+}
+}; // namespace Mafs
+
+#endif // MAFS_INSTRUMENTATION_H
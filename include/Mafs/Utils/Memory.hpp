@@ -0,0 +1,503 @@
+#ifndef MAFS_MEMORY_H
+#define MAFS_MEMORY_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <new>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#endif
+#if defined(__linux__)
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/**
+ * Placement and page size of the large dynamic containers.
+ *
+ * By default the containers use malloc/calloc (new[] for non trivial types), so on a multi socket
+ * machine the pages of a matrix end up on the node of the thread that first writes them (usually
+ * the one that created it). Above MtxMemoryPolicy::nNumaThreshold bytes the containers can
+ * instead be mapped directly and
+ * - MtxNumaInterleave: spread page by page over every node, or
+ * - MtxNumaPartition: split in one contiguous block per node, block n on node n. The parallel
+ *   kernels (ParallelFor) given such a container split their work on its page blocks and run each
+ *   part on a thread bound to the node owning it.
+ *
+ * Above MtxMemoryPolicy::nHugePageThreshold bytes they can also be backed by 2 MB huge pages, which
+ * cuts the TLB misses of large strided (e.g. col major) walks. Explicit huge pages must be
+ * reserved by the administrator (vm.nr_hugepages), transparent ones depend on
+ * /sys/kernel/mm/transparent_hugepage/enabled being "always" or "madvise".
+ *
+ * NUMA placement is only available on Linux (mbind), elsewhere the policy is ignored.
+ */
+namespace Mafs {
+/**
+ * @brief Placement of the large containers on the NUMA nodes.
+ */
+enum MtxNumaPolicy {
+  MtxNumaLocal = 0,      // Operating system default (node of the first writer).
+  MtxNumaInterleave = 1, // Pages round robin over every node.
+  MtxNumaPartition = 2   // One contiguous block per node, kernel threads follow the blocks.
+};
+
+/**
+ * @brief Huge pages backing of the large containers.
+ */
+enum MtxHugePageMode {
+  MtxHugePagesOff = 0,         // Regular pages.
+  MtxHugePagesTransparent = 1, // 2 MB aligned mapping with madvise(MADV_HUGEPAGE).
+  MtxHugePagesExplicit = 2     // Reserved huge pages (MAP_HUGETLB), transparent ones if exhausted.
+};
+
+/**
+ * @brief Container allocation policy.
+ * @see SetMemoryPolicy
+ */
+struct MtxMemoryPolicy {
+  MtxNumaPolicy eNuma = MtxNumaLocal;           // Placement of the large containers.
+  size_t nNumaThreshold = size_t(1) << 24;      // Minimum container size (bytes) to apply eNuma.
+  MtxHugePageMode eHugePages = MtxHugePagesOff; // Page size of the large containers.
+  size_t nHugePageThreshold = size_t(1) << 25;  // Minimum container size (bytes) for huge pages.
+};
+
+namespace Internal {
+// Size of the huge pages requested by MtxHugePagesExplicit/Transparent (x86-64 and ARM64 default).
+inline constexpr size_t nHugePageSize = size_t(2) << 20;
+
+/**
+ * @brief NUMA nodes of the machine and their cpus (a single node when unknown).
+ */
+class NumaTopology {
+protected:
+  std::vector<std::vector<int>> m_NodeCpus; // m_NodeCpus[n] = cpus of the n-th online node.
+  std::vector<int> m_Nodes;                 // Ids of the online nodes.
+
+  /**
+   * @brief Parses a kernel cpu/node list such as "0-3,8,10-11".
+   *
+   * @param strList
+   * @return std::vector<int>
+   */
+  static auto ParseList(const std::string &strList) -> std::vector<int> {
+    std::vector<int> Values;
+    size_t nPos = 0;
+    while (nPos < strList.size()) {
+      size_t nEnd = strList.find(',', nPos);
+      if (nEnd == std::string::npos)
+        nEnd = strList.size();
+      const std::string strRange = strList.substr(nPos, nEnd - nPos);
+      const size_t nDash = strRange.find('-');
+      try {
+        const int nFirst = std::stoi(strRange.substr(0, nDash));
+        const int nLast =
+            nDash == std::string::npos ? nFirst : std::stoi(strRange.substr(nDash + 1));
+        for (int i = nFirst; i <= nLast; ++i)
+          Values.push_back(i);
+      } catch (const std::exception &) {
+        // Empty or malformed entry, skipped.
+      }
+      nPos = nEnd + 1;
+    }
+    return Values;
+  }
+
+  static auto CpuListPath(int nNode) -> std::string {
+    return "/sys/devices/system/node/node" + std::to_string(nNode) + "/cpulist";
+  }
+
+  NumaTopology() {
+#if defined(__linux__)
+    std::string strLine;
+    std::ifstream Online("/sys/devices/system/node/online");
+    if (std::getline(Online, strLine))
+      for (int nNode : ParseList(strLine)) {
+        std::ifstream Cpus(CpuListPath(nNode));
+        std::string strCpus;
+        std::getline(Cpus, strCpus);
+        m_Nodes.push_back(nNode);
+        m_NodeCpus.push_back(ParseList(strCpus));
+      }
+#endif
+    if (m_Nodes.empty()) {
+      m_Nodes.push_back(0);
+      m_NodeCpus.emplace_back();
+    }
+  }
+
+public:
+  static auto Instance() -> const NumaTopology & {
+    static const NumaTopology Topology;
+    return Topology;
+  }
+
+  inline auto NodeCount() const -> size_t { return m_Nodes.size(); }
+  inline auto NodeId(size_t nIndex) const -> int { return m_Nodes[nIndex]; }
+  inline auto NodeCpus(size_t nIndex) const -> const std::vector<int> & {
+    return m_NodeCpus[nIndex];
+  }
+};
+
+/**
+ * @brief Process wide MtxMemoryPolicy. Every container allocation reads it: each thread keeps a
+ * copy, refreshed only when Set changed the generation, so Get takes no lock.
+ */
+class MemoryConfig {
+protected:
+  std::mutex m_Mutex; // Guards m_Policy.
+  MtxMemoryPolicy m_Policy;
+  std::atomic<uint64_t> m_nGeneration = 1; // Bumped by every Set.
+
+public:
+  static auto Instance() -> MemoryConfig & {
+    static MemoryConfig Config;
+    return Config;
+  }
+
+  auto Get() -> MtxMemoryPolicy {
+    thread_local uint64_t nSeen = 0;
+    thread_local MtxMemoryPolicy Local;
+    if (m_nGeneration.load(std::memory_order_acquire) != nSeen) {
+      std::lock_guard<std::mutex> Lock(m_Mutex);
+      Local = m_Policy;
+      nSeen = m_nGeneration.load(std::memory_order_relaxed);
+    }
+    return Local;
+  }
+
+  void Set(const MtxMemoryPolicy &Policy) {
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+    m_Policy = Policy;
+    m_nGeneration.fetch_add(1, std::memory_order_release);
+  }
+};
+
+/**
+ * @brief Page blocks of a MtxNumaPartition mapping: node n holds the pages
+ * [n * nPages / nNodes, (n + 1) * nPages / nNodes) of the nMapped / nPageSize ones.
+ */
+struct NumaPartition {
+  size_t nMapped = 0;
+  size_t nPageSize = 0;
+  size_t nNodes = 0;
+};
+
+/**
+ * @brief Live MtxNumaPartition mappings, by start address, so the kernels can find the blocks of
+ * their operands.
+ */
+class NumaPartitions {
+protected:
+  std::mutex m_Mutex;
+  std::map<uintptr_t, NumaPartition> m_Partitions;
+
+public:
+  static auto Instance() -> NumaPartitions & {
+    static NumaPartitions Partitions;
+    return Partitions;
+  }
+
+  void Add(const void *pData, const NumaPartition &Partition) {
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+    m_Partitions[reinterpret_cast<uintptr_t>(pData)] = Partition;
+  }
+
+  void Remove(const void *pData) {
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+    m_Partitions.erase(reinterpret_cast<uintptr_t>(pData));
+  }
+
+  /**
+   * @brief Finds the mapping holding p.
+   *
+   * @param p
+   * @param Partition set to its blocks.
+   * @param nOffset set to the offset of p in the mapping.
+   * @return bool false if p is not in a partitioned mapping.
+   */
+  bool Find(const void *p, NumaPartition &Partition, size_t &nOffset) {
+    const uintptr_t nAddress = reinterpret_cast<uintptr_t>(p);
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+    auto It = m_Partitions.upper_bound(nAddress);
+    if (It == m_Partitions.begin())
+      return false;
+    --It;
+    if (nAddress - It->first >= It->second.nMapped)
+      return false;
+    Partition = It->second;
+    nOffset = nAddress - It->first;
+    return true;
+  }
+};
+
+/**
+ * @brief First of nCount units of nUnitBytes, starting nOffset bytes into a partitioned mapping,
+ * whose start lies in the block of node nNode (nCount for nNode >= Partition.nNodes). The units
+ * [PartitionBegin(n), PartitionBegin(n + 1)) start on node n.
+ *
+ * @param nNode
+ * @param Partition
+ * @param nOffset
+ * @param nUnitBytes
+ * @param nCount
+ * @return size_t
+ */
+inline auto PartitionBegin(size_t nNode, const NumaPartition &Partition, size_t nOffset,
+                           size_t nUnitBytes, size_t nCount) -> size_t {
+  if (nNode >= Partition.nNodes)
+    return nCount;
+  const size_t nPages = Partition.nMapped / Partition.nPageSize;
+  const size_t nStart = nNode * nPages / Partition.nNodes * Partition.nPageSize;
+  if (nStart <= nOffset)
+    return 0;
+  return std::min(nCount, (nStart - nOffset + nUnitBytes - 1) / nUnitBytes);
+}
+
+#if defined(__linux__)
+/**
+ * @brief mbind(2) on [pData, pData + nBytes) with a single node, or every node if nNode < 0.
+ * Failures are ignored, the pages then follow the default policy.
+ */
+inline void BindPages(void *pData, size_t nBytes, long nMode, int nNode) {
+  constexpr size_t nMaskWords = 16; // Up to 1024 nodes.
+  constexpr size_t nWordBits = 8 * sizeof(unsigned long);
+  unsigned long Mask[nMaskWords] = {};
+  const NumaTopology &Topology = NumaTopology::Instance();
+  for (size_t n = 0; n < Topology.NodeCount(); ++n) {
+    const size_t nBit = static_cast<size_t>(Topology.NodeId(n));
+    if ((nNode < 0 || Topology.NodeId(n) == nNode) && nBit < nMaskWords * nWordBits)
+      Mask[nBit / nWordBits] |= 1UL << (nBit % nWordBits);
+  }
+  syscall(SYS_mbind, pData, nBytes, nMode, Mask, nMaskWords * nWordBits + 1, 0);
+}
+#endif
+
+/**
+ * @brief Returns true if a nBytes container must be mapped with MapMemory.
+ *
+ * @param nBytes
+ * @return bool
+ */
+inline bool UseMappedMemory(size_t nBytes) {
+#if defined(__unix__) || defined(__APPLE__)
+  const MtxMemoryPolicy Policy = MemoryConfig::Instance().Get();
+  return (Policy.eNuma != MtxNumaLocal && nBytes >= Policy.nNumaThreshold) ||
+         (Policy.eHugePages != MtxHugePagesOff && nBytes >= Policy.nHugePageThreshold);
+#else
+  (void)nBytes;
+  return false;
+#endif
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+/**
+ * @brief Anonymous mapping of nBytes aligned on nAlignment (a multiple of the page size), so
+ * transparent huge pages can back it from its first byte.
+ *
+ * @return void* nullptr on failure.
+ */
+inline auto MapAligned(size_t nBytes, size_t nAlignment) -> void * {
+  const size_t nTotal = nBytes + nAlignment;
+  void *pMapping =
+      mmap(nullptr, nTotal, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (pMapping == MAP_FAILED)
+    return nullptr;
+  char *pStart = static_cast<char *>(pMapping);
+  char *pAligned = pStart + (nAlignment - reinterpret_cast<uintptr_t>(pStart) % nAlignment) %
+                                nAlignment;
+  // Returns the unused head and tail to the system.
+  if (pAligned != pStart)
+    munmap(pStart, static_cast<size_t>(pAligned - pStart));
+  const size_t nTail = nTotal - static_cast<size_t>(pAligned - pStart) - nBytes;
+  if (nTail > 0)
+    munmap(pAligned + nBytes, nTail);
+  return pAligned;
+}
+#endif
+
+/**
+ * @brief Maps at least nBytes of zeroed, page aligned memory, backed by huge pages and placed on
+ * the NUMA nodes according to the memory policy. Throws std::bad_alloc on failure.
+ *
+ * With MtxHugePagesExplicit the size is rounded to whole huge pages and taken from the reserved
+ * pool (MAP_HUGETLB); if the pool is exhausted it falls back to MtxHugePagesTransparent, a 2 MB
+ * aligned mapping marked with madvise(MADV_HUGEPAGE).
+ *
+ * @param nBytes
+ * @param nMapped set to the size of the mapping, to give to UnmapMemory.
+ * @return void*
+ */
+inline auto MapMemory(size_t nBytes, size_t &nMapped) -> void * {
+#if defined(__unix__) || defined(__APPLE__)
+  const MtxMemoryPolicy Policy = MemoryConfig::Instance().Get();
+  const bool bHugePages =
+      Policy.eHugePages != MtxHugePagesOff && nBytes >= Policy.nHugePageThreshold;
+  size_t nPageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  void *pData = nullptr;
+  nMapped = (nBytes + nPageSize - 1) / nPageSize * nPageSize;
+  if (bHugePages) {
+    const size_t nHugeMapped = (nBytes + nHugePageSize - 1) / nHugePageSize * nHugePageSize;
+#if defined(MAP_HUGETLB)
+    if (Policy.eHugePages == MtxHugePagesExplicit) {
+      pData = mmap(nullptr, nHugeMapped, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+      if (pData == MAP_FAILED)
+        pData = nullptr;
+    }
+#endif
+    if (pData == nullptr)
+      pData = MapAligned(nHugeMapped, nHugePageSize);
+#if defined(MADV_HUGEPAGE)
+    if (pData != nullptr)
+      madvise(pData, nHugeMapped, MADV_HUGEPAGE); // No-op for MAP_HUGETLB, hint for THP.
+#endif
+    nMapped = nHugeMapped;
+    nPageSize = nHugePageSize; // NUMA blocks must not split a huge page.
+  } else {
+    pData = mmap(nullptr, nMapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (pData == MAP_FAILED)
+      pData = nullptr;
+  }
+  if (pData == nullptr)
+    throw std::bad_alloc();
+
+#if defined(__linux__)
+  constexpr long nPreferred = 1, nInterleave = 3; // MPOL_PREFERRED, MPOL_INTERLEAVE
+  const NumaTopology &Topology = NumaTopology::Instance();
+  const size_t nNodes = Topology.NodeCount();
+  const bool bNuma = nBytes >= Policy.nNumaThreshold;
+  if (bNuma && nNodes > 1 && Policy.eNuma == MtxNumaInterleave)
+    BindPages(pData, nMapped, nInterleave, -1);
+  else if (bNuma && nNodes > 1 && Policy.eNuma == MtxNumaPartition) {
+    // Node n gets the n-th contiguous block, rounded to whole pages.
+    const NumaPartition Partition = {nMapped, nPageSize, nNodes};
+    const size_t nPages = nMapped / nPageSize;
+    for (size_t n = 0; n < nNodes; ++n) {
+      const size_t nBegin = n * nPages / nNodes, nEnd = (n + 1) * nPages / nNodes;
+      if (nEnd > nBegin)
+        BindPages(static_cast<char *>(pData) + nBegin * nPageSize, (nEnd - nBegin) * nPageSize,
+                  nPreferred, Topology.NodeId(n));
+    }
+    NumaPartitions::Instance().Add(pData, Partition);
+  }
+#endif
+  return pData;
+#else
+  (void)nBytes;
+  (void)nMapped;
+  throw std::bad_alloc();
+#endif
+}
+
+/**
+ * @brief Releases memory returned by MapMemory.
+ *
+ * @param pData
+ * @param nMapped size of the mapping returned by MapMemory.
+ */
+inline void UnmapMemory(void *pData, size_t nMapped) {
+#if defined(__unix__) || defined(__APPLE__)
+#if defined(__linux__)
+  NumaPartitions::Instance().Remove(pData);
+#endif
+  munmap(pData, nMapped);
+#else
+  (void)pData;
+  (void)nMapped;
+#endif
+}
+
+/**
+ * @brief Finds the partitioned mapping holding pData (see NumaPartitions::Find).
+ *
+ * @return bool false if pData is not in a MtxNumaPartition container.
+ */
+inline bool FindPartition(const void *pData, NumaPartition &Partition, size_t &nOffset) {
+#if defined(__linux__)
+  return NumaPartitions::Instance().Find(pData, Partition, nOffset);
+#else
+  (void)pData;
+  (void)Partition;
+  (void)nOffset;
+  return false;
+#endif
+}
+
+/**
+ * @brief Binds the calling thread to the cpus of node nNode, or gives it back the cpus it had
+ * before its first binding if nNode is SIZE_MAX. Nothing is done if the thread is already there.
+ *
+ * @param nNode
+ * @return bool false if the binding failed (the thread is left unchanged).
+ */
+inline bool BindThreadToNode(size_t nNode) {
+#if defined(__linux__)
+  thread_local size_t nBound = SIZE_MAX;
+  thread_local cpu_set_t Initial;
+  if (nNode == nBound)
+    return true;
+  const NumaTopology &Topology = NumaTopology::Instance();
+  cpu_set_t Set;
+  if (nNode == SIZE_MAX)
+    Set = Initial;
+  else {
+    if (nNode >= Topology.NodeCount())
+      return false;
+    if (nBound == SIZE_MAX && sched_getaffinity(0, sizeof(Initial), &Initial) != 0)
+      return false;
+    CPU_ZERO(&Set);
+    for (int nCpu : Topology.NodeCpus(nNode))
+      if (nCpu < CPU_SETSIZE)
+        CPU_SET(nCpu, &Set);
+    if (CPU_COUNT(&Set) == 0)
+      return false;
+  }
+  if (sched_setaffinity(0, sizeof(Set), &Set) != 0)
+    return false;
+  nBound = nNode;
+  return true;
+#else
+  (void)nNode;
+  return false;
+#endif
+}
+}; // namespace Internal
+
+/**
+ * @brief Sets the allocation policy of the containers created from now on.
+ *
+ * Usage (dual socket machine, large element-wise or parallel kernels):
+ * Mafs::SetMemoryPolicy({Mafs::MtxNumaPartition, size_t(64) << 20});
+ *
+ * @param Policy
+ */
+inline void SetMemoryPolicy(const MtxMemoryPolicy &Policy) {
+  Internal::MemoryConfig::Instance().Set(Policy);
+}
+
+/**
+ * @brief Returns the current allocation policy.
+ *
+ * @return MtxMemoryPolicy
+ */
+inline auto MemoryPolicy() -> MtxMemoryPolicy { return Internal::MemoryConfig::Instance().Get(); }
+
+/**
+ * @brief Number of NUMA nodes of the machine (1 when unknown).
+ *
+ * @return size_t
+ */
+inline auto NumaNodeCount() -> size_t { return Internal::NumaTopology::Instance().NodeCount(); }
+}; // namespace Mafs
+
+#endif // MAFS_MEMORY_H
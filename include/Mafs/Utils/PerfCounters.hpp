@@ -0,0 +1,402 @@
+#ifndef MAFS_PERFCOUNTERS_H
+#define MAFS_PERFCOUNTERS_H
+
+#include <cstdint>
+#include <fmt/format.h>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/**
+ * Hardware performance counters (Linux perf_event_open).
+ *
+ * Each thread lazily opens one counter group (cycles, instructions, cache misses, branch misses)
+ * for itself, user space only, that is kept running; a PerfScope reads the group when it is
+ * created and destroyed, so scopes can be nested and cost two read() calls. When the counters
+ * can't be opened (not Linux, perf_event_paranoid, containers, VMs without PMU) every reading is
+ * zero and MtxPerfCounters::bValid is false.
+ *
+ * A scope counts its own thread plus the chunks that the workers of ParallelFor run for it: each
+ * worker reads its group around the chunks it runs and adds the difference to the innermost scope
+ * of the calling thread, and a nested scope passes what its workers counted on to its parent.
+ * Threads started otherwise (user threads, the tasks of MatrixOperations::Async) are not counted.
+ *
+ * PerfScope can be used in user code. Build with MAFS_ENABLE_PERF_COUNTERS (CMake option
+ * ENABLE_PERF_COUNTERS) to also record every MatrixOperations call, keyed by
+ * "<Backend>::<Operation>".
+ */
+namespace Mafs {
+/**
+ * @brief Hardware counters of a scope (or accumulated over several scopes).
+ */
+struct MtxPerfCounters {
+  uint64_t nScopes = 0;       // Number of scopes accumulated.
+  uint64_t nCycles = 0;       // CPU cycles.
+  uint64_t nInstructions = 0; // Retired instructions.
+  uint64_t nCacheMisses = 0;  // Last level cache misses.
+  uint64_t nBranchMisses = 0; // Mispredicted branches.
+  bool bValid = false;        // False if the counters are unavailable (all zero).
+
+  /**
+   * @brief Instructions per cycle, a low value with many cache misses hints a memory bound scope.
+   *
+   * @return double
+   */
+  auto InstructionsPerCycle() const -> double {
+    return nCycles > 0 ? static_cast<double>(nInstructions) / static_cast<double>(nCycles) : 0;
+  }
+
+  auto operator+=(const MtxPerfCounters &Other) -> MtxPerfCounters & {
+    nScopes += Other.nScopes;
+    nCycles += Other.nCycles;
+    nInstructions += Other.nInstructions;
+    nCacheMisses += Other.nCacheMisses;
+    nBranchMisses += Other.nBranchMisses;
+    bValid = bValid || Other.bValid;
+    return *this;
+  }
+};
+
+namespace Internal {
+/**
+ * @brief Per thread perf_event_open counter group, opened on first use.
+ */
+class PerfGroup {
+protected:
+  enum { m_nEvents = 4 };
+  int m_Fds[m_nEvents] = {-1, -1, -1, -1};
+  // m_Events[i] = which MtxPerfCounters field the i-th value of a group read belongs to.
+  size_t m_Events[m_nEvents] = {0, 0, 0, 0};
+  size_t m_nOpened = 0;
+
+#if defined(__linux__)
+  static auto Open(uint64_t nConfig, int nGroupFd) -> int {
+    perf_event_attr Attr{};
+    Attr.size = sizeof(perf_event_attr);
+    Attr.type = PERF_TYPE_HARDWARE;
+    Attr.config = nConfig;
+    Attr.disabled = nGroupFd == -1 ? 1 : 0;
+    Attr.exclude_kernel = 1;
+    Attr.exclude_hv = 1;
+    Attr.read_format = PERF_FORMAT_GROUP;
+    return static_cast<int>(syscall(SYS_perf_event_open, &Attr, 0, -1, nGroupFd, 0));
+  }
+#endif
+
+  PerfGroup() {
+#if defined(__linux__)
+    const uint64_t Configs[m_nEvents] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                         PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+    // The cycles counter leads the group, the others are optional (some PMUs lack them).
+    for (size_t i = 0; i < m_nEvents; ++i) {
+      const int nFd = Open(Configs[i], m_nOpened == 0 ? -1 : m_Fds[0]);
+      if (nFd == -1) {
+        if (i == 0)
+          return;
+        continue;
+      }
+      m_Fds[m_nOpened] = nFd;
+      m_Events[m_nOpened++] = i;
+    }
+    ioctl(m_Fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(m_Fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+  }
+
+public:
+  PerfGroup(const PerfGroup &) = delete;
+  PerfGroup &operator=(const PerfGroup &) = delete;
+
+  ~PerfGroup() {
+#if defined(__linux__)
+    for (size_t i = 0; i < m_nOpened; ++i)
+      close(m_Fds[i]);
+#endif
+  }
+
+  static auto ThreadInstance() -> PerfGroup & {
+    thread_local PerfGroup Group;
+    return Group;
+  }
+
+  inline bool IsValid() const { return m_nOpened > 0; }
+
+  /**
+   * @brief Current (running) values of the counters of this thread.
+   *
+   * @return MtxPerfCounters
+   */
+  auto Read() const -> MtxPerfCounters {
+    MtxPerfCounters Counters;
+#if defined(__linux__)
+    if (!IsValid())
+      return Counters;
+    uint64_t Values[1 + m_nEvents] = {};
+    if (read(m_Fds[0], Values, sizeof(Values)) <= 0)
+      return Counters;
+    uint64_t *Fields[m_nEvents] = {&Counters.nCycles, &Counters.nInstructions,
+                                   &Counters.nCacheMisses, &Counters.nBranchMisses};
+    for (size_t i = 0; i < Values[0] && i < m_nOpened; ++i)
+      *Fields[m_Events[i]] = Values[1 + i];
+    Counters.bValid = true;
+#endif
+    return Counters;
+  }
+
+  /**
+   * @brief Events counted between two readings.
+   *
+   * @param Start
+   * @param Now
+   * @return MtxPerfCounters
+   */
+  static auto Difference(const MtxPerfCounters &Start, const MtxPerfCounters &Now)
+      -> MtxPerfCounters {
+    MtxPerfCounters Counters;
+    Counters.nCycles = Now.nCycles - Start.nCycles;
+    Counters.nInstructions = Now.nInstructions - Start.nInstructions;
+    Counters.nCacheMisses = Now.nCacheMisses - Start.nCacheMisses;
+    Counters.nBranchMisses = Now.nBranchMisses - Start.nBranchMisses;
+    Counters.bValid = Now.bValid && Start.bValid;
+    return Counters;
+  }
+};
+
+/**
+ * @brief Accumulated counters of a MAFS_PERF_SCOPE call site.
+ */
+struct PerfSite {
+  MtxPerfCounters *pStats;
+};
+
+/**
+ * @brief Process wide accumulation of the named scopes.
+ * The entries are never erased (Reset zeroes them), so call sites keep a pointer to theirs.
+ */
+class PerfRegistry {
+protected:
+  std::mutex m_Mutex;
+  std::map<std::string, MtxPerfCounters> m_Scopes;
+
+public:
+  static auto Instance() -> PerfRegistry & {
+    static PerfRegistry Registry;
+    return Registry;
+  }
+
+  /**
+   * @brief Entry of "<Backend>::<Operation>". Called once per call site.
+   *
+   * @param pBackend
+   * @param pOperation
+   * @return PerfSite
+   */
+  auto Site(const char *pBackend, const char *pOperation) -> PerfSite {
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+    return {&m_Scopes[fmt::format("{}::{}", pBackend, pOperation)]};
+  }
+
+  void Record(const std::string &strName, const MtxPerfCounters &Counters) {
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+    m_Scopes[strName] += Counters;
+  }
+
+  void Record(PerfSite Site, const MtxPerfCounters &Counters) {
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+    *Site.pStats += Counters;
+  }
+
+  auto Scopes() -> std::map<std::string, MtxPerfCounters> {
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+    std::map<std::string, MtxPerfCounters> Result;
+    for (const auto &[strName, Counters] : m_Scopes)
+      if (Counters.nScopes > 0)
+        Result.emplace(strName, Counters);
+    return Result;
+  }
+
+  void Reset() {
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+    for (auto &Entry : m_Scopes)
+      Entry.second = MtxPerfCounters();
+  }
+};
+}; // namespace Internal
+
+/**
+ * @brief Counts the hardware events of the calling thread from construction to destruction.
+ *
+ * Usage:
+ * {
+ *   Mafs::PerfScope Scope("MyKernel"); // Accumulated in PerfCounterStats()["MyKernel"].
+ *   ...
+ * }
+ * or, to get the values of a single scope:
+ * Mafs::MtxPerfCounters Counters;
+ * {
+ *   Mafs::PerfScope Scope(Counters); // Counters is written on destruction.
+ *   ...
+ * }
+ */
+class PerfScope {
+protected:
+  std::string m_strName;
+  MtxPerfCounters *m_pResult = nullptr;
+  Internal::PerfSite m_Site = {nullptr};
+  MtxPerfCounters m_Start;
+  PerfScope *m_pParent; // Enclosing scope of the thread.
+  mutable std::mutex m_WorkerMutex;
+  MtxPerfCounters m_Workers; // Counted by the workers of ParallelFor.
+
+  inline static thread_local PerfScope *m_pCurrent = nullptr;
+
+  auto Open() -> MtxPerfCounters {
+    m_pCurrent = this;
+    return Internal::PerfGroup::ThreadInstance().Read();
+  }
+
+public:
+  /**
+   * @brief Records the scope under strName (see PerfCounterStats).
+   *
+   * @param strName
+   */
+  explicit PerfScope(std::string strName)
+      : m_strName(std::move(strName)), m_pParent(m_pCurrent) {
+    m_Start = Open();
+  }
+
+  /**
+   * @brief Writes the counters of the scope to Result on destruction.
+   *
+   * @param Result
+   */
+  explicit PerfScope(MtxPerfCounters &Result) : m_pResult(&Result), m_pParent(m_pCurrent) {
+    m_Start = Open();
+  }
+
+  /**
+   * @brief Records the scope in the entry of a call site (see MAFS_PERF_SCOPE).
+   *
+   * @param Site
+   */
+  explicit PerfScope(Internal::PerfSite Site) : m_Site(Site), m_pParent(m_pCurrent) {
+    m_Start = Open();
+  }
+
+  PerfScope(const PerfScope &) = delete;
+  PerfScope &operator=(const PerfScope &) = delete;
+
+  ~PerfScope() {
+    const MtxPerfCounters Counters = Elapsed();
+    m_pCurrent = m_pParent;
+    if (m_pParent != nullptr)
+      m_pParent->AddWorkers(m_Workers); // The parent's thread didn't count them either.
+    if (m_pResult != nullptr)
+      *m_pResult = Counters;
+    if (!m_strName.empty())
+      Internal::PerfRegistry::Instance().Record(m_strName, Counters);
+    if (m_Site.pStats != nullptr)
+      Internal::PerfRegistry::Instance().Record(m_Site, Counters);
+  }
+
+  /**
+   * @brief Innermost scope of the calling thread (nullptr if none).
+   *
+   * @return PerfScope*
+   */
+  static inline auto Current() -> PerfScope * { return m_pCurrent; }
+
+  /**
+   * @brief Adds events counted by another thread on behalf of this scope.
+   *
+   * @param Counters
+   */
+  void AddWorkers(const MtxPerfCounters &Counters) {
+    if (!Counters.bValid)
+      return;
+    std::lock_guard<std::mutex> Lock(m_WorkerMutex);
+    m_Workers += Counters;
+  }
+
+  /**
+   * @brief Counters since the scope was created, workers included.
+   *
+   * @return MtxPerfCounters
+   */
+  auto Elapsed() const -> MtxPerfCounters {
+    MtxPerfCounters Counters =
+        Internal::PerfGroup::Difference(m_Start, Internal::PerfGroup::ThreadInstance().Read());
+    {
+      std::lock_guard<std::mutex> Lock(m_WorkerMutex);
+      if (Counters.bValid)
+        Counters += m_Workers;
+    }
+    Counters.nScopes = 1;
+    return Counters;
+  }
+};
+
+#ifdef MAFS_ENABLE_PERF_COUNTERS
+#define MAFS_PERFCOUNTERS_CAT2(a, b) a##b
+#define MAFS_PERFCOUNTERS_CAT(a, b) MAFS_PERFCOUNTERS_CAT2(a, b)
+// Records the hardware counters of the enclosing scope as one call of pOperation on pBackend
+// (constant strings, looked up once per call site).
+#define MAFS_PERF_SCOPE(pBackend, pOperation)                                                      \
+  static const ::Mafs::Internal::PerfSite MAFS_PERFCOUNTERS_CAT(MafsPerfSite, __LINE__) =          \
+      ::Mafs::Internal::PerfRegistry::Instance().Site(pBackend, pOperation);                       \
+  ::Mafs::PerfScope MAFS_PERFCOUNTERS_CAT(MafsPerfScope, __LINE__)(                                \
+      MAFS_PERFCOUNTERS_CAT(MafsPerfSite, __LINE__))
+#else
+#define MAFS_PERF_SCOPE(pBackend, pOperation)
+#endif
+
+/**
+ * @brief Returns true if the hardware counters can be read on the calling thread.
+ *
+ * @return bool
+ */
+inline bool PerfCountersAvailable() { return Internal::PerfGroup::ThreadInstance().IsValid(); }
+
+/**
+ * @brief Returns the accumulated counters of every named scope.
+ *
+ * @return std::map<std::string, MtxPerfCounters>
+ */
+inline auto PerfCounterStats() -> std::map<std::string, MtxPerfCounters> {
+  return Internal::PerfRegistry::Instance().Scopes();
+}
+
+/**
+ * @brief Clears the accumulated counters.
+ */
+inline void ResetPerfCounterStats() { Internal::PerfRegistry::Instance().Reset(); }
+
+/**
+ * @brief Formats the accumulated counters as a table.
+ *
+ * @return std::string
+ */
+inline auto DumpPerfCounterStats() -> std::string {
+  fmt::memory_buffer Buffer;
+  fmt::format_to(std::back_inserter(Buffer), "{:<32} {:>8} {:>14} {:>14} {:>8} {:>12} {:>12}\n",
+                 "Scope", "Count", "Cycles", "Instructions", "IPC", "Cache miss", "Branch miss");
+  for (const auto &[strName, Counters] : PerfCounterStats())
+    fmt::format_to(std::back_inserter(Buffer),
+                   "{:<32} {:>8} {:>14} {:>14} {:>8.2f} {:>12} {:>12}\n", strName,
+                   Counters.nScopes, Counters.nCycles, Counters.nInstructions,
+                   Counters.InstructionsPerCycle(), Counters.nCacheMisses, Counters.nBranchMisses);
+  return fmt::to_string(Buffer);
+}
+}; // namespace Mafs
+
+#endif // MAFS_PERFCOUNTERS_H
@@ -0,0 +1,235 @@
+#ifndef MAFS_WORKSPACE_H
+#define MAFS_WORKSPACE_H
+
+#include <Mafs/Utils/Instrumentation.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <new>
+#include <stddef.h>
+#include <type_traits>
+#include <vector>
+
+/**
+ * Scratch memory of the operations.
+ *
+ * Row/col swaps, the row major copies of the GEMM operands, transposed lines and factorizations
+ * need temporary buffers. Instead of allocating them on every call they borrow them from a
+ * thread local workspace: a stack of blocks that grows to the largest amount used at once by the
+ * thread and is then reused. Once every buffer is returned the blocks are merged into one, so a
+ * steady workload runs without allocations.
+ *
+ * Mafs::ReleaseScratch() frees the workspace of the calling thread (e.g. after a large one-off
+ * factorization).
+ */
+namespace Mafs::Internal {
+class Workspace {
+protected:
+  // Alignment of every buffer (cache line, also enough for any vector register).
+  static constexpr size_t m_nAlignment = 64;
+  // Size of the first block.
+  static constexpr size_t m_nMinBlock = size_t(64) << 10;
+
+  struct Block {
+    std::byte *pData = nullptr;
+    size_t nSize = 0;
+  };
+  std::vector<Block> m_Blocks;
+  size_t m_nBlock = 0;  // Block being filled.
+  size_t m_nOffset = 0; // Bytes used in m_Blocks[m_nBlock].
+  size_t m_nLeases = 0; // Buffers not returned yet.
+
+  Workspace() = default;
+
+  static constexpr auto RoundUp(size_t nBytes) -> size_t {
+    return (std::max<size_t>(nBytes, 1) + m_nAlignment - 1) / m_nAlignment * m_nAlignment;
+  }
+
+  static auto AllocBlock(size_t nSize) -> Block {
+    MAFS_RECORD_ALLOC(nSize);
+    return {static_cast<std::byte *>(::operator new(nSize, std::align_val_t(m_nAlignment))),
+            nSize};
+  }
+
+  void FreeBlocks() {
+    for (const Block &Current : m_Blocks) {
+      ::operator delete(Current.pData, std::align_val_t(m_nAlignment));
+      MAFS_RECORD_FREE(Current.nSize);
+    }
+    m_Blocks.clear();
+  }
+
+public:
+  Workspace(const Workspace &) = delete;
+  Workspace &operator=(const Workspace &) = delete;
+  ~Workspace() { FreeBlocks(); }
+
+  /**
+   * @brief Workspace of the calling thread.
+   *
+   * @return Workspace&
+   */
+  static auto Local() -> Workspace & {
+    thread_local Workspace Scratch;
+    return Scratch;
+  }
+
+  /**
+   * @brief Borrows nBytes, aligned to 64 bytes, until the matching Release.
+   * The buffers are stacked: the space of a buffer is reused once it and every buffer borrowed
+   * after it are returned.
+   *
+   * @param nBytes
+   * @return void*
+   */
+  auto Acquire(size_t nBytes) -> void * {
+    nBytes = RoundUp(nBytes);
+    m_nLeases++;
+    for (; m_nBlock < m_Blocks.size(); ++m_nBlock, m_nOffset = 0)
+      if (m_nOffset + nBytes <= m_Blocks[m_nBlock].nSize) {
+        void *pData = m_Blocks[m_nBlock].pData + m_nOffset;
+        m_nOffset += nBytes;
+        return pData;
+      }
+    // Doubles the capacity, so a thread only grows its workspace a few times.
+    m_Blocks.push_back(AllocBlock(std::max({nBytes, Capacity(), m_nMinBlock})));
+    m_nBlock = m_Blocks.size() - 1;
+    m_nOffset = nBytes;
+    return m_Blocks.back().pData;
+  }
+
+  /**
+   * @brief Returns a buffer of Acquire. The top of the stack is rewound, once every buffer is
+   * returned the workspace is rewound entirely (and its blocks merged into one).
+   *
+   * @param pData
+   * @param nBytes size given to Acquire.
+   */
+  void Release(void *pData, size_t nBytes) {
+    if (--m_nLeases > 0) {
+      nBytes = RoundUp(nBytes);
+      if (m_nBlock < m_Blocks.size() && m_nOffset >= nBytes &&
+          static_cast<std::byte *>(pData) == m_Blocks[m_nBlock].pData + m_nOffset - nBytes)
+        m_nOffset -= nBytes;
+      return;
+    }
+    m_nBlock = 0;
+    m_nOffset = 0;
+    if (m_Blocks.size() > 1) {
+      const size_t nCapacity = Capacity();
+      FreeBlocks();
+      m_Blocks.push_back(AllocBlock(nCapacity));
+    }
+  }
+
+  /**
+   * @brief Frees the blocks, if no buffer is borrowed.
+   */
+  void Shrink() {
+    if (m_nLeases == 0)
+      FreeBlocks();
+  }
+
+  /**
+   * @brief Bytes reserved by the workspace.
+   *
+   * @return size_t
+   */
+  inline auto Capacity() const -> size_t {
+    size_t nCapacity = 0;
+    for (const Block &Current : m_Blocks)
+      nCapacity += Current.nSize;
+    return nCapacity;
+  }
+};
+
+/**
+ * @brief Uninitialized buffer of nCount T borrowed from the thread local workspace, returned when
+ * it goes out of scope. Types that are not trivially copyable are allocated in a std::vector
+ * instead (the workspace doesn't construct/destroy values).
+ *
+ * Usage: ScratchBuffer<double> Row(nCols); std::memcpy(Row.Data(), pRow, nCols * sizeof(double));
+ *
+ * @tparam T
+ */
+template <typename T> class ScratchBuffer {
+protected:
+  static constexpr bool m_bPlain =
+      std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>;
+
+  T *m_pData = nullptr;
+  size_t m_nSize = 0;
+  std::vector<T> m_Fallback;
+
+public:
+  ScratchBuffer() = default;
+  explicit ScratchBuffer(size_t nSize) { Resize(nSize); }
+  ScratchBuffer(const ScratchBuffer &) = delete;
+  ScratchBuffer &operator=(const ScratchBuffer &) = delete;
+  ~ScratchBuffer() { Reset(); }
+
+  /**
+   * @brief Borrows nSize values, the previous ones are returned (not copied).
+   *
+   * @param nSize
+   */
+  void Resize(size_t nSize) {
+    Reset();
+    if constexpr (m_bPlain)
+      m_pData = static_cast<T *>(Workspace::Local().Acquire(sizeof(T) * nSize));
+    else {
+      m_Fallback.resize(nSize);
+      m_pData = m_Fallback.data();
+    }
+    m_nSize = nSize;
+  }
+
+  /**
+   * @brief Borrows nSize values and copies pSource into them.
+   *
+   * @param pSource
+   * @param nSize
+   */
+  void Assign(const T *pSource, size_t nSize) {
+    Resize(nSize);
+    std::copy(pSource, pSource + nSize, m_pData);
+  }
+
+  /**
+   * @brief Returns the values to the workspace.
+   */
+  void Reset() {
+    if constexpr (m_bPlain) {
+      if (m_pData != nullptr)
+        Workspace::Local().Release(m_pData, sizeof(T) * m_nSize);
+    } else
+      m_Fallback = std::vector<T>();
+    m_pData = nullptr;
+    m_nSize = 0;
+  }
+
+  T &operator[](size_t nIndex) { return m_pData[nIndex]; }
+  const T &operator[](size_t nIndex) const { return m_pData[nIndex]; }
+
+  inline T *Data() { return m_pData; }
+  inline const T *Data() const { return m_pData; }
+  inline size_t Size() const { return m_nSize; }
+  inline bool Empty() const { return m_nSize == 0; }
+};
+}; // namespace Mafs::Internal
+
+namespace Mafs {
+/**
+ * @brief Frees the scratch workspace of the calling thread. It grows again on the next operation
+ * that needs it.
+ */
+inline void ReleaseScratch() { Internal::Workspace::Local().Shrink(); }
+
+/**
+ * @brief Bytes reserved by the scratch workspace of the calling thread.
+ *
+ * @return size_t
+ */
+inline auto ScratchCapacity() -> size_t { return Internal::Workspace::Local().Capacity(); }
+}; // namespace Mafs
+
+#endif // MAFS_WORKSPACE_H
@@ -0,0 +1,134 @@
+/*********************************************************************************
+ * BitMatrixTest.cpp
+ * It has tests for the bit-packed boolean matrices and their products.
+ *********************************************************************************/
+
+#include <Mafs/Matrix/Bit/BitOperations.hpp>
+#include <Mafs/Matrix/Matrix.hpp>
+#include <TestHelpers.hpp>
+#include <doctest/doctest.h>
+#include <random>
+
+namespace {
+// Random 0/1 matrix with about Density of the entries set.
+auto RandomBits(size_t nRows, size_t nCols, double Density, unsigned nSeed)
+    -> Mafs::Bit::BitMatrix {
+  std::mt19937 Generator(nSeed);
+  std::bernoulli_distribution Distribution(Density);
+  Mafs::Bit::BitMatrix Matrix(nRows, nCols);
+  for (size_t i = 0; i < nRows; ++i)
+    for (size_t j = 0; j < nCols; ++j)
+      Matrix.Set(i, j, Distribution(Generator));
+  return Matrix;
+}
+
+void CheckProducts(const Mafs::Bit::BitMatrix &A, const Mafs::Bit::BitMatrix &B) {
+  const auto Intersection = Mafs::Bit::IntersectionCount(A, B);
+  const auto Hamming = Mafs::Bit::HammingDistance(A, B);
+  const auto Jaccard = Mafs::Bit::Jaccard(A, B);
+  REQUIRE(Intersection.RowCount() == A.RowCount());
+  REQUIRE(Intersection.ColCount() == B.RowCount());
+  for (size_t i = 0; i < A.RowCount(); ++i)
+    for (size_t j = 0; j < B.RowCount(); ++j) {
+      uint32_t nBoth = 0, nDiffer = 0, nAny = 0;
+      for (size_t k = 0; k < A.ColCount(); ++k) {
+        nBoth += A(i, k) && B(j, k);
+        nDiffer += A(i, k) != B(j, k);
+        nAny += A(i, k) || B(j, k);
+      }
+      REQUIRE(Intersection(i, j) == nBoth);
+      REQUIRE(Hamming(i, j) == nDiffer);
+      REQUIRE(Jaccard(i, j) == doctest::Approx(nAny == 0 ? 1.0 : double(nBoth) / nAny));
+    }
+
+  // Boolean product A * B^T.
+  const auto Product = Mafs::Bit::Multiplication(A, B.Transpose());
+  for (size_t i = 0; i < A.RowCount(); ++i)
+    for (size_t j = 0; j < B.RowCount(); ++j)
+      REQUIRE(Product(i, j) == (Intersection(i, j) > 0));
+}
+}; // namespace
+
+TEST_CASE("BitMatrix entries and element-wise operations") {
+  Mafs::Bit::BitMatrix A(3, 70);
+  CHECK(A.WordsPerRow() == 2);
+  CHECK(A.Count() == 0);
+  A.Set(0, 0);
+  A.Set(1, 64);
+  A.Set(2, 69);
+  CHECK(A(0, 0));
+  CHECK(A(1, 64));
+  CHECK_FALSE(A(1, 63));
+  CHECK(A.Count() == 3);
+  A.Set(1, 64, false);
+  CHECK(A.CountRow(1) == 0);
+  REQUIRE_THROWS_AS(A.Get(3, 0), std::out_of_range);
+  REQUIRE_THROWS_AS(A.Set(0, 70), std::out_of_range);
+
+  // The padding bits stay clear: NOT of 3 entries leaves 3 * 70 - 2.
+  const auto NotA = ~A;
+  CHECK(NotA.Count() == 3 * 70 - 2);
+  CHECK((NotA | A).Count() == 3 * 70);
+  CHECK((NotA & A).Count() == 0);
+  CHECK((NotA ^ A) == Mafs::Bit::BitMatrix(3, 70, true));
+  CHECK(Mafs::Bit::BitMatrix(2, 3, true).Count() == 6);
+  REQUIRE_THROWS_AS(A & Mafs::Bit::BitMatrix(3, 71), std::domain_error);
+
+  const auto T = NotA.Transpose();
+  REQUIRE(T.RowCount() == 70);
+  REQUIRE(T.ColCount() == 3);
+  for (size_t i = 0; i < 3; ++i)
+    for (size_t j = 0; j < 70; ++j)
+      REQUIRE(T(j, i) == NotA(i, j));
+  CHECK(T.Transpose() == NotA);
+}
+
+TEST_CASE("BitMatrix dense conversions") {
+  Mafs::Matrix<double, 0, 0, Mafs::MtxColMajor> Dense(5, 130);
+  Dense.SetRandom(-1.0, 1.0, 3);
+  for (size_t i = 0; i < 5; ++i)
+    for (size_t j = 0; j < 130; ++j)
+      if (Dense(i, j) < 0)
+        Dense(i, j) = 0;
+  const Mafs::Bit::BitMatrix Bits(Dense);
+  for (size_t i = 0; i < 5; ++i)
+    for (size_t j = 0; j < 130; ++j)
+      REQUIRE(Bits(i, j) == (Dense(i, j) != 0));
+
+  const auto Bytes = Bits.ToMatrix<uint8_t>();
+  const auto Floats = Bits.ToMatrix<float, Mafs::MtxColMajor>();
+  for (size_t i = 0; i < 5; ++i)
+    for (size_t j = 0; j < 130; ++j) {
+      REQUIRE(Bytes(i, j) == (Bits(i, j) ? 1 : 0));
+      REQUIRE(Floats(i, j) == (Bits(i, j) ? 1.f : 0.f));
+    }
+  CHECK(Mafs::Bit::BitMatrix(Bytes) == Bits);
+}
+
+TEST_CASE("BitMatrix products") {
+  CheckProducts(RandomBits(9, 200, 0.3, 1), RandomBits(11, 200, 0.6, 2));
+  CheckProducts(RandomBits(5, 64, 0.5, 3), RandomBits(5, 64, 0.5, 3));
+  CheckProducts(RandomBits(4, 7, 0.0, 4), RandomBits(3, 7, 0.5, 5));
+
+  // Reachability in two steps of the chain 0 -> 1 -> 2 -> ... -> 99.
+  Mafs::Bit::BitMatrix Chain(100, 100);
+  for (size_t i = 0; i + 1 < 100; ++i)
+    Chain.Set(i, i + 1);
+  const auto TwoSteps = Mafs::Bit::Multiplication(Chain, Chain);
+  CHECK(TwoSteps.Count() == 98);
+  CHECK(TwoSteps(10, 12));
+
+  {
+    MafsTests::TuningParamsGuard Guard;
+    Mafs::MtxTuningParams Params;
+    Params.nGemmBlockM = 3;
+    Params.nParallelThreshold = 0;
+    Params.nThreads = 3;
+    Guard.Set(Params);
+    CheckProducts(RandomBits(17, 150, 0.4, 6), RandomBits(13, 150, 0.4, 7));
+  }
+
+  REQUIRE_THROWS_AS(Mafs::Bit::Multiplication(Chain, Mafs::Bit::BitMatrix(99, 4)),
+                    std::domain_error);
+  REQUIRE_THROWS_AS(Mafs::Bit::Jaccard(Chain, Mafs::Bit::BitMatrix(4, 99)), std::domain_error);
+}
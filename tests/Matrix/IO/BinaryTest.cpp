@@ -0,0 +1,127 @@
+/*********************************************************************************
+ * BinaryTest.cpp
+ * It has tests for the binary serialization and the memory mapped matrices.
+ *********************************************************************************/
+
+#include <Mafs/Matrix/IO/Binary.hpp>
+#include <Mafs/Matrix/Operations/Operations.hpp>
+#include <doctest/doctest.h>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+
+static std::string TempPath(const std::string &strName) {
+  return (std::filesystem::temp_directory_path() / strName).string();
+}
+
+TEST_CASE("Binary save/load round trip") {
+  Mafs::Matrix<double, 0, 0, Mafs::MtxRowMajor> Matrix(3, 4);
+  for (size_t i = 0; i < Matrix.RowCount(); ++i)
+    for (size_t j = 0; j < Matrix.ColCount(); ++j)
+      Matrix(i, j) = static_cast<double>(i * 10 + j);
+
+  const std::string strPath = TempPath("mafs_binary_test.bin");
+  Mafs::Save(Matrix, strPath);
+
+  auto Same = Mafs::Load<Mafs::Matrix<double, 0, 0, Mafs::MtxRowMajor>>(strPath);
+  auto Transposed = Mafs::Load<Mafs::Matrix<double, 0, 0, Mafs::MtxColMajor>>(strPath);
+  auto Static = Mafs::Load<Mafs::Matrix<double, 3, 4, Mafs::MtxColMajor>>(strPath);
+
+  REQUIRE(Same.RowCount() == 3);
+  REQUIRE(Same.ColCount() == 4);
+  for (size_t i = 0; i < Matrix.RowCount(); ++i)
+    for (size_t j = 0; j < Matrix.ColCount(); ++j) {
+      REQUIRE(Same(i, j) == Matrix(i, j));
+      REQUIRE(Transposed(i, j) == Matrix(i, j));
+      REQUIRE(Static(i, j) == Matrix(i, j));
+    }
+
+  // Wrong type or wrong static dimensions.
+  REQUIRE_THROWS(Mafs::Load<Mafs::Matrix<float, 0, 0, Mafs::MtxRowMajor>>(strPath));
+  REQUIRE_THROWS(Mafs::Load<Mafs::Matrix<double, 4, 3, Mafs::MtxRowMajor>>(strPath));
+  REQUIRE_THROWS(
+      Mafs::Load<Mafs::Matrix<double, 0, 0, Mafs::MtxRowMajor>>(TempPath("mafs_missing.bin")));
+
+  // Headers asking for more data than the file holds, overflowing sizes and a cut payload.
+  typedef Mafs::Matrix<double, 0, 0, Mafs::MtxRowMajor> DynMatrix;
+  const auto SetSize = [&strPath](uint64_t nRows, uint64_t nCols) {
+    std::fstream File(strPath, std::ios::binary | std::ios::in | std::ios::out);
+    File.seekp(offsetof(Mafs::Internal::BinaryHeader, nRows));
+    File.write(reinterpret_cast<const char *>(&nRows), sizeof(nRows));
+    File.write(reinterpret_cast<const char *>(&nCols), sizeof(nCols));
+  };
+  SetSize(1000, 4);
+  REQUIRE_THROWS_AS(Mafs::Load<DynMatrix>(strPath), std::runtime_error);
+  REQUIRE_THROWS_AS((Mafs::MappedMatrix<double, Mafs::MtxRowMajor>(strPath)), std::runtime_error);
+  SetSize(uint64_t(1) << 62, 16);
+  REQUIRE_THROWS_AS(Mafs::Load<DynMatrix>(strPath), std::runtime_error);
+  REQUIRE_THROWS_AS((Mafs::MappedMatrix<double, Mafs::MtxRowMajor>(strPath)), std::runtime_error);
+  SetSize(3, 4);
+  REQUIRE(Mafs::Load<DynMatrix>(strPath)(2, 3) == Matrix(2, 3));
+  std::filesystem::resize_file(strPath, std::filesystem::file_size(strPath) - 1);
+  REQUIRE_THROWS_AS(Mafs::Load<DynMatrix>(strPath), std::runtime_error);
+
+  std::filesystem::remove(strPath);
+}
+
+TEST_CASE("Binary memory mapped matrix") {
+  Mafs::Matrix<int, 0, 0, Mafs::MtxColMajor> Matrix(5, 2);
+  for (size_t i = 0; i < Matrix.RowCount(); ++i)
+    for (size_t j = 0; j < Matrix.ColCount(); ++j)
+      Matrix(i, j) = static_cast<int>(i + j * 100);
+
+  const std::string strPath = TempPath("mafs_mapped_test.bin");
+  Mafs::Save(Matrix, strPath);
+
+  {
+    auto Mapped = Mafs::MapFile<int, Mafs::MtxColMajor>(strPath);
+    REQUIRE(Mapped.RowCount() == 5);
+    REQUIRE(Mapped.ColCount() == 2);
+    REQUIRE(reinterpret_cast<uintptr_t>(Mapped.Get().Data()) % 64 == 0);
+    for (size_t i = 0; i < Matrix.RowCount(); ++i)
+      for (size_t j = 0; j < Matrix.ColCount(); ++j)
+        REQUIRE(Mapped(i, j) == Matrix(i, j));
+
+    // Mapped matrices can be used in operations.
+    auto Sum = Mafs::Internal::MtxOperation.Sum(Mapped.Get(), Matrix);
+    REQUIRE(Sum(4, 1) == 2 * Matrix(4, 1));
+
+    REQUIRE_THROWS((Mafs::MapFile<int, Mafs::MtxRowMajor>(strPath)));
+  }
+
+  std::filesystem::remove(strPath);
+}
+
+TEST_CASE("Binary memory mapped matrix with shared storage") {
+  typedef Mafs::Matrix<double, 0, 0, Mafs::MtxRowMajor | Mafs::MtxSharedStorage> SharedMatrix;
+  SharedMatrix Matrix(4, 3);
+  for (size_t i = 0; i < Matrix.RowCount(); ++i)
+    for (size_t j = 0; j < Matrix.ColCount(); ++j)
+      Matrix(i, j) = static_cast<double>(i * 3 + j);
+
+  const std::string strPath = TempPath("mafs_mapped_shared_test.bin");
+  Mafs::Save(Matrix, strPath);
+
+  // The copy owns its values: it can be written and outlives the mapping.
+  SharedMatrix Copy;
+  {
+    auto Mapped = Mafs::MapFile<double, Mafs::MtxRowMajor | Mafs::MtxSharedStorage>(strPath);
+    Copy = Mapped.Get();
+    REQUIRE(Copy.ShareCount() == 1);
+    REQUIRE(static_cast<const SharedMatrix &>(Copy).Data() != Mapped.Get().Data());
+    Copy(0, 0) = 5;
+    REQUIRE(Mapped(0, 0) == 0);
+  }
+  REQUIRE(Copy(0, 0) == 5);
+  for (size_t i = 0; i < Matrix.RowCount(); ++i)
+    for (size_t j = 0; j < Matrix.ColCount(); ++j)
+      if (i + j > 0)
+        REQUIRE(Copy(i, j) == Matrix(i, j));
+
+  // Copies of the copy share its array as usual.
+  SharedMatrix Second(Copy);
+  REQUIRE(Second.IsShared());
+  REQUIRE(Copy.ShareCount() == 2);
+
+  std::filesystem::remove(strPath);
+}
@@ -0,0 +1,167 @@
+/*********************************************************************************
+ * TextTest.cpp
+ * It has tests for the CSV and MatrixMarket readers/writers.
+ *********************************************************************************/
+
+#include <Mafs/Matrix/IO/Text.hpp>
+#include <doctest/doctest.h>
+#include <filesystem>
+#include <fstream>
+
+static std::string TempPath(const std::string &strName) {
+  return (std::filesystem::temp_directory_path() / strName).string();
+}
+
+static void WriteFile(const std::string &strPath, const std::string &strContent) {
+  std::ofstream File(strPath, std::ios::binary | std::ios::trunc);
+  File << strContent;
+}
+
+TEST_CASE("CSV round trip") {
+  Mafs::Matrix<double, 0, 0, Mafs::MtxColMajor> Matrix(4, 3);
+  for (size_t i = 0; i < Matrix.RowCount(); ++i)
+    for (size_t j = 0; j < Matrix.ColCount(); ++j)
+      Matrix(i, j) = 1.0 / static_cast<double>(i * 3 + j + 1) - 0.25;
+
+  const std::string strPath = TempPath("mafs_text_test.csv");
+  Mafs::WriteCsv(Matrix, strPath);
+
+  Mafs::MtxCsvOptions Options;
+  Options.nThreads = 4;
+  auto Read = Mafs::ReadCsv<Mafs::Matrix<double, 0, 0, Mafs::MtxRowMajor>>(strPath, Options);
+  REQUIRE(Read.RowCount() == 4);
+  REQUIRE(Read.ColCount() == 3);
+  // to_chars/from_chars round trip exactly.
+  for (size_t i = 0; i < Matrix.RowCount(); ++i)
+    for (size_t j = 0; j < Matrix.ColCount(); ++j)
+      REQUIRE(Read(i, j) == Matrix(i, j));
+
+  std::filesystem::remove(strPath);
+}
+
+TEST_CASE("CSV parsing") {
+  const std::string strPath = TempPath("mafs_text_parse.csv");
+  WriteFile(strPath, "a;b;c\r\n1; 2 ;+3\r\n-4;5;6\r\n\r\n");
+
+  Mafs::MtxCsvOptions Options;
+  Options.cDelimiter = ';';
+  Options.bHeader = true;
+  auto Read = Mafs::ReadCsv<Mafs::Matrix<int, 2, 3, Mafs::MtxRowMajor>>(strPath, Options);
+  REQUIRE(Read(0, 0) == 1);
+  REQUIRE(Read(0, 1) == 2);
+  REQUIRE(Read(0, 2) == 3);
+  REQUIRE(Read(1, 0) == -4);
+  REQUIRE(Read(1, 2) == 6);
+
+  WriteFile(strPath, "1,2,3\n4,5\n");
+  REQUIRE_THROWS(Mafs::ReadCsv<Mafs::Matrix<int, 0, 0, Mafs::MtxRowMajor>>(strPath));
+  WriteFile(strPath, "1,2,3\n4,x,6\n");
+  REQUIRE_THROWS(Mafs::ReadCsv<Mafs::Matrix<int, 0, 0, Mafs::MtxRowMajor>>(strPath));
+  WriteFile(strPath, "1,2,3,4\n");
+  REQUIRE_THROWS(Mafs::ReadCsv<Mafs::Matrix<int, 2, 3, Mafs::MtxRowMajor>>(strPath));
+
+  std::filesystem::remove(strPath);
+}
+
+TEST_CASE("CSV bool values") {
+  Mafs::Matrix<bool, 0, 0, Mafs::MtxRowMajor> Matrix(2, 3);
+  for (size_t i = 0; i < 2; ++i)
+    for (size_t j = 0; j < 3; ++j)
+      Matrix(i, j) = (i + j) % 2 == 0;
+
+  const std::string strPath = TempPath("mafs_text_bool.csv");
+  Mafs::WriteCsv(Matrix, strPath);
+  std::ifstream File(strPath, std::ios::binary);
+  std::string strLine;
+  std::getline(File, strLine);
+  CHECK(strLine == "1,0,1");
+  File.close();
+
+  auto Read = Mafs::ReadCsv<Mafs::Matrix<bool, 0, 0, Mafs::MtxColMajor>>(strPath);
+  REQUIRE(Read.RowCount() == 2);
+  REQUIRE(Read.ColCount() == 3);
+  for (size_t i = 0; i < 2; ++i)
+    for (size_t j = 0; j < 3; ++j)
+      REQUIRE(Read(i, j) == Matrix(i, j));
+
+  WriteFile(strPath, "1,0\n2,1\n");
+  REQUIRE_THROWS(Mafs::ReadCsv<Mafs::Matrix<bool, 0, 0, Mafs::MtxRowMajor>>(strPath));
+
+  std::filesystem::remove(strPath);
+}
+
+TEST_CASE("MatrixMarket round trip") {
+  Mafs::Matrix<double, 0, 0, Mafs::MtxRowMajor> Matrix(3, 5);
+  Matrix.Fill(0);
+  Matrix(0, 0) = 1.5;
+  Matrix(2, 1) = -2;
+  Matrix(1, 4) = 1e-20;
+
+  const std::string strArray = TempPath("mafs_text_array.mtx");
+  const std::string strCoordinate = TempPath("mafs_text_coordinate.mtx");
+  Mafs::WriteMatrixMarket(Matrix, strArray);
+  Mafs::WriteMatrixMarket(Matrix, strCoordinate, true);
+
+  auto Array = Mafs::ReadMatrixMarket<Mafs::Matrix<double, 0, 0, Mafs::MtxColMajor>>(strArray);
+  auto Coordinate =
+      Mafs::ReadMatrixMarket<Mafs::Matrix<double, 0, 0, Mafs::MtxRowMajor>>(strCoordinate, 2);
+  for (size_t i = 0; i < Matrix.RowCount(); ++i)
+    for (size_t j = 0; j < Matrix.ColCount(); ++j) {
+      REQUIRE(Array(i, j) == Matrix(i, j));
+      REQUIRE(Coordinate(i, j) == Matrix(i, j));
+    }
+
+  std::filesystem::remove(strArray);
+  std::filesystem::remove(strCoordinate);
+}
+
+TEST_CASE("MatrixMarket symmetric files") {
+  const std::string strPath = TempPath("mafs_text_symmetric.mtx");
+  WriteFile(strPath, "%%MatrixMarket matrix coordinate real symmetric\n"
+                     "% comment\n"
+                     "3 3 3\n"
+                     "1 1 4\n"
+                     "3 1 -1\n"
+                     "3 2 2.5\n");
+  auto Coordinate = Mafs::ReadMatrixMarket<Mafs::Matrix<double, 3, 3, Mafs::MtxRowMajor>>(strPath);
+  REQUIRE(Coordinate(0, 0) == 4);
+  REQUIRE(Coordinate(2, 0) == -1);
+  REQUIRE(Coordinate(0, 2) == -1);
+  REQUIRE(Coordinate(1, 2) == 2.5);
+  REQUIRE(Coordinate(1, 1) == 0);
+
+  // Lower triangle, column major, without the diagonal.
+  WriteFile(strPath, "%%MatrixMarket matrix array integer skew-symmetric\n"
+                     "3 3\n"
+                     "1\n2\n3\n");
+  auto Array = Mafs::ReadMatrixMarket<Mafs::Matrix<int, 0, 0, Mafs::MtxRowMajor>>(strPath);
+  REQUIRE(Array(1, 0) == 1);
+  REQUIRE(Array(0, 1) == -1);
+  REQUIRE(Array(2, 0) == 2);
+  REQUIRE(Array(2, 1) == 3);
+  REQUIRE(Array(1, 2) == -3);
+  REQUIRE(Array(2, 2) == 0);
+
+  // Fewer or more entries/values than the size line says.
+  typedef Mafs::Matrix<double, 0, 0, Mafs::MtxRowMajor> DynMatrix;
+  WriteFile(strPath, "%%MatrixMarket matrix coordinate real general\n"
+                     "3 3 3\n"
+                     "1 1 4\n"
+                     "3 1 -1\n");
+  REQUIRE_THROWS_AS(Mafs::ReadMatrixMarket<DynMatrix>(strPath), std::runtime_error);
+  WriteFile(strPath, "%%MatrixMarket matrix coordinate real general\n"
+                     "3 3 1\n"
+                     "1 1 4\n"
+                     "3 1 -1\n");
+  REQUIRE_THROWS_AS(Mafs::ReadMatrixMarket<DynMatrix>(strPath), std::runtime_error);
+  WriteFile(strPath, "%%MatrixMarket matrix array real general\n"
+                     "3 2\n"
+                     "1\n2\n3\n");
+  REQUIRE_THROWS_AS(Mafs::ReadMatrixMarket<DynMatrix>(strPath), std::runtime_error);
+  WriteFile(strPath, "%%MatrixMarket matrix array real general\n"
+                     "1 2\n"
+                     "1\n2\n3\n4\n\n");
+  REQUIRE_THROWS_AS(Mafs::ReadMatrixMarket<DynMatrix>(strPath), std::runtime_error);
+
+  std::filesystem::remove(strPath);
+}
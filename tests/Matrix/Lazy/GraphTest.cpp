@@ -0,0 +1,160 @@
+/*********************************************************************************
+ * GraphTest.cpp
+ * It has tests for the lazy expression graph (CSE, fusion and buffer reuse).
+ *********************************************************************************/
+
+#include <Mafs/Matrix/Lazy/Graph.hpp>
+#include <TestHelpers.hpp>
+#include <doctest/doctest.h>
+#include <utility>
+
+namespace {
+typedef Mafs::Matrix<double, 0, 0, Mafs::MtxRowMajor> RowMatrix;
+typedef Mafs::Matrix<double, 0, 0, Mafs::MtxColMajor> ColMatrix;
+
+template <typename lMatrixType, typename rMatrixType>
+auto Product(const lMatrixType &A, const rMatrixType &B, size_t i, size_t j) -> double {
+  double Value = 0;
+  for (size_t k = 0; k < A.ColCount(); ++k)
+    Value += A(i, k) * B(k, j);
+  return Value;
+}
+}; // namespace
+
+TEST_CASE("Lazy graph fuses products into element-wise chains") {
+  const auto A = MafsTests::RandomMatrix<double, Mafs::MtxRowMajor>(5, 7, 1);
+  const auto B = MafsTests::RandomMatrix<double, Mafs::MtxColMajor>(7, 4, 2);
+  const auto C = MafsTests::RandomMatrix<double, Mafs::MtxRowMajor>(5, 4, 3);
+
+  Mafs::Lazy::Graph<double> G;
+  auto a = G.Input(A), b = G.Input(B), c = G.Input(C);
+  auto Y = 2.0 * (a * b) + c - 0.5 * c;
+
+  Mafs::MtxLazyStats Stats;
+  const auto Result = G.Evaluate<RowMatrix>(Y, &Stats);
+  REQUIRE(Result.RowCount() == 5);
+  REQUIRE(Result.ColCount() == 4);
+  for (size_t i = 0; i < 5; ++i)
+    for (size_t j = 0; j < 4; ++j)
+      REQUIRE(Result(i, j) == doctest::Approx(2 * Product(A, B, i, j) + 0.5 * C(i, j)));
+
+  // B (col major) is copied, then one linear combination with the fused product.
+  CHECK(Stats.nSteps == 2);
+  CHECK(Stats.nFusedGemms == 1);
+  CHECK(Stats.nBuffers == 2);
+
+  // A scaled product alone is a single GEMM writing its result.
+  const auto D = MafsTests::RandomMatrix<double, Mafs::MtxRowMajor>(7, 4, 8);
+  auto d = G.Input(D);
+  const auto Scaled = G.Evaluate<RowMatrix>(-3.0 * (a * d), &Stats);
+  for (size_t i = 0; i < 5; ++i)
+    for (size_t j = 0; j < 4; ++j)
+      REQUIRE(Scaled(i, j) == doctest::Approx(-3 * Product(A, D, i, j)));
+  CHECK(Stats.nSteps == 1);
+  CHECK(Stats.nFusedGemms == 1);
+  CHECK(Stats.nBuffers == 1);
+}
+
+TEST_CASE("Lazy graph eliminates common subexpressions") {
+  const auto A = MafsTests::RandomMatrix<double, Mafs::MtxRowMajor>(6, 6, 4);
+  const auto B = MafsTests::RandomMatrix<double, Mafs::MtxRowMajor>(6, 6, 5);
+
+  Mafs::Lazy::Graph<double> G;
+  auto a = G.Input(A), b = G.Input(B);
+  const size_t nNodes = G.NodeCount();
+  auto P = a * b;
+  auto Q = G.Input(A) * G.Input(B); // Same node as P.
+  CHECK(G.NodeCount() == nNodes + 1);
+  CHECK(((a + b) * a).RowCount() == ((b + a) * a).RowCount());
+  const size_t nAfterSum = G.NodeCount();
+  auto S = (b + a) * a; // Already built as (a + b) * a.
+  CHECK(G.NodeCount() == nAfterSum);
+
+  // P is used twice: computed once, then read by the transpose and the sum.
+  auto Y = P + Q;
+  auto Z = Mafs::Lazy::Transpose(P);
+  Mafs::MtxLazyStats Stats;
+  const auto Results = G.Evaluate<ColMatrix>({Y, Z, S}, &Stats);
+  for (size_t i = 0; i < 6; ++i)
+    for (size_t j = 0; j < 6; ++j) {
+      const double Value = Product(A, B, i, j);
+      REQUIRE(Results[0](i, j) == doctest::Approx(2 * Value));
+      REQUIRE(Results[1](j, i) == doctest::Approx(Value));
+      double Sum = 0;
+      for (size_t k = 0; k < 6; ++k)
+        Sum += (A(i, k) + B(i, k)) * A(k, j);
+      REQUIRE(Results[2](i, j) == doctest::Approx(Sum));
+    }
+  CHECK(Stats.nFusedGemms == 0);
+  // P, Y, Z, a + b and S.
+  CHECK(Stats.nSteps == 5);
+}
+
+TEST_CASE("Lazy graph splits element-wise passes among threads") {
+  const auto A = MafsTests::RandomMatrix<double, Mafs::MtxRowMajor>(37, 29, 10);
+  const auto B = MafsTests::RandomMatrix<double, Mafs::MtxRowMajor>(37, 29, 11);
+  const auto C = MafsTests::RandomMatrix<double, Mafs::MtxRowMajor>(29, 29, 12);
+
+  Mafs::Lazy::Graph<double> G;
+  auto a = G.Input(A), b = G.Input(B), c = G.Input(C);
+  auto Y = 3.0 * a - b + 0.25 * (a * c);
+  const auto Serial = G.Evaluate<RowMatrix>(Y);
+  MafsTests::TuningParamsGuard Guard(MafsTests::SmallBlocks());
+  const auto Parallel = G.Evaluate<RowMatrix>(Y);
+  for (size_t i = 0; i < 37; ++i)
+    for (size_t j = 0; j < 29; ++j) {
+      REQUIRE(Serial(i, j) == doctest::Approx(3 * A(i, j) - B(i, j) + 0.25 * Product(A, C, i, j)));
+      REQUIRE(Parallel(i, j) == doctest::Approx(Serial(i, j)));
+    }
+}
+
+TEST_CASE("Lazy graph reuses freed buffers") {
+  const auto A = MafsTests::RandomMatrix<double, Mafs::MtxRowMajor>(8, 8, 6);
+  Mafs::Lazy::Graph<double> G;
+  auto a = G.Input(A);
+  // Each product only feeds the next one, so two buffers are enough for the whole chain.
+  auto Y = a;
+  for (int i = 0; i < 6; ++i)
+    Y = Mafs::Lazy::Transpose(Y * a);
+
+  Mafs::MtxLazyStats Stats;
+  const auto Result = G.Evaluate<RowMatrix>(Y, &Stats);
+  CHECK(Stats.nSteps == 12);
+  CHECK(Stats.nBuffers <= 3);
+  CHECK(Result.RowCount() == 8);
+}
+
+TEST_CASE("Lazy graph inputs sharing a storage") {
+  typedef Mafs::Matrix<double, 0, 0, Mafs::MtxRowMajor | Mafs::MtxSharedStorage> SharedMatrix;
+  SharedMatrix A =
+      MafsTests::RandomMatrix<double, Mafs::MtxRowMajor | Mafs::MtxSharedStorage>(4, 4, 9);
+  SharedMatrix B(A);
+  REQUIRE(std::as_const(A).Data() == std::as_const(B).Data());
+
+  // Copies are distinct inputs, and a write after Input is seen by Evaluate.
+  Mafs::Lazy::Graph<double> G;
+  auto a = G.Input(A), b = G.Input(B);
+  CHECK(G.NodeCount() == 2);
+  CHECK(G.Input(B).RowCount() == 4);
+  CHECK(G.NodeCount() == 2);
+  B(1, 2) = 10;
+  REQUIRE(std::as_const(A).Data() != std::as_const(B).Data());
+
+  const auto Result = G.Evaluate<RowMatrix>(a - b);
+  for (size_t i = 0; i < 4; ++i)
+    for (size_t j = 0; j < 4; ++j)
+      REQUIRE(Result(i, j) == (i == 1 && j == 2 ? std::as_const(A)(1, 2) - 10 : 0));
+}
+
+TEST_CASE("Lazy graph errors") {
+  const auto A = MafsTests::RandomMatrix<double, Mafs::MtxRowMajor>(2, 3, 7);
+  Mafs::Lazy::Graph<double> G, H;
+  auto a = G.Input(A);
+  REQUIRE_THROWS_AS(a * a, std::domain_error);
+  REQUIRE_THROWS_AS(a + Mafs::Lazy::Transpose(a), std::domain_error);
+  REQUIRE_THROWS_AS(a + H.Input(A), std::invalid_argument);
+  REQUIRE_THROWS_AS((G.Evaluate<Mafs::Matrix<double, 3, 2, Mafs::MtxRowMajor>>(a)),
+                    std::domain_error);
+  auto Static = G.Evaluate<Mafs::Matrix<double, 2, 3, Mafs::MtxColMajor>>(a);
+  CHECK(Static(1, 2) == A(1, 2));
+}
@@ -5,6 +5,20 @@
 
 #include <doctest/doctest.h>
 
+// The standard headers used by the library must be included before the access override below.
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
 #define private public
 #define protected public
 #include <Mafs/Matrix/Matrix.hpp>
@@ -57,7 +71,36 @@ TEST_CASE("Copy constructor") {
   CheckIfEquals(MtxStaticCopy, MtxStatic);
 }
 
-TEST_CASE("Operator=") {}
+TEST_CASE("Operator=") {
+  Mafs::Matrix<int, 3, 5, 1> MtxStatic, MtxStaticCopy;
+  RangeFill(MtxStatic);
+  MtxStaticCopy = MtxStatic;
+  REQUIRE(CheckIfEquals(MtxStaticCopy, MtxStatic));
+
+  // Dynamic matrices: the previous values are released and the new ones copied.
+  Mafs::Matrix<int, 0, 0, 1> MtxDyn(3, 5), MtxDynCopy(2, 2);
+  RangeFill(MtxDyn);
+  MtxDynCopy = MtxDyn;
+  REQUIRE(CheckIfEquals(MtxDynCopy, MtxDyn));
+  REQUIRE(MtxDynCopy.Data() != MtxDyn.Data());
+  MtxDynCopy(0, 0) = -1;
+  REQUIRE(MtxDyn(0, 0) == 0);
+  const Mafs::Matrix<int, 0, 0, 1> &Self = MtxDynCopy;
+  MtxDynCopy = Self;
+  REQUIRE(MtxDynCopy(0, 0) == -1);
+
+  // Moves take the array without copying it (also when a std::vector of matrices grows).
+  static_assert(std::is_nothrow_move_constructible_v<Mafs::Matrix<int, 0, 0, 1>>);
+  static_assert(std::is_nothrow_move_assignable_v<Mafs::Matrix<int, 0, 0, 1>>);
+  const int *pData = MtxDyn.Data();
+  Mafs::Matrix<int, 0, 0, 1> MtxMoved(std::move(MtxDyn));
+  REQUIRE(MtxMoved.Data() == pData);
+  REQUIRE(MtxDyn.Size() == 0);
+  MtxDynCopy = std::move(MtxMoved);
+  REQUIRE(MtxDynCopy.Data() == pData);
+  REQUIRE(MtxDynCopy(2, 4) == 14);
+  REQUIRE(MtxMoved.Size() == 0);
+}
 
 TEST_CASE("Change matrix data") {
   Mafs::Matrix<int, 0, 0, 1> MtxDyn(3, 5);
@@ -130,6 +173,160 @@ TEST_CASE("Container dynamic resize") {
   REQUIRE(Container.ColCount() == nColsIncrease);
 }
 
+TEST_CASE("Container shared storage") {
+  typedef Mafs::Internal::Container<int, Mafs::MtxDynamic, Mafs::MtxDynamic, true> Shared;
+  Shared Container(3, 4);
+  for (size_t i = 0; i < Container.Size(); ++i)
+    Container.Data()[i] = static_cast<int>(i);
+  REQUIRE(!Container.IsShared());
+
+  {
+    Shared Copy;
+    Copy.Share(Container);
+    const Shared &ReadOnly = Copy;
+    REQUIRE(Container.IsShared());
+    REQUIRE(Copy.IsShared());
+    REQUIRE(ReadOnly.Data() == static_cast<const Shared &>(Container).Data());
+    // Const access can't write to the shared array.
+    static_assert(std::is_same_v<decltype(ReadOnly[0]), const int &>);
+    REQUIRE(ReadOnly[5] == 5);
+    REQUIRE(Copy.IsShared());
+    REQUIRE(Copy.RowCount() == 3);
+    REQUIRE(Copy.ColCount() == 4);
+
+    // The first non const access copies the array, the other container keeps the old one.
+    Copy[5] = 42;
+    REQUIRE(!Copy.IsShared());
+    REQUIRE(!Container.IsShared());
+    REQUIRE(Copy[5] == 42);
+    REQUIRE(Container[5] == 5);
+    REQUIRE(Copy[6] == 6);
+  }
+
+  // The last container using the array frees it.
+  Shared *pCopy = new Shared;
+  pCopy->Share(Container);
+  Container.Resize(2, 2);
+  REQUIRE(!pCopy->IsShared());
+  REQUIRE((*pCopy)[11] == 11);
+  delete pCopy;
+}
+
+TEST_CASE("MatrixBase copy on write") {
+  typedef Mafs::Matrix<double, 0, 0, Mafs::MtxColMajor | Mafs::MtxSharedStorage> SharedMatrix;
+  SharedMatrix Matrix(4, 3);
+  for (size_t i = 0; i < 4; ++i)
+    for (size_t j = 0; j < 3; ++j)
+      Matrix(i, j) = static_cast<double>(i * 3 + j);
+
+  SharedMatrix Copy(Matrix);
+  const SharedMatrix &ReadOnly = Copy;
+  REQUIRE(Copy.IsShared());
+  REQUIRE(ReadOnly.Data() == static_cast<const SharedMatrix &>(Matrix).Data());
+  CHECK(ReadOnly(3, 2) == 11);
+  CHECK(ReadOnly.Sum() == 66);
+  CHECK(Copy.ToString() == Matrix.ToString());
+  REQUIRE(Copy.IsShared());
+
+  // Every mutating access detaches.
+  Copy.At(0, 0) = -1;
+  REQUIRE(!Copy.IsShared());
+  CHECK(Matrix(0, 0) == 0);
+  SharedMatrix Filled(Matrix);
+  Filled.Fill(7);
+  CHECK(Matrix(1, 1) == 4);
+  SharedMatrix Swapped(Matrix);
+  Swapped.SwapRows(0, 3);
+  Swapped.SwapCols(0, 2);
+  CHECK(Matrix(0, 0) == 0);
+  CHECK(Swapped(0, 0) == 11);
+  SharedMatrix Applied(Matrix);
+  Applied.Apply([](double x) { return -x; });
+  CHECK(Matrix(2, 2) == 8);
+  CHECK(Applied(2, 2) == -8);
+  REQUIRE(!Matrix.IsShared());
+
+  // Results written in place into a shared matrix.
+  SharedMatrix Product(Matrix), Right(3, 3);
+  Right.Fill(1);
+  SharedMatrix Left(Matrix);
+  Mafs::Internal::MtxOperation.Multiplication(Left, Mafs::MtxNoTrans, Right, Mafs::MtxNoTrans,
+                                              Product, 1.0, 0.0, Mafs::MtxEpilogue<double>());
+  CHECK(Product(1, 0) == 12);
+  CHECK(Matrix(1, 0) == 3);
+  CHECK(Left(1, 0) == 3);
+
+  // Static matrices ignore the option.
+  Mafs::Matrix<int, 2, 2, Mafs::MtxSharedStorage> Static;
+  Static.Fill(1);
+  Mafs::Matrix<int, 2, 2, Mafs::MtxSharedStorage> StaticCopy(Static);
+  REQUIRE(!StaticCopy.IsShared());
+  StaticCopy(0, 0) = 2;
+  CHECK(Static(0, 0) == 1);
+}
+
+TEST_CASE("MatrixBase shared assignment") {
+  typedef Mafs::Matrix<double, 0, 0, Mafs::MtxRowMajor | Mafs::MtxSharedStorage> SharedMatrix;
+  SharedMatrix Matrix(2, 2);
+  Matrix.Fill(3);
+  REQUIRE(Matrix.ShareCount() == 1);
+  {
+    SharedMatrix Assigned(2, 2);
+    Assigned = Matrix;
+    REQUIRE(Matrix.ShareCount() == 2);
+    REQUIRE(Assigned.ShareCount() == 2);
+    Assigned = Matrix;
+    const SharedMatrix &Self = Assigned;
+    Assigned = Self;
+    REQUIRE(Matrix.ShareCount() == 2);
+    CHECK(Self(1, 1) == 3);
+
+    // A move transfers the reference.
+    SharedMatrix Moved(std::move(Assigned));
+    REQUIRE(Matrix.ShareCount() == 2);
+    REQUIRE(Assigned.ShareCount() == 0);
+    SharedMatrix Other(3, 3);
+    Other = std::move(Moved);
+    REQUIRE(Matrix.ShareCount() == 2);
+    Other(0, 0) = 1;
+    REQUIRE(Matrix.ShareCount() == 1);
+    CHECK(Matrix(0, 0) == 3);
+    Other = Matrix;
+  }
+  REQUIRE(Matrix.ShareCount() == 1);
+
+  // Vectors of matrices move them when they grow.
+  std::vector<SharedMatrix> Matrices;
+  for (size_t i = 0; i < 8; ++i)
+    Matrices.push_back(Matrix);
+  REQUIRE(Matrix.ShareCount() == 9);
+  Matrices.clear();
+  REQUIRE(Matrix.ShareCount() == 1);
+}
+
+TEST_CASE("MatrixBase copy on write across threads") {
+  typedef Mafs::Matrix<int, 0, 0, Mafs::MtxSharedStorage> SharedMatrix;
+  SharedMatrix Matrix(64, 64);
+  Matrix.Fill(1);
+  std::atomic<int> nErrors(0);
+  std::vector<std::thread> Threads;
+  for (int t = 0; t < 4; ++t)
+    Threads.emplace_back([&Matrix, &nErrors, t]() {
+      for (int i = 0; i < 200; ++i) {
+        SharedMatrix Copy(Matrix);
+        if (i % 2 == 0)
+          Copy(0, 0) = t;
+        if (static_cast<const SharedMatrix &>(Copy)(10, 10) != 1 ||
+            static_cast<const SharedMatrix &>(Matrix)(0, 0) != 1)
+          nErrors++;
+      }
+    });
+  for (std::thread &Thread : Threads)
+    Thread.join();
+  CHECK(nErrors == 0);
+  CHECK(!Matrix.IsShared());
+}
+
 TEST_CASE("MatrixBase options") {
   Mafs::Matrix<int, 1, 1, Mafs::MtxRowMajor> MtxRow;
   Mafs::Matrix<int, 1, 1, Mafs::MtxColMajor> MtxCol;
@@ -383,3 +580,164 @@ TEST_CASE("MatrixBase col swap (col major)") {
   REQUIRE(Matrix(1, 4) == 1);
   REQUIRE(Matrix(2, 4) == 2);
 }
+
+// Matrix[i][j] = i * 100 + j.
+template <typename MatrixType> void IndexFill(MatrixType &Matrix) {
+  for (size_t i = 0; i < Matrix.RowCount(); ++i)
+    for (size_t j = 0; j < Matrix.ColCount(); ++j)
+      Matrix(i, j) = static_cast<int>(i * 100 + j);
+}
+
+template <size_t Options_> void CheckInsertRemove() {
+  Mafs::Matrix<int, 0, 0, Options_> Matrix(3, 4);
+  IndexFill(Matrix);
+
+  Matrix.InsertRows(1, 2, -1);
+  REQUIRE(Matrix.RowCount() == 5);
+  REQUIRE(Matrix.ColCount() == 4);
+  CHECK(Matrix(0, 3) == 3);
+  CHECK(Matrix(1, 0) == -1);
+  CHECK(Matrix(2, 3) == -1);
+  CHECK(Matrix(3, 2) == 102);
+  CHECK(Matrix(4, 3) == 203);
+
+  Matrix.InsertCols(4, 1, 7);
+  Matrix.InsertCols(0, 2);
+  REQUIRE(Matrix.ColCount() == 7);
+  CHECK(Matrix(0, 0) == 0);
+  CHECK(Matrix(0, 2) == 0);
+  CHECK(Matrix(0, 5) == 3);
+  CHECK(Matrix(0, 6) == 7);
+  CHECK(Matrix(4, 4) == 202);
+
+  Matrix.RemoveRows(1, 2);
+  Matrix.RemoveCols(0, 2);
+  Matrix.RemoveCols(4);
+  Mafs::Matrix<int, 0, 0, Options_> Expected(3, 4);
+  IndexFill(Expected);
+  REQUIRE(CheckIfEquals(Matrix, Expected));
+
+  REQUIRE_THROWS_AS(Matrix.InsertRows(4, 1), std::out_of_range);
+  REQUIRE_THROWS_AS(Matrix.InsertCols(5, 1), std::out_of_range);
+  REQUIRE_THROWS_AS(Matrix.RemoveRows(2, 2), std::out_of_range);
+  REQUIRE_THROWS_AS(Matrix.RemoveCols(4), std::out_of_range);
+
+  // Rows/cols of another matrix, any storage order.
+  Mafs::Matrix<int, 0, 0, Mafs::MtxColMajor> Other(2, 4);
+  Other.Fill(9);
+  Matrix.InsertRows(1, Other);
+  CHECK(Matrix.RowCount() == 5);
+  CHECK(Matrix(1, 3) == 9);
+  CHECK(Matrix(3, 0) == 100);
+  Matrix.AppendCols(Matrix);
+  REQUIRE(Matrix.ColCount() == 8);
+  CHECK(Matrix(4, 7) == 203);
+  CHECK(Matrix(2, 5) == 9);
+  REQUIRE_THROWS_AS(Matrix.AppendRows(Other), std::domain_error);
+}
+
+TEST_CASE("MatrixBase insert and remove rows/cols") {
+  CheckInsertRemove<Mafs::MtxRowMajor>();
+  CheckInsertRemove<Mafs::MtxColMajor>();
+  CheckInsertRemove<Mafs::MtxColMajor | Mafs::MtxSharedStorage>();
+}
+
+TEST_CASE("MatrixBase append rows with amortized capacity") {
+  Mafs::Matrix<double, 0, 0, Mafs::MtxRowMajor> Samples;
+  Mafs::Matrix<double, 1, 8, Mafs::MtxRowMajor> Sample;
+  size_t nReallocations = 0;
+  const double *pData = nullptr;
+  for (size_t i = 0; i < 1000; ++i) {
+    Sample.Fill(static_cast<double>(i));
+    Samples.AppendRows(Sample);
+    if (Samples.Data() != pData) {
+      pData = Samples.Data();
+      nReallocations++;
+    }
+  }
+  REQUIRE(Samples.RowCount() == 1000);
+  REQUIRE(Samples.ColCount() == 8);
+  CHECK(nReallocations <= 12);
+  CHECK(Samples.Capacity() >= Samples.Size());
+  for (size_t i = 0; i < 1000; i += 111)
+    CHECK(Samples(i, 7) == static_cast<double>(i));
+  Samples.ShrinkToFit();
+  CHECK(Samples.Capacity() == Samples.Size());
+  CHECK(Samples(999, 0) == 999);
+
+  // Reserved matrices are never reallocated.
+  Mafs::Matrix<double, 0, 0, Mafs::MtxColMajor> Cols(16, 0);
+  Cols.Reserve(16 * 100);
+  pData = Cols.Data();
+  for (size_t j = 0; j < 100; ++j)
+    Cols.InsertCols(j, 1, static_cast<double>(j));
+  CHECK(Cols.Data() == pData);
+  CHECK(Cols(15, 99) == 99);
+
+  // The other dimension of an empty matrix comes from the first rows.
+  Mafs::Matrix<int, 0, 0, Mafs::MtxColMajor> Empty;
+  Mafs::Matrix<int, 2, 3, Mafs::MtxRowMajor> Block;
+  IndexFill(Block);
+  Empty.AppendRows(Block);
+  Empty.AppendRows(Block);
+  REQUIRE(Empty.RowCount() == 4);
+  REQUIRE(Empty.ColCount() == 3);
+  CHECK(Empty(3, 2) == 102);
+}
+
+TEST_CASE("MatrixBase reshape and conservative resize") {
+  Mafs::Matrix<int, 0, 0, Mafs::MtxRowMajor> Matrix(2, 6);
+  IndexFill(Matrix);
+  const int *pData = Matrix.Data();
+  Matrix.Reshape(3, 4);
+  CHECK(Matrix.Data() == pData);
+  CHECK(Matrix(1, 0) == 4);
+  CHECK(Matrix(2, 3) == 105);
+  REQUIRE_THROWS_AS(Matrix.Reshape(5, 2), std::domain_error);
+  Matrix.Reshape(2, 6);
+
+  for (const bool bColMajor : {false, true}) {
+    Mafs::Matrix<int, 0, 0, Mafs::MtxRowMajor> Row(3, 4);
+    Mafs::Matrix<int, 0, 0, Mafs::MtxColMajor> Col(3, 4);
+    IndexFill(Row);
+    IndexFill(Col);
+    auto Check = [](const auto &Resized, size_t nRows, size_t nCols) {
+      REQUIRE(Resized.RowCount() == nRows);
+      REQUIRE(Resized.ColCount() == nCols);
+      for (size_t i = 0; i < nRows; ++i)
+        for (size_t j = 0; j < nCols; ++j)
+          CHECK(Resized(i, j) == (i < 3 && j < 4 ? static_cast<int>(i * 100 + j) : -5));
+    };
+    for (const auto &Dims : {std::pair<size_t, size_t>{5, 6}, {2, 7}, {6, 2}, {1, 1}}) {
+      if (bColMajor) {
+        auto Resized = Col;
+        Resized.ConservativeResize(Dims.first, Dims.second, -5);
+        Check(Resized, Dims.first, Dims.second);
+      } else {
+        auto Resized = Row;
+        Resized.ConservativeResize(Dims.first, Dims.second, -5);
+        Check(Resized, Dims.first, Dims.second);
+      }
+    }
+  }
+
+  // A shared copy is detached before being changed.
+  Mafs::Matrix<int, 0, 0, Mafs::MtxSharedStorage> Shared(2, 2);
+  IndexFill(Shared);
+  Mafs::Matrix<int, 0, 0, Mafs::MtxSharedStorage> Copy(Shared);
+  Copy.ConservativeResize(3, 3, 1);
+  Copy.Reshape(1, 9);
+  CHECK(Shared.RowCount() == 2);
+  CHECK(Shared(1, 1) == 101);
+  CHECK(Copy(0, 8) == 1);
+}
+
+TEST_CASE("MatrixBase to string") {
+  Mafs::Matrix<int, 2, 3, Mafs::MtxColMajor> Matrix;
+  RangeFill(Matrix);
+
+  REQUIRE(Matrix.ToString() == fmt::format("Matrix<{}>[2][3] // ColMajor, Static\n"
+                                           "0 2 4 \n"
+                                           "1 3 5 \n\n",
+                                           typeid(int).name()));
+}
@@ -0,0 +1,133 @@
+/*********************************************************************************
+ * MatrixGenerateTest.cpp
+ * It has tests for the initialization kernels and the MatrixBase factories.
+ *********************************************************************************/
+
+#include <Mafs/Matrix/Matrix.hpp>
+#include <TestHelpers.hpp>
+#include <cmath>
+#include <doctest/doctest.h>
+#include <vector>
+
+namespace {
+auto ParallelParams(size_t nThreads) -> Mafs::MtxTuningParams {
+  Mafs::MtxTuningParams Params;
+  Params.nParallelThreshold = 0;
+  Params.nThreads = nThreads;
+  return Params;
+}
+
+template <typename T> auto Values(const T &Matrix) -> std::vector<double> {
+  return std::vector<double>(Matrix.Data(), Matrix.Data() + Matrix.Size());
+}
+}; // namespace
+
+TEST_CASE("Philox4x32-10 known answers") {
+  using Mafs::Internal::Kernels::Philox4x32;
+  // Random123 known answer tests.
+  const uint32_t ZeroCounter[4] = {0, 0, 0, 0}, ZeroKey[2] = {0, 0};
+  uint32_t Result[4];
+  Philox4x32(ZeroCounter, ZeroKey, Result);
+  CHECK(Result[0] == 0x6627e8d5);
+  CHECK(Result[1] == 0xe169c58d);
+  CHECK(Result[2] == 0xbc57ac4c);
+  CHECK(Result[3] == 0x9b00dbd8);
+  const uint32_t OnesCounter[4] = {~0u, ~0u, ~0u, ~0u}, OnesKey[2] = {~0u, ~0u};
+  Philox4x32(OnesCounter, OnesKey, Result);
+  CHECK(Result[0] == 0x408f276d);
+  CHECK(Result[1] == 0x41c83b0e);
+  CHECK(Result[2] == 0xa20bc7c6);
+  CHECK(Result[3] == 0x6d5451fd);
+}
+
+TEST_CASE("Random values are independent of the thread count") {
+  typedef Mafs::Matrix<double, 0, 0, Mafs::MtxRowMajor> RowMatrix;
+  // Odd sizes so the chunks split the pairs of values of a block.
+  const auto Uniform = RowMatrix::Random(37, 29, -2.0, 3.0, 11);
+  const auto Normal = RowMatrix::RandomNormal(37, 29, 1.0, 0.5, 11);
+  const auto Sequence = RowMatrix::LinSpace(37, 29, -1.0, 1.0);
+  {
+    MafsTests::TuningParamsGuard Guard;
+    for (const size_t nThreads : {2, 3, 7}) {
+      Guard.Set(ParallelParams(nThreads));
+      CHECK(Values(RowMatrix::Random(37, 29, -2.0, 3.0, 11)) == Values(Uniform));
+      CHECK(Values(RowMatrix::RandomNormal(37, 29, 1.0, 0.5, 11)) == Values(Normal));
+      CHECK(Values(RowMatrix::LinSpace(37, 29, -1.0, 1.0)) == Values(Sequence));
+      RowMatrix Zeros = RowMatrix::Constant(37, 29, 4.0);
+      Zeros.SetZero();
+      CHECK(Zeros.Max() == 0.0);
+      CHECK(Zeros.Min() == 0.0);
+    }
+  }
+
+  // Another seed gives other values, the same seed the same ones in place.
+  CHECK(Values(RowMatrix::Random(37, 29, -2.0, 3.0, 12)) != Values(Uniform));
+  RowMatrix Again(37, 29);
+  Again.SetRandom(-2.0, 3.0, 11);
+  CHECK(Values(Again) == Values(Uniform));
+}
+
+TEST_CASE("Random value distributions") {
+  typedef Mafs::Matrix<double, 0, 0, Mafs::MtxColMajor> ColMatrix;
+  const auto Uniform = ColMatrix::Random(400, 500, -1.0, 3.0, 5);
+  CHECK(Uniform.Min() >= -1.0);
+  CHECK(Uniform.Max() < 3.0);
+  CHECK(Uniform.Mean() == doctest::Approx(1.0).epsilon(0.01));
+
+  const auto Normal = ColMatrix::RandomNormal(400, 500, 2.0, 3.0, 5);
+  const double Mean = Normal.Mean();
+  double Variance = 0;
+  for (size_t i = 0; i < Normal.Size(); ++i)
+    Variance += (Normal.Data()[i] - Mean) * (Normal.Data()[i] - Mean);
+  Variance /= static_cast<double>(Normal.Size());
+  CHECK(Mean == doctest::Approx(2.0).epsilon(0.01));
+  CHECK(Variance == doctest::Approx(9.0).epsilon(0.01));
+
+  const auto Floats = Mafs::Matrix<float, 0, 0, Mafs::MtxRowMajor>::Random(100, 100, 0.f, 1.f);
+  CHECK(Floats.Min() >= 0.f);
+  CHECK(Floats.Max() < 1.f);
+
+  // Integers cover [Low, High] with both bounds.
+  const auto Dice = Mafs::Matrix<int, 0, 0, Mafs::MtxRowMajor>::Random(60, 100, 1, 6, 3);
+  std::vector<size_t> Counts(7, 0);
+  for (size_t i = 0; i < Dice.Size(); ++i)
+    ++Counts[static_cast<size_t>(Dice.Data()[i])];
+  CHECK(Counts[0] == 0);
+  for (size_t k = 1; k <= 6; ++k)
+    CHECK(Counts[k] == doctest::Approx(1000).epsilon(0.1));
+}
+
+TEST_CASE("Constant, zero, identity and linspace factories") {
+  const auto Zero = Mafs::Matrix<double, 0, 0, Mafs::MtxRowMajor>::Zero(300, 200);
+  CHECK(Zero.RowCount() == 300);
+  CHECK(Zero.ColCount() == 200);
+  CHECK(Zero.Norm1() == 0.0);
+
+  const auto Constant = Mafs::Matrix<float, 3, 4, Mafs::MtxColMajor>::Constant(3, 4, 2.5f);
+  CHECK(Constant.Sum() == 30.f);
+  REQUIRE_THROWS_AS((Mafs::Matrix<float, 3, 4, Mafs::MtxColMajor>::Zero(4, 3)), std::domain_error);
+
+  const auto Identity = Mafs::Matrix<double, 0, 0, Mafs::MtxColMajor>::Identity(4, 6);
+  for (size_t i = 0; i < 4; ++i)
+    for (size_t j = 0; j < 6; ++j)
+      CHECK(Identity(i, j) == (i == j ? 1.0 : 0.0));
+  auto Square = Mafs::Matrix<int, 5, 5, Mafs::MtxRowMajor>::Identity(5, 5);
+  CHECK(Square.Trace() == 5);
+  CHECK(Square.Sum() == 5);
+  Square.Fill(3);
+  Square.SetIdentity();
+  CHECK(Square.Sum() == 5);
+
+  // Row order for both storage orders, the bounds are exact.
+  const auto Row = Mafs::Matrix<double, 0, 0, Mafs::MtxRowMajor>::LinSpace(3, 7, 0.0, 2.0);
+  const auto Col = Mafs::Matrix<double, 0, 0, Mafs::MtxColMajor>::LinSpace(3, 7, 0.0, 2.0);
+  for (size_t i = 0; i < 3; ++i)
+    for (size_t j = 0; j < 7; ++j) {
+      CHECK(Row(i, j) == doctest::Approx(0.1 * static_cast<double>(i * 7 + j)));
+      CHECK(Col(i, j) == Row(i, j));
+    }
+  CHECK(Row(0, 0) == 0.0);
+  CHECK(Row(2, 6) == 2.0);
+  CHECK(Mafs::Matrix<double, 0, 0, Mafs::MtxRowMajor>::LinSpace(1, 1, 4.0, 9.0)(0, 0) == 4.0);
+  CHECK(Mafs::Matrix<double, 0, 0, Mafs::MtxRowMajor>::Zero(0, 0).Size() == 0);
+}
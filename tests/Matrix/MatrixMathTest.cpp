@@ -0,0 +1,202 @@
+/*********************************************************************************
+ * MatrixMathTest.cpp
+ * It has tests for the element-wise math kernels and MatrixBase::Apply/Map.
+ *********************************************************************************/
+
+#include <Mafs/Matrix/Matrix.hpp>
+#include <TestHelpers.hpp>
+#include <bit>
+#include <cmath>
+#include <doctest/doctest.h>
+#include <limits>
+#include <random>
+
+namespace {
+// Distance in ULPs between Value and the exact Expected (computed in long double).
+template <typename T> auto UlpError(T Value, long double Expected) -> double {
+  const T Rounded = static_cast<T>(Expected);
+  if (std::isinf(Rounded))
+    return Value == Rounded ? 0 : std::numeric_limits<double>::infinity();
+  T Ulp = std::nextafter(std::abs(Rounded), std::numeric_limits<T>::infinity()) -
+          std::abs(Rounded);
+  if (Rounded == T(0))
+    Ulp = std::numeric_limits<T>::denorm_min();
+  return static_cast<double>(fabsl(static_cast<long double>(Value) - Expected) / Ulp);
+}
+
+// Samples the whole domain: Exp up to the overflow and down to the subnormal results, Log over
+// every positive finite bit pattern (subnormals included).
+template <typename T> void CheckAccuracy(double MaxExp, double MaxLog, double MaxTanh) {
+  using namespace Mafs::Internal::Kernels;
+  typedef typename MathTraits<T>::Bits Bits;
+  std::mt19937_64 Generator(7);
+  const T Overflow = std::log(std::numeric_limits<T>::max());
+  const T Underflow = std::log(std::numeric_limits<T>::min());
+  std::uniform_real_distribution<T> Wide(MathTraits<T>::ExpLow, Overflow), Narrow(T(-2), T(2));
+  std::uniform_real_distribution<T> Subnormal(MathTraits<T>::ExpLow, Underflow);
+  double ExpError = 0, LogError = 0, TanhError = 0, SigmoidError = 0;
+  for (size_t i = 0; i < 30000; ++i) {
+    const T x = i % 3 == 0   ? Wide(Generator)
+                : i % 3 == 1 ? Narrow(Generator)
+                             : Subnormal(Generator);
+    const long double X = x;
+    ExpError = std::max(ExpError, UlpError(Exp(x), expl(X)));
+    TanhError = std::max(TanhError, UlpError(Tanh(x), tanhl(X)));
+    SigmoidError = std::max(SigmoidError, UlpError(Sigmoid(x), 1.0L / (1.0L + expl(-X))));
+    const T Positive = std::bit_cast<T>(static_cast<Bits>(Generator() >> 1) &
+                                        std::bit_cast<Bits>(std::numeric_limits<T>::max()));
+    if (Positive > T(0))
+      LogError = std::max(LogError, UlpError(Log(Positive), logl(Positive)));
+  }
+  CHECK(ExpError <= MaxExp);
+  CHECK(LogError <= MaxLog);
+  CHECK(TanhError <= MaxTanh);
+  CHECK(SigmoidError <= MaxTanh);
+
+  // Edges of the ranges.
+  const T Max = std::numeric_limits<T>::max(), Min = std::numeric_limits<T>::min();
+  const T Tiny = std::numeric_limits<T>::denorm_min();
+  for (const T Edge : {Overflow, std::nextafter(Overflow, Max), Underflow,
+                       std::log(Tiny), std::nextafter(std::log(Tiny), -Max)}) {
+    CHECK(UlpError(Exp(Edge), expl(Edge)) <= MaxExp);
+    CHECK(UlpError(Sigmoid(Edge), 1.0L / (1.0L + expl(-static_cast<long double>(Edge)))) <=
+          MaxTanh);
+  }
+  for (const T Edge : {Max, Min, std::nextafter(Min, T(0)), Tiny, T(1), std::nextafter(T(1), Max)})
+    CHECK(UlpError(Log(Edge), logl(Edge)) <= MaxLog);
+}
+
+template <typename T> void CheckSpecialValues() {
+  using namespace Mafs::Internal::Kernels;
+  const T Inf = std::numeric_limits<T>::infinity();
+  const T NaN = std::numeric_limits<T>::quiet_NaN();
+  CHECK(Exp(T(0)) == T(1));
+  CHECK(Exp(T(1000)) == Inf);
+  CHECK(Exp(-Inf) == T(0));
+  CHECK(Exp(T(-1000)) == T(0));
+  CHECK(std::isnan(Exp(NaN)));
+  CHECK(Exp(std::log(std::numeric_limits<T>::denorm_min())) > T(0)); // Subnormal result.
+  CHECK(Log(T(1)) == T(0));
+  CHECK(Log(T(0)) == -Inf);
+  CHECK(Log(Inf) == Inf);
+  CHECK(std::isnan(Log(T(-1))));
+  CHECK(std::isnan(Log(NaN)));
+  CHECK(Log(std::numeric_limits<T>::denorm_min()) ==
+        doctest::Approx(std::log(std::numeric_limits<T>::denorm_min())));
+  CHECK(Tanh(T(0)) == T(0));
+  CHECK(Tanh(T(50)) == T(1));
+  CHECK(Tanh(-Inf) == T(-1));
+  CHECK(Tanh(Inf) == T(1));
+  CHECK(std::isnan(Tanh(NaN)));
+  CHECK(std::signbit(Tanh(T(-0.0))));
+  CHECK(Tanh(std::numeric_limits<T>::denorm_min()) == std::numeric_limits<T>::denorm_min());
+  CHECK(Sigmoid(T(0)) == T(0.5));
+  CHECK(Sigmoid(-Inf) == T(0));
+  CHECK(Sigmoid(Inf) == T(1));
+  CHECK(Sigmoid(T(-1000)) == T(0));
+  CHECK(std::isnan(Sigmoid(NaN)));
+  CHECK(Pow(T(2), T(10)) == doctest::Approx(1024));
+  CHECK(Pow(T(0), T(0)) == T(1));
+  CHECK(Pow(NaN, T(0)) == T(1));
+  CHECK(Pow(T(0), T(2)) == T(0));
+  CHECK(std::isnan(Pow(NaN, T(1))));
+  CHECK(Pow(T(2), -Inf) == T(0));
+  CHECK(Pow(T(2), Inf) == Inf);
+  CHECK(Pow(T(0.5), Inf) == T(0));
+  CHECK(Pow(T(2), T(std::numeric_limits<T>::min_exponent - std::numeric_limits<T>::digits)) ==
+        std::numeric_limits<T>::denorm_min());
+  // Negative bases, as std::pow.
+  CHECK(Pow(T(-2), T(2)) == doctest::Approx(4));
+  CHECK(Pow(T(-2), T(3)) == doctest::Approx(-8));
+  CHECK(Pow(T(-2), T(-3)) == doctest::Approx(-0.125));
+  CHECK(std::isnan(Pow(T(-2), T(0.5))));
+  CHECK(std::isnan(Pow(T(-2), T(-2.5))));
+  CHECK(Pow(T(-1), Inf) == T(1));
+  CHECK(Pow(T(-1), T(1e30)) == T(1));
+  CHECK(Pow(-Inf, T(3)) == -Inf);
+  CHECK(Pow(-Inf, T(2)) == Inf);
+  CHECK(Pow(T(-0.0), T(-3)) == -Inf);
+  CHECK(Pow(T(-0.0), T(-2)) == Inf);
+  CHECK(std::signbit(Pow(T(-0.0), T(3))));
+  CHECK(std::signbit(Pow(-Inf, T(-3))));
+}
+}; // namespace
+
+TEST_CASE("Math kernels accuracy") {
+  CheckAccuracy<double>(1.5, 1, 3.5);
+  CheckAccuracy<float>(1.5, 1, 3.5);
+
+  std::mt19937_64 Generator(3);
+  std::uniform_real_distribution<double> Base(0, 10), Exponent(-3, 3);
+  for (size_t i = 0; i < 1000; ++i) {
+    const double x = Base(Generator), y = Exponent(Generator);
+    CHECK(Mafs::Internal::Kernels::Pow(x, y) == doctest::Approx(std::pow(x, y)).epsilon(1e-14));
+    const float a = static_cast<float>(x), b = static_cast<float>(y);
+    CHECK(UlpError(Mafs::Internal::Kernels::Pow(a, b), powl(a, b)) <= 0.5 + 1e-3);
+    const double k = static_cast<double>(static_cast<int>(Generator() % 11) - 5);
+    CHECK(Mafs::Internal::Kernels::Pow(-x, k) == doctest::Approx(std::pow(-x, k)).epsilon(1e-14));
+  }
+}
+
+TEST_CASE("Math kernels special values") {
+  CheckSpecialValues<double>();
+  CheckSpecialValues<float>();
+}
+
+TEST_CASE("Apply and Map") {
+  {
+    MafsTests::TuningParamsGuard Guard;
+    for (const bool bParallel : {false, true}) {
+      if (bParallel) {
+        Mafs::MtxTuningParams Params;
+        Params.nTransposeBlock = 3;
+        Params.nParallelThreshold = 0;
+        Params.nThreads = 3;
+        Guard.Set(Params);
+      }
+      Mafs::Matrix<double, 0, 0, Mafs::MtxRowMajor> A(4, 5);
+      Mafs::Matrix<double, 4, 5, Mafs::MtxColMajor> B;
+      for (size_t i = 0; i < 4; ++i)
+        for (size_t j = 0; j < 5; ++j) {
+          A(i, j) = 0.25 * static_cast<double>(i) - 0.5 * static_cast<double>(j);
+          B(i, j) = static_cast<double>(i + j) / 3.0;
+        }
+
+      const auto Sigmoid = A.Map(Mafs::MtxSigmoid{});
+      const auto Squares = A.Map([](double x) { return x * x; });
+      const auto Powers = B.Map(Mafs::MtxPow{2.5});
+      // Row major A with col major B: B is transposed before the loop.
+      const auto Products = A.Map(B, [](double x, double y) { return x * y; });
+      auto C = B;
+      C.Apply(A, Mafs::MtxPow{}).Apply(Mafs::MtxSqrt{});
+      for (size_t i = 0; i < 4; ++i)
+        for (size_t j = 0; j < 5; ++j) {
+          CHECK(Sigmoid(i, j) == doctest::Approx(1.0 / (1.0 + std::exp(-A(i, j)))));
+          CHECK(Squares(i, j) == doctest::Approx(A(i, j) * A(i, j)));
+          CHECK(Powers(i, j) == doctest::Approx(std::pow(B(i, j), 2.5)));
+          CHECK(Products(i, j) == doctest::Approx(A(i, j) * B(i, j)));
+          if (B(i, j) > 0)
+            CHECK(C(i, j) == doctest::Approx(std::sqrt(std::pow(B(i, j), A(i, j)))));
+        }
+
+      A.Apply(Mafs::MtxExp{}).Apply(Mafs::MtxLog{});
+      for (size_t i = 0; i < 4; ++i)
+        for (size_t j = 0; j < 5; ++j)
+          CHECK(A(i, j) == doctest::Approx(0.25 * static_cast<double>(i) -
+                                           0.5 * static_cast<double>(j)));
+
+      Mafs::Matrix<double, 0, 0, Mafs::MtxRowMajor> Wrong(5, 4);
+      REQUIRE_THROWS_AS(A.Apply(Wrong, Mafs::MtxPow{}), std::domain_error);
+    }
+  }
+
+  Mafs::Matrix<int, 2, 2, Mafs::MtxRowMajor> Integers;
+  Integers.Fill(9);
+  Integers.Apply(Mafs::MtxSqrt{});
+  CHECK(Integers(1, 1) == 3);
+
+  Mafs::Matrix<float, 0, 0, Mafs::MtxRowMajor> Activations(3, 3);
+  Activations.Fill(-1.0f);
+  Activations.Apply(Mafs::MtxTanh{});
+  CHECK(Activations(2, 2) == doctest::Approx(std::tanh(-1.0f)));
+}
@@ -0,0 +1,193 @@
+/*********************************************************************************
+ * MatrixReduceTest.cpp
+ * It has tests for the reductions and norms of MatrixBase.
+ *********************************************************************************/
+
+#include <Mafs/Matrix/Matrix.hpp>
+#include <TestHelpers.hpp>
+#include <cmath>
+#include <doctest/doctest.h>
+#include <limits>
+#include <vector>
+
+namespace {
+// Small parallel threshold, so the multithreaded paths run too (with MAFS_ENABLE_THREADS).
+auto ParallelParams() -> Mafs::MtxTuningParams {
+  Mafs::MtxTuningParams Params;
+  Params.nTransposeBlock = 3;
+  Params.nParallelThreshold = 0;
+  Params.nThreads = 3;
+  return Params;
+}
+
+template <typename MatrixType> void CheckReductions(MatrixType &Matrix) {
+  // Matrix[i][j] = i - 2j, a 5 x 7 matrix.
+  for (size_t i = 0; i < 5; ++i)
+    for (size_t j = 0; j < 7; ++j)
+      Matrix(i, j) = static_cast<double>(i) - 2.0 * static_cast<double>(j);
+
+  CHECK(Matrix.Sum() == doctest::Approx(7 * 10 - 2 * 5 * 21));
+  CHECK(Matrix.Sum(Mafs::MtxSumKahan) == doctest::Approx(Matrix.Sum()));
+  CHECK(Matrix.Sum(Mafs::MtxSumPairwise) == doctest::Approx(Matrix.Sum()));
+  CHECK(Matrix.Mean() == doctest::Approx(Matrix.Sum() / 35));
+
+  size_t nRow = 99, nCol = 99;
+  CHECK(Matrix.Min(&nRow, &nCol) == -12);
+  CHECK(nRow == 0);
+  CHECK(nCol == 6);
+  CHECK(Matrix.Max(&nRow, &nCol) == 4);
+  CHECK(nRow == 4);
+  CHECK(nCol == 0);
+
+  double SumSquares = 0, Norm1 = 0, NormInf = 0;
+  for (size_t j = 0; j < 7; ++j) {
+    double ColSum = 0;
+    for (size_t i = 0; i < 5; ++i) {
+      SumSquares += Matrix(i, j) * Matrix(i, j);
+      ColSum += std::abs(Matrix(i, j));
+    }
+    Norm1 = std::max(Norm1, ColSum);
+  }
+  for (size_t i = 0; i < 5; ++i) {
+    double RowSum = 0;
+    for (size_t j = 0; j < 7; ++j)
+      RowSum += std::abs(Matrix(i, j));
+    NormInf = std::max(NormInf, RowSum);
+  }
+  CHECK(Matrix.Dot(Matrix) == doctest::Approx(SumSquares));
+  CHECK(Matrix.Norm() == doctest::Approx(std::sqrt(SumSquares)));
+  CHECK(Matrix.Norm1() == doctest::Approx(Norm1));
+  CHECK(Matrix.NormInf() == doctest::Approx(NormInf));
+
+  const auto RowSums = Matrix.RowReduce(Mafs::MtxReduceSum);
+  const auto RowMax = Matrix.RowReduce(Mafs::MtxReduceMax);
+  const auto ColMeans = Matrix.ColReduce(Mafs::MtxReduceMean, Mafs::MtxSumKahan);
+  const auto ColMin = Matrix.ColReduce(Mafs::MtxReduceMin);
+  const auto ColNorms = Matrix.ColReduce(Mafs::MtxReduceNorm);
+  REQUIRE(RowSums.size() == 5);
+  REQUIRE(ColMeans.size() == 7);
+  for (size_t i = 0; i < 5; ++i) {
+    CHECK(RowSums[i] == doctest::Approx(7.0 * static_cast<double>(i) - 42));
+    CHECK(RowMax[i] == static_cast<double>(i));
+  }
+  for (size_t j = 0; j < 7; ++j) {
+    CHECK(ColMeans[j] == doctest::Approx(2.0 - 2.0 * static_cast<double>(j)));
+    CHECK(ColMin[j] == -2.0 * static_cast<double>(j));
+    double Squares = 0;
+    for (size_t i = 0; i < 5; ++i)
+      Squares += Matrix(i, j) * Matrix(i, j);
+    CHECK(ColNorms[j] == doctest::Approx(std::sqrt(Squares)));
+  }
+  REQUIRE_THROWS_AS(Matrix.Trace(), std::domain_error);
+}
+}; // namespace
+
+TEST_CASE("Reductions") {
+  {
+    MafsTests::TuningParamsGuard Guard;
+    for (const bool bParallel : {false, true}) {
+      if (bParallel)
+        Guard.Set(ParallelParams());
+      Mafs::Matrix<double, 0, 0, Mafs::MtxRowMajor> RowMatrix(5, 7);
+      Mafs::Matrix<double, 5, 7, Mafs::MtxColMajor> ColMatrix;
+      CheckReductions(RowMatrix);
+      CheckReductions(ColMatrix);
+      CHECK(RowMatrix.Dot(ColMatrix) == doctest::Approx(RowMatrix.Dot(RowMatrix)));
+
+      Mafs::Matrix<double, 3, 3, Mafs::MtxColMajor> Square;
+      for (size_t i = 0; i < 3; ++i)
+        for (size_t j = 0; j < 3; ++j)
+          Square(i, j) = static_cast<double>(10 * i + j);
+      CHECK(Square.Trace() == 0 + 11 + 22);
+    }
+  }
+
+  Mafs::Matrix<double, 0, 0, Mafs::MtxRowMajor> Empty, Other(2, 2);
+  CHECK(Empty.Sum() == 0);
+  CHECK(Empty.Norm1() == 0);
+  REQUIRE_THROWS_AS(Empty.Min(), std::domain_error);
+  REQUIRE_THROWS_AS(Empty.Mean(), std::domain_error);
+  REQUIRE_THROWS_AS(Empty.Dot(Other), std::domain_error);
+
+  Mafs::Matrix<int, 0, 0, Mafs::MtxRowMajor> Integers(2, 3);
+  Integers.Fill(-3);
+  CHECK(Integers.Sum() == -18);
+  CHECK(Integers.NormInf() == 9);
+}
+
+TEST_CASE("Compensated summation") {
+  // 1e16 + 1000 * 1 - 1e16: each 1 is below half an ulp of 1e16.
+  Mafs::Matrix<double, 0, 0, Mafs::MtxRowMajor> Values(1, 1002);
+  Values.Fill(1.0);
+  Values(0, 0) = 1e16;
+  Values(0, 1001) = -1e16;
+  CHECK(Values.Sum(Mafs::MtxSumKahan) == 1000);
+  CHECK(std::abs(Values.Sum(Mafs::MtxSumFast) - 1000) > 0);
+
+  Values(0, 5) = std::numeric_limits<double>::quiet_NaN();
+  size_t nRow = 1, nCol = 0;
+  CHECK(Values.Max(&nRow, &nCol) == 1e16);
+  CHECK(nRow == 0);
+  CHECK(nCol == 0);
+}
+
+namespace {
+void CheckSame(double Value, double Expected) {
+  if (std::isnan(Expected))
+    CHECK(std::isnan(Value));
+  else
+    CHECK(Value == doctest::Approx(Expected));
+}
+}; // namespace
+
+TEST_CASE("Reductions across the storage lines") {
+  // Rows of a col major matrix (and cols of a row major one) are streamed, not transposed: the
+  // results must match the contiguous lines of the other storage order.
+  Mafs::Matrix<double, 0, 0, Mafs::MtxRowMajor> RowMatrix(300, 37);
+  Mafs::Matrix<double, 0, 0, Mafs::MtxColMajor> ColMatrix(300, 37);
+  for (size_t i = 0; i < 300; ++i)
+    for (size_t j = 0; j < 37; ++j)
+      RowMatrix(i, j) = ColMatrix(i, j) = std::sin(static_cast<double>(i * 37 + j));
+  // A line of NaNs and a line with a single value among NaNs.
+  const double NaN = std::numeric_limits<double>::quiet_NaN();
+  for (size_t i = 0; i < 300; ++i) {
+    RowMatrix(i, 3) = ColMatrix(i, 3) = NaN;
+    RowMatrix(i, 5) = ColMatrix(i, 5) = i == 150 ? -7.0 : NaN;
+  }
+  ColMatrix(1, 0) = RowMatrix(1, 0) = 1e16;
+  ColMatrix(2, 0) = RowMatrix(2, 0) = -1e16;
+
+  {
+    MafsTests::TuningParamsGuard Guard;
+    for (const bool bParallel : {false, true}) {
+      if (bParallel)
+        Guard.Set(ParallelParams());
+      for (const auto eOp : {Mafs::MtxReduceSum, Mafs::MtxReduceMean, Mafs::MtxReduceMin,
+                             Mafs::MtxReduceMax, Mafs::MtxReduceAbsSum, Mafs::MtxReduceNorm})
+        for (const auto eMode : {Mafs::MtxSumFast, Mafs::MtxSumPairwise, Mafs::MtxSumKahan}) {
+          const auto Rows = ColMatrix.RowReduce(eOp, eMode);
+          const auto Expected = RowMatrix.RowReduce(eOp, eMode);
+          const auto Cols = RowMatrix.ColReduce(eOp, eMode);
+          const auto ExpectedCols = ColMatrix.ColReduce(eOp, eMode);
+          REQUIRE(Rows.size() == 300);
+          REQUIRE(Cols.size() == 37);
+          for (size_t i = 0; i < 300; ++i)
+            CheckSame(Rows[i], Expected[i]);
+          // The col 0 cancels 1e16, only the compensated sums agree on it.
+          for (size_t j = eMode == Mafs::MtxSumKahan ? 0 : 1; j < 37; ++j)
+            CheckSame(Cols[j], ExpectedCols[j]);
+        }
+      CHECK(RowMatrix.ColReduce(Mafs::MtxReduceMin)[5] == -7);
+      CHECK(RowMatrix.ColReduce(Mafs::MtxReduceMax)[5] == -7);
+      CHECK(std::isnan(RowMatrix.ColReduce(Mafs::MtxReduceMax)[3]));
+      CHECK(RowMatrix.Norm1() == doctest::Approx(ColMatrix.Norm1()));
+    }
+  }
+
+  // The compensated sum of the streamed col keeps the small values between the large ones.
+  const auto Sums = RowMatrix.ColReduce(Mafs::MtxReduceSum, Mafs::MtxSumKahan);
+  double Expected = 0;
+  for (size_t i = 3; i < 300; ++i)
+    Expected += RowMatrix(i, 0);
+  CHECK(Sums[0] == doctest::Approx(Expected + RowMatrix(0, 0)).epsilon(1e-12));
+}
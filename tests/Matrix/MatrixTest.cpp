@@ -1,6 +1,16 @@
 #include <doctest/doctest.h>
 #include <iostream>
 
+// The standard headers used by the library must be included before the access override below.
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <thread>
+
 #define private public
 #define protected public
 #include <Mafs/Matrix/Matrix.hpp>
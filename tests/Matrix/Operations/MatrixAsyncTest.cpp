@@ -0,0 +1,160 @@
+/*********************************************************************************
+ * MatrixAsyncTest.cpp
+ * It has tests for the asynchronous operations and their dependencies.
+ *********************************************************************************/
+
+#include <Mafs/Matrix/Matrix.hpp>
+#include <Mafs/Matrix/Operations/Operations.hpp>
+#include <TestHelpers.hpp>
+#include <atomic>
+#include <doctest/doctest.h>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+typedef Mafs::Matrix<double, 0, 0, Mafs::MtxRowMajor> AsyncMatrix;
+
+auto FilledMatrix(size_t nSize, double Value) -> AsyncMatrix {
+  AsyncMatrix Matrix(nSize, nSize);
+  std::fill(Matrix.Data(), Matrix.Data() + Matrix.Size(), Value);
+  return Matrix;
+}
+
+// Threads of the process (0 if unknown).
+auto ProcessThreads() -> size_t {
+  std::ifstream Status("/proc/self/status");
+  std::string strLine;
+  while (std::getline(Status, strLine))
+    if (strLine.rfind("Threads:", 0) == 0)
+      return std::stoul(strLine.substr(8));
+  return 0;
+}
+}; // namespace
+
+TEST_CASE("Async operations") {
+  auto &Operations = Mafs::Internal::MtxOperation;
+  auto A = Operations.Async([]() { return FilledMatrix(20, 1.0); });
+  auto B = Operations.Async([]() { return FilledMatrix(20, 2.0); });
+  auto C = Operations.Async(
+      [](const AsyncMatrix &a, const AsyncMatrix &b) {
+        return Mafs::Internal::MtxOperation.Multiplication(a, b);
+      },
+      A, B);
+  auto D = Operations.Async(
+      [](const AsyncMatrix &c, const AsyncMatrix &a) {
+        return Mafs::Internal::MtxOperation.Sum(c, a);
+      },
+      C, A);
+  auto Trace = Operations.Async(
+      [](const AsyncMatrix &d) {
+        double Value = 0;
+        for (size_t i = 0; i < d.RowCount(); ++i)
+          Value += d(i, i);
+        return Value;
+      },
+      D);
+
+  CHECK(Trace.Get() == doctest::Approx(20 * (20 * 2.0 + 1.0)));
+  CHECK(C.IsReady());
+  CHECK(C.Get()(3, 4) == doctest::Approx(40.0));
+  CHECK(D.Get()(0, 0) == doctest::Approx(41.0));
+
+  // Ready values as dependencies and functions without result.
+  auto Ready = Mafs::MakeReadyFuture(FilledMatrix(2, 3.0));
+  CHECK(Ready.IsReady());
+  double Sink = 0;
+  auto Done = Operations.Async([&Sink](const AsyncMatrix &m) { Sink = m(1, 1); }, Ready);
+  Done.Wait();
+  CHECK(Sink == 3.0);
+
+  // Void tasks as order only dependencies, mixed with valued ones.
+  std::vector<int> Steps;
+  auto First = Operations.Async([&Steps]() { Steps.push_back(1); });
+  auto Second = Operations.Async([&Steps]() { Steps.push_back(2); }, First);
+  auto Last = Operations.Async(
+      [&Steps](const AsyncMatrix &m) {
+        Steps.push_back(3);
+        return m(0, 0);
+      },
+      Second, Ready, First);
+  CHECK(Last.Get() == 3.0);
+  CHECK(Steps == std::vector<int>{1, 2, 3});
+
+  auto FailingVoid = Operations.Async([]() { throw std::runtime_error("Failed step"); });
+  bool bCalled = false;
+  auto AfterFailure = Operations.Async([&bCalled]() { bCalled = true; }, FailingVoid);
+  REQUIRE_THROWS_AS(AfterFailure.Get(), std::runtime_error);
+  CHECK_FALSE(bCalled);
+}
+
+TEST_CASE("Async dependency order and errors") {
+  auto &Operations = Mafs::Internal::MtxOperation;
+  std::vector<Mafs::MtxFuture<size_t>> Chain;
+  std::atomic<size_t> nCalls{0};
+  Chain.push_back(Operations.Async([&nCalls]() { return ++nCalls; }));
+  for (size_t i = 1; i < 50; ++i)
+    Chain.push_back(Operations.Async(
+        [&nCalls](size_t nPrevious) {
+          const size_t nCall = ++nCalls;
+          return nCall == nPrevious + 1 ? nCall : 0; // 0 if it ran before its dependency.
+        },
+        Chain.back()));
+  CHECK(Chain.back().Get() == 50);
+
+  auto Failing = Operations.Async([]() -> AsyncMatrix {
+    return Mafs::Internal::MtxOperation.Multiplication(FilledMatrix(2, 1.0), AsyncMatrix(3, 3));
+  });
+  bool bCalled = false;
+  auto Dependent = Operations.Async(
+      [&bCalled](const AsyncMatrix &) {
+        bCalled = true;
+        return 1;
+      },
+      Failing);
+  REQUIRE_THROWS_AS(Failing.Get(), std::domain_error);
+  REQUIRE_THROWS_AS(Dependent.Get(), std::domain_error);
+  CHECK_FALSE(bCalled);
+  CHECK_FALSE(Mafs::MtxFuture<int>().IsValid());
+}
+
+TEST_CASE("Async tasks keep their kernels on their worker") {
+  MafsTests::TuningParamsGuard Guard;
+  Mafs::MtxTuningParams Params = Guard.Previous();
+  Params.nParallelThreshold = 0;
+  Params.nThreads = 0;
+  Guard.Set(Params);
+  auto &Operations = Mafs::Internal::MtxOperation;
+
+  // The executor and the kernel workers started so far are the only other threads.
+  const size_t nExecutor = Mafs::Internal::Executor::Instance().WorkerCount();
+  const size_t nBaseline = ProcessThreads();
+#ifdef MAFS_ENABLE_THREADS
+  const size_t nPool = Mafs::Internal::Kernels::ThreadPool::Instance().WorkerCount();
+#endif
+
+  std::vector<Mafs::MtxFuture<AsyncMatrix>> Products;
+  std::vector<Mafs::MtxFuture<size_t>> Limits;
+  for (size_t i = 0; i < 2 * std::max<size_t>(nExecutor, 1); ++i) {
+    Products.push_back(Operations.Async([]() {
+      return Mafs::Internal::MtxOperation.Multiplication(FilledMatrix(96, 1.0),
+                                                         FilledMatrix(96, 2.0));
+    }));
+    Limits.push_back(
+        Operations.Async([]() { return Mafs::Internal::Kernels::ThreadCount(0); }));
+  }
+  size_t nPeak = ProcessThreads();
+  for (const auto &Product : Products)
+    while (!Product.IsReady())
+      nPeak = std::max(nPeak, ProcessThreads());
+
+  for (size_t i = 0; i < Products.size(); ++i) {
+    CHECK(Products[i].Get()(95, 95) == 2 * 96);
+    CHECK(Limits[i].Get() == 1);
+  }
+  CHECK(nPeak <= nBaseline);
+#ifdef MAFS_ENABLE_THREADS
+  CHECK(Mafs::Internal::Kernels::ThreadPool::Instance().WorkerCount() == nPool);
+#endif
+}
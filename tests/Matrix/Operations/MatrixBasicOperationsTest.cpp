@@ -33,3 +33,28 @@ TEST_CASE("Sum") {
   
   REQUIRE_THROWS(MtxStatic + MtxDiff);
 }
+
+TEST_CASE("Concatenation") {
+  Mafs::Matrix<int, 2, 3, Mafs::MtxRowMajor> Left;
+  Mafs::Matrix<int, 0, 0, Mafs::MtxColMajor> Right(2, 2);
+  for (size_t i = 0; i < 2; ++i) {
+    for (size_t j = 0; j < 3; ++j)
+      Left(i, j) = static_cast<int>(i * 10 + j);
+    for (size_t j = 0; j < 2; ++j)
+      Right(i, j) = -static_cast<int>(i * 10 + j);
+  }
+
+  const auto Horizontal = Mafs::Internal::MtxOperation.HorizontalConcat(Left, Right);
+  REQUIRE(Horizontal.RowCount() == 2);
+  REQUIRE(Horizontal.ColCount() == 5);
+  CHECK(Horizontal(1, 2) == 12);
+  CHECK(Horizontal(1, 4) == -11);
+
+  const auto Vertical = Mafs::Internal::MtxOperation.VerticalConcat(Horizontal, Horizontal);
+  REQUIRE(Vertical.RowCount() == 4);
+  CHECK(Vertical(3, 4) == -11);
+  CHECK(Vertical(2, 0) == 0);
+  REQUIRE_THROWS_AS(Mafs::Internal::MtxOperation.VerticalConcat(Left, Right), std::domain_error);
+  Mafs::Matrix<int, 0, 0, Mafs::MtxColMajor> Tall(3, 1);
+  REQUIRE_THROWS_AS(Mafs::Internal::MtxOperation.HorizontalConcat(Left, Tall), std::domain_error);
+}
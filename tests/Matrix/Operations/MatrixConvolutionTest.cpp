@@ -0,0 +1,116 @@
+/*********************************************************************************
+ * MatrixConvolutionTest.cpp
+ * It has tests for the 2D convolutions and cross-correlations.
+ *********************************************************************************/
+
+#include <Mafs/Matrix/Matrix.hpp>
+#include <Mafs/Matrix/Operations/Operations.hpp>
+#include <TestHelpers.hpp>
+#include <doctest/doctest.h>
+#include <vector>
+
+namespace {
+// Quadruple loop reference, bFlip for the convolution.
+template <typename Image, typename Filter, typename Result>
+void CheckFilter(const Image &A, const Filter &F, const Mafs::MtxConvolution &Options, bool bFlip,
+                 const Result &Out) {
+  const size_t nRows = A.RowCount() + 2 * Options.nPaddingRow;
+  const size_t nCols = A.ColCount() + 2 * Options.nPaddingCol;
+  REQUIRE(Out.RowCount() == (nRows - F.RowCount()) / Options.nStrideRow + 1);
+  REQUIRE(Out.ColCount() == (nCols - F.ColCount()) / Options.nStrideCol + 1);
+  for (size_t i = 0; i < Out.RowCount(); ++i)
+    for (size_t j = 0; j < Out.ColCount(); ++j) {
+      double Value = 0;
+      for (size_t u = 0; u < F.RowCount(); ++u)
+        for (size_t v = 0; v < F.ColCount(); ++v) {
+          const size_t r = i * Options.nStrideRow + u, c = j * Options.nStrideCol + v;
+          if (r < Options.nPaddingRow || r >= Options.nPaddingRow + A.RowCount() ||
+              c < Options.nPaddingCol || c >= Options.nPaddingCol + A.ColCount())
+            continue;
+          const double Weight = bFlip ? F(F.RowCount() - 1 - u, F.ColCount() - 1 - v) : F(u, v);
+          Value += Weight * A(r - Options.nPaddingRow, c - Options.nPaddingCol);
+        }
+      REQUIRE(Out(i, j) == doctest::Approx(Value));
+    }
+}
+
+template <size_t Options_> void CheckFilters() {
+  const auto A = MafsTests::RandomMatrix<double, Options_>(23, 19, 1);
+  std::vector<Mafs::Matrix<double, 0, 0, Mafs::MtxColMajor>> Filters;
+  for (const size_t nSize : {1, 3, 5, 9})
+    for (unsigned nSeed = 0; nSeed < 2; ++nSeed)
+      Filters.push_back(MafsTests::RandomMatrix<double, Mafs::MtxColMajor>(nSize, nSize + 1, nSeed + 2));
+  for (const auto &Options : {Mafs::MtxConvolution{}, Mafs::MtxConvolution{2, 3, 0, 0},
+                              Mafs::MtxConvolution{1, 1, 1, 2}, Mafs::MtxConvolution{3, 2, 4, 1}})
+    for (const bool bFlip : {false, true}) {
+      for (const auto &F : Filters) {
+        CheckFilter(A, F, Options, bFlip,
+                    bFlip ? Mafs::Internal::MtxOperation.Convolution(A, F, Options)
+                          : Mafs::Internal::MtxOperation.Correlation(A, F, Options));
+      }
+      // Bank of filters of the same size.
+      const std::vector<Mafs::Matrix<double, 0, 0, Mafs::MtxColMajor>> Bank = {
+          Filters[4], Filters[5], Filters[4]};
+      const auto Outputs = bFlip ? Mafs::Internal::MtxOperation.Convolution(A, Bank, Options)
+                                 : Mafs::Internal::MtxOperation.Correlation(A, Bank, Options);
+      REQUIRE(Outputs.size() == 3);
+      for (size_t f = 0; f < 3; ++f)
+        CheckFilter(A, Bank[f], Options, bFlip, Outputs[f]);
+    }
+}
+}; // namespace
+
+TEST_CASE("Convolutions and correlations") {
+  {
+    MafsTests::TuningParamsGuard Guard;
+    // Default choice, then every filter through the direct kernel and through im2col.
+    for (const size_t nDirectTaps : {Guard.Previous().nConvDirectTaps, size_t(1000), size_t(0)}) {
+      Mafs::MtxTuningParams Params = Guard.Previous();
+      Params.nConvDirectTaps = nDirectTaps;
+      Guard.Set(Params);
+      CheckFilters<Mafs::MtxRowMajor>();
+      CheckFilters<Mafs::MtxColMajor>();
+      Params.nGemmBlockM = 2;
+      Params.nGemmBlockN = 7;
+      Params.nGemmBlockK = 5;
+      Params.nParallelThreshold = 0;
+      Params.nThreads = 3;
+      Guard.Set(Params);
+      CheckFilters<Mafs::MtxRowMajor>();
+      CheckFilters<Mafs::MtxColMajor>();
+    }
+  }
+
+  // Signal smoothing: 3 points moving average of a row vector, same length.
+  Mafs::Matrix<float, 1, 6, Mafs::MtxRowMajor> Signal;
+  for (size_t j = 0; j < 6; ++j)
+    Signal(0, j) = static_cast<float>(3 * j);
+  const auto Average = Mafs::Matrix<float, 1, 3, Mafs::MtxRowMajor>::Constant(1, 3, 1.f / 3);
+  const auto Smooth =
+      Mafs::Internal::MtxOperation.Correlation(Signal, Average, Mafs::MtxConvolution{1, 1, 0, 1});
+  REQUIRE(Smooth.ColCount() == 6);
+  CHECK(Smooth(0, 0) == doctest::Approx(1.0));
+  CHECK(Smooth(0, 2) == doctest::Approx(6.0));
+  CHECK(Smooth(0, 5) == doctest::Approx(9.0));
+
+  // The convolution flips the filter: a shifted impulse moves the image the other way.
+  const auto A = MafsTests::RandomMatrix<double, Mafs::MtxRowMajor>(5, 5, 4);
+  auto Shift = Mafs::Matrix<double, 0, 0, Mafs::MtxRowMajor>::Zero(3, 3);
+  Shift(0, 0) = 1;
+  const auto Shifted = Mafs::Internal::MtxOperation.Convolution(A, Shift);
+  CHECK(Shifted(0, 0) == A(2, 2));
+  CHECK(Mafs::Internal::MtxOperation.Correlation(A, Shift)(0, 0) == A(0, 0));
+
+  const auto Large = MafsTests::RandomMatrix<double, Mafs::MtxRowMajor>(6, 6, 5);
+  REQUIRE_THROWS_AS(Mafs::Internal::MtxOperation.Correlation(Shift, Large), std::domain_error);
+  CHECK(Mafs::Internal::MtxOperation.Correlation(Shift, Large, Mafs::MtxConvolution{1, 1, 2, 2})
+            .Size() == 4);
+  REQUIRE_THROWS_AS(
+      Mafs::Internal::MtxOperation.Correlation(A, Shift, Mafs::MtxConvolution{0, 1, 0, 0}),
+      std::invalid_argument);
+  const std::vector<Mafs::Matrix<double, 0, 0, Mafs::MtxRowMajor>> Mixed = {Shift, Large};
+  REQUIRE_THROWS_AS(Mafs::Internal::MtxOperation.Correlation(Large, Mixed), std::domain_error);
+  CHECK(Mafs::Internal::MtxOperation
+            .Correlation(A, std::vector<Mafs::Matrix<double, 0, 0, Mafs::MtxRowMajor>>())
+            .empty());
+}
@@ -0,0 +1,164 @@
+/*********************************************************************************
+ * MatrixEigenTest.cpp
+ * It has tests for the symmetric eigensolver.
+ *********************************************************************************/
+
+#include <Mafs/Matrix/Matrix.hpp>
+#include <Mafs/Matrix/Operations/Operations.hpp>
+#include <TestHelpers.hpp>
+#include <cmath>
+#include <doctest/doctest.h>
+#include <limits>
+
+namespace {
+// Random matrix with its lower triangle mirrored above the diagonal.
+template <typename T, size_t Options_>
+auto RandomSymmetric(size_t nSize, unsigned nSeed) -> Mafs::Matrix<T, 0, 0, Options_> {
+  auto Matrix = MafsTests::RandomMatrix<T, Options_>(nSize, nSize, nSeed);
+  for (size_t i = 0; i < nSize; ++i)
+    for (size_t j = 0; j < i; ++j)
+      Matrix(j, i) = Matrix(i, j);
+  return Matrix;
+}
+
+// Checks A * v = x * v, the orthonormality of the vectors and the order of the values.
+template <typename Derived, typename Result>
+void CheckEigenpairs(const Derived &A, const Result &Eigen, double Tolerance) {
+  const size_t nSize = A.RowCount(), nCount = Eigen.Values.size();
+  REQUIRE(Eigen.Vectors.RowCount() == nSize);
+  REQUIRE(Eigen.Vectors.ColCount() == nCount);
+  double Norm = 0;
+  for (size_t i = 0; i < nSize; ++i)
+    for (size_t j = 0; j < nSize; ++j)
+      Norm = std::max(Norm, std::abs(static_cast<double>(A(i, j))));
+  Norm *= static_cast<double>(nSize);
+
+  double Residual = 0, Orthogonality = 0;
+  for (size_t k = 0; k < nCount; ++k) {
+    if (k > 0)
+      CHECK(Eigen.Values[k - 1] >= Eigen.Values[k]);
+    for (size_t i = 0; i < nSize; ++i) {
+      double Value = -static_cast<double>(Eigen.Values[k]) * Eigen.Vectors(i, k);
+      for (size_t j = 0; j < nSize; ++j)
+        Value += static_cast<double>(A(i, j)) * Eigen.Vectors(j, k);
+      Residual = std::max(Residual, std::abs(Value));
+    }
+    for (size_t l = 0; l <= k; ++l) {
+      double Value = k == l ? -1 : 0;
+      for (size_t i = 0; i < nSize; ++i)
+        Value += static_cast<double>(Eigen.Vectors(i, k)) * Eigen.Vectors(i, l);
+      Orthogonality = std::max(Orthogonality, std::abs(Value));
+    }
+  }
+  CHECK(Residual <= Tolerance * Norm);
+  CHECK(Orthogonality <= Tolerance * static_cast<double>(nSize));
+}
+
+template <size_t Options_> void CheckRandom(size_t nSize) {
+  const auto A = RandomSymmetric<double, Options_>(nSize, 7);
+  const auto Eigen = Mafs::Internal::MtxOperation.SymmetricEigen(A);
+  CheckEigenpairs(A, Eigen, 1e-13);
+
+  double Trace = 0, Sum = 0;
+  for (size_t i = 0; i < nSize; ++i) {
+    Trace += A(i, i);
+    Sum += Eigen.Values[i];
+  }
+  CHECK(Sum == doctest::Approx(Trace));
+
+  const auto Values = Mafs::Internal::MtxOperation.SymmetricEigen(A, Mafs::MtxEigenValues);
+  CHECK(Values.Vectors.Size() == 0);
+  REQUIRE(Values.Values.size() == nSize);
+  for (size_t i = 0; i < nSize; ++i)
+    CHECK(Values.Values[i] == doctest::Approx(Eigen.Values[i]).epsilon(1e-10));
+
+  const auto Top = Mafs::Internal::MtxOperation.SymmetricEigen(A, Mafs::MtxEigenVectors, 5);
+  CheckEigenpairs(A, Top, 1e-13);
+  for (size_t i = 0; i < 5; ++i)
+    CHECK(Top.Values[i] == doctest::Approx(Eigen.Values[i]).epsilon(1e-10));
+}
+}; // namespace
+
+TEST_CASE("Symmetric eigensolver") {
+  MafsTests::TuningParamsGuard Guard;
+  for (const bool bParallel : {false, true}) {
+    if (bParallel) {
+      // Narrow panels and blocks so every blocked and threaded path runs.
+      Mafs::MtxTuningParams Params;
+      Params.nTransposeBlock = 3;
+      Params.nLUBlock = 8;
+      Params.nGemmBlockM = 16;
+      Params.nParallelThreshold = 0;
+      Params.nThreads = 3;
+      Guard.Set(Params);
+    }
+    CheckRandom<Mafs::MtxRowMajor>(150);
+    CheckRandom<Mafs::MtxColMajor>(45);
+    CheckRandom<Mafs::MtxRowMajor>(6);
+  }
+}
+
+TEST_CASE("Symmetric eigensolver with repeated eigenvalues") {
+  // 1D Laplacian: eigenvalues 2 - 2 * cos(k * pi / (n + 1)).
+  constexpr size_t nSize = 100;
+  const double Pi = std::acos(-1.0);
+  Mafs::Matrix<double, 0, 0, Mafs::MtxRowMajor> Laplacian(nSize, nSize);
+  Laplacian.Fill(0);
+  for (size_t i = 0; i < nSize; ++i) {
+    Laplacian(i, i) = 2;
+    if (i + 1 < nSize)
+      Laplacian(i, i + 1) = Laplacian(i + 1, i) = -1;
+  }
+  const auto Eigen = Mafs::Internal::MtxOperation.SymmetricEigen(Laplacian);
+  CheckEigenpairs(Laplacian, Eigen, 1e-13);
+  for (size_t k = 0; k < nSize; ++k)
+    CHECK(Eigen.Values[k] ==
+          doctest::Approx(2 - 2 * std::cos(static_cast<double>(nSize - k) * Pi /
+                                           static_cast<double>(nSize + 1))));
+
+  // Two clusters of equal eigenvalues (deflation and inverse iteration within a cluster).
+  Mafs::Matrix<double, 0, 0, Mafs::MtxColMajor> Blocks(80, 80);
+  Blocks.Fill(0);
+  for (size_t i = 0; i < 80; ++i)
+    Blocks(i, i) = i % 2 == 0 ? 3 : -1;
+  const auto Rotated = RandomSymmetric<double, Mafs::MtxColMajor>(80, 3);
+  auto Q = Mafs::Internal::MtxOperation.SymmetricEigen(Rotated).Vectors;
+  auto QD = Mafs::Internal::MtxOperation.Multiplication(Q, Blocks);
+  Mafs::Matrix<double, 0, 0, Mafs::MtxColMajor> A(80, 80);
+  Mafs::Internal::MtxOperation.Multiplication(QD, Mafs::MtxNoTrans, Q, Mafs::MtxTrans, A, 1.0,
+                                              0.0, Mafs::MtxEpilogue<double>());
+  const auto Clustered = Mafs::Internal::MtxOperation.SymmetricEigen(A);
+  CheckEigenpairs(A, Clustered, 1e-13);
+  CHECK(Clustered.Values[0] == doctest::Approx(3));
+  CHECK(Clustered.Values[79] == doctest::Approx(-1));
+  const auto Top = Mafs::Internal::MtxOperation.SymmetricEigen(A, Mafs::MtxEigenVectors, 10);
+  CheckEigenpairs(A, Top, 1e-12);
+  CHECK(Top.Values[9] == doctest::Approx(3));
+
+  // Diagonal: every pair is deflated.
+  const auto Diagonal = Mafs::Internal::MtxOperation.SymmetricEigen(Blocks);
+  CheckEigenpairs(Blocks, Diagonal, 1e-15);
+}
+
+TEST_CASE("Symmetric eigensolver single precision and errors") {
+  const auto A = RandomSymmetric<float, Mafs::MtxRowMajor>(70, 11);
+  const auto Eigen = Mafs::Internal::MtxOperation.SymmetricEigen(A);
+  CheckEigenpairs(A, Eigen, 1e-5);
+
+  // Only the lower triangle is read.
+  auto Lower = A;
+  for (size_t i = 0; i < 70; ++i)
+    for (size_t j = i + 1; j < 70; ++j)
+      Lower(i, j) = 0;
+  const auto Values = Mafs::Internal::MtxOperation.SymmetricEigen(Lower, Mafs::MtxEigenValues);
+  for (size_t i = 0; i < 70; ++i)
+    CHECK(Values.Values[i] == doctest::Approx(Eigen.Values[i]).epsilon(1e-4));
+
+  Mafs::Matrix<double, 0, 0, Mafs::MtxRowMajor> Empty;
+  CHECK(Mafs::Internal::MtxOperation.SymmetricEigen(Empty).Values.empty());
+  Mafs::Matrix<double, 0, 0, Mafs::MtxRowMajor> NotSquare(3, 2);
+  REQUIRE_THROWS_AS(Mafs::Internal::MtxOperation.SymmetricEigen(NotSquare), std::domain_error);
+  Mafs::Matrix<double, 2, 2, Mafs::MtxRowMajor> Infinite;
+  Infinite.Fill(std::numeric_limits<double>::infinity());
+  REQUIRE_THROWS_AS(Mafs::Internal::MtxOperation.SymmetricEigen(Infinite), std::domain_error);
+}
@@ -0,0 +1,222 @@
+/*********************************************************************************
+ * MatrixFunctionsTest.cpp
+ * It has tests for the matrix powers and exponential.
+ *********************************************************************************/
+
+#include <Mafs/Matrix/Matrix.hpp>
+#include <Mafs/Matrix/Operations/Operations.hpp>
+#include <TestHelpers.hpp>
+#include <cmath>
+#include <doctest/doctest.h>
+#include <vector>
+
+namespace {
+typedef std::vector<long double> Square;
+
+auto Product(const Square &A, const Square &B, size_t n) -> Square {
+  Square C(n * n, 0);
+  for (size_t i = 0; i < n; ++i)
+    for (size_t k = 0; k < n; ++k)
+      for (size_t j = 0; j < n; ++j)
+        C[i * n + j] += A[i * n + k] * B[k * n + j];
+  return C;
+}
+
+// exp(A) in long double: Taylor series of A / 2^s (norm below 1/2), squared s times.
+template <typename Derived> auto ReferenceExp(const Derived &A) -> Square {
+  const size_t n = A.RowCount();
+  long double Norm = 0;
+  Square Scaled(n * n);
+  for (size_t i = 0; i < n; ++i)
+    for (size_t j = 0; j < n; ++j)
+      Norm += std::abs(static_cast<long double>(A(i, j)));
+  int nSquarings = 0;
+  while (Norm > 0.5L) {
+    Norm /= 2;
+    ++nSquarings;
+  }
+  for (size_t i = 0; i < n; ++i)
+    for (size_t j = 0; j < n; ++j)
+      Scaled[i * n + j] = std::ldexp(static_cast<long double>(A(i, j)), -nSquarings);
+  Square Result(n * n, 0), Term(n * n, 0);
+  for (size_t i = 0; i < n; ++i)
+    Result[i * n + i] = Term[i * n + i] = 1;
+  for (int k = 1; k < 30; ++k) {
+    Term = Product(Term, Scaled, n);
+    for (size_t i = 0; i < n * n; ++i)
+      Result[i] += Term[i] /= k;
+  }
+  for (int s = 0; s < nSquarings; ++s)
+    Result = Product(Result, Result, n);
+  return Result;
+}
+
+// Largest |Matrix - Reference| relative to max |Reference|.
+template <typename Derived> auto RelativeError(const Derived &Matrix, const Square &Reference) {
+  const size_t n = Matrix.RowCount();
+  long double Error = 0, Norm = 0;
+  for (size_t i = 0; i < n; ++i)
+    for (size_t j = 0; j < n; ++j) {
+      Norm = std::max(Norm, std::abs(Reference[i * n + j]));
+      Error = std::max(Error, std::abs(static_cast<long double>(Matrix(i, j)) -
+                                       Reference[i * n + j]));
+    }
+  return static_cast<double>(Error / Norm);
+}
+
+template <size_t Options_> void CheckPowers() {
+  const auto A = MafsTests::RandomMatrix<double, Options_>(9, 9, 0.5, 1);
+  auto Expected = Mafs::Matrix<double, 0, 0, Options_>::Identity(9, 9);
+  for (uint64_t n = 0; n <= 13; ++n) {
+    const auto Power = Mafs::Internal::MtxOperation.Power(A, n);
+    for (size_t i = 0; i < 9; ++i)
+      for (size_t j = 0; j < 9; ++j)
+        REQUIRE(Power(i, j) == doctest::Approx(Expected(i, j)).epsilon(1e-12));
+    Mafs::Internal::MtxOperation.Multiplication(Expected, Mafs::MtxNoTrans, A, Mafs::MtxNoTrans,
+                                                Expected);
+  }
+  // Into a result of the other storage order.
+  Mafs::Matrix<double, 0, 0, 1 - Options_> Result(9, 9);
+  Mafs::Internal::MtxOperation.Power(A, 13, Result);
+  const auto Power = Mafs::Internal::MtxOperation.Power(A, 13);
+  for (size_t i = 0; i < 9; ++i)
+    for (size_t j = 0; j < 9; ++j)
+      REQUIRE(Result(i, j) == doctest::Approx(Power(i, j)));
+}
+
+template <size_t Options_> void CheckExponentials() {
+  // The norms select every Pade degree, and scaling and squaring past 5.4.
+  for (const double Scale : {0.001, 0.02, 0.1, 0.2, 0.4, 2.0, 5.0, 10.0}) {
+    const auto A = MafsTests::RandomMatrix<double, Options_>(12, 12, Scale, 2);
+    CHECK(RelativeError(Mafs::Internal::MtxOperation.Exp(A), ReferenceExp(A)) < 1e-12);
+    Mafs::Matrix<double, 0, 0, 1 - Options_> Result(12, 12);
+    Mafs::Internal::MtxOperation.Exp(A, Result);
+    CHECK(RelativeError(Result, ReferenceExp(A)) < 1e-12);
+  }
+  for (const double Scale : {0.01, 0.1, 2.0}) {
+    const auto A = MafsTests::RandomMatrix<float, Options_>(8, 8, Scale, 3);
+    CHECK(RelativeError(Mafs::Internal::MtxOperation.Exp(A), ReferenceExp(A)) < 1e-5);
+  }
+}
+}; // namespace
+
+TEST_CASE("Matrix powers") {
+  {
+    MafsTests::TuningParamsGuard Guard;
+    CheckPowers<Mafs::MtxRowMajor>();
+    CheckPowers<Mafs::MtxColMajor>();
+    Mafs::MtxTuningParams Params;
+    Params.nGemmBlockM = 3;
+    Params.nGemmBlockN = 4;
+    Params.nGemmBlockK = 5;
+    Params.nParallelThreshold = 0;
+    Params.nThreads = 3;
+    Guard.Set(Params);
+    CheckPowers<Mafs::MtxRowMajor>();
+    CheckPowers<Mafs::MtxColMajor>();
+  }
+
+  // Small static matrices: Fibonacci numbers.
+  Mafs::Matrix<long, 2, 2, Mafs::MtxRowMajor> Fibonacci;
+  Fibonacci(0, 0) = Fibonacci(0, 1) = Fibonacci(1, 0) = 1;
+  Fibonacci(1, 1) = 0;
+  const auto F = Mafs::Internal::MtxOperation.Power(Fibonacci, 50);
+  CHECK(F(0, 0) == 20365011074);
+  CHECK(F(0, 1) == 12586269025);
+  CHECK(F(1, 1) == 7778742049);
+
+  // Markov chain: the rows of P^n stay distributions and converge to the stationary one.
+  Mafs::Matrix<double, 3, 3, Mafs::MtxColMajor> P;
+  const double Transitions[3][3] = {{0.9, 0.075, 0.025}, {0.15, 0.8, 0.05}, {0.25, 0.25, 0.5}};
+  for (size_t i = 0; i < 3; ++i)
+    for (size_t j = 0; j < 3; ++j)
+      P(i, j) = Transitions[i][j];
+  const auto Steady = Mafs::Internal::MtxOperation.Power(P, 1000);
+  for (size_t i = 0; i < 3; ++i) {
+    CHECK(Steady(i, 0) + Steady(i, 1) + Steady(i, 2) == doctest::Approx(1.0));
+    CHECK(Steady(i, 0) == doctest::Approx(0.625));
+    CHECK(Steady(i, 1) == doctest::Approx(0.3125));
+  }
+
+  // Diagonal matrices only raise their diagonal.
+  auto Diagonal = Mafs::Matrix<double, 0, 0, Mafs::MtxRowMajor>::Zero(4, 4);
+  for (size_t i = 0; i < 4; ++i)
+    Diagonal(i, i) = static_cast<double>(i) - 1.5;
+  const auto D = Mafs::Internal::MtxOperation.Power(Diagonal, 7);
+  for (size_t i = 0; i < 4; ++i)
+    for (size_t j = 0; j < 4; ++j)
+      CHECK(D(i, j) == (i == j ? std::pow(static_cast<double>(i) - 1.5, 7) : 0.0));
+
+  // In place: the result overlaps the operand.
+  auto A = MafsTests::RandomMatrix<double, Mafs::MtxRowMajor>(5, 5, 1.0, 4);
+  const auto Cube = Mafs::Internal::MtxOperation.Power(A, 3);
+  Mafs::Internal::MtxOperation.Power(A, 3, A);
+  for (size_t i = 0; i < 5; ++i)
+    for (size_t j = 0; j < 5; ++j)
+      REQUIRE(A(i, j) == doctest::Approx(Cube(i, j)));
+
+  Mafs::Matrix<double, 0, 0, Mafs::MtxRowMajor> Rectangle(3, 4);
+  REQUIRE_THROWS_AS(Mafs::Internal::MtxOperation.Power(Rectangle, 2), std::domain_error);
+  Mafs::Matrix<double, 0, 0, Mafs::MtxRowMajor> Wrong(4, 4);
+  REQUIRE_THROWS_AS(Mafs::Internal::MtxOperation.Power(A, 2, Wrong), std::domain_error);
+}
+
+TEST_CASE("Matrix exponential") {
+  {
+    MafsTests::TuningParamsGuard Guard;
+    CheckExponentials<Mafs::MtxRowMajor>();
+    CheckExponentials<Mafs::MtxColMajor>();
+    Mafs::MtxTuningParams Params;
+    Params.nGemmBlockM = 3;
+    Params.nGemmBlockN = 4;
+    Params.nGemmBlockK = 5;
+    Params.nLUBlock = 2;
+    Params.nParallelThreshold = 0;
+    Params.nThreads = 3;
+    Guard.Set(Params);
+    CheckExponentials<Mafs::MtxRowMajor>();
+    CheckExponentials<Mafs::MtxColMajor>();
+  }
+
+  // Rotations: exp([0 -t; t 0]) = [cos t -sin t; sin t cos t], small static matrices.
+  for (const double t : {0.3, 25.0}) {
+    Mafs::Matrix<double, 2, 2, Mafs::MtxRowMajor> Generator;
+    Generator(0, 0) = Generator(1, 1) = 0;
+    Generator(0, 1) = -t;
+    Generator(1, 0) = t;
+    const auto R = Mafs::Internal::MtxOperation.Exp(Generator);
+    CHECK(R(0, 0) == doctest::Approx(std::cos(t)).epsilon(1e-12));
+    CHECK(R(0, 1) == doctest::Approx(-std::sin(t)).epsilon(1e-12));
+    CHECK(R(1, 0) == doctest::Approx(std::sin(t)).epsilon(1e-12));
+    CHECK(R(1, 1) == doctest::Approx(std::cos(t)).epsilon(1e-12));
+  }
+
+  // Nilpotent: exp(N) = I + N + N^2 / 2.
+  auto N = Mafs::Matrix<double, 3, 3, Mafs::MtxColMajor>::Zero(3, 3);
+  N(0, 1) = 2;
+  N(1, 2) = 3;
+  const auto E = Mafs::Internal::MtxOperation.Exp(N);
+  CHECK(E(0, 0) == doctest::Approx(1.0));
+  CHECK(E(0, 1) == doctest::Approx(2.0));
+  CHECK(E(0, 2) == doctest::Approx(3.0));
+  CHECK(E(1, 2) == doctest::Approx(3.0));
+  CHECK(E(2, 0) == 0.0);
+
+  // exp(A) * exp(-A) = I and the diagonal fast path.
+  const auto A = MafsTests::RandomMatrix<double, Mafs::MtxRowMajor>(20, 20, 0.5, 5);
+  const auto Identity = Mafs::Internal::MtxOperation.Multiplication(
+      Mafs::Internal::MtxOperation.Exp(A),
+      Mafs::Internal::MtxOperation.Exp(A.Map([](double Value) { return -Value; })));
+  for (size_t i = 0; i < 20; ++i)
+    for (size_t j = 0; j < 20; ++j)
+      REQUIRE(Identity(i, j) == doctest::Approx(i == j ? 1.0 : 0.0).epsilon(1e-10));
+  const auto Zero = Mafs::Matrix<double, 0, 0, Mafs::MtxRowMajor>::Zero(6, 6);
+  CHECK(Mafs::Internal::MtxOperation.Exp(Zero).Trace() == 6.0);
+  auto Diagonal = Mafs::Matrix<double, 0, 0, Mafs::MtxRowMajor>::Zero(3, 3);
+  Diagonal(1, 1) = 2;
+  CHECK(Mafs::Internal::MtxOperation.Exp(Diagonal)(1, 1) == std::exp(2.0));
+
+  Mafs::Matrix<double, 0, 0, Mafs::MtxRowMajor> Rectangle(3, 4);
+  REQUIRE_THROWS_AS(Mafs::Internal::MtxOperation.Exp(Rectangle), std::domain_error);
+  CHECK(Mafs::Internal::MtxOperation.Exp(Mafs::Matrix<double, 0, 0, 0>()).Size() == 0);
+}
@@ -0,0 +1,70 @@
+/*********************************************************************************
+ * MatrixGramTest.cpp
+ * It has tests for the Gram matrices (symmetric rank k updates).
+ *********************************************************************************/
+
+#include <Mafs/Matrix/Matrix.hpp>
+#include <Mafs/Matrix/Operations/Operations.hpp>
+#include <TestHelpers.hpp>
+#include <doctest/doctest.h>
+#include <vector>
+
+using MafsTests::RandomVector;
+
+namespace {
+template <typename Derived, typename Result>
+void CheckGram(const Derived &A, Mafs::MtxTransposeOp eOp, const Result &C, double Alpha,
+               double Beta, double Initial) {
+  const size_t nN = eOp == Mafs::MtxNoTrans ? A.RowCount() : A.ColCount();
+  const size_t nK = eOp == Mafs::MtxNoTrans ? A.ColCount() : A.RowCount();
+  REQUIRE(C.RowCount() == nN);
+  REQUIRE(C.ColCount() == nN);
+  auto Op = [&](size_t i, size_t k) { return eOp == Mafs::MtxNoTrans ? A(i, k) : A(k, i); };
+  for (size_t i = 0; i < nN; ++i)
+    for (size_t j = 0; j < nN; ++j) {
+      double Value = 0;
+      for (size_t k = 0; k < nK; ++k)
+        Value += Op(i, k) * Op(j, k);
+      REQUIRE(C(i, j) == doctest::Approx(Alpha * Value + Beta * Initial));
+      REQUIRE(C(i, j) == C(j, i));
+    }
+}
+
+template <size_t Options_> void CheckGrams() {
+  Mafs::Matrix<double, 0, 0, Options_> A(13, 8);
+  const auto Values = RandomVector(A.Size(), 11);
+  std::copy(Values.begin(), Values.end(), A.Data());
+  for (const auto eOp : {Mafs::MtxNoTrans, Mafs::MtxTrans}) {
+    CheckGram(A, eOp, Mafs::Internal::MtxOperation.Gram(A, eOp), 1, 0, 0);
+    // Alpha * op(A) * op(A)^T + Beta * C into a result of the other storage order.
+    const size_t nN = eOp == Mafs::MtxNoTrans ? 13 : 8;
+    Mafs::Matrix<double, 0, 0, 1 - Options_> C(nN, nN);
+    C.Fill(3.0);
+    Mafs::Internal::MtxOperation.Gram(A, eOp, C, 0.5, 2.0);
+    CheckGram(A, eOp, C, 0.5, 2.0, 3.0);
+  }
+}
+}; // namespace
+
+TEST_CASE("Gram matrices") {
+  MafsTests::TuningParamsGuard Guard;
+  CheckGrams<Mafs::MtxRowMajor>();
+  CheckGrams<Mafs::MtxColMajor>();
+  Guard.Set(MafsTests::SmallBlocks());
+  CheckGrams<Mafs::MtxRowMajor>();
+  CheckGrams<Mafs::MtxColMajor>();
+
+  // Result overlapping the operand: S = S * S^T.
+  Mafs::Matrix<double, 0, 0, Mafs::MtxRowMajor> Square(6, 6);
+  const auto Values = RandomVector(Square.Size(), 12);
+  std::copy(Values.begin(), Values.end(), Square.Data());
+  const auto Copy = Square;
+  Mafs::Internal::MtxOperation.Gram(Square, Mafs::MtxNoTrans, Square);
+  CheckGram(Copy, Mafs::MtxNoTrans, Square, 1, 0, 0);
+
+  Mafs::Matrix<double, 0, 0, Mafs::MtxRowMajor> Wrong(4, 4);
+  REQUIRE_THROWS_AS(Mafs::Internal::MtxOperation.Gram(Square, Mafs::MtxTrans, Wrong),
+                    std::domain_error);
+  Mafs::Matrix<double, 0, 0, Mafs::MtxRowMajor> Empty;
+  CHECK(Mafs::Internal::MtxOperation.Gram(Empty, Mafs::MtxTrans).Size() == 0);
+}
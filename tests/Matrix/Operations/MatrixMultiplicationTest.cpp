@@ -0,0 +1,74 @@
+/*********************************************************************************
+ * MatrixMultiplicationTest.cpp
+ * It has tests for the general products: transposed operands and the fused epilogue.
+ *********************************************************************************/
+
+#include <Mafs/Matrix/Matrix.hpp>
+#include <Mafs/Matrix/Operations/Operations.hpp>
+#include <TestHelpers.hpp>
+#include <doctest/doctest.h>
+#include <vector>
+
+using MafsTests::RandomVector;
+
+TEST_CASE("Multiplication with transposes and epilogue") {
+  MafsTests::TuningParamsGuard Guard(MafsTests::SmallBlocks());
+
+  // A^T is 7 x 9 and B^T is 9 x 6.
+  Mafs::Matrix<double, 0, 0, Mafs::MtxColMajor> A(9, 7);
+  Mafs::Matrix<double, 0, 0, Mafs::MtxRowMajor> B(6, 9);
+  const auto ValuesA = RandomVector(A.Size(), 6), ValuesB = RandomVector(B.Size(), 7);
+  std::copy(ValuesA.begin(), ValuesA.end(), A.Data());
+  std::copy(ValuesB.begin(), ValuesB.end(), B.Data());
+  const auto RowBias = RandomVector(7, 8), ColBias = RandomVector(6, 9);
+  auto Relu = [](double Value) { return Value > 0 ? Value : 0.0; };
+  auto Product = [&](size_t i, size_t j) {
+    double Value = 0;
+    for (size_t k = 0; k < 9; ++k)
+      Value += A(k, i) * B(j, k);
+    return Value;
+  };
+
+  Mafs::Matrix<double, 0, 0, Mafs::MtxRowMajor> RowC(7, 6);
+  Mafs::Matrix<double, 0, 0, Mafs::MtxColMajor> ColC(7, 6);
+  for (size_t i = 0; i < 7; ++i)
+    for (size_t j = 0; j < 6; ++j)
+      RowC(i, j) = ColC(i, j) = static_cast<double>(i) - static_cast<double>(j);
+
+  Mafs::Internal::MtxOperation.Multiplication(A, Mafs::MtxTrans, B, Mafs::MtxTrans, RowC, 2.0, 0.5,
+                                              Mafs::MtxEpilogue{Mafs::MtxColBias, ColBias.data(),
+                                                                Relu});
+  Mafs::Internal::MtxOperation.Multiplication(A, Mafs::MtxTrans, B, Mafs::MtxTrans, ColC, 2.0, 0.5,
+                                              Mafs::MtxEpilogue{Mafs::MtxRowBias, RowBias.data()});
+  for (size_t i = 0; i < 7; ++i)
+    for (size_t j = 0; j < 6; ++j) {
+      const double Initial = static_cast<double>(i) - static_cast<double>(j);
+      const double Value = 2.0 * Product(i, j) + 0.5 * Initial;
+      REQUIRE(RowC(i, j) == doctest::Approx(Relu(Value + ColBias[j])));
+      REQUIRE(ColC(i, j) == doctest::Approx(Value + RowBias[i]));
+    }
+
+  // Result overlapping an operand: C = C^T * C.
+  Mafs::Matrix<double, 0, 0, Mafs::MtxRowMajor> Square(5, 5), Expected(5, 5);
+  const auto ValuesS = RandomVector(Square.Size(), 10);
+  std::copy(ValuesS.begin(), ValuesS.end(), Square.Data());
+  for (size_t i = 0; i < 5; ++i)
+    for (size_t j = 0; j < 5; ++j) {
+      Expected(i, j) = 0;
+      for (size_t k = 0; k < 5; ++k)
+        Expected(i, j) += Square(k, i) * Square(k, j);
+    }
+  Mafs::Internal::MtxOperation.Multiplication(Square, Mafs::MtxTrans, Square, Mafs::MtxNoTrans,
+                                              Square);
+  for (size_t i = 0; i < 5; ++i)
+    for (size_t j = 0; j < 5; ++j)
+      REQUIRE(Square(i, j) == doctest::Approx(Expected(i, j)));
+
+  REQUIRE_THROWS_AS(Mafs::Internal::MtxOperation.Multiplication(A, Mafs::MtxNoTrans, B,
+                                                                Mafs::MtxTrans, RowC),
+                    std::domain_error);
+  REQUIRE_THROWS_AS(Mafs::Internal::MtxOperation.Multiplication(
+                        A, Mafs::MtxTrans, B, Mafs::MtxTrans, RowC, 1.0, 0.0,
+                        Mafs::MtxEpilogue<double>{Mafs::MtxRowBias, nullptr}),
+                    std::invalid_argument);
+}
@@ -0,0 +1,88 @@
+/*********************************************************************************
+ * MatrixSolverTest.cpp
+ * It has tests for the linear solvers (LU and mixed precision refinement).
+ *********************************************************************************/
+
+#include <Mafs/Matrix/Matrix.hpp>
+#include <Mafs/Matrix/Operations/Operations.hpp>
+#include <doctest/doctest.h>
+#include <random>
+
+template <typename T, size_t Rows_, size_t Cols_, size_t Options_>
+void RandomFill(Mafs::Matrix<T, Rows_, Cols_, Options_> &Matrix, unsigned nSeed) {
+  std::mt19937 Generator(nSeed);
+  std::uniform_real_distribution<T> Distribution(-1, 1);
+  for (size_t i = 0; i < Matrix.RowCount(); ++i)
+    for (size_t j = 0; j < Matrix.ColCount(); ++j)
+      Matrix(i, j) = Distribution(Generator);
+}
+
+TEST_CASE("Solve LU") {
+  Mafs::Matrix<double, 3, 3, Mafs::MtxRowMajor> A;
+  Mafs::Matrix<double, 3, 1, Mafs::MtxRowMajor> B;
+  // x = [1, 2, 3]
+  A(0, 0) = 0;  A(0, 1) = 2; A(0, 2) = 1;
+  A(1, 0) = 1;  A(1, 1) = 1; A(1, 2) = 1;
+  A(2, 0) = -2; A(2, 1) = 0; A(2, 2) = 4;
+  B(0, 0) = 7;
+  B(1, 0) = 6;
+  B(2, 0) = 10;
+
+  auto X = Mafs::Internal::MtxOperation.Solve(A, B);
+  REQUIRE(X(0, 0) == doctest::Approx(1));
+  REQUIRE(X(1, 0) == doctest::Approx(2));
+  REQUIRE(X(2, 0) == doctest::Approx(3));
+}
+
+TEST_CASE("Solve errors") {
+  Mafs::Matrix<double, 0, 0, Mafs::MtxRowMajor> NotSquare(3, 2);
+  Mafs::Matrix<double, 0, 0, Mafs::MtxRowMajor> Singular(2, 2);
+  Mafs::Matrix<double, 0, 0, Mafs::MtxRowMajor> B(2, 1);
+  Singular.Fill(1);
+  B.Fill(1);
+
+  REQUIRE_THROWS(Mafs::Internal::MtxOperation.Solve(NotSquare, B));
+  REQUIRE_THROWS(Mafs::Internal::MtxOperation.Solve(Singular, B));
+  REQUIRE_THROWS(Mafs::Internal::MtxOperation.MixedPrecisionSolve(Singular, B));
+}
+
+TEST_CASE("Mixed precision solve refines to double accuracy") {
+  constexpr size_t nSize = 64;
+  Mafs::Matrix<double, 0, 0, Mafs::MtxColMajor> A(nSize, nSize);
+  Mafs::Matrix<double, 0, 0, Mafs::MtxRowMajor> B(nSize, 3);
+  RandomFill(A, 1);
+  RandomFill(B, 2);
+  for (size_t i = 0; i < nSize; ++i)
+    A(i, i) += 4;
+
+  Mafs::MtxSolverInfo Info;
+  auto X = Mafs::Internal::MtxOperation.MixedPrecisionSolve(A, B, &Info);
+  auto Reference = Mafs::Internal::MtxOperation.Solve(A, B);
+
+  REQUIRE(Info.bConverged);
+  REQUIRE_FALSE(Info.bFallback);
+  REQUIRE(Info.nIterations > 0);
+  for (size_t i = 0; i < nSize; ++i)
+    for (size_t j = 0; j < B.ColCount(); ++j)
+      REQUIRE(X(i, j) == doctest::Approx(Reference(i, j)).epsilon(1e-12));
+}
+
+TEST_CASE("Mixed precision solve falls back on ill conditioned matrices") {
+  // Hilbert matrix, cond ~ 1e16 for n = 12: float can't refine it.
+  constexpr size_t nSize = 12;
+  Mafs::Matrix<double, 0, 0, Mafs::MtxRowMajor> A(nSize, nSize);
+  Mafs::Matrix<double, 0, 0, Mafs::MtxRowMajor> B(nSize, 1);
+  for (size_t i = 0; i < nSize; ++i) {
+    for (size_t j = 0; j < nSize; ++j)
+      A(i, j) = 1.0 / static_cast<double>(i + j + 1);
+    B(i, 0) = 1;
+  }
+
+  Mafs::MtxSolverInfo Info;
+  auto X = Mafs::Internal::MtxOperation.MixedPrecisionSolve(A, B, &Info);
+  auto Reference = Mafs::Internal::MtxOperation.Solve(A, B);
+
+  REQUIRE(Info.bFallback);
+  for (size_t i = 0; i < nSize; ++i)
+    REQUIRE(X(i, 0) == doctest::Approx(Reference(i, 0)));
+}
@@ -0,0 +1,189 @@
+/*********************************************************************************
+ * MatrixSvdTest.cpp
+ * It has tests for the singular value decompositions.
+ *********************************************************************************/
+
+#include <Mafs/Matrix/Matrix.hpp>
+#include <Mafs/Matrix/Operations/Operations.hpp>
+#include <TestHelpers.hpp>
+#include <cmath>
+#include <doctest/doctest.h>
+#include <limits>
+
+namespace {
+// Largest |A - U * S * V^T| relative to max |A|.
+template <typename Derived, typename Result>
+auto ReconstructionError(const Derived &A, const Result &Svd) -> double {
+  double Error = 0, Norm = 0;
+  for (size_t i = 0; i < A.RowCount(); ++i)
+    for (size_t j = 0; j < A.ColCount(); ++j) {
+      double Value = static_cast<double>(A(i, j));
+      Norm = std::max(Norm, std::abs(Value));
+      for (size_t k = 0; k < Svd.Values.size(); ++k)
+        Value -= static_cast<double>(Svd.U(i, k)) * Svd.Values[k] * Svd.V(j, k);
+      Error = std::max(Error, std::abs(Value));
+    }
+  return Error / std::max(Norm, 1e-300);
+}
+
+// Largest |Q^T * Q - I| of the orthonormal cols of Q.
+template <typename Derived> auto OrthogonalityError(const Derived &Q) -> double {
+  double Error = 0;
+  for (size_t k = 0; k < Q.ColCount(); ++k)
+    for (size_t l = 0; l <= k; ++l) {
+      double Value = k == l ? -1 : 0;
+      for (size_t i = 0; i < Q.RowCount(); ++i)
+        Value += static_cast<double>(Q(i, k)) * Q(i, l);
+      Error = std::max(Error, std::abs(Value));
+    }
+  return Error;
+}
+
+template <typename Derived, typename Result>
+void CheckSvd(const Derived &A, const Result &Svd, double Tolerance) {
+  const size_t nThin = std::min(A.RowCount(), A.ColCount());
+  REQUIRE(Svd.Values.size() == nThin);
+  REQUIRE(Svd.U.RowCount() == A.RowCount());
+  REQUIRE(Svd.U.ColCount() == nThin);
+  REQUIRE(Svd.V.RowCount() == A.ColCount());
+  REQUIRE(Svd.V.ColCount() == nThin);
+  for (size_t k = 0; k < nThin; ++k) {
+    CHECK(Svd.Values[k] >= 0);
+    if (k > 0)
+      CHECK(Svd.Values[k - 1] >= Svd.Values[k]);
+  }
+  const double nScale = static_cast<double>(std::max(A.RowCount(), A.ColCount()));
+  CHECK(ReconstructionError(A, Svd) <= Tolerance * nScale);
+  CHECK(OrthogonalityError(Svd.U) <= Tolerance * nScale);
+  CHECK(OrthogonalityError(Svd.V) <= Tolerance * nScale);
+}
+
+template <size_t Options_> void CheckRandom(size_t nRows, size_t nCols) {
+  const auto A = MafsTests::RandomMatrix<double, Options_>(nRows, nCols, 5);
+  const auto Svd = Mafs::Internal::MtxOperation.Svd(A);
+  CheckSvd(A, Svd, 1e-14);
+
+  // Sum of the squared singular values = squared Frobenius norm.
+  double Frobenius = 0, Sum = 0;
+  for (size_t i = 0; i < nRows; ++i)
+    for (size_t j = 0; j < nCols; ++j)
+      Frobenius += A(i, j) * A(i, j);
+  for (const double Value : Svd.Values)
+    Sum += Value * Value;
+  CHECK(Sum == doctest::Approx(Frobenius));
+
+  const auto Values = Mafs::Internal::MtxOperation.Svd(A, Mafs::MtxSvdValues);
+  CHECK(Values.U.Size() == 0);
+  CHECK(Values.V.Size() == 0);
+  REQUIRE(Values.Values.size() == Svd.Values.size());
+  for (size_t i = 0; i < Svd.Values.size(); ++i)
+    CHECK(Values.Values[i] == doctest::Approx(Svd.Values[i]).epsilon(1e-10));
+}
+
+// Rank nRank matrix with singular values 2^-k plus noise of magnitude Noise.
+template <size_t Options_>
+auto LowRank(size_t nRows, size_t nCols, size_t nRank, double Noise)
+    -> Mafs::Matrix<double, 0, 0, Options_> {
+  const auto U = MafsTests::RandomMatrix<double, Options_>(nRows, nRank, 1);
+  const auto V = MafsTests::RandomMatrix<double, Options_>(nCols, nRank, 2);
+  auto A = MafsTests::RandomMatrix<double, Options_>(nRows, nCols, 3);
+  for (size_t i = 0; i < nRows; ++i)
+    for (size_t j = 0; j < nCols; ++j) {
+      A(i, j) *= Noise;
+      for (size_t k = 0; k < nRank; ++k)
+        A(i, j) += U(i, k) * V(j, k) * std::ldexp(1.0, -static_cast<int>(k));
+    }
+  return A;
+}
+
+template <size_t Options_> void CheckRandomized() {
+  const auto A = LowRank<Options_>(300, 120, 8, 1e-10);
+  const auto Exact = Mafs::Internal::MtxOperation.Svd(A, Mafs::MtxSvdValues);
+  const auto Approx = Mafs::Internal::MtxOperation.RandomizedSvd(A, 8);
+  REQUIRE(Approx.Values.size() == 8);
+  REQUIRE(Approx.U.RowCount() == 300);
+  REQUIRE(Approx.U.ColCount() == 8);
+  REQUIRE(Approx.V.RowCount() == 120);
+  REQUIRE(Approx.V.ColCount() == 8);
+  for (size_t k = 0; k < 8; ++k)
+    CHECK(Approx.Values[k] == doctest::Approx(Exact.Values[k]).epsilon(1e-8));
+  CHECK(ReconstructionError(A, Approx) <= 1e-8);
+  CHECK(OrthogonalityError(Approx.U) <= 1e-12);
+  CHECK(OrthogonalityError(Approx.V) <= 1e-12);
+
+  // Leading values of a full rank matrix, the same for a given seed.
+  const auto B = MafsTests::RandomMatrix<double, Options_>(90, 70, 9);
+  const auto Top = Mafs::Internal::MtxOperation.RandomizedSvd(B, 3, 20, 4, 42);
+  const auto Again = Mafs::Internal::MtxOperation.RandomizedSvd(B, 3, 20, 4, 42);
+  const auto All = Mafs::Internal::MtxOperation.Svd(B, Mafs::MtxSvdValues);
+  for (size_t k = 0; k < 3; ++k) {
+    CHECK(Top.Values[k] == doctest::Approx(All.Values[k]).epsilon(1e-3));
+    CHECK(Top.Values[k] == Again.Values[k]);
+  }
+}
+}; // namespace
+
+TEST_CASE("Singular value decomposition") {
+  MafsTests::TuningParamsGuard Guard;
+  for (const bool bParallel : {false, true}) {
+    if (bParallel) {
+      // Narrow panels and blocks so every blocked and threaded path runs.
+      Mafs::MtxTuningParams Params;
+      Params.nTransposeBlock = 3;
+      Params.nLUBlock = 8;
+      Params.nGemmBlockM = 16;
+      Params.nParallelThreshold = 0;
+      Params.nThreads = 3;
+      Guard.Set(Params);
+    }
+    CheckRandom<Mafs::MtxRowMajor>(120, 45);
+    CheckRandom<Mafs::MtxColMajor>(30, 75);
+    CheckRandom<Mafs::MtxRowMajor>(40, 40);
+    CheckRandom<Mafs::MtxColMajor>(5, 1);
+    CheckRandomized<Mafs::MtxRowMajor>();
+    CheckRandomized<Mafs::MtxColMajor>();
+  }
+}
+
+TEST_CASE("Singular value decomposition of rank deficient matrices") {
+  // Rank 5: the other singular values vanish and their vectors stay orthonormal.
+  const auto A = LowRank<Mafs::MtxRowMajor>(60, 35, 5, 0);
+  const auto Svd = Mafs::Internal::MtxOperation.Svd(A);
+  CheckSvd(A, Svd, 1e-14);
+  for (size_t k = 5; k < 35; ++k)
+    CHECK(Svd.Values[k] <= 1e-13 * Svd.Values[0]);
+
+  // Singular values of a symmetric matrix are the magnitudes of its eigenvalues.
+  Mafs::Matrix<double, 0, 0, Mafs::MtxColMajor> Symmetric(50, 50);
+  const auto Random = MafsTests::RandomMatrix<double, Mafs::MtxColMajor>(50, 50, 4);
+  for (size_t i = 0; i < 50; ++i)
+    for (size_t j = 0; j < 50; ++j)
+      Symmetric(i, j) = Random(i, j) + Random(j, i);
+  auto Eigen = Mafs::Internal::MtxOperation.SymmetricEigen(Symmetric, Mafs::MtxEigenValues);
+  for (double &Value : Eigen.Values)
+    Value = std::abs(Value);
+  std::sort(Eigen.Values.rbegin(), Eigen.Values.rend());
+  const auto Values = Mafs::Internal::MtxOperation.Svd(Symmetric, Mafs::MtxSvdValues);
+  for (size_t k = 0; k < 50; ++k)
+    CHECK(Values.Values[k] == doctest::Approx(Eigen.Values[k]).epsilon(1e-10));
+
+  Mafs::Matrix<double, 0, 0, Mafs::MtxRowMajor> Zero(7, 4);
+  Zero.Fill(0);
+  const auto Null = Mafs::Internal::MtxOperation.Svd(Zero);
+  CheckSvd(Zero, Null, 1e-15);
+  CHECK(Null.Values[0] == 0);
+}
+
+TEST_CASE("Singular value decomposition single precision and errors") {
+  const auto A = MafsTests::RandomMatrix<float, Mafs::MtxRowMajor>(64, 48, 8);
+  CheckSvd(A, Mafs::Internal::MtxOperation.Svd(A), 1e-6);
+
+  Mafs::Matrix<double, 0, 0, Mafs::MtxRowMajor> Empty;
+  CHECK(Mafs::Internal::MtxOperation.Svd(Empty).Values.empty());
+  Mafs::Matrix<double, 2, 3, Mafs::MtxRowMajor> Infinite;
+  Infinite.Fill(std::numeric_limits<double>::infinity());
+  REQUIRE_THROWS_AS(Mafs::Internal::MtxOperation.Svd(Infinite), std::domain_error);
+  const auto B = MafsTests::RandomMatrix<double, Mafs::MtxRowMajor>(10, 6, 1);
+  REQUIRE_THROWS_AS(Mafs::Internal::MtxOperation.RandomizedSvd(B, 0), std::domain_error);
+  REQUIRE_THROWS_AS(Mafs::Internal::MtxOperation.RandomizedSvd(B, 7), std::domain_error);
+}
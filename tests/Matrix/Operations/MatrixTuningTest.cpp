@@ -0,0 +1,164 @@
+/*********************************************************************************
+ * MatrixTuningTest.cpp
+ * It has tests for the blocked kernels, the products/transposes using them and the tuning cache.
+ *********************************************************************************/
+
+#include <Mafs/Matrix/Matrix.hpp>
+#include <Mafs/Matrix/Operations/Operations.hpp>
+#include <TestHelpers.hpp>
+#include <doctest/doctest.h>
+#include <filesystem>
+#include <thread>
+#include <vector>
+
+using MafsTests::RandomVector;
+using MafsTests::SmallBlocks;
+
+TEST_CASE("Blocked kernels match the reference kernels") {
+  const size_t nM = 13, nN = 11, nK = 17;
+  const auto A = RandomVector(nM * nK, 1), B = RandomVector(nK * nN, 2);
+  std::vector<double> C(nM * nN, 1.0), Expected(nM * nN, 1.0);
+  Mafs::Internal::Kernels::Gemm(nM, nN, nK, 0.5, A.data(), nK, B.data(), nN, Expected.data(), nN);
+  Mafs::Internal::Kernels::GemmBlocked(nM, nN, nK, 0.5, A.data(), nK, B.data(), nN, C.data(), nN,
+                                       SmallBlocks());
+  for (size_t i = 0; i < C.size(); ++i)
+    REQUIRE(C[i] == doctest::Approx(Expected[i]));
+
+  std::vector<double> T(nK * nM);
+  Mafs::Internal::Kernels::TransposeBlocked(nM, nK, A.data(), nK, T.data(), nM, SmallBlocks());
+  for (size_t i = 0; i < nM; ++i)
+    for (size_t j = 0; j < nK; ++j)
+      REQUIRE(T[j * nM + i] == A[i * nK + j]);
+
+  const size_t nSize = 15;
+  std::vector<double> LU = RandomVector(nSize * nSize, 3), BlockedLU = LU;
+  std::vector<size_t> Pivots(nSize), BlockedPivots(nSize);
+  REQUIRE(Mafs::Internal::Kernels::LUFactor(LU.data(), nSize, Pivots.data()));
+  REQUIRE(Mafs::Internal::Kernels::LUFactorBlocked(BlockedLU.data(), nSize, BlockedPivots.data(),
+                                                   SmallBlocks()));
+  CHECK(Pivots == BlockedPivots);
+  for (size_t i = 0; i < LU.size(); ++i)
+    REQUIRE(BlockedLU[i] == doctest::Approx(LU[i]));
+
+  std::vector<double> Singular(nSize * nSize, 1.0);
+  CHECK_FALSE(Mafs::Internal::Kernels::LUFactorBlocked(Singular.data(), nSize,
+                                                       BlockedPivots.data(), SmallBlocks()));
+}
+
+TEST_CASE("Multiplication and Transpose") {
+  MafsTests::TuningParamsGuard Guard(SmallBlocks());
+
+  Mafs::Matrix<double, 0, 0, Mafs::MtxRowMajor> A(7, 9);
+  Mafs::Matrix<double, 0, 0, Mafs::MtxColMajor> B(9, 6);
+  const auto ValuesA = RandomVector(A.Size(), 4), ValuesB = RandomVector(B.Size(), 5);
+  std::copy(ValuesA.begin(), ValuesA.end(), A.Data());
+  std::copy(ValuesB.begin(), ValuesB.end(), B.Data());
+
+  auto C = Mafs::Internal::MtxOperation.Multiplication(A, B);
+  REQUIRE(C.RowCount() == 7);
+  REQUIRE(C.ColCount() == 6);
+  for (size_t i = 0; i < 7; ++i)
+    for (size_t j = 0; j < 6; ++j) {
+      double Expected = 0;
+      for (size_t k = 0; k < 9; ++k)
+        Expected += A(i, k) * B(k, j);
+      REQUIRE(C(i, j) == doctest::Approx(Expected));
+    }
+
+  // Col major result and static dimensions.
+  Mafs::Matrix<double, 2, 3, Mafs::MtxColMajor> S;
+  Mafs::Matrix<double, 3, 2, Mafs::MtxRowMajor> R;
+  for (size_t i = 0; i < 2; ++i)
+    for (size_t j = 0; j < 3; ++j) {
+      S(i, j) = static_cast<double>(i + j);
+      R(j, i) = static_cast<double>(i * j + 1);
+    }
+  auto SR = Mafs::Internal::MtxOperation.Multiplication(S, R);
+  static_assert(std::is_same_v<decltype(SR), Mafs::Matrix<double, 2, 2, Mafs::MtxColMajor>>);
+  for (size_t i = 0; i < 2; ++i)
+    for (size_t j = 0; j < 2; ++j) {
+      double Expected = 0;
+      for (size_t k = 0; k < 3; ++k)
+        Expected += S(i, k) * R(k, j);
+      REQUIRE(SR(i, j) == Expected);
+    }
+
+  REQUIRE_THROWS_AS(Mafs::Internal::MtxOperation.Multiplication(A, A), std::domain_error);
+
+  auto AT = Mafs::Internal::MtxOperation.Transpose(A);
+  auto BT = Mafs::Internal::MtxOperation.Transpose(B);
+  auto ST = Mafs::Internal::MtxOperation.Transpose(S);
+  static_assert(std::is_same_v<decltype(ST), Mafs::Matrix<double, 3, 2, Mafs::MtxColMajor>>);
+  REQUIRE(AT.RowCount() == 9);
+  REQUIRE(AT.ColCount() == 7);
+  for (size_t i = 0; i < 7; ++i)
+    for (size_t j = 0; j < 9; ++j) {
+      REQUIRE(AT(j, i) == A(i, j));
+      REQUIRE(BT(i % 6, j) == B(j, i % 6));
+    }
+  for (size_t i = 0; i < 2; ++i)
+    for (size_t j = 0; j < 3; ++j)
+      REQUIRE(ST(j, i) == S(i, j));
+}
+
+TEST_CASE("Tuning cache") {
+  const std::string strPath =
+      (std::filesystem::temp_directory_path() / "mafs_tuning_test" / "tuning.cfg").string();
+  std::filesystem::remove_all(std::filesystem::path(strPath).parent_path());
+
+  Mafs::MtxTuningParams Params, Loaded;
+  REQUIRE_FALSE(Mafs::Internal::LoadTuning(strPath, "Host A", Loaded));
+
+  Params.nGemmBlockM = 7;
+  Params.nLUBlock = 9;
+  Params.nParallelThreshold = 123456789;
+  Mafs::Internal::SaveTuning(strPath, "Host A", Params);
+  Params.nGemmBlockM = 11;
+  Mafs::Internal::SaveTuning(strPath, "Host B", Params);
+  Params.nLUBlock = 13;
+  Mafs::Internal::SaveTuning(strPath, "Host B", Params); // Replaces the section.
+
+  REQUIRE(Mafs::Internal::LoadTuning(strPath, "Host A", Loaded));
+  CHECK(Loaded.nGemmBlockM == 7);
+  CHECK(Loaded.nLUBlock == 9);
+  CHECK(Loaded.nParallelThreshold == 123456789);
+  REQUIRE(Mafs::Internal::LoadTuning(strPath, "Host B", Loaded));
+  CHECK(Loaded.nGemmBlockM == 11);
+  CHECK(Loaded.nLUBlock == 13);
+  CHECK_FALSE(Mafs::Internal::LoadTuning(strPath, "Host C", Loaded));
+  CHECK_FALSE(Mafs::Internal::CpuModel().empty());
+
+  std::filesystem::remove_all(std::filesystem::path(strPath).parent_path());
+}
+
+TEST_CASE("Tuning parameters reach every thread") {
+  MafsTests::TuningParamsGuard Guard;
+  Mafs::MtxTuningParams Params = Guard.Previous();
+  Params.nGemmBlockM = 17;
+  Guard.Set(Params);
+  CHECK(Mafs::Internal::MtxOperation.TuningParams().nGemmBlockM == 17);
+
+  // Each thread reads its own copy, a later Set replaces it.
+  size_t nSeen = 0, nAfterSet = 0;
+  std::thread Reader([&]() {
+    nSeen = Mafs::Internal::MtxOperation.TuningParams().nGemmBlockM;
+    Mafs::MtxTuningParams Changed = Mafs::Internal::MtxOperation.TuningParams();
+    Changed.nGemmBlockM = 19;
+    Mafs::Internal::MtxOperation.SetTuningParams(Changed);
+    nAfterSet = Mafs::Internal::MtxOperation.TuningParams().nGemmBlockM;
+  });
+  Reader.join();
+  CHECK(nSeen == 17);
+  CHECK(nAfterSet == 19);
+  CHECK(Mafs::Internal::MtxOperation.TuningParams().nGemmBlockM == 19);
+}
+
+TEST_CASE("Auto tune") {
+  const Mafs::MtxTuningParams Params = Mafs::Internal::RunAutoTune(32);
+  CHECK(Params.nGemmBlockM >= 16);
+  CHECK(Params.nGemmBlockN >= 64);
+  CHECK(Params.nGemmBlockK >= 32);
+  CHECK(Params.nTransposeBlock >= 8);
+  CHECK(Params.nLUBlock >= 16);
+  CHECK(Params.nParallelThreshold > 0);
+}
@@ -0,0 +1,130 @@
+/*********************************************************************************
+ * TiledMatrixTest.cpp
+ * It has tests for the out-of-core tiled matrices and their operations.
+ *********************************************************************************/
+
+#include <Mafs/Matrix/Matrix.hpp>
+#include <Mafs/Matrix/Operations/Kernels/LU.hpp>
+#include <Mafs/Matrix/OutOfCore/TiledOperations.hpp>
+#include <TestHelpers.hpp>
+#include <doctest/doctest.h>
+#include <filesystem>
+
+typedef Mafs::Matrix<double, 0, 0, Mafs::MtxRowMajor> DynMatrix;
+
+static std::string TempPath(const std::string &strName) {
+  return (std::filesystem::temp_directory_path() / strName).string();
+}
+
+// Budget of a few 4x4 double tiles, way smaller than the matrices.
+constexpr size_t nTile = 4;
+constexpr size_t nBudget = 6 * nTile * nTile * sizeof(double);
+
+TEST_CASE("Tiled matrix element access and eviction") {
+  const std::string strPath = TempPath("mafs_tiled_access.bin");
+  {
+    Mafs::OutOfCore::TiledMatrix<double> Matrix(strPath, 10, 9, nTile, nBudget);
+    REQUIRE(Matrix.TileRowCount() == 3);
+    REQUIRE(Matrix.TileColCount() == 3);
+    REQUIRE(Matrix.TileRows(2) == 2);
+    REQUIRE(Matrix.TileCols(2) == 1);
+
+    for (size_t i = 0; i < 10; ++i)
+      for (size_t j = 0; j < 9; ++j)
+        Matrix.Set(i, j, static_cast<double>(i * 100 + j));
+    // Every tile has been touched, most of them were evicted and written back.
+    for (size_t i = 0; i < 10; ++i)
+      for (size_t j = 0; j < 9; ++j)
+        REQUIRE(Matrix.Get(i, j) == static_cast<double>(i * 100 + j));
+
+    REQUIRE_THROWS(Matrix.Get(10, 0));
+  }
+  std::filesystem::remove(strPath);
+}
+
+TEST_CASE("Tiled matrix reopened from its file") {
+  const DynMatrix A = MafsTests::RandomMatrix<double>(9, 6, 4);
+  const std::string strPath = TempPath("mafs_tiled_open.bin");
+  {
+    Mafs::OutOfCore::TiledMatrix<double> Matrix(strPath, 9, 6, nTile, nBudget);
+    Matrix.Assign(A);
+  }
+  {
+    Mafs::OutOfCore::TiledMatrix<double> Matrix(strPath, 9, 6, nTile, nBudget,
+                                                Mafs::OutOfCore::MtxTiledOpen);
+    for (size_t i = 0; i < 9; ++i)
+      for (size_t j = 0; j < 6; ++j)
+        REQUIRE(Matrix.Get(i, j) == A(i, j));
+    Matrix.Set(8, 5, -1.0);
+  }
+  const DynMatrix B = Mafs::OutOfCore::TiledMatrix<double>(strPath, 9, 6, nTile, nBudget,
+                                                            Mafs::OutOfCore::MtxTiledOpen)
+                          .ToMatrix<DynMatrix>();
+  CHECK(B(8, 5) == -1.0);
+  CHECK(B(0, 0) == A(0, 0));
+
+  // 9 x 9 needs 9 tiles, the file has 6.
+  REQUIRE_THROWS_AS(Mafs::OutOfCore::TiledMatrix<double>(strPath, 9, 9, nTile, nBudget,
+                                                          Mafs::OutOfCore::MtxTiledOpen),
+                    std::runtime_error);
+  std::filesystem::remove(strPath);
+  REQUIRE_THROWS_AS(Mafs::OutOfCore::TiledMatrix<double>(strPath, 9, 6, nTile, nBudget,
+                                                          Mafs::OutOfCore::MtxTiledOpen),
+                    std::runtime_error);
+}
+
+TEST_CASE("Tiled multiplication and transpose") {
+  const DynMatrix A = MafsTests::RandomMatrix<double>(10, 7, 1);
+  const DynMatrix B = MafsTests::RandomMatrix<double>(7, 9, 2);
+  const std::string strA = TempPath("mafs_tiled_a.bin"), strB = TempPath("mafs_tiled_b.bin"),
+                    strC = TempPath("mafs_tiled_c.bin"), strT = TempPath("mafs_tiled_t.bin");
+  {
+    Mafs::OutOfCore::TiledMatrix<double> TiledA(strA, 10, 7, nTile, nBudget);
+    Mafs::OutOfCore::TiledMatrix<double> TiledB(strB, 7, 9, nTile, nBudget);
+    Mafs::OutOfCore::TiledMatrix<double> TiledC(strC, 10, 9, nTile, nBudget);
+    Mafs::OutOfCore::TiledMatrix<double> TiledT(strT, 7, 10, nTile, nBudget);
+    TiledA.Assign(A);
+    TiledB.Assign(B);
+
+    Mafs::OutOfCore::Multiplication(TiledA, TiledB, TiledC);
+    Mafs::OutOfCore::Transpose(TiledA, TiledT);
+    REQUIRE_THROWS(Mafs::OutOfCore::Multiplication(TiledA, TiledA, TiledC));
+
+    const DynMatrix C = TiledC.ToMatrix<DynMatrix>();
+    for (size_t i = 0; i < 10; ++i)
+      for (size_t j = 0; j < 9; ++j) {
+        double Expected = 0;
+        for (size_t k = 0; k < 7; ++k)
+          Expected += A(i, k) * B(k, j);
+        REQUIRE(C(i, j) == doctest::Approx(Expected));
+      }
+
+    for (size_t i = 0; i < 10; ++i)
+      for (size_t j = 0; j < 7; ++j)
+        REQUIRE(TiledT.Get(j, i) == A(i, j));
+  }
+  for (const auto &strPath : {strA, strB, strC, strT})
+    std::filesystem::remove(strPath);
+}
+
+TEST_CASE("Tiled LU decomposition") {
+  constexpr size_t nSize = 11;
+  DynMatrix A = MafsTests::RandomMatrix<double>(nSize, nSize, 3);
+  const std::string strPath = TempPath("mafs_tiled_lu.bin");
+  {
+    Mafs::OutOfCore::TiledMatrix<double> Tiled(strPath, nSize, nSize, nTile,
+                                               12 * nTile * nTile * sizeof(double));
+    Tiled.Assign(A);
+    std::vector<size_t> Pivots;
+    Mafs::OutOfCore::LUDecomposition(Tiled, Pivots);
+
+    // Same factors and pivots as the in memory decomposition.
+    std::vector<size_t> Expected(nSize);
+    REQUIRE(Mafs::Internal::Kernels::LUFactor(A.Data(), nSize, Expected.data()));
+    REQUIRE(Pivots == Expected);
+    for (size_t i = 0; i < nSize; ++i)
+      for (size_t j = 0; j < nSize; ++j)
+        REQUIRE(Tiled.Get(i, j) == doctest::Approx(A(i, j)));
+  }
+  std::filesystem::remove(strPath);
+}
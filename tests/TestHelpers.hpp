@@ -0,0 +1,94 @@
+/*********************************************************************************
+ * TestHelpers.hpp
+ * It has the fixtures shared by the test files.
+ *********************************************************************************/
+
+#ifndef MAFS_TESTS_TEST_HELPERS_H
+#define MAFS_TESTS_TEST_HELPERS_H
+
+#include <Mafs/Matrix/Matrix.hpp>
+#include <Mafs/Matrix/Operations/Operations.hpp>
+#include <random>
+#include <vector>
+
+namespace MafsTests {
+/**
+ * @brief nSize values uniform in [-1, 1), the same for a given nSeed.
+ */
+inline auto RandomVector(size_t nSize, unsigned nSeed) -> std::vector<double> {
+  std::mt19937 Generator(nSeed);
+  std::uniform_real_distribution<double> Distribution(-1, 1);
+  std::vector<double> Values(nSize);
+  for (auto &Value : Values)
+    Value = Distribution(Generator);
+  return Values;
+}
+
+/**
+ * @brief nRows x nCols matrix of values uniform in [-Scale, Scale), the same for a given nSeed.
+ */
+template <typename T, size_t Options_ = Mafs::MtxRowMajor>
+auto RandomMatrix(size_t nRows, size_t nCols, double Scale, unsigned nSeed)
+    -> Mafs::Matrix<T, 0, 0, Options_> {
+  std::mt19937 Generator(nSeed);
+  std::uniform_real_distribution<double> Distribution(-Scale, Scale);
+  Mafs::Matrix<T, 0, 0, Options_> Matrix(nRows, nCols);
+  for (size_t i = 0; i < nRows; ++i)
+    for (size_t j = 0; j < nCols; ++j)
+      Matrix(i, j) = static_cast<T>(Distribution(Generator));
+  return Matrix;
+}
+
+/**
+ * @brief nRows x nCols matrix of values uniform in [-1, 1), the same for a given nSeed.
+ */
+template <typename T, size_t Options_ = Mafs::MtxRowMajor>
+auto RandomMatrix(size_t nRows, size_t nCols, unsigned nSeed) -> Mafs::Matrix<T, 0, 0, Options_> {
+  return RandomMatrix<T, Options_>(nRows, nCols, 1.0, nSeed);
+}
+
+/**
+ * @brief Small odd blocks and every product split among threads, so every edge case of the
+ * blocked kernels is exercised.
+ */
+inline auto SmallBlocks() -> Mafs::MtxTuningParams {
+  Mafs::MtxTuningParams Params;
+  Params.nGemmBlockM = 3;
+  Params.nGemmBlockN = 5;
+  Params.nGemmBlockK = 4;
+  Params.nTransposeBlock = 3;
+  Params.nLUBlock = 4;
+  Params.nParallelThreshold = 0;
+  Params.nThreads = 3;
+  return Params;
+}
+
+/**
+ * @brief Restores the process tuning parameters when it goes out of scope, so the parameters set
+ * by a test don't leak into the next ones even if one of its REQUIREs fails.
+ */
+class TuningParamsGuard {
+protected:
+  Mafs::MtxTuningParams m_Previous;
+
+public:
+  TuningParamsGuard() : m_Previous(Mafs::Internal::MtxOperation.TuningParams()) {}
+  explicit TuningParamsGuard(const Mafs::MtxTuningParams &Params) : TuningParamsGuard() {
+    Set(Params);
+  }
+  TuningParamsGuard(const TuningParamsGuard &) = delete;
+  TuningParamsGuard &operator=(const TuningParamsGuard &) = delete;
+  ~TuningParamsGuard() { Mafs::Internal::MtxOperation.SetTuningParams(m_Previous); }
+
+  void Set(const Mafs::MtxTuningParams &Params) {
+    Mafs::Internal::MtxOperation.SetTuningParams(Params);
+  }
+
+  /**
+   * @brief Parameters in use when the guard was created.
+   */
+  inline auto Previous() const -> const Mafs::MtxTuningParams & { return m_Previous; }
+};
+}; // namespace MafsTests
+
+#endif // MAFS_TESTS_TEST_HELPERS_H
@@ -0,0 +1,79 @@
+/*********************************************************************************
+ * InstrumentationTest.cpp
+ * It has tests for the operation/allocation statistics.
+ *********************************************************************************/
+
+#include <Mafs/Matrix/Matrix.hpp>
+#include <Mafs/Matrix/Operations/Operations.hpp>
+#include <Mafs/Utils/Instrumentation.hpp>
+#include <doctest/doctest.h>
+#include <thread>
+#include <vector>
+
+TEST_CASE("Instrumentation") {
+  Mafs::ResetStats();
+  {
+    Mafs::Matrix<double, Mafs::MtxDynamic, Mafs::MtxDynamic, Mafs::MtxRowMajor> A(4, 8);
+    Mafs::Matrix<double, Mafs::MtxDynamic, Mafs::MtxDynamic, Mafs::MtxRowMajor> B(4, 8);
+    A.Fill(1);
+    B.Fill(2);
+    auto C = Mafs::Internal::MtxOperation.Sum(A, B);
+    CHECK(C(3, 7) == 3);
+    auto D = Mafs::Internal::MtxOperation.Sum(C, B);
+    CHECK(D(0, 0) == 5);
+  }
+
+  const Mafs::MtxOpStats Sum =
+      Mafs::OperationStats(Mafs::Internal::MatrixOperations::BackendName(), "Sum");
+  const Mafs::MtxAllocStats Allocs = Mafs::AllocationStats();
+#ifdef MAFS_ENABLE_INSTRUMENTATION
+  CHECK(Sum.nCalls == 2);
+  CHECK(Sum.nElements == 64);
+  CHECK(Sum.Flops == 64);
+  CHECK(Sum.Bytes == 2 * 3 * 32 * sizeof(double));
+  CHECK(Sum.Seconds >= 0);
+  CHECK(Allocs.nAllocs >= 4);
+  CHECK(Allocs.nBytes == 4 * 32 * sizeof(double)); // Only the values, no swap arrays.
+  CHECK(Mafs::DumpStats().find("Basic::Sum") != std::string::npos);
+#else
+  CHECK(Sum.nCalls == 0);
+  CHECK(Allocs.nAllocs == 0);
+  CHECK(Mafs::OperationStats().empty());
+#endif
+
+  Mafs::ResetStats();
+  CHECK(Mafs::OperationStats().empty());
+  CHECK(Mafs::AllocationStats().nAllocs == 0);
+}
+
+TEST_CASE("Instrumentation from several threads") {
+  Mafs::ResetStats();
+  const auto Work = []() {
+    Mafs::Matrix<double, Mafs::MtxDynamic, Mafs::MtxDynamic, Mafs::MtxRowMajor> A(2, 3);
+    A.Fill(1);
+    for (size_t i = 0; i < 10; ++i)
+      A = Mafs::Internal::MtxOperation.Sum(A, A);
+    CHECK(A(1, 2) == 1024);
+  };
+  std::vector<std::thread> Threads;
+  for (size_t t = 0; t < 4; ++t)
+    Threads.emplace_back(Work);
+  Work(); // The main thread records too, the others are merged when they exit.
+  for (auto &Thread : Threads)
+    Thread.join();
+
+  const Mafs::MtxOpStats Sum =
+      Mafs::OperationStats(Mafs::Internal::MatrixOperations::BackendName(), "Sum");
+  const Mafs::MtxAllocStats Allocs = Mafs::AllocationStats();
+#ifdef MAFS_ENABLE_INSTRUMENTATION
+  CHECK(Sum.nCalls == 50);
+  CHECK(Sum.nElements == 50 * 6);
+  CHECK(Allocs.nAllocs >= 55);
+  CHECK(Allocs.nFrees >= 55);
+  CHECK(Allocs.nLiveBytes >= 0);
+#else
+  CHECK(Sum.nCalls == 0);
+  CHECK(Allocs.nAllocs == 0);
+#endif
+  Mafs::ResetStats();
+}
@@ -0,0 +1,131 @@
+/*********************************************************************************
+ * MemoryTest.cpp
+ * It has tests for the container allocation policies.
+ *********************************************************************************/
+
+#include <Mafs/Matrix/Matrix.hpp>
+#include <Mafs/Matrix/Operations/Operations.hpp>
+#include <Mafs/Utils/Memory.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <doctest/doctest.h>
+#include <thread>
+#include <vector>
+
+TEST_CASE("Memory policy") {
+  const Mafs::MtxMemoryPolicy Previous = Mafs::MemoryPolicy();
+  CHECK(Mafs::NumaNodeCount() >= 1);
+  CHECK(Previous.eNuma == Mafs::MtxNumaLocal);
+
+  for (Mafs::MtxNumaPolicy eNuma : {Mafs::MtxNumaInterleave, Mafs::MtxNumaPartition}) {
+    Mafs::SetMemoryPolicy({eNuma, 1024, Mafs::MtxHugePagesOff, size_t(1) << 25});
+    CHECK(Mafs::Internal::UseMappedMemory(4096));
+    CHECK_FALSE(Mafs::Internal::UseMappedMemory(512));
+
+    // Mapped (above the threshold) and regular containers.
+    Mafs::Matrix<double, 0, 0, Mafs::MtxRowMajor> A(64, 48), B(64, 48), Small(4, 4);
+    A.Fill(1);
+    B.Fill(2);
+    Small.Fill(3);
+    auto C = Mafs::Internal::MtxOperation.Sum(A, B);
+    CHECK(C(63, 47) == 3);
+    auto BT = Mafs::Internal::MtxOperation.Transpose(B);
+    auto D = Mafs::Internal::MtxOperation.Multiplication(A, BT);
+    CHECK(D(10, 20) == 2 * 48);
+    auto SmallCopy(Small);
+    CHECK(SmallCopy(3, 3) == 3);
+
+    // Every value of a mapped container is visited once with the placement of its pages.
+    Mafs::Matrix<double, 0, 0, Mafs::MtxRowMajor> Visited(64, 48);
+    Visited.Fill(0);
+    double *pVisited = Visited.Data();
+    Mafs::Internal::Kernels::ParallelFor(
+        Visited.Size(), 4,
+        [&](size_t nBegin, size_t nEnd) {
+          for (size_t i = nBegin; i < nEnd; ++i)
+            pVisited[i]++;
+        },
+        pVisited, sizeof(double));
+    CHECK(Visited.Sum() == 64 * 48);
+  }
+
+  // Other threads see the policy of the last Set.
+  Mafs::SetMemoryPolicy({Mafs::MtxNumaInterleave, 4096, Mafs::MtxHugePagesOff, size_t(1) << 25});
+  size_t nThreshold = 0;
+  std::thread([&]() { nThreshold = Mafs::MemoryPolicy().nNumaThreshold; }).join();
+  CHECK(nThreshold == 4096);
+
+  Mafs::SetMemoryPolicy(Previous);
+  CHECK_FALSE(Mafs::Internal::UseMappedMemory(size_t(1) << 40));
+}
+
+TEST_CASE("NUMA partitions") {
+  // 10 pages of 4096 bytes on 2 nodes: node 1 holds the pages [5, 10).
+  const Mafs::Internal::NumaPartition Partition = {10 * 4096, 4096, 2};
+  CHECK(Mafs::Internal::PartitionBegin(0, Partition, 0, 8, 5120) == 0);
+  CHECK(Mafs::Internal::PartitionBegin(1, Partition, 0, 8, 5120) == 2560);
+  CHECK(Mafs::Internal::PartitionBegin(2, Partition, 0, 8, 5120) == 5120);
+  // Units straddling the block boundary stay on the node of their start.
+  CHECK(Mafs::Internal::PartitionBegin(1, Partition, 100, 8, 5000) == 2548);
+  CHECK(Mafs::Internal::PartitionBegin(1, Partition, 100, 8, 1000) == 1000);
+  CHECK(Mafs::Internal::PartitionBegin(1, Partition, 30000, 8, 1000) == 0);
+  // 3 nodes: the blocks start at the pages 0, 3 and 6.
+  const Mafs::Internal::NumaPartition Thirds = {10 * 4096, 4096, 3};
+  CHECK(Mafs::Internal::PartitionBegin(1, Thirds, 0, 4096, 10) == 3);
+  CHECK(Mafs::Internal::PartitionBegin(2, Thirds, 0, 4096, 10) == 6);
+
+  // A registered mapping is found from any of its bytes, and the chunks of a ParallelFor over it
+  // follow its blocks.
+  std::vector<int> Data(10 * 1024, 0);
+  Mafs::Internal::NumaPartitions &Partitions = Mafs::Internal::NumaPartitions::Instance();
+  Partitions.Add(Data.data(), Partition);
+  Mafs::Internal::NumaPartition Found;
+  size_t nOffset = 0;
+  REQUIRE(Partitions.Find(Data.data() + 1500, Found, nOffset));
+  CHECK(nOffset == 1500 * sizeof(int));
+  CHECK(Found.nNodes == 2);
+  CHECK_FALSE(Partitions.Find(Data.data() + Data.size(), Found, nOffset));
+
+  std::vector<int> Visited(Data.size(), 0);
+  std::atomic<bool> bSplit = true;
+  Mafs::Internal::Kernels::ParallelFor(
+      Visited.size(), 4,
+      [&](size_t nBegin, size_t nEnd) {
+        for (size_t i = nBegin; i < nEnd; ++i)
+          Visited[i]++;
+        if (nBegin < 5120 && nEnd > 5120)
+          bSplit = false;
+      },
+      Data.data(), sizeof(int));
+  CHECK(std::count(Visited.begin(), Visited.end(), 1) == static_cast<long>(Visited.size()));
+#ifdef MAFS_ENABLE_THREADS
+  CHECK(bSplit);
+#endif
+
+  Partitions.Remove(Data.data());
+  CHECK_FALSE(Partitions.Find(Data.data() + 1500, Found, nOffset));
+}
+
+TEST_CASE("Huge pages") {
+  const Mafs::MtxMemoryPolicy Previous = Mafs::MemoryPolicy();
+  for (Mafs::MtxHugePageMode eHugePages :
+       {Mafs::MtxHugePagesTransparent, Mafs::MtxHugePagesExplicit}) {
+    Mafs::MtxMemoryPolicy Policy;
+    Policy.eHugePages = eHugePages;
+    Policy.nHugePageThreshold = size_t(1) << 20;
+    Mafs::SetMemoryPolicy(Policy);
+    CHECK(Mafs::Internal::UseMappedMemory(size_t(1) << 20));
+    CHECK_FALSE(Mafs::Internal::UseMappedMemory(1024));
+
+    // 3 MB, rounded to 2 huge pages and aligned on them (explicit pages fall back to transparent
+    // ones when none are reserved).
+    Mafs::Matrix<double, 0, 0, Mafs::MtxColMajor> A(512, 768);
+    CHECK(reinterpret_cast<uintptr_t>(A.Data()) % Mafs::Internal::nHugePageSize == 0);
+    A.Fill(2);
+    auto AT = Mafs::Internal::MtxOperation.Transpose(A);
+    CHECK(AT(767, 511) == 2);
+    CHECK(reinterpret_cast<uintptr_t>(AT.Data()) % Mafs::Internal::nHugePageSize == 0);
+  }
+  Mafs::SetMemoryPolicy(Previous);
+}
@@ -0,0 +1,95 @@
+/*********************************************************************************
+ * PerfCountersTest.cpp
+ * It has tests for the hardware performance counter scopes.
+ *********************************************************************************/
+
+#include <Mafs/Matrix/Matrix.hpp>
+#include <Mafs/Matrix/Operations/Operations.hpp>
+#include <Mafs/Utils/PerfCounters.hpp>
+#include <doctest/doctest.h>
+
+TEST_CASE("PerfScope") {
+  Mafs::ResetPerfCounterStats();
+  Mafs::MtxPerfCounters Outer, Inner;
+  volatile double Accumulator = 0;
+  {
+    Mafs::PerfScope OuterScope(Outer);
+    {
+      Mafs::PerfScope InnerScope(Inner);
+      for (int i = 0; i < 100000; ++i)
+        Accumulator = Accumulator + i;
+    }
+    Mafs::PerfScope NamedScope("Loop");
+    for (int i = 0; i < 1000; ++i)
+      Accumulator = Accumulator + i;
+  }
+
+  // The counters may be unavailable (permissions, containers), then everything reads zero.
+  CHECK(Outer.bValid == Mafs::PerfCountersAvailable());
+  CHECK(Inner.bValid == Mafs::PerfCountersAvailable());
+  CHECK(Outer.nScopes == 1);
+  CHECK(Outer.nCycles >= Inner.nCycles);
+  CHECK(Outer.nInstructions >= Inner.nInstructions);
+  if (Mafs::PerfCountersAvailable())
+    CHECK(Inner.nInstructions > 100000);
+  else
+    CHECK(Inner.nInstructions == 0);
+
+  auto Stats = Mafs::PerfCounterStats();
+  REQUIRE(Stats.count("Loop") == 1);
+  CHECK(Stats["Loop"].nScopes == 1);
+  CHECK(Mafs::DumpPerfCounterStats().find("Loop") != std::string::npos);
+
+  Mafs::ResetPerfCounterStats();
+  CHECK(Mafs::PerfCounterStats().empty());
+}
+
+TEST_CASE("PerfScope operations") {
+  Mafs::ResetPerfCounterStats();
+  {
+    Mafs::Matrix<float, 8, 8, Mafs::MtxRowMajor> A, B;
+    A.Fill(1);
+    B.Fill(2);
+    auto C = Mafs::Internal::MtxOperation.Sum(A, B);
+    CHECK(C(7, 7) == 3);
+  }
+  const std::string strKey =
+      fmt::format("{}::Sum", Mafs::Internal::MatrixOperations::BackendName());
+#ifdef MAFS_ENABLE_PERF_COUNTERS
+  CHECK(Mafs::PerfCounterStats()[strKey].nScopes == 1);
+#else
+  CHECK(Mafs::PerfCounterStats().count(strKey) == 0);
+#endif
+}
+
+TEST_CASE("PerfScope counts the parallel workers") {
+  // The same work serially and split among 4 threads: the workers' events are credited to the
+  // scope of the caller, so both count about the same instructions.
+  const auto Work = [](size_t nBegin, size_t nEnd) {
+    volatile double Accumulator = 0;
+    for (size_t i = nBegin; i < nEnd; ++i)
+      Accumulator = Accumulator + static_cast<double>(i);
+  };
+  Mafs::MtxPerfCounters Serial, Threaded, Outer;
+  {
+    Mafs::PerfScope Scope(Serial);
+    Mafs::Internal::Kernels::ParallelFor(400000, 1, Work);
+  }
+  {
+    Mafs::PerfScope OuterScope(Outer);
+    {
+      Mafs::PerfScope Scope(Threaded);
+      Mafs::Internal::Kernels::ParallelFor(400000, 4, Work);
+    }
+  }
+  CHECK(Mafs::PerfScope::Current() == nullptr);
+
+  if (Mafs::PerfCountersAvailable()) {
+    CHECK(Threaded.nInstructions > Serial.nInstructions / 10 * 9);
+    // The nested scope passed the workers' events on.
+    CHECK(Outer.nInstructions >= Threaded.nInstructions);
+  } else {
+    CHECK_FALSE(Threaded.bValid);
+    CHECK(Threaded.nInstructions == 0);
+  }
+}
@@ -0,0 +1,128 @@
+/*********************************************************************************
+ * WorkspaceTest.cpp
+ * It has tests for the thread local scratch workspace and its reuse by the parallel kernels.
+ *********************************************************************************/
+
+#include <Mafs/Matrix/Matrix.hpp>
+#include <Mafs/Matrix/Operations/Operations.hpp>
+#include <Mafs/Utils/Workspace.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <doctest/doctest.h>
+#include <stdexcept>
+#include <string>
+
+TEST_CASE("Scratch workspace") {
+  Mafs::ReleaseScratch();
+  CHECK(Mafs::ScratchCapacity() == 0);
+  {
+    Mafs::Internal::ScratchBuffer<double> A(100);
+    Mafs::Internal::ScratchBuffer<float> B(3);
+    CHECK(reinterpret_cast<uintptr_t>(A.Data()) % 64 == 0);
+    CHECK(reinterpret_cast<uintptr_t>(B.Data()) % 64 == 0);
+    CHECK(static_cast<const void *>(B.Data()) != static_cast<const void *>(A.Data()));
+    A[99] = 1.5;
+    B[2] = 2.5f;
+    CHECK(A[99] == 1.5);
+
+    // B is on top of the stack: resizing it reuses its space.
+    const float *pB = B.Data();
+    B.Resize(5);
+    CHECK(B.Data() == pB);
+
+    // Larger than the first block: a second block is stacked, A is untouched.
+    const size_t nFirst = Mafs::ScratchCapacity();
+    Mafs::Internal::ScratchBuffer<char> Large(nFirst + 1);
+    CHECK(Mafs::ScratchCapacity() > nFirst);
+    CHECK(A[99] == 1.5);
+  }
+  // Everything was returned: the blocks are merged and the next borrows don't allocate.
+  const size_t nCapacity = Mafs::ScratchCapacity();
+  {
+    Mafs::Internal::ScratchBuffer<char> Large(nCapacity);
+    CHECK(Mafs::ScratchCapacity() == nCapacity);
+  }
+
+  // Types that are not trivially copyable are constructed in a vector.
+  Mafs::Internal::ScratchBuffer<std::string> Strings(2);
+  Strings[1] = "scratch";
+  CHECK(Strings[0].empty());
+  CHECK(Strings[1] == "scratch");
+
+  Mafs::ReleaseScratch();
+  CHECK(Mafs::ScratchCapacity() == 0);
+}
+
+TEST_CASE("Operations borrow the workspace") {
+  // The static containers only hold their values.
+  CHECK(sizeof(Mafs::Matrix<float, 4, 4, Mafs::MtxRowMajor>) == 16 * sizeof(float));
+
+  Mafs::Matrix<double, Mafs::MtxDynamic, Mafs::MtxDynamic, Mafs::MtxColMajor> A(40, 40), B(40, 40);
+  for (size_t i = 0; i < 40; ++i)
+    for (size_t j = 0; j < 40; ++j) {
+      A(i, j) = static_cast<double>(i == j ? 50 : (i + 2 * j) % 7);
+      B(i, j) = static_cast<double>((3 * i + j) % 5);
+    }
+  Mafs::ReleaseScratch();
+  A.SwapCols(1, 3);
+  A.SwapCols(1, 3);
+  auto C = Mafs::Internal::MtxOperation.Multiplication(A, B);
+  auto X = Mafs::Internal::MtxOperation.Solve(A, B);
+  const size_t nCapacity = Mafs::ScratchCapacity();
+  CHECK(nCapacity > 0);
+
+  // Repeated calls reuse the same workspace.
+  for (size_t n = 0; n < 3; ++n) {
+    A.SwapCols(0, 39);
+    A.SwapCols(0, 39);
+    auto D = Mafs::Internal::MtxOperation.Multiplication(A, B);
+    auto Y = Mafs::Internal::MtxOperation.Solve(A, B);
+    CHECK(D(5, 7) == C(5, 7));
+    CHECK(Y(5, 7) == X(5, 7));
+  }
+  CHECK(Mafs::ScratchCapacity() == nCapacity);
+}
+
+TEST_CASE("Parallel kernels reuse their workers") {
+  // Every chunk borrows scratch memory: the workers keep their workspace between the calls, so
+  // the only allocations are the first borrows of each worker.
+  const Mafs::MtxAllocStats Before = Mafs::AllocationStats();
+#if defined(MAFS_ENABLE_INSTRUMENTATION) && defined(MAFS_ENABLE_THREADS)
+  const size_t nWorkers = Mafs::Internal::Kernels::ThreadPool::Instance().WorkerCount();
+#endif
+  std::atomic<size_t> nVisited = 0;
+  for (size_t n = 0; n < 50; ++n)
+    Mafs::Internal::Kernels::ParallelFor(300, 3, [&](size_t nBegin, size_t nEnd) {
+      Mafs::Internal::ScratchBuffer<double> Scratch(1000);
+      Scratch[999] = static_cast<double>(nEnd - nBegin);
+      nVisited += nEnd - nBegin;
+    });
+  CHECK(nVisited == 50 * 300);
+  const Mafs::MtxAllocStats After = Mafs::AllocationStats();
+#if defined(MAFS_ENABLE_INSTRUMENTATION) && defined(MAFS_ENABLE_THREADS)
+  CHECK(After.nAllocs - Before.nAllocs <=
+        1 + Mafs::Internal::Kernels::ThreadPool::Instance().WorkerCount());
+  // 2 helpers per call at most, whatever the number of calls.
+  CHECK(Mafs::Internal::Kernels::ThreadPool::Instance().WorkerCount() <=
+        std::max<size_t>(nWorkers, 2));
+#else
+  CHECK(After.nAllocs - Before.nAllocs <= 1);
+#endif
+
+  // Nested calls run on the worker, exceptions reach the caller.
+  std::atomic<size_t> nInner = 0;
+  Mafs::Internal::Kernels::ParallelFor(4, 4, [&](size_t nBegin, size_t nEnd) {
+    for (size_t i = nBegin; i < nEnd; ++i)
+      Mafs::Internal::Kernels::ParallelFor(10, 4, [&](size_t nFirst, size_t nLast) {
+        nInner += nLast - nFirst;
+      });
+  });
+  CHECK(nInner == 40);
+  REQUIRE_THROWS_AS(Mafs::Internal::Kernels::ParallelFor(8, 4,
+                                                         [](size_t, size_t nEnd) {
+                                                           if (nEnd > 4)
+                                                             throw std::out_of_range("chunk");
+                                                         }),
+                    std::out_of_range);
+}